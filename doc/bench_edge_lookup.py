@@ -0,0 +1,37 @@
+#!/bin/env python
+
+# Compares the lookup and removal of edges given by their endpoints, with and
+# without Graph.set_fast_edge_lookup(), for a hub vertex of degree k.
+
+from __future__ import print_function
+
+import time
+from graph_tool.all import *
+import numpy.random
+from numpy.random import randint
+
+numpy.random.seed(42)
+
+for k in [10 ** 2, 10 ** 4, 10 ** 5, 10 ** 6]:
+    for fast in [False, True]:
+        g = Graph()
+        g.add_vertex(k + 1)
+        g.add_edge_list([(0, i) for i in range(1, k + 1)])
+        g.set_fast_edge_lookup(fast)
+
+        Q = min(20000, int(2e8 / k))
+        ts = randint(1, 2 * k + 1, Q)
+        t0 = time.time()
+        found = 0
+        for t in ts:
+            found += g.edge(0, t) is not None
+        t1 = time.time()
+
+        R = min(Q, k // 2)
+        for t in range(1, R + 1):
+            g.remove_edge(g.edge(0, t))
+        t2 = time.time()
+
+        print("k = %d, fast = %s: edge() %g us/query, remove_edge() %g us/op"
+              " (%d found)" % (k, fast, (t1 - t0) * 1e6 / Q,
+                               (t2 - t1) * 1e6 / R, found))
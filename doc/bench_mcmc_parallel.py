@@ -0,0 +1,52 @@
+#!/bin/env python
+
+# Times sequential and parallel MCMC sweeps of BlockState, for increasing
+# numbers of threads, on a planted partition graph with many blocks.
+
+from __future__ import print_function
+
+import time
+from graph_tool.all import *
+import numpy.random
+
+numpy.random.seed(42)
+seed_rng(42)
+
+N = 100000
+B = 1000
+k = 10
+
+# planted partition: each edge connects two vertices of the same block with
+# probability 0.9, otherwise two random vertices
+b = numpy.arange(N) % B
+E = N * k // 2
+s = numpy.random.randint(0, N, E)
+t = numpy.random.randint(0, N // B, E) * B + b[s]
+out = numpy.random.random(E) > .9
+t[out] = numpy.random.randint(0, N, out.sum())
+g = Graph(directed=False)
+g.add_vertex(N)
+g.add_edge_list(numpy.array([s, t]).T)
+b = g.new_vp("int", b)
+
+nthreads = openmp_get_num_threads()
+
+for dense in [False, True]:
+    t_seq = None
+    for n in [None, 1, 2, 4, 8, 16, 32, 64]:
+        if n is not None:
+            if n > nthreads:
+                break
+            openmp_set_num_threads(n)
+        state = BlockState(g, b=b.copy(), B=B, deg_corr=True)
+        state.mcmc_sweep(niter=1, parallel=n is not None,
+                         entropy_args=dict(dense=dense))
+        t0 = time.time()
+        dS, nmoves = state.mcmc_sweep(niter=5, parallel=n is not None,
+                                      entropy_args=dict(dense=dense))
+        t = (time.time() - t0) / 5
+        if t_seq is None:
+            t_seq = t
+        print("dense = %s, threads = %s: %g s/sweep, speedup %g (%d moves)" %
+              (dense, "sequential" if n is None else n, t, t_seq / t, nmoves))
+    openmp_set_num_threads(nthreads)
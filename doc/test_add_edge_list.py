@@ -0,0 +1,97 @@
+#!/bin/env python
+
+# Checks that the bulk insertion of edge arrays by Graph.add_edge_list()
+# gives the same graph as inserting the edges one by one with
+# Graph.add_edge(), including the edge indexes and the fast edge lookup.
+
+from __future__ import print_function
+
+from graph_tool.all import *
+import numpy.random
+from numpy.random import randint, random
+
+numpy.random.seed(42)
+seed_rng(42)
+
+verbose = __name__ == "__main__"
+
+
+def check_eq(name, x, y):
+    if x != y:
+        print("Warning, %s differs" % name)
+    elif verbose:
+        print(name, "OK")
+
+
+def adjacency(g, eprops=[]):
+    # out- and in-edges of every vertex, in their order, with the edge index
+    # and the given edge property values
+    adj = []
+    for v in g.vertices():
+        out = [(int(e.target()), int(g.edge_index[e])) +
+               tuple(p[e] for p in eprops) for e in v.out_edges()]
+        inc = []
+        if g.is_directed():
+            inc = [(int(e.source()), int(g.edge_index[e])) +
+                   tuple(p[e] for p in eprops) for e in v.in_edges()]
+        adj.append((out, inc))
+    return adj
+
+
+def base_graph(directed, fast):
+    # graph with free edge indexes, which are reused by the new edges
+    g = Graph(directed=directed)
+    g.add_vertex(100)
+    for i in range(300):
+        g.add_edge(i % 100, (7 * i) % 100)
+    for e in list(g.edges())[::3]:
+        g.remove_edge(e)
+    g.set_fast_edge_lookup(fast)
+    g.ep.w = g.new_ep("double")
+    return g
+
+
+for directed in [True, False]:
+    for fast in [False, True]:
+        for rev in [False, True]:
+            # endpoints beyond the existing vertices, parallel edges and
+            # self-loops included
+            el = randint(0, 150, (2000, 2))
+            el[:100, 1] = el[:100, 0]
+            el[100:200] = el[:100]
+            ws = random(len(el))
+
+            g1 = base_graph(directed, fast)
+            g1.set_reversed(rev)
+            g1.add_edge_list(numpy.column_stack((el, ws)), eprops=[g1.ep.w])
+            g1.set_reversed(False)
+
+            g2 = base_graph(directed, fast)
+            g2.set_reversed(rev)
+            for (s, t), x in zip(el, ws):
+                e = g2.add_edge(s, t)
+                g2.ep.w[e] = x
+            g2.set_reversed(False)
+
+            name = "directed=%s, fast=%s, reversed=%s" % (directed, fast,
+                                                          rev)
+            check_eq("number of vertices for %s" % name,
+                     g1.num_vertices(), g2.num_vertices())
+            check_eq("adjacency for %s" % name,
+                     adjacency(g1, [g1.ep.w]), adjacency(g2, [g2.ep.w]))
+
+            for s, t in el[::10]:
+                check_eq("edge(%d, %d) for %s" % (s, t, name),
+                         sorted(int(g1.edge_index[e])
+                                for e in g1.edge(s, t, all_edges=True)),
+                         sorted(int(g2.edge_index[e])
+                                for e in g2.edge(s, t, all_edges=True)))
+
+            # the edges inserted in bulk can be removed as usual
+            for g in [g1, g2]:
+                for e in list(g.edges())[::4]:
+                    g.remove_edge(e)
+            check_eq("adjacency after removal for %s" % name,
+                     adjacency(g1, [g1.ep.w]), adjacency(g2, [g2.ep.w]))
+
+print("OK")
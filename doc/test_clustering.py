@@ -0,0 +1,121 @@
+#!/bin/env python
+
+# Compares the motif counts returned by motifs() with a direct enumeration of
+# the induced subgraphs, for several numbers of threads, with and without a
+# motif_list, and checks the triangle counts of the edges.
+
+from __future__ import print_function
+
+import itertools
+from graph_tool.all import *
+import numpy.random
+from numpy.random import poisson
+
+numpy.random.seed(42)
+seed_rng(42)
+
+verbose = __name__ == "__main__"
+
+nthreads = openmp_get_num_threads()
+
+
+def brute_force_motifs(g, k):
+    # classifies every connected induced subgraph of size k by isomorphism
+    ms = []
+    counts = []
+    for vs in itertools.combinations(range(g.num_vertices()), k):
+        mask = g.new_vp("bool")
+        mask.a[list(vs)] = True
+        u = GraphView(g, vfilt=mask)
+        hist = label_components(GraphView(u, directed=False))[1]
+        if len(hist) != 1:
+            continue
+        m = Graph(u, prune=True)
+        for i, m2 in enumerate(ms):
+            if isomorphism(m, m2):
+                counts[i] += 1
+                break
+        else:
+            ms.append(m)
+            counts.append(1)
+    return ms, counts
+
+
+def match(ms1, counts1, ms2, counts2):
+    # whether both lists contain the same motifs, with the same counts
+    if len(ms1) != len(ms2):
+        return False
+    for m, c in zip(ms1, counts1):
+        for m2, c2 in zip(ms2, counts2):
+            if isomorphism(m, m2):
+                if c != c2:
+                    return False
+                break
+        else:
+            return False
+    return True
+
+
+for directed in [False, True]:
+    for k, N in [(3, 30), (4, 20)]:
+        if directed:
+            g = random_graph(N, lambda: (poisson(2), poisson(2)))
+        else:
+            g = random_graph(N, lambda: poisson(3), directed=False)
+
+        ms0, counts0 = brute_force_motifs(g, k)
+
+        for n in [1, 2, 4]:
+            openmp_set_num_threads(n)
+            ms, counts = motifs(g, k)
+            # this enumerates the subgraphs, even for k = 3
+            ms_m, counts_m, maps = motifs(g, k, return_maps=True)
+            openmp_set_num_threads(nthreads)
+
+            name = "directed=%s, k=%d, threads=%d" % (directed, k, n)
+            if not match(ms, counts, ms0, counts0):
+                print("Warning, motif counts differ from the direct " +
+                      "enumeration for %s: %s != %s" % (name, str(counts),
+                                                        str(counts0)))
+            elif verbose:
+                print("motif counts for", name, "OK")
+            if not match(ms_m, counts_m, ms0, counts0):
+                print("Warning, motif counts with return_maps == True " +
+                      "differ for %s" % name)
+            for i, c in enumerate(counts_m):
+                if len(maps[i]) != c:
+                    print("Warning, wrong number of maps for %s" % name)
+
+            # only the given motifs are counted
+            for sub in [[0], [len(ms) - 1], list(reversed(range(len(ms))))]:
+                ms_l, counts_l = motifs(g, k, motif_list=[ms[i] for i in sub])
+                if not match(ms_l, counts_l, [ms[i] for i in sub],
+                             [counts[i] for i in sub]):
+                    print("Warning, motif counts with motif_list differ for " +
+                          "%s: %s != %s" % (name, str(counts_l),
+                                            str([counts[i] for i in sub])))
+                elif verbose:
+                    print("motif counts with motif_list", sub, "for", name,
+                          "OK")
+
+# every edge of K4 belongs to two triangles, also with parallel and reciprocal
+# edges, while self-loops belong to none
+for directed in [False, True]:
+    g = complete_graph(4, directed=directed)
+    g.add_edge(0, 1)
+    g.add_edge(2, 2)
+    for n in [1, 2, 4]:
+        openmp_set_num_threads(n)
+        tri = edge_triangles(g)
+        openmp_set_num_threads(nthreads)
+        for e in g.edges():
+            expected = 0 if e.source() == e.target() else 2
+            if tri[e] != expected:
+                print("Warning, edge (%d, %d) of K4 belongs to %d triangles " %
+                      (int(e.source()), int(e.target()), tri[e]) +
+                      "instead of %d, for directed=%s, threads=%d" %
+                      (expected, directed, n))
+    if verbose:
+        print("edge triangles of K4 for directed=%s OK" % directed)
+
+print("OK")
@@ -0,0 +1,82 @@
+#!/bin/env python
+
+# Compares the component labels obtained by label_components() with
+# different numbers of threads with those of a serial search.
+
+from __future__ import print_function
+
+from graph_tool.all import *
+import numpy.random
+from numpy.random import poisson
+import scipy.sparse
+import scipy.sparse.csgraph
+
+numpy.random.seed(42)
+seed_rng(42)
+
+verbose = __name__ == "__main__"
+
+nthreads = openmp_get_num_threads()
+thread_counts = [1, 2, 4, 8]
+
+
+def degrees(k, directed):
+    if directed:
+        return lambda: (poisson(k), poisson(k))
+    return lambda: poisson(k)
+
+
+def check(name, x, y):
+    x = numpy.asarray(x)
+    y = numpy.asarray(y)
+    if x.dtype.kind == "f":
+        equal = x.shape == y.shape and numpy.allclose(x, y)
+    else:
+        equal = numpy.array_equal(x, y)
+    if not equal:
+        print("Warning, %s differs" % name)
+    elif verbose:
+        print(name, "OK")
+
+
+def reference_labels(g, strong):
+    # labels of the scipy search, renumbered in the order of the smallest
+    # vertex index of each component
+    N = g.num_vertices()
+    es = [(int(e.source()), int(e.target())) for e in g.edges()]
+    s, t = zip(*es) if len(es) > 0 else ([], [])
+    A = scipy.sparse.coo_matrix((numpy.ones(len(es)), (s, t)), shape=(N, N))
+    nc, l = scipy.sparse.csgraph.connected_components(A, directed=strong,
+                                                      connection="strong")
+    relabel = {}
+    for r in l:
+        if r not in relabel:
+            relabel[r] = len(relabel)
+    return numpy.array([relabel[r] for r in l])
+
+
+for directed in [False, True]:
+    for k in [0.8, 1.5, 4]:
+        g = random_graph(5000, degrees(k, directed), directed=directed)
+        ref = reference_labels(g, directed)
+        for n in thread_counts:
+            openmp_set_num_threads(n)
+            comp, hist = label_components(g)
+            openmp_set_num_threads(nthreads)
+            name = "component labels for directed=%s, k=%g, threads=%d" % \
+                   (directed, k, n)
+            check(name, comp.a, ref)
+            check("histogram of " + name, hist, numpy.bincount(ref))
+
+        # vertices removed from a view
+        u = GraphView(g, vfilt=lambda v: int(v) % 5 != 0)
+        ref = reference_labels(Graph(u, prune=True), directed)
+        for n in thread_counts:
+            openmp_set_num_threads(n)
+            comp = label_components(u)[0]
+            openmp_set_num_threads(nthreads)
+            check(("component labels for filtered graph with " +
+                   "directed=%s, k=%g, threads=%d") % (directed, k, n),
+                  comp.fa, ref)
+
+print("OK")
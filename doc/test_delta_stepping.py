@@ -0,0 +1,90 @@
+#!/bin/env python
+
+# Compares the distances obtained by the parallel delta-stepping search
+# (shortest_distance(..., delta_stepping=True)) with those of Dijkstra's
+# algorithm, for several bucket widths and numbers of threads.
+
+from __future__ import print_function
+
+from graph_tool.all import *
+import numpy.random
+from numpy.random import randint, poisson, random
+
+numpy.random.seed(42)
+seed_rng(42)
+
+verbose = __name__ == "__main__"
+
+nthreads = openmp_get_num_threads()
+thread_counts = [1, 2, 4, 8]
+
+
+def degrees(k, directed):
+    if directed:
+        return lambda: (poisson(k), poisson(k))
+    return lambda: poisson(k)
+
+
+def check(name, x, y):
+    x = numpy.asarray(x)
+    y = numpy.asarray(y)
+    if x.dtype.kind == "f":
+        equal = x.shape == y.shape and numpy.allclose(x, y)
+    else:
+        equal = numpy.array_equal(x, y)
+    if not equal:
+        print("Warning, %s differs" % name)
+    elif verbose:
+        print(name, "OK")
+
+
+for directed in [True, False]:
+    g = random_graph(3000, degrees(4, directed), directed=directed)
+    wi = g.new_ep("int", randint(1, 20, g.num_edges()))
+    wd = g.new_ep("double", random(g.num_edges()) * 10)
+    wd.a[:10] = 0                          # zero weights are allowed
+
+    for w in [wi, wd]:
+        for max_dist in [None, 15]:
+            for s in [0, 10, 100]:
+                d0, p0 = shortest_distance(g, source=g.vertex(s), weights=w,
+                                           max_dist=max_dist, pred_map=True)
+                for n in thread_counts:
+                    openmp_set_num_threads(n)
+                    for delta in [None, 0.5, 3, 100]:
+                        d, p = shortest_distance(g, source=g.vertex(s),
+                                                 weights=w, max_dist=max_dist,
+                                                 pred_map=True,
+                                                 delta_stepping=True,
+                                                 delta=delta)
+                        name = ("delta-stepping distances for directed=%s, " +
+                                "weights=%s, max_dist=%s, source=%d, " +
+                                "threads=%d, delta=%s") % \
+                                (directed, w.value_type(), max_dist, s, n,
+                                 delta)
+                        check(name, d.a, d0.a)
+
+                        # the predecessors may differ, but must be on a
+                        # shortest path
+                        if max_dist is not None:
+                            continue
+                        ok = True
+                        for v in g.vertices():
+                            u = g.vertex(p[v])
+                            if u == v:
+                                continue
+                            x = min(w[e] for e in g.edge(u, v, all_edges=True))
+                            if abs(d[u] + x - d[v]) > 1e-8 * max(1, d[v]):
+                                ok = False
+                        if not ok:
+                            print("Warning, invalid predecessors in " + name)
+                openmp_set_num_threads(nthreads)
+
+try:
+    shortest_distance(g, source=g.vertex(0), weights=wd, delta_stepping=True,
+                      delta=0)
+    print("Warning, delta == 0 accepted")
+except ValueError:
+    pass
+
+print("OK")
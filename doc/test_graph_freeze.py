@@ -0,0 +1,68 @@
+#!/bin/env python
+
+# Checks that the read-only algorithms give the same results on a graph
+# frozen with Graph.freeze(), where they use the CSR snapshot, as on the
+# adjacency list, for several graph views.
+
+from __future__ import print_function
+
+from graph_tool.all import *
+import numpy.random
+from numpy.random import poisson, random
+
+numpy.random.seed(42)
+seed_rng(42)
+
+verbose = __name__ == "__main__"
+
+
+def check(name, x, y):
+    x = numpy.asarray(x, dtype="float")
+    y = numpy.asarray(y, dtype="float")
+    if x.shape != y.shape or not numpy.allclose(x, y, equal_nan=True):
+        print("Warning, %s differs: %s != %s" % (name, str(x), str(y)))
+    elif verbose:
+        print(name, "OK")
+
+
+g = random_graph(1000, lambda: (poisson(3), poisson(3)))
+w = g.new_ep("double", random(g.num_edges()) + 0.1)
+
+
+def algorithms(u, w):
+    s = u.vertex(0)
+    return [("pagerank", pagerank(u).fa),
+            ("local_clustering", local_clustering(u).fa),
+            ("global_clustering", global_clustering(u)),
+            ("unweighted shortest_distance",
+             shortest_distance(u, source=s).fa),
+            ("weighted shortest_distance",
+             shortest_distance(u, source=s, weights=w).fa)]
+
+
+views = [("directed", lambda: g),
+         ("undirected", lambda: GraphView(g, directed=False)),
+         ("reversed", lambda: GraphView(g, reversed=True)),
+         ("filtered", lambda: GraphView(g, vfilt=lambda v: int(v) % 7 != 0))]
+
+for name, view in views:
+    g.unfreeze()
+    ref = algorithms(view(), w)
+    g.freeze()
+    if not g.is_frozen():
+        print("Warning, graph not frozen after freeze()")
+    for (alg, x), (alg, y) in zip(algorithms(view(), w), ref):
+        check("frozen %s, %s" % (name, alg), x, y)
+
+g.freeze()
+e = g.add_edge(0, 1)
+w[e] = 1
+if g.is_frozen():
+    print("Warning, graph still frozen after modification")
+ref = algorithms(g, w)
+g.freeze()
+for (alg, x), (alg, y) in zip(algorithms(g, w), ref):
+    check("frozen after modification, %s" % alg, x, y)
+g.unfreeze()
+
+print("OK")
@@ -0,0 +1,151 @@
+#!/bin/env python
+
+# Checks that graphs saved with the memory-mappable version 2 of the gt
+# format (Graph.save(..., mmap=True)) are loaded unchanged, with and without
+# compression.
+
+from __future__ import print_function
+
+import os
+import tempfile
+from graph_tool.all import *
+import numpy.random
+from numpy.random import randint, poisson, random
+
+numpy.random.seed(42)
+seed_rng(42)
+
+verbose = __name__ == "__main__"
+
+
+def check(name, x, y):
+    x = numpy.asarray(x, dtype="float")
+    y = numpy.asarray(y, dtype="float")
+    if x.shape != y.shape or not numpy.allclose(x, y, equal_nan=True):
+        print("Warning, %s differs: %s != %s" % (name, str(x), str(y)))
+    elif verbose:
+        print(name, "OK")
+
+
+def check_eq(name, x, y):
+    if x != y:
+        print("Warning, %s differs" % name)
+    elif verbose:
+        print(name, "OK")
+
+
+def adjacency(g, eprops=[]):
+    # out- and in-edges of every vertex, in their order, with the edge index
+    # and the given edge property values
+    adj = []
+    for v in g.vertices():
+        out = [(int(e.target()), int(g.edge_index[e])) +
+               tuple(p[e] for p in eprops) for e in v.out_edges()]
+        inc = []
+        if g.is_directed():
+            inc = [(int(e.source()), int(g.edge_index[e])) +
+                   tuple(p[e] for p in eprops) for e in v.in_edges()]
+        adj.append((out, inc))
+    return adj
+
+
+def unindexed(adj):
+    # the same as above, without the edge indexes, as sorted lists
+    return [(sorted(x[:1] + x[2:] for x in out),
+             sorted(x[:1] + x[2:] for x in inc)) for out, inc in adj]
+
+
+tmpdir = tempfile.mkdtemp()
+
+for directed in [True, False]:
+    if directed:
+        g = random_graph(500, lambda: (poisson(3), poisson(3)))
+    else:
+        g = random_graph(500, lambda: poisson(3), directed=False)
+
+    # leave gaps in the edge indexes
+    for e in list(g.edges())[::5]:
+        g.remove_edge(e)
+
+    g.vp.vi = g.new_vp("int", randint(0, 100, g.num_vertices()))
+    g.vp.vd = g.new_vp("double", random(g.num_vertices()))
+    g.vp.vs = g.new_vp("string")
+    g.vp.vv = g.new_vp("vector<double>")
+    g.vp.vo = g.new_vp("object")
+    for v in g.vertices():
+        g.vp.vs[v] = "v%d" % int(v)
+        g.vp.vv[v] = random(int(v) % 4)
+        g.vp.vo[v] = {"v": int(v)}
+    g.ep.ei = g.new_ep("int64_t")
+    g.ep.ed = g.new_ep("double")
+    g.ep.es = g.new_ep("string")
+    for e in g.edges():
+        g.ep.ei[e] = randint(0, 1 << 40)
+        g.ep.ed[e] = random()
+        g.ep.es[e] = "%d-%d" % (int(e.source()), int(e.target()))
+    g.gp.desc = g.new_gp("string", "test graph")
+
+    for suffix in [".gt", ".gt.gz"]:
+        for mmap in [False, True]:
+            fname = os.path.join(tmpdir, "g%s" % suffix)
+            g.save(fname, mmap=mmap)
+            u = load_graph(fname)
+            u2 = load_graph(fname)
+            os.remove(fname)
+
+            name = "directed=%s, %s, mmap=%s" % (directed, suffix, mmap)
+            if u.is_directed() != directed:
+                print("Warning, directedness differs for %s" % name)
+            check_eq("number of vertices for %s" % name,
+                     u.num_vertices(), g.num_vertices())
+            check_eq("number of edges for %s" % name,
+                     u.num_edges(), g.num_edges())
+            check_eq("adjacency for %s" % name,
+                     unindexed(adjacency(u, [u.ep.ei, u.ep.ed, u.ep.es])),
+                     unindexed(adjacency(g, [g.ep.ei, g.ep.ed, g.ep.es])))
+            if mmap:
+                # the edges are renumbered in the order of the out-edges
+                idx = sorted(int(u.edge_index[e]) for e in u.edges())
+                check_eq("edge indexes for %s" % name, idx,
+                         list(range(u.num_edges())))
+            for k in ["vi", "vd"]:
+                check("property %s for %s" % (k, name), u.vp[k].fa, g.vp[k].fa)
+            for k in ["vs", "vo"]:
+                check_eq("property %s for %s" % (k, name),
+                         [u.vp[k][v] for v in u.vertices()],
+                         [g.vp[k][v] for v in g.vertices()])
+            check_eq("property vv for %s" % name,
+                     [list(u.vp.vv[v]) for v in u.vertices()],
+                     [list(g.vp.vv[v]) for v in g.vertices()])
+            check_eq("property desc for %s" % name, u.gp.desc, g.gp.desc)
+
+            if u.is_frozen() != mmap:
+                print("Warning, is_frozen() == %s for %s" % (u.is_frozen(),
+                                                            name))
+
+            # copies of a graph which was never modified are complete
+            w = Graph(u2)
+            check_eq("adjacency of a copy for %s" % name,
+                     unindexed(adjacency(w, [w.ep.ei, w.ep.ed, w.ep.es])),
+                     unindexed(adjacency(g, [g.ep.ei, g.ep.ed, g.ep.es])))
+
+            # the property maps can be modified, without affecting the other
+            # graphs loaded from the same file, and they grow as usual
+            u.vp.vi.fa += 1
+            check("modified property vi for %s" % name, u.vp.vi.fa,
+                  g.vp.vi.fa + 1)
+            check("property vi of another graph for %s" % name, u2.vp.vi.fa,
+                  g.vp.vi.fa)
+            u.add_vertex()
+            check("property vd after adding a vertex for %s" % name,
+                  u.vp.vd.fa[:-1], g.vp.vd.fa)
+
+            # the loaded graph is an ordinary graph otherwise
+            e = u.add_edge(0, 1)
+            if u.is_frozen():
+                print("Warning, loaded graph still frozen after " +
+                      "modification for %s" % name)
+
+os.rmdir(tmpdir)
+
+print("OK")
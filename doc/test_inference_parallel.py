@@ -0,0 +1,70 @@
+#!/bin/env python
+
+# Compares the distributions of the description length and of the number of
+# nonempty blocks sampled by sequential and parallel MCMC sweeps, for several
+# numbers of threads, with the sparse and dense entropies.
+
+from __future__ import print_function
+
+from graph_tool.all import *
+import numpy.random
+from numpy.random import randint
+import scipy.stats
+
+numpy.random.seed(42)
+seed_rng(42)
+
+verbose = __name__ == "__main__"
+
+g = graph_union(complete_graph(4), complete_graph(4))
+g.add_edge(3, 4)
+vs = list(g.add_vertex(8))
+for i in range(3 * 8):
+    s = vs[randint(4)]
+    t = vs[randint(4) + 4]
+    g.add_edge(s, t)
+
+nthreads = openmp_get_num_threads()
+
+for directed in [True, False]:
+    g.set_directed(directed)
+
+    for dense in [False, True]:
+        hists = {}
+        entropy_args = dict(dense=dense, multigraph=not dense)
+
+        state = minimize_blockmodel_dl(g, deg_corr=not dense)
+        state = state.copy(B=g.num_vertices())
+
+        for n in [None, 1, 2, 4]:
+            if n is not None:
+                openmp_set_num_threads(n)
+            mcmc_args = dict(beta=1, niter=10, parallel=n is not None,
+                             entropy_args=entropy_args)
+            hists[n] = mcmc_equilibrate(state,
+                                        mcmc_args=mcmc_args,
+                                        wait=1000,
+                                        nbreaks=5,
+                                        callback=lambda s: [s.get_nonempty_B()],
+                                        history=True)
+            openmp_set_num_threads(nthreads)
+
+        for n in [1, 2, 4]:
+            for i, name in [(0, "S"), (2, "B")]:
+                x1 = numpy.array(list(zip(*hists[None]))[i], dtype="float")
+                x2 = numpy.array(list(zip(*hists[n]))[i], dtype="float")
+                # add very small normal noise, to solve discreteness issue
+                x1 += numpy.random.normal(0, 1e-2, len(x1))
+                x2 += numpy.random.normal(0, 1e-2, len(x2))
+                D, p = scipy.stats.ks_2samp(x1, x2)
+                if verbose:
+                    print("directed:", directed, "dense:", dense, "threads:", n,
+                          name, "D:", D, "p-value:", p)
+                if p < .001:
+                    print(("Warning, distributions of %s for directed=%s, " +
+                           "dense=%s are not the same for sequential and " +
+                           "parallel sweeps with %d threads, with a p-value: " +
+                           "%g (D=%g)") % (name, str(directed), str(dense), n,
+                                           p, D))
+
+print("OK")
@@ -0,0 +1,75 @@
+#!/bin/env python
+
+# Compares the k-core decomposition updated incrementally by kcore_update()
+# with the one computed from scratch, and the decompositions obtained with
+# different numbers of threads.
+
+from __future__ import print_function
+
+from graph_tool.all import *
+import numpy.random
+from numpy.random import randint, poisson, random
+
+numpy.random.seed(42)
+seed_rng(42)
+
+verbose = __name__ == "__main__"
+
+nthreads = openmp_get_num_threads()
+thread_counts = [1, 2, 4, 8]
+
+
+def degrees(k, directed):
+    if directed:
+        return lambda: (poisson(k), poisson(k))
+    return lambda: poisson(k)
+
+
+def check(name, x, y):
+    x = numpy.asarray(x)
+    y = numpy.asarray(y)
+    if x.dtype.kind == "f":
+        equal = x.shape == y.shape and numpy.allclose(x, y)
+    else:
+        equal = numpy.array_equal(x, y)
+    if not equal:
+        print("Warning, %s differs" % name)
+    elif verbose:
+        print(name, "OK")
+
+
+for directed in [False, True]:
+    g = random_graph(2000, degrees(3, directed), directed=directed)
+    u = GraphView(g, directed=False)
+    kcore = kcore_decomposition(u)
+
+    for i in range(200):
+        inserted = []
+        removed = []
+        if random() < .5:
+            for j in range(randint(1, 10)):
+                s, t = randint(0, g.num_vertices(), 2)
+                g.add_edge(s, t)
+                inserted.append((s, t))
+        else:
+            es = list(g.edges())
+            m = min(randint(1, 10), len(es))
+            for j in numpy.random.choice(len(es), m, replace=False):
+                e = es[j]
+                removed.append((int(e.source()), int(e.target())))
+                g.remove_edge(e)
+        kcore_update(g, kcore, inserted=inserted, removed=removed)
+        check("k-core after update %d for directed=%s" % (i, directed),
+              kcore.a, kcore_decomposition(u).a)
+
+    for deg in ["in", "out", "total"]:
+        for n in thread_counts:
+            openmp_set_num_threads(n)
+            kc = kcore_decomposition(g, deg=deg)
+            openmp_set_num_threads(nthreads)
+            if n == thread_counts[0]:
+                kc0 = kc
+            check("k-core for directed=%s, deg=%s, threads=%d" %
+                  (directed, deg, n), kc.a, kc0.a)
+
+print("OK")
@@ -0,0 +1,67 @@
+#!/bin/env python
+
+# Compares the global clustering coefficient estimated by
+# stream_global_clustering(), with a reservoir larger than the graph, with the
+# exact one, for graphs with parallel, reciprocal edges and self-loops, and
+# checks that truncated files are rejected.
+
+from __future__ import print_function
+
+import os
+import tempfile
+from graph_tool.all import *
+import numpy.random
+from numpy.random import randint, poisson
+
+numpy.random.seed(42)
+seed_rng(42)
+
+verbose = __name__ == "__main__"
+
+tmpdir = tempfile.mkdtemp()
+
+for directed in [False, True]:
+    if directed:
+        g = random_graph(300, lambda: (poisson(4), poisson(4)))
+    else:
+        g = random_graph(300, lambda: poisson(4), directed=False)
+    es = numpy.array([(int(u), int(v)) for u, v in g.edges()])
+    # parallel and reciprocal edges
+    g.add_edge_list(es[:200])
+    g.add_edge_list(es[200:400, ::-1])
+    for i in range(20):
+        v = randint(g.num_vertices())
+        g.add_edge(v, v)
+
+    c = global_clustering(g)[0]
+
+    for fmt in ["gt", "edgelist"]:
+        if fmt == "gt":
+            fname = os.path.join(tmpdir, "g.gt")
+            g.save(fname)
+        else:
+            fname = os.path.join(tmpdir, "g.txt")
+            with open(fname, "w") as f:
+                for u, v in g.edges():
+                    print(int(u), int(v), file=f)
+
+        cs = stream_global_clustering(fname, fmt=fmt, n_estimates=2)[0]
+        if abs(cs[0] - c) > 1e-8:
+            print("Warning, streamed clustering differs for directed=%s, " %
+                  directed + "fmt=%s: %g != %g" % (fmt, cs[0], c))
+        elif verbose:
+            print("streamed clustering for directed=%s, fmt=%s OK" %
+                  (directed, fmt))
+
+    data = open(os.path.join(tmpdir, "g.gt"), "rb").read()
+    fname = os.path.join(tmpdir, "t.gt")
+    with open(fname, "wb") as f:
+        f.write(data[:len(data) // 4])
+    try:
+        stream_global_clustering(fname, fmt="gt")
+        print("Warning, truncated file accepted for directed=%s" % directed)
+    except IOError:
+        if verbose:
+            print("truncated file rejected for directed=%s OK" % directed)
+
+print("OK")
@@ -23,6 +23,9 @@
 #include "graph.hh"
 #include "graph_selectors.hh"
 #include "graph_util.hh"
+#include "random.hh"
+
+#include "graph_betweenness.hh"
 
 using namespace std;
 using namespace boost;
@@ -60,67 +63,57 @@ void normalize_betweenness(const Graph& g,
 
 struct get_betweenness
 {
-    typedef void result_type;
-    template <class Graph, class EdgeBetweenness, class VertexBetweenness>
-    void operator()(Graph& g,
-                    GraphInterface::vertex_index_map_t index_map,
-                    EdgeBetweenness edge_betweenness,
-                    VertexBetweenness vertex_betweenness,
-                    bool normalize, size_t n) const
+    // uniform sample of pivots, without replacement
+    template <class Graph>
+    static vector<size_t> sample_pivots(Graph& g, size_t n_pivots, rng_t& rng)
     {
-        vector<vector<typename graph_traits<Graph>::edge_descriptor> >
-            incoming_map(num_vertices(g));
-        vector<size_t> distance_map(num_vertices(g));
-        vector<typename property_traits<VertexBetweenness>::value_type>
-            dependency_map(num_vertices(g));
-        vector<size_t> path_count_map(num_vertices(g));
-        brandes_betweenness_centrality
-            (g, vertex_betweenness, edge_betweenness,
-             make_iterator_property_map(incoming_map.begin(), index_map),
-             make_iterator_property_map(distance_map.begin(), index_map),
-             make_iterator_property_map(dependency_map.begin(), index_map),
-             make_iterator_property_map(path_count_map.begin(), index_map),
-             index_map);
-        if (normalize)
-            normalize_betweenness(g, edge_betweenness, vertex_betweenness, n);
+        vector<size_t> sources;
+        for (auto v : vertices_range(g))
+            sources.push_back(v);
+        n_pivots = std::min(n_pivots, sources.size());
+        for (size_t i = 0; i < n_pivots; ++i)
+        {
+            std::uniform_int_distribution<size_t> sample(i, sources.size() - 1);
+            std::swap(sources[i], sources[sample(rng)]);
+        }
+        sources.resize(n_pivots);
+        return sources;
     }
-};
 
-struct get_weighted_betweenness
-{
-    typedef void result_type;
-    template <class Graph, class EdgeBetweenness, class VertexBetweenness,
-              class VertexIndexMap>
-        void operator()(Graph& g, VertexIndexMap vertex_index,
-                        EdgeBetweenness edge_betweenness,
-                        VertexBetweenness vertex_betweenness,
-                        boost::any weight_map, bool normalize,
-                        size_t n, size_t max_eindex) const
+    // the dependencies of each source are scaled by n / sources.size()
+    template <class Graph, class EdgeBetweenness, class VertexBetweenness>
+    void operator()(Graph& g, EdgeBetweenness edge_betweenness,
+                    VertexBetweenness vertex_betweenness, boost::any weight,
+                    const vector<size_t>& sources, bool normalize, size_t n,
+                    size_t max_eindex) const
     {
-        vector<vector<typename graph_traits<Graph>::edge_descriptor> >
-            incoming_map(num_vertices(g));
-        vector<typename property_traits<EdgeBetweenness>::value_type>
-            distance_map(num_vertices(g));
-        vector<typename property_traits<VertexBetweenness>::value_type>
-            dependency_map(num_vertices(g));
-        vector<size_t> path_count_map(num_vertices(g));
-
-        typename EdgeBetweenness::checked_t weight =
-            any_cast<typename EdgeBetweenness::checked_t>(weight_map);
-
-        brandes_betweenness_centrality
-            (g, vertex_betweenness, edge_betweenness,
-             make_iterator_property_map(incoming_map.begin(), vertex_index),
-             make_iterator_property_map(distance_map.begin(), vertex_index),
-             make_iterator_property_map(dependency_map.begin(), vertex_index),
-             make_iterator_property_map(path_count_map.begin(), vertex_index),
-             vertex_index, weight.get_unchecked(max_eindex+1));
+        double scale = sources.empty() ? 0 : n / double(sources.size());
+
+        typedef typename property_traits<EdgeBetweenness>::value_type val_t;
+        if (weight.empty())
+        {
+            get_sources_betweenness<size_t>(g, sources, dummy_property_map(),
+                                            edge_betweenness,
+                                            vertex_betweenness, max_eindex,
+                                            scale);
+        }
+        else
+        {
+            typename EdgeBetweenness::checked_t w =
+                any_cast<typename EdgeBetweenness::checked_t>(weight);
+            get_sources_betweenness<val_t>(g, sources,
+                                           w.get_unchecked(max_eindex + 1),
+                                           edge_betweenness,
+                                           vertex_betweenness, max_eindex,
+                                           scale);
+        }
+
         if (normalize)
             normalize_betweenness(g, edge_betweenness, vertex_betweenness, n);
     }
 };
 
-void betweenness(GraphInterface& g, boost::any weight,
+void betweenness(GraphInterface& gi, boost::any weight,
                  boost::any edge_betweenness,
                  boost::any vertex_betweenness,
                  bool normalize)
@@ -133,29 +126,50 @@ void betweenness(GraphInterface& g, boost::any weight,
         throw ValueException("vertex property must be of floating point value"
                              " type");
 
-    if (!weight.empty())
-    {
-        run_action<>()
-            (g, std::bind<>(get_weighted_betweenness(),
-                            std::placeholders::_1, g.get_vertex_index(),
-                            std::placeholders::_2,
-                            std::placeholders::_3, weight, normalize,
-                            g.get_num_vertices(), g.get_edge_index_range()),
-             edge_floating_properties(),
-             vertex_floating_properties())
-            (edge_betweenness, vertex_betweenness);
-    }
-    else
-    {
-        run_action<>()
-            (g, std::bind<void>(get_betweenness(), std::placeholders::_1,
-                                g.get_vertex_index(), std::placeholders::_2,
-                                std::placeholders::_3, normalize,
-                                g.get_num_vertices()),
-             edge_floating_properties(),
-             vertex_floating_properties())
-            (edge_betweenness, vertex_betweenness);
-    }
+    size_t n = gi.get_num_vertices();
+    size_t max_eindex = gi.get_edge_index_range();
+
+    run_action<>()
+        (gi, [&](auto& g, auto eb, auto vb)
+         {
+             // exact values: every vertex is a source
+             vector<size_t> sources;
+             for (auto v : vertices_range(g))
+                 sources.push_back(v);
+             get_betweenness()(g, eb, vb, weight, sources, normalize, n,
+                               max_eindex);
+         },
+         edge_floating_properties(),
+         vertex_floating_properties())
+        (edge_betweenness, vertex_betweenness);
+}
+
+void sampled_betweenness(GraphInterface& gi, boost::any weight,
+                         boost::any edge_betweenness,
+                         boost::any vertex_betweenness,
+                         bool normalize, size_t n_pivots, rng_t& rng)
+{
+    if (!belongs<edge_floating_properties>()(edge_betweenness))
+        throw ValueException("edge property must be of floating point value"
+                             " type");
+
+    if (!belongs<vertex_floating_properties>()(vertex_betweenness))
+        throw ValueException("vertex property must be of floating point value"
+                             " type");
+
+    size_t n = gi.get_num_vertices();
+    size_t max_eindex = gi.get_edge_index_range();
+
+    run_action<>()
+        (gi, [&](auto& g, auto eb, auto vb)
+         {
+             auto sources = get_betweenness::sample_pivots(g, n_pivots, rng);
+             get_betweenness()(g, eb, vb, weight, sources, normalize, n,
+                               max_eindex);
+         },
+         edge_floating_properties(),
+         vertex_floating_properties())
+        (edge_betweenness, vertex_betweenness);
 }
 
 struct get_central_point_dominance
@@ -183,5 +197,6 @@ void export_betweenness()
 {
     using namespace boost::python;
     def("get_betweenness", &betweenness);
+    def("get_sampled_betweenness", &sampled_betweenness);
     def("get_central_point_dominance", &central_point);
 }
@@ -0,0 +1,254 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2016 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_BETWEENNESS_HH
+#define GRAPH_BETWEENNESS_HH
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include "graph.hh"
+#include "graph_selectors.hh"
+#include "graph_util.hh"
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Single-source stage of Brandes' algorithm: a shortest-path search from s,
+// which records the number of shortest paths to each vertex and the edges
+// which lie on them, followed by the accumulation of the dependencies in
+// reverse order of distance. An instance is used by a single thread, and is
+// reused for every source, so that no memory is allocated per source, and
+// only the vertices reached from the previous source need to be reset.
+
+template <class Graph, class Dist>
+class brandes_workspace
+{
+public:
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+
+    brandes_workspace(const Graph& g)
+        : _dist(num_vertices(g)), _sigma(num_vertices(g)),
+          _delta(num_vertices(g)), _preds(num_vertices(g)) {}
+
+    // unweighted search
+    void search(const Graph& g, vertex_t s, dummy_property_map)
+    {
+        reset(g);
+        _dist[s] = 0;
+        _sigma[s] = 1;
+        _order.push_back(s);
+        for (size_t i = 0; i < _order.size(); ++i)
+        {
+            auto u = _order[i];
+            for (const auto& e : out_edges_range(u, g))
+            {
+                auto v = target(e, g);
+                if (_dist[v] == _inf)
+                {
+                    _dist[v] = _dist[u] + 1;
+                    _order.push_back(v);
+                }
+                if (_dist[v] == _dist[u] + 1)
+                {
+                    _sigma[v] += _sigma[u];
+                    _preds[v].push_back(e);
+                }
+            }
+        }
+    }
+
+    // weighted search
+    template <class Weight>
+    void search(const Graph& g, vertex_t s, Weight weight)
+    {
+        auto cmp = [](const auto& a, const auto& b) { return a > b; };
+
+        reset(g);
+        _dist[s] = 0;
+        _sigma[s] = 1;
+        _queue.emplace_back(0, s);
+        while (!_queue.empty())
+        {
+            std::pop_heap(_queue.begin(), _queue.end(), cmp);
+            Dist d;
+            vertex_t u;
+            std::tie(d, u) = _queue.back();
+            _queue.pop_back();
+            if (d > _dist[u])
+                continue;
+            _order.push_back(u);
+            for (const auto& e : out_edges_range(u, g))
+            {
+                auto v = target(e, g);
+                Dist nd = _dist[u] + get(weight, e);
+                if (nd < _dist[v])
+                {
+                    _dist[v] = nd;
+                    _sigma[v] = _sigma[u];
+                    _preds[v].clear();
+                    _preds[v].push_back(e);
+                    _queue.emplace_back(nd, v);
+                    std::push_heap(_queue.begin(), _queue.end(), cmp);
+                }
+                else if (nd == _dist[v] && v != s)
+                {
+                    _sigma[v] += _sigma[u];
+                    _preds[v].push_back(e);
+                }
+            }
+        }
+    }
+
+    // adds the dependencies of the last source to the vertex and edge
+    // accumulators
+    template <class EdgeIndex>
+    void accumulate(const Graph& g, EdgeIndex eindex, vector<double>& vb,
+                    vector<double>& eb)
+    {
+        auto s = _order.front();
+        for (auto iter = _order.rbegin(); iter != _order.rend(); ++iter)
+        {
+            auto u = *iter;
+            for (const auto& e : _preds[u])
+            {
+                auto v = source(e, g);
+                double c = (_sigma[v] / _sigma[u]) * (1 + _delta[u]);
+                _delta[v] += c;
+                eb[eindex[e]] += c;
+            }
+            if (u != s)
+                vb[u] += _delta[u];
+        }
+    }
+
+private:
+    void reset(const Graph&)
+    {
+        for (auto v : _order)
+        {
+            _dist[v] = _inf;
+            _sigma[v] = 0;
+            _delta[v] = 0;
+            _preds[v].clear();
+        }
+        _order.clear();
+        if (!_init)
+        {
+            std::fill(_dist.begin(), _dist.end(), _inf);
+            _init = true;
+        }
+    }
+
+    const Dist _inf = std::numeric_limits<Dist>::has_infinity ?
+        std::numeric_limits<Dist>::infinity() :
+        std::numeric_limits<Dist>::max();
+    bool _init = false;
+    vector<Dist> _dist;
+    vector<double> _sigma;
+    vector<double> _delta;
+    vector<vector<edge_t>> _preds;
+    vector<vertex_t> _order;
+    vector<pair<Dist, vertex_t>> _queue;
+};
+
+// Sets the vertex and edge betweenness maps to the sum of the dependencies of
+// all vertices in "sources", multiplied by "scale". The sources are processed in
+// parallel, each thread with its own workspace and accumulators, which are
+// summed at the end.
+
+template <class Dist, class Graph, class Weight, class EdgeBetweenness,
+          class VertexBetweenness>
+void get_sources_betweenness(const Graph& g, const vector<size_t>& sources,
+                             Weight weight, EdgeBetweenness edge_betweenness,
+                             VertexBetweenness vertex_betweenness,
+                             size_t max_eindex, double scale)
+{
+    size_t N = num_vertices(g);
+    size_t E = max_eindex + 1;
+    auto eindex = get(edge_index_t(), g);
+
+    // each pair of vertices is counted only once
+    if (!boost::is_directed(g))
+        scale /= 2;
+
+#ifdef USING_OPENMP
+    size_t n_threads = (sources.size() > 1) ? omp_get_max_threads() : 1;
+#else
+    size_t n_threads = 1;
+#endif
+
+    vector<vector<double>> vbs(n_threads), ebs(n_threads);
+
+    #pragma omp parallel num_threads(n_threads) if (n_threads > 1)
+    {
+#ifdef USING_OPENMP
+        size_t tid = omp_get_thread_num();
+#else
+        size_t tid = 0;
+#endif
+        auto& vb = vbs[tid];
+        auto& eb = ebs[tid];
+        vb.resize(N);
+        eb.resize(E);
+
+        brandes_workspace<Graph, Dist> ws(g);
+
+        #pragma omp for schedule(runtime)
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            auto s = vertex(sources[i], g);
+            ws.search(g, s, weight);
+            ws.accumulate(g, eindex, vb, eb);
+        }
+    }
+
+    typedef typename property_traits<VertexBetweenness>::value_type vval_t;
+    typedef typename property_traits<EdgeBetweenness>::value_type eval_t;
+
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             double x = 0;
+             for (auto& vb : vbs)
+                 x += vb[v];
+             vertex_betweenness[v] = vval_t(scale * x);
+         });
+
+    parallel_edge_loop
+        (g,
+         [&](const auto& e)
+         {
+             double x = 0;
+             for (auto& eb : ebs)
+                 x += eb[eindex[e]];
+             edge_betweenness[e] = eval_t(scale * x);
+         });
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_BETWEENNESS_HH
@@ -18,7 +18,6 @@
 #ifndef GRAPH_CLOSENESS_HH
 #define GRAPH_CLOSENESS_HH
 
-#include <boost/graph/breadth_first_search.hpp>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 
 #include <boost/python/object.hpp>
@@ -27,6 +26,7 @@
 
 #include "histogram.hh"
 #include "hash_map_wrap.hh"
+#include "graph_ms_bfs.hh"
 
 namespace graph_tool
 {
@@ -49,6 +49,57 @@ struct get_val_type<no_weightS>
 struct get_closeness
 {
     typedef void result_type;
+
+    // unweighted version, which uses a multi-source BFS
+    template <class Graph, class VertexIndex, class Closeness>
+    void operator()(const Graph& g, VertexIndex, no_weightS,
+                    Closeness closeness, bool harmonic, bool norm) const
+    {
+        typedef typename boost::property_traits<Closeness>::value_type c_t;
+        size_t HN = HardNumVertices()(g);
+        parallel_ms_bfs
+            (g,
+             [&](auto& bfs, auto sources, size_t n)
+             {
+                 constexpr size_t width = std::remove_reference_t
+                     <decltype(bfs)>::width;
+                 std::array<size_t, width> sum, comp_size;
+                 std::array<double, width> hsum;
+                 sum.fill(0);
+                 hsum.fill(0);
+                 comp_size.fill(1);
+
+                 bfs.search(g, sources, n,
+                            [&](auto, auto mask, size_t d)
+                            {
+                                for_each_bit(mask,
+                                             [&](size_t i)
+                                             {
+                                                 sum[i] += d;
+                                                 hsum[i] += 1. / d;
+                                                 ++comp_size[i];
+                                             });
+                            });
+
+                 for (size_t i = 0; i < n; ++i)
+                 {
+                     auto v = sources[i];
+                     if (!harmonic)
+                         closeness[v] = 1 / c_t(sum[i]);
+                     else
+                         closeness[v] = hsum[i];
+                     if (norm)
+                     {
+                         if (harmonic)
+                             closeness[v] /= HN - 1;
+                         else
+                             closeness[v] *= comp_size[i] - 1;
+                     }
+                 }
+             });
+    }
+
+    // weighted version, which uses Dijkstra's algorithm from every source
     template <class Graph, class VertexIndex, class WeightMap, class Closeness>
     void operator()(const Graph& g, VertexIndex vertex_index, WeightMap weights,
                     Closeness closeness, bool harmonic, bool norm)
@@ -56,54 +107,53 @@ struct get_closeness
     {
         using namespace boost;
 
-        // select get_vertex_dists based on the existence of weights
-        typedef typename mpl::if_<std::is_same<WeightMap, no_weightS>,
-                                  get_dists_bfs,
-                                  get_dists_djk>::type get_vertex_dists_t;
-
         // distance type
         typedef typename get_val_type<WeightMap>::type val_type;
 
-        get_vertex_dists_t get_vertex_dists;
         size_t HN = HardNumVertices()(g);
-        parallel_vertex_loop
-            (g,
-             [&](auto v)
-             {
-                 unchecked_vector_property_map<val_type,VertexIndex>
-                     dist_map(vertex_index, num_vertices(g));
 
-                 for (auto u : vertices_range(g))
-                     dist_map[u] = numeric_limits<val_type>::max();
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
+        {
+            unchecked_vector_property_map<val_type,VertexIndex>
+                dist_map(vertex_index, num_vertices(g));
 
-                 dist_map[v] = 0;
+            parallel_vertex_loop_no_spawn
+                (g,
+                 [&](auto v)
+                 {
+                     for (auto u : vertices_range(g))
+                         dist_map[u] = numeric_limits<val_type>::max();
 
-                 size_t comp_size = 0;
-                 get_vertex_dists(g, v, vertex_index, dist_map, weights, comp_size);
+                     dist_map[v] = 0;
 
-                 closeness[v] = 0;
-                 for (auto v2 : vertices_range(g))
-                 {
-                     if (v2 != v && dist_map[v2] != numeric_limits<val_type>::max())
+                     size_t comp_size = 0;
+                     get_dists_djk()(g, v, vertex_index, dist_map, weights,
+                                     comp_size);
+
+                     closeness[v] = 0;
+                     for (auto v2 : vertices_range(g))
                      {
-                         if (!harmonic)
-                             closeness[v] += dist_map[v2];
-                         else
-                             closeness[v] += 1. / dist_map[v2];
+                         if (v2 != v && dist_map[v2] != numeric_limits<val_type>::max())
+                         {
+                             if (!harmonic)
+                                 closeness[v] += dist_map[v2];
+                             else
+                                 closeness[v] += 1. / dist_map[v2];
+                         }
                      }
-                 }
 
-                 if (!harmonic)
-                     closeness[v] = 1 / closeness[v];
+                     if (!harmonic)
+                         closeness[v] = 1 / closeness[v];
 
-                 if (norm)
-                 {
-                     if (harmonic)
-                         closeness[v] /= HN - 1;
-                     else
-                         closeness[v] *= comp_size - 1;
-                 }
-             });
+                     if (norm)
+                     {
+                         if (harmonic)
+                             closeness[v] /= HN - 1;
+                         else
+                             closeness[v] *= comp_size - 1;
+                     }
+                 });
+        }
     }
 
 
@@ -139,53 +189,6 @@ struct get_closeness
                                     weight_map(weights).distance_map(dist_map).visitor(vis));
         }
     };
-
-    template <class DistMap>
-    class component_bfs_visitor: public boost::bfs_visitor<>
-    {
-    public:
-        //component_visitor() { }
-        component_bfs_visitor(DistMap dist_map, size_t& comp_size)
-            : _dist_map(dist_map), _comp_size(comp_size) { }
-
-        template <class Vertex, class Graph>
-        void discover_vertex(Vertex, const Graph&)
-        {
-            ++_comp_size;
-        }
-
-        template <class Edge, class Graph>
-        void tree_edge(Edge e, const Graph& g)
-        {
-            _dist_map[target(e, g)] = _dist_map[source(e, g)] + 1;
-        }
-
-    private:
-        DistMap _dist_map;
-        size_t& _comp_size;
-    };
-
-
-    // unweighted version. Use BFS.
-    struct get_dists_bfs
-    {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, no_weightS, size_t& comp_size) const
-        {
-            using namespace boost;
-            typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-            typedef gt_hash_map<vertex_t,default_color_type,
-                                DescriptorHash<VertexIndex> > cmap_t;
-            cmap_t cmap(0, DescriptorHash<VertexIndex>(vertex_index));
-            InitializedPropertyMap<cmap_t>
-                color_map(cmap, color_traits<default_color_type>::white());
-            component_bfs_visitor<DistanceMap> vis(dist_map, comp_size);
-            breadth_first_visit(g, s, visitor(vis).
-                                color_map(color_map));
-        }
-    };
 };
 
 } // boost namespace
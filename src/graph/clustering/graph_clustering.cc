@@ -36,7 +36,7 @@ boost::python::tuple global_clustering(GraphInterface& g)
     double c, c_err;
     bool directed = g.get_directed();
     g.set_directed(false);
-    run_action<graph_tool::detail::never_directed>()
+    run_action<graph_tool::never_directed_frozen>()
         (g, std::bind(get_global_clustering(), std::placeholders::_1,
                       std::ref(c), std::ref(c_err)))();
     g.set_directed(directed);
@@ -47,7 +47,7 @@ void local_clustering(GraphInterface& g, boost::any prop)
 {
     bool directed = g.get_directed();
     g.set_directed(false);
-    run_action<graph_tool::detail::never_directed>()
+    run_action<graph_tool::never_directed_frozen>()
         (g, std::bind(set_clustering_to_property(),
                       std::placeholders::_1,
                       std::placeholders::_2),
@@ -55,17 +55,32 @@ void local_clustering(GraphInterface& g, boost::any prop)
     g.set_directed(directed);
 }
 
+void edge_triangles(GraphInterface& g, boost::any prop)
+{
+    bool directed = g.get_directed();
+    g.set_directed(false);
+    run_action<graph_tool::never_directed_frozen>()
+        (g, std::bind(set_edge_triangles_to_property(),
+                      std::placeholders::_1,
+                      std::placeholders::_2),
+         writable_edge_scalar_properties())(prop);
+    g.set_directed(directed);
+}
+
 using namespace boost::python;
 
 void extended_clustering(GraphInterface& g, boost::python::list props);
 void get_motifs(GraphInterface& g, size_t k, boost::python::list subgraph_list,
                 boost::python::list hist, boost::python::list pvmaps, bool collect_vmaps,
                 boost::python::list p, bool comp_iso, bool fill_list, rng_t& rng);
+void export_sampled_clustering();
 
 BOOST_PYTHON_MODULE(libgraph_tool_clustering)
 {
     def("global_clustering", &global_clustering);
     def("local_clustering", &local_clustering);
+    def("edge_triangles", &edge_triangles);
     def("extended_clustering", &extended_clustering);
     def("get_motifs", &get_motifs);
+    export_sampled_clustering();
 }
@@ -21,6 +21,7 @@
 #include "config.h"
 
 #include "hash_map_wrap.hh"
+#include "graph_triangles.hh"
 #include <boost/mpl/if.hpp>
 
 #ifdef USING_OPENMP
@@ -42,60 +43,23 @@ namespace graph_tool
 {
 using namespace boost;
 
-// calculates the number of triangles to which v belongs
-template <class Graph, class VProp>
-pair<int,int>
-get_triangles(typename graph_traits<Graph>::vertex_descriptor v, VProp& mark,
-              const Graph &g)
-{
-    size_t triangles = 0;
-
-    for (auto n : adjacent_vertices_range(v, g))
-    {
-        if (n == v)
-            continue;
-        mark[n] = true;
-    }
-
-    for (auto n : adjacent_vertices_range(v, g))
-    {
-        if (n == v)
-            continue;
-        for (auto n2 : adjacent_vertices_range(n, g))
-        {
-            if (n2 == n)
-                continue;
-            if (mark[n2])
-                ++triangles;
-        }
-    }
-
-    for (auto n : adjacent_vertices_range(v, g))
-        mark[n] = false;
-
-    size_t k = out_degree(v, g);
-    return make_pair(triangles / 2, (k * (k - 1)) / 2);
-}
-
-
 // retrieves the global clustering coefficient
 struct get_global_clustering
 {
     template <class Graph>
     void operator()(const Graph& g, double& c, double& c_err) const
     {
-        size_t triangles = 0, n = 0;
-        vector<bool> mask(num_vertices(g), false);
+        triangle_counts<Graph> tc(g);
 
+        size_t triangles = 0, n = 0;
         #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            firstprivate(mask) reduction(+:triangles, n)
+            reduction(+:triangles, n)
         parallel_vertex_loop_no_spawn
                 (g,
                  [&](auto v)
                  {
-                     auto temp = get_triangles(v, mask, g);
-                     triangles += temp.first;
-                     n += temp.second;
+                     triangles += tc.triangles(v);
+                     n += tc.wedges(v);
                  });
         c = double(triangles) / n;
 
@@ -103,14 +67,13 @@ struct get_global_clustering
         c_err = 0.0;
         double cerr = 0.0;
         #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            firstprivate(mask) reduction(+:cerr)
+            reduction(+:cerr)
         parallel_vertex_loop_no_spawn
                 (g,
                  [&](auto v)
                  {
-                     auto temp = get_triangles(v, mask, g);
-                     double cl = double(triangles - temp.first) /
-                         (n - temp.second);
+                     double cl = double(triangles - tc.triangles(v)) /
+                         (n - tc.wedges(v));
                      cerr += power(c - cl, 2);
                  });
         c_err = sqrt(cerr);
@@ -124,32 +87,41 @@ struct set_clustering_to_property
     void operator()(const Graph& g, ClustMap clust_map) const
     {
         typedef typename property_traits<ClustMap>::value_type c_type;
-        typename get_undirected_graph<Graph>::type ug(g);
-        vector<bool> mask(num_vertices(g), false);
 
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            firstprivate(mask)
-        parallel_vertex_loop_no_spawn
+        // edge directions are ignored by the counts themselves
+        triangle_counts<Graph> tc(g);
+
+        parallel_vertex_loop
             (g,
              [&](auto v)
              {
-                 auto triangles = get_triangles(v, mask, ug); // get from ug
-                 double clustering = (triangles.second > 0) ?
-                     double(triangles.first)/triangles.second :
+                 size_t wedges = tc.wedges(v);
+                 double clustering = (wedges > 0) ?
+                     double(tc.triangles(v)) / wedges :
                      0.0;
                  clust_map[v] = c_type(clustering);
              });
     }
+};
 
-    template <class Graph>
-    struct get_undirected_graph
+// sets the number of triangles to which every edge belongs to a property
+struct set_edge_triangles_to_property
+{
+    template <class Graph, class TriMap>
+    void operator()(const Graph& g, TriMap tri_map) const
     {
-        typedef typename mpl::if_
-           <std::is_convertible<typename graph_traits<Graph>::directed_category,
-                                directed_tag>,
-            const UndirectedAdaptor<Graph>,
-            const Graph& >::type type;
-    };
+        typedef typename property_traits<TriMap>::value_type t_type;
+
+        triangle_counts<Graph> tc(g, true);
+
+        parallel_edge_loop
+            (g,
+             [&](const auto& e)
+             {
+                 tri_map[e] = t_type(tc.edge_triangles(source(e, g),
+                                                       target(e, g)));
+             });
+    }
 };
 
 } //graph-tool namespace
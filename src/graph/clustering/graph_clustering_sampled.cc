@@ -0,0 +1,165 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2016 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph_filtering.hh"
+
+#include "graph.hh"
+#include "graph_selectors.hh"
+#include "graph_properties.hh"
+
+#include "graph_clustering_sampled.hh"
+#include "graph_io_edges.hh"
+
+#include "random.hh"
+
+#include <fstream>
+#include <cstdlib>
+#include <boost/python.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/math/distributions/students_t.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+
+boost::python::tuple sampled_global_clustering(GraphInterface& g,
+                                               size_t n_samples, rng_t& rng)
+{
+    double c, c_err;
+    bool directed = g.get_directed();
+    g.set_directed(false);
+    run_action<graph_tool::never_directed_frozen>()
+        (g, [&](auto& graph)
+         {
+             get_sampled_global_clustering()(graph, n_samples, rng, c, c_err);
+         })();
+    g.set_directed(directed);
+    return boost::python::make_tuple(c, c_err);
+}
+
+// Reads the edges of a text file, with one edge per line, given by the indexes
+// of its endpoints. Empty lines, lines starting with '#' or '%', and any
+// further columns are ignored.
+template <class F>
+void read_edge_list(std::istream& s, F&& f)
+{
+    string line;
+    size_t n = 0;
+    while (getline(s, line))
+    {
+        ++n;
+        const char* p = line.c_str();
+        while (isspace(*p))
+            ++p;
+        if (*p == '\0' || *p == '#' || *p == '%')
+            continue;
+        char* end;
+        auto u = strtoull(p, &end, 10);
+        if (end == p)
+            throw IOException("error reading edge list: invalid line " +
+                              lexical_cast<string>(n));
+        p = end;
+        auto v = strtoull(p, &end, 10);
+        if (end == p)
+            throw IOException("error reading edge list: invalid line " +
+                              lexical_cast<string>(n));
+        f(size_t(u), size_t(v));
+    }
+}
+
+boost::python::tuple stream_global_clustering(string file, string format,
+                                              size_t M, size_t n_est,
+                                              double confidence, rng_t& rng)
+{
+    if (format != "gt" && format != "edgelist")
+        throw ValueException("error reading from file '" + file +
+                             "': requested invalid format '" + format + "'");
+
+    boost::iostreams::filtering_stream<boost::iostreams::input> stream;
+    std::ifstream file_stream;
+    file_stream.open(file.c_str(), std::ios_base::in | std::ios_base::binary);
+    if (!file_stream.is_open())
+        throw IOException("error opening file '" + file + "'");
+    if (boost::ends_with(file, ".gz"))
+        stream.push(boost::iostreams::gzip_decompressor());
+    if (boost::ends_with(file, ".bz2"))
+        stream.push(boost::iostreams::bzip2_decompressor());
+    stream.push(file_stream);
+    stream.exceptions(ios_base::badbit);
+
+    vector<double> cs, ts;
+    try
+    {
+        if (format == "gt")
+        {
+            stream.exceptions(ios_base::badbit | ios_base::failbit |
+                              ios_base::eofbit);
+            get_stream_global_clustering
+                ([&](auto&& f) { read_graph_edges(stream, f); }, M, n_est, rng,
+                 cs, ts);
+        }
+        else
+        {
+            get_stream_global_clustering
+                ([&](auto&& f) { read_edge_list(stream, f); }, M, n_est, rng,
+                 cs, ts);
+        }
+    }
+    catch (ios_base::failure& e)
+    {
+        throw IOException("error reading from file '" + file + "': " +
+                          e.what());
+    }
+
+    // mean, standard error and Student's t confidence interval over the
+    // independent estimates
+    auto summary = [&](const vector<double>& xs)
+        {
+            double n = xs.size();
+            double m = 0, s = 0;
+            for (auto x : xs)
+                m += x;
+            m /= n;
+            for (auto x : xs)
+                s += (x - m) * (x - m);
+            double err = numeric_limits<double>::quiet_NaN();
+            double delta = err;
+            if (xs.size() > 1)
+            {
+                err = sqrt(s / (n - 1) / n);
+                math::students_t dist(n - 1);
+                delta = math::quantile(dist, (1 + confidence) / 2) * err;
+            }
+            return boost::python::make_tuple(m, err,
+                                             boost::python::make_tuple
+                                                 (m - delta, m + delta));
+        };
+
+    return boost::python::make_tuple(summary(cs), summary(ts));
+}
+
+void export_sampled_clustering()
+{
+    using namespace boost::python;
+    def("sampled_global_clustering", &sampled_global_clustering);
+    def("stream_global_clustering", &stream_global_clustering);
+}
@@ -0,0 +1,386 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2016 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_CLUSTERING_SAMPLED_HH
+#define GRAPH_CLUSTERING_SAMPLED_HH
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "graph_selectors.hh"
+#include "graph_util.hh"
+#include "hash_map_wrap.hh"
+#include "random.hh"
+#include "../inference/parallel_rng.hh"
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Estimates the global clustering coefficient by wedge sampling, as described
+// in C. Seshadhri, A. Pinar, T. G. Kolda, "Wedge sampling for computing
+// clustering coefficients and triangle counts on large graphs", Stat. Anal.
+// Data Min. 7, 294 (2014).
+//
+// A wedge (i.e. a path of length two) is sampled uniformly by choosing its
+// center v with a probability proportional to k_v(k_v-1)/2, and then two
+// distinct edges of v, and the clustering coefficient is the fraction of
+// closed wedges. As in the exact computation, parallel edges and self-loops
+// are ignored: samples containing a self-loop, or two edges to the same
+// neighbour, are rejected, and the remaining ones are accepted with
+// probability 1/(m_u m_w), where m_u and m_w are the multiplicities of the
+// edges to the two neighbours. The accepted wedges are then uniform over the
+// wedges of the simple graph. Only the degrees of all vertices are scanned
+// beforehand, so that the time required is O(V + n (log V + k)), where n is
+// the number of samples and k the typical degree, which is sublinear in the
+// number of edges. The standard error of the estimate, sqrt(c(1-c)/n), is
+// stored in c_err.
+
+struct get_sampled_global_clustering
+{
+    // the out-edge iterators of filtered graphs are not random-access
+    template <class Iter>
+    static Iter nth_iter(Iter iter, size_t n)
+    {
+        typedef typename iterator_traversal<Iter>::type traversal_t;
+        return advance_iter(iter, n,
+                            typename std::is_convertible
+                                <traversal_t,
+                                 random_access_traversal_tag>::type());
+    }
+
+    template <class Iter>
+    static Iter advance_iter(Iter iter, size_t n, std::true_type)
+    {
+        return iter + n;
+    }
+
+    template <class Iter>
+    static Iter advance_iter(Iter iter, size_t n, std::false_type)
+    {
+        for (; n > 0; --n)
+            ++iter;
+        return iter;
+    }
+
+    template <class Graph, class RNG>
+    void operator()(const Graph& g, size_t n_samples, RNG& rng, double& c,
+                    double& c_err) const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+        size_t N = num_vertices(g);
+        vector<double> cum(N);
+        double W = 0;
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto v = vertex(i, g);
+            if (is_valid_vertex(v, g))
+            {
+                double k = out_degree(v, g);
+                W += (k * (k - 1)) / 2;
+            }
+            cum[i] = W;
+        }
+
+        // whether v has at least two distinct neighbours other than itself
+        auto has_wedge = [&](vertex_t v)
+            {
+                bool first = true;
+                vertex_t u0 = v;
+                for (auto u : out_neighbours_range(v, g))
+                {
+                    if (u == v)
+                        continue;
+                    if (first)
+                    {
+                        u0 = u;
+                        first = false;
+                    }
+                    else if (u != u0)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            };
+
+        // the rejection loop below requires at least one wedge; this scan
+        // usually stops at the first vertex with degree larger than one
+        bool found = false;
+        for (size_t i = 0; i < N && W > 0 && !found; ++i)
+        {
+            auto v = vertex(i, g);
+            if (is_valid_vertex(v, g) && out_degree(v, g) > 1)
+                found = has_wedge(v);
+        }
+
+        if (!found || n_samples == 0)
+        {
+            c = c_err = std::numeric_limits<double>::quiet_NaN();
+            return;
+        }
+
+        auto is_adjacent = [&](vertex_t u, vertex_t w)
+            {
+                if (out_degree(u, g) > out_degree(w, g))
+                    std::swap(u, w);
+                for (auto x : out_neighbours_range(u, g))
+                {
+                    if (x == w)
+                        return true;
+                }
+                return false;
+            };
+
+        vector<std::shared_ptr<RNG>> rngs;
+        init_rngs(rngs, rng);
+
+        size_t closed = 0;
+        #pragma omp parallel for schedule(runtime) reduction(+:closed) \
+            if (n_samples > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < n_samples; ++i)
+        {
+            auto& rng_ = get_rng(rngs, rng);
+
+            uniform_real_distribution<double> sample_w(0, W);
+            uniform_real_distribution<double> sample_r(0, 1);
+            vertex_t u, w;
+            while (true)
+            {
+                double r = sample_w(rng_);
+                size_t j = std::upper_bound(cum.begin(), cum.end(), r) -
+                    cum.begin();
+                j = std::min(j, N - 1);
+                auto v = vertex(j, g);
+
+                size_t k = out_degree(v, g);
+                if (k < 2)
+                    continue;
+                uniform_int_distribution<size_t> sample_a(0, k - 1);
+                uniform_int_distribution<size_t> sample_b(0, k - 2);
+                size_t a = sample_a(rng_);
+                size_t b = sample_b(rng_);
+                if (b >= a)
+                    ++b;
+
+                auto es = out_edges(v, g);
+                u = target(*nth_iter(es.first, a), g);
+                w = target(*nth_iter(es.first, b), g);
+                if (u == v || w == v || u == w)
+                    continue;
+
+                size_t m_u = 0, m_w = 0;
+                for (auto x : out_neighbours_range(v, g))
+                {
+                    m_u += (x == u);
+                    m_w += (x == w);
+                }
+                if (m_u * m_w > 1 && sample_r(rng_) * (m_u * m_w) >= 1)
+                    continue;
+                break;
+            }
+
+            if (is_adjacent(u, w))
+                ++closed;
+        }
+
+        c = double(closed) / n_samples;
+        c_err = sqrt(c * (1 - c) / n_samples);
+    }
+};
+
+// Estimates the number of triangles in a stream of undirected edges, keeping a
+// uniform sample of at most M edges in memory, with the TRIEST-IMPR algorithm
+// of L. De Stefani, A. Epasto, M. Riondato, E. Upfal, "TRIÈST: counting local
+// and global triangles in fully dynamic streams with fixed memory size", KDD
+// '16.
+//
+// Every incoming edge (u, v) closes a triangle with each common neighbour of u
+// and v in the sample, which is counted with a weight equal to the inverse of
+// the probability that the two other edges are both in the sample. The edge is
+// then inserted in the sample by reservoir sampling. The estimate is unbiased,
+// and is exact if the stream has no more than M edges, provided the stream
+// contains no repeated edges, which get_stream_global_clustering() below
+// ensures.
+
+class triest_counter
+{
+public:
+    triest_counter(size_t M, rng_t rng)
+        : _M(std::max(M, size_t(2))), _rng(rng) {}
+
+    void put_edge(size_t u, size_t v)
+    {
+        if (u == v)
+            return;
+
+        // repeated edges which are currently in the sample are ignored
+        auto iu = _adj.find(u);
+        if (iu != _adj.end() && iu->second.count(v) > 0)
+            return;
+        auto iv = _adj.find(v);
+
+        ++_t;
+        if (iu != _adj.end() && iv != _adj.end())
+        {
+            auto* a = &iu->second;
+            auto* b = &iv->second;
+            if (a->size() > b->size())
+                std::swap(a, b);
+            size_t c = 0;
+            for (auto w : *a)
+                c += b->count(w);
+            if (c > 0)
+            {
+                double eta = (double(_t - 1) * (_t - 2)) /
+                    (double(_M) * (_M - 1));
+                _tau += std::max(eta, 1.) * c;
+            }
+        }
+
+        if (_t <= _M)
+        {
+            insert(u, v);
+            _edges.emplace_back(u, v);
+            return;
+        }
+
+        bernoulli_distribution keep(double(_M) / _t);
+        if (!keep(_rng))
+            return;
+        uniform_int_distribution<size_t> sample(0, _M - 1);
+        auto& e = _edges[sample(_rng)];
+        remove(e.first, e.second);
+        insert(u, v);
+        e = make_pair(u, v);
+    }
+
+    double get_triangles() const { return _tau; }
+
+private:
+    void insert(size_t u, size_t v)
+    {
+        _adj[u].insert(v);
+        _adj[v].insert(u);
+    }
+
+    void remove(size_t u, size_t v)
+    {
+        for (auto x : {make_pair(u, v), make_pair(v, u)})
+        {
+            auto iter = _adj.find(x.first);
+            iter->second.erase(x.second);
+            if (iter->second.empty())
+                _adj.erase(iter);
+        }
+    }
+
+    size_t _M;
+    size_t _t = 0;
+    double _tau = 0;
+    vector<pair<size_t, size_t>> _edges;
+    gt_hash_map<size_t, gt_hash_set<size_t>> _adj;
+    rng_t _rng;
+};
+
+// Estimates the global clustering coefficient of a stream of edges, where
+// read_edges(f) calls f(u, v) for every edge. As in the exact computation,
+// self-loops are skipped, and so are repeated edges, i.e. parallel edges and
+// reciprocal edges of directed graphs, which are detected with the set of the
+// distinct unordered pairs seen so far. The degrees of all vertices in the
+// resulting simple graph are counted exactly, to obtain the number of wedges,
+// and the number of triangles is estimated by n_est independent instances of
+// triest_counter, with a reservoir of M edges each, which are run in
+// parallel. The estimates of the
+// clustering coefficient and number of triangles of each instance are stored
+// in cs and ts, respectively, so that their spread can be used to obtain
+// confidence intervals.
+
+template <class ReadEdges, class RNG>
+void get_stream_global_clustering(ReadEdges&& read_edges, size_t M,
+                                  size_t n_est, RNG& rng, vector<double>& cs,
+                                  vector<double>& ts)
+{
+    vector<triest_counter> counters;
+    for (size_t i = 0; i < n_est; ++i)
+    {
+        std::array<int, RNG::state_size> seed_data;
+        std::generate_n(seed_data.data(), seed_data.size(), std::ref(rng));
+        std::seed_seq seq(std::begin(seed_data), std::end(seed_data));
+        counters.emplace_back(M, rng_t(seq));
+    }
+
+    vector<size_t> deg;
+    gt_hash_set<pair<size_t, size_t>> seen;
+    vector<pair<size_t, size_t>> chunk;
+    const size_t chunk_size = 1 << 16;
+
+    auto flush = [&]()
+        {
+            #pragma omp parallel for schedule(dynamic, 1) \
+                if (n_est > 1 && chunk.size() * n_est > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < counters.size(); ++i)
+            {
+                for (auto& e : chunk)
+                    counters[i].put_edge(e.first, e.second);
+            }
+            chunk.clear();
+        };
+
+    read_edges([&](size_t u, size_t v)
+               {
+                   if (u == v)
+                       return;
+                   if (!seen.insert(make_pair(std::min(u, v),
+                                              std::max(u, v))).second)
+                       return;
+                   size_t n = std::max(u, v) + 1;
+                   if (n > deg.size())
+                       deg.resize(std::max(n, 2 * deg.size()));
+                   deg[u]++;
+                   deg[v]++;
+                   chunk.emplace_back(u, v);
+                   if (chunk.size() == chunk_size)
+                       flush();
+               });
+    flush();
+
+    double W = 0;
+    for (auto k : deg)
+        W += (double(k) * (k - 1)) / 2;
+
+    cs.clear();
+    ts.clear();
+    for (auto& counter : counters)
+    {
+        double t = counter.get_triangles();
+        ts.push_back(t);
+        cs.push_back((W > 0) ? 3 * t / W :
+                     std::numeric_limits<double>::quiet_NaN());
+    }
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_CLUSTERING_SAMPLED_HH
@@ -25,6 +25,7 @@
 
 #include "random.hh"
 #include "hash_map_wrap.hh"
+#include "graph_triangles.hh"
 
 namespace graph_tool
 {
@@ -294,6 +295,197 @@ void get_sig(Graph& g, std::vector<size_t>& sig)
     sort(sig.begin(), sig.end());
 }
 
+// Canonical labelling of small subgraphs.
+//
+// The induced subgraph of a sorted vertex list with k vertices is encoded as
+// an integer, with b bits per vertex pair holding the multiplicity of the
+// edges between them, so that two subgraphs are isomorphic if and only if
+// their codes become identical under some relabelling of the vertices. The
+// canonical code of a subgraph is the smallest code among all its k!
+// relabellings, which identifies its isomorphism class directly, without any
+// isomorphism test. As in make_subgraph(), self-loops are only considered for
+// directed graphs.
+
+constexpr size_t max_canon_k = 5;
+
+inline size_t get_pair_index(size_t i, size_t j, size_t k, bool directed)
+{
+    if (directed)
+        return i * k + j;
+    if (i < j)
+        std::swap(i, j);
+    return (i * (i - 1)) / 2 + j;
+}
+
+inline size_t get_num_pairs(size_t k, bool directed)
+{
+    return directed ? k * k : (k * (k - 1)) / 2;
+}
+
+template <class Graph, class VList>
+uint64_t get_motif_code(Graph& g, const VList& vlist, size_t b)
+{
+    constexpr bool directed = is_directed::apply<Graph>::type::value;
+    size_t k = vlist.size();
+    uint64_t code = 0;
+    for (size_t i = 0; i < k; ++i)
+    {
+        for (auto e : out_edges_range(vlist[i], g))
+        {
+            auto u = target(e, g);
+            size_t j = std::find(vlist.begin(), vlist.end(), u) - vlist.begin();
+            if (j == k || (!directed && j >= i))
+                continue;
+            code += uint64_t(1) << (b * get_pair_index(i, j, k, directed));
+        }
+    }
+    return code;
+}
+
+// Computes canonical codes. Since the number of distinct labelled subgraphs
+// which are encountered is usually small, the results are memoized, and each
+// thread should use its own copy.
+class motif_canon
+{
+public:
+    motif_canon(size_t k, size_t b, bool directed, bool comp_iso)
+        : _k(k), _b(b), _n_pairs(get_num_pairs(k, directed)),
+          _comp_iso(comp_iso)
+    {
+        std::vector<uint8_t> perm(k);
+        for (size_t i = 0; i < k; ++i)
+            perm[i] = i;
+        do
+        {
+            _perms.insert(_perms.end(), perm.begin(), perm.end());
+            for (size_t i = 0; i < k; ++i)
+            {
+                for (size_t j = 0; j < k; ++j)
+                {
+                    if (!directed && j >= i)
+                        continue;
+                    _pair_map.push_back(get_pair_index(perm[i], perm[j], k,
+                                                       directed));
+                }
+            }
+        }
+        while (std::next_permutation(perm.begin(), perm.end()));
+        _n_perms = _perms.size() / k;
+    }
+
+    // Returns the canonical code, and the index of the relabelling which
+    // attains it, which should be passed to get_perm(). If comp_iso == false,
+    // the code itself is returned, with the identity relabelling.
+    std::pair<uint64_t, size_t> get_canonical(uint64_t code)
+    {
+        if (!_comp_iso || _n_perms == 1)
+            return std::make_pair(code, size_t(0));
+
+        auto iter = _cache.find(code);
+        if (iter != _cache.end())
+            return iter->second;
+
+        uint64_t mask = (uint64_t(1) << _b) - 1;
+        _digits.clear();
+        for (size_t x = 0; x < _n_pairs; ++x)
+        {
+            uint64_t d = (code >> (_b * x)) & mask;
+            if (d > 0)
+                _digits.emplace_back(x, d);
+        }
+
+        auto best = std::make_pair(code, size_t(0));
+        for (size_t p = 1; p < _n_perms; ++p)
+        {
+            const uint8_t* pmap = &_pair_map[p * _n_pairs];
+            uint64_t c = 0;
+            for (auto& xd : _digits)
+                c += xd.second << (_b * pmap[xd.first]);
+            if (c < best.first)
+                best = std::make_pair(c, p);
+        }
+        _cache[code] = best;
+        return best;
+    }
+
+    // The position of each vertex in the canonical labelling.
+    const uint8_t* get_perm(size_t p) const { return &_perms[p * _k]; }
+
+    // Builds the subgraph with the given code.
+    template <class Graph>
+    void make_graph(uint64_t code, Graph& sub) const
+    {
+        constexpr bool directed = is_directed::apply<Graph>::type::value;
+        uint64_t mask = (uint64_t(1) << _b) - 1;
+        for (size_t i = 0; i < _k; ++i)
+            add_vertex(sub);
+        for (size_t i = 0; i < _k; ++i)
+        {
+            for (size_t j = 0; j < _k; ++j)
+            {
+                if (!directed && j >= i)
+                    continue;
+                size_t x = get_pair_index(i, j, _k, directed);
+                uint64_t d = (code >> (_b * x)) & mask;
+                for (; d > 0; --d)
+                    add_edge(vertex(i, sub), vertex(j, sub), sub);
+            }
+        }
+    }
+
+private:
+    size_t _k;
+    size_t _b;
+    size_t _n_pairs;
+    size_t _n_perms;
+    bool _comp_iso;
+    std::vector<uint8_t> _perms;
+    std::vector<uint8_t> _pair_map;
+    std::vector<std::pair<size_t, uint64_t>> _digits;
+    gt_hash_map<uint64_t, std::pair<uint64_t, size_t>> _cache;
+};
+
+// largest multiplicity of the edges between two vertices, considering
+// self-loops only for directed graphs
+template <class Graph>
+size_t get_max_multiplicity(Graph& g)
+{
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    constexpr bool directed = is_directed::apply<Graph>::type::value;
+
+    size_t N = num_vertices(g);
+    size_t m_max = 0;
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+    {
+        std::vector<vertex_t> us;
+        size_t m_thread = 0;
+        #pragma omp for schedule(runtime)
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto v = vertex(i, g);
+            if (!is_valid_vertex(v, g))
+                continue;
+            us.clear();
+            for (auto e : out_edges_range(v, g))
+            {
+                vertex_t u = target(e, g);
+                if (directed || u < v)
+                    us.push_back(u);
+            }
+            std::sort(us.begin(), us.end());
+            size_t m = 0;
+            for (size_t j = 0; j < us.size(); ++j)
+            {
+                m = (j > 0 && us[j] == us[j - 1]) ? m + 1 : 1;
+                m_thread = std::max(m_thread, m);
+            }
+        }
+        #pragma omp critical (max_multiplicity)
+        m_max = std::max(m_max, m_thread);
+    }
+    return m_max;
+}
+
 // gets (or samples) all the subgraphs in graph g
 struct get_all_motifs
 {
@@ -312,49 +504,246 @@ struct get_all_motifs
                     std::vector<size_t>& hist, std::vector<std::vector<VMap> >& vmaps,
                     Sampler sampler) const
     {
-        // this hashes subgraphs according to their signature
-        gt_hash_map<std::vector<size_t>,
-                    std::vector<pair<size_t, d_graph_t> >,
-                    std::hash<std::vector<size_t>>> sub_list;
-        std::vector<size_t> sig; // current signature
+        constexpr bool directed = is_directed::apply<Graph>::type::value;
 
-        for (size_t i = 0; i < subgraph_list.size(); ++i)
+        // the subgraph count
+        hist.resize(subgraph_list.size());
+
+        // the set of vertices V to be sampled (filled only if p < 1)
+        std::vector<size_t> V;
+        if (p < 1)
+            sample_vertices(g, V);
+
+        // number of bits needed for the edge multiplicities
+        size_t m_max = get_max_multiplicity(g);
+        for (auto& sub : subgraph_list)
         {
-            auto& sub = subgraph_list[i];
-            typename wrap_directed::apply<Graph,d_graph_t>::type
-                usub(sub);
-            get_sig(usub, sig);
-            sub_list[sig].push_back(make_pair(i, sub));
+            typename wrap_directed::apply<Graph,d_graph_t>::type usub(sub);
+            m_max = std::max(m_max, get_max_multiplicity(usub));
         }
+        size_t b = 1;
+        while ((m_max >> b) > 0)
+            ++b;
 
-        // the subgraph count
-        hist.resize(subgraph_list.size());
+        size_t n_pairs = get_num_pairs(k, directed);
+        if (k <= max_canon_k && n_pairs * b <= 64)
+            count_canonical(g, k, b, subgraph_list, hist, vmaps, sampler, V);
+        else
+            count_isomorphic(g, k, subgraph_list, hist, vmaps, sampler, V);
+    }
 
+    template <class Graph>
+    void sample_vertices(Graph& g, std::vector<size_t>& V) const
+    {
         typedef std::uniform_real_distribution<double> rdist_t;
         auto random = std::bind(rdist_t(), std::ref(rng));
 
-        // the set of vertices V to be sampled (filled only if p < 1)
-        std::vector<size_t> V;
-        if (p < 1)
+        for (auto v : vertices_range(g))
+            V.push_back(v);
+
+        size_t n;
+        if (random() < p)
+            n = size_t(ceil(V.size()*p));
+        else
+            n = size_t(floor(V.size()*p));
+
+        typedef std::uniform_int_distribution<size_t> idist_t;
+        for (size_t i = 0; i < n; ++i)
+        {
+            auto random_v = std::bind(idist_t(0, V.size()-i-1),
+                                      std::ref(rng));
+            size_t j = i + random_v();
+            swap(V[i], V[j]);
+        }
+        V.resize(n);
+    }
+
+    // Subgraphs with at most max_canon_k vertices are classified by their
+    // canonical codes, and are counted in per-thread hash tables, which are
+    // merged at the end. The vertex maps are aligned with the labelling of
+    // the corresponding motif graph.
+    template <class Graph, class Sampler, class VMap>
+    void count_canonical(Graph& g, size_t k, size_t b,
+                         std::vector<d_graph_t>& subgraph_list,
+                         std::vector<size_t>& hist,
+                         std::vector<std::vector<VMap> >& vmaps,
+                         Sampler sampler, std::vector<size_t>& V) const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        constexpr bool directed = is_directed::apply<Graph>::type::value;
+
+        motif_canon canon(k, b, directed, comp_iso);
+
+        // position of each class in subgraph_list, and the relabelling of the
+        // motif graph into the canonical one
+        gt_hash_map<uint64_t, size_t> class_pos;
+        std::vector<const uint8_t*> motif_perm;
+        std::vector<size_t> vlist;
+        for (size_t i = 0; i < k; ++i)
+            vlist.push_back(i);
+        for (size_t i = 0; i < subgraph_list.size(); ++i)
+        {
+            auto& sub = subgraph_list[i];
+            typename wrap_directed::apply<Graph,d_graph_t>::type usub(sub);
+            auto c = canon.get_canonical(get_motif_code(usub, vlist, b));
+            class_pos.insert(make_pair(c.first, i));
+            motif_perm.push_back(canon.get_perm(c.second));
+        }
+
+        // counts, and vertices of every occurrence in canonical order
+        gt_hash_map<uint64_t, size_t> counts;
+        gt_hash_map<uint64_t, std::vector<vertex_t>> locations;
+
+        if (k == 3 && !directed && b == 1 && p >= 1 && !collect_vmaps &&
+            comp_iso && std::is_same<Sampler, sample_all>::value)
+        {
+            // the connected subgraphs with three vertices of a simple
+            // undirected graph are either triangles or open wedges, which can
+            // be counted directly
+            triangle_counts<Graph> tc(g);
+            size_t N = num_vertices(g);
+            size_t t = 0, w = 0;
+            #pragma omp parallel for schedule(runtime) reduction(+:t, w) \
+                if (N > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < N; ++i)
+            {
+                auto v = vertex(i, g);
+                if (!is_valid_vertex(v, g))
+                    continue;
+                t += tc.triangles(v);
+                w += tc.wedges(v);
+            }
+            t /= 3;
+
+            auto put = [&](uint64_t code, size_t n)
+                {
+                    auto c = canon.get_canonical(code).first;
+                    if (n == 0 ||
+                        (!fill_list && class_pos.find(c) == class_pos.end()))
+                        return;
+                    counts[c] = n;
+                };
+            put(0b011, w - 3 * t);
+            put(0b111, t);
+        }
+        else
+        {
+            size_t N = (p < 1) ? V.size() : num_vertices(g);
+            #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+            {
+                motif_canon t_canon(canon);
+                gt_hash_map<uint64_t, size_t> t_counts;
+                gt_hash_map<uint64_t, std::vector<vertex_t>> t_locations;
+                std::vector<std::vector<vertex_t>> subgraphs;
+                std::vector<vertex_t> cvlist(k);
+
+                #pragma omp for schedule(runtime)
+                for (size_t i = 0; i < N; ++i)
+                {
+                    vertex_t v = (p < 1) ? V[i] : vertex(i, g);
+                    if (!is_valid_vertex(v, g))
+                        continue;
+
+                    subgraphs.clear();
+                    typename wrap_undirected::apply<Graph>::type ug(g);
+                    get_subgraphs(ug, v, k, subgraphs, sampler);
+
+                    for (auto& sub : subgraphs)
+                    {
+                        auto c = t_canon.get_canonical(get_motif_code(g, sub, b));
+                        if (!fill_list && class_pos.find(c.first) == class_pos.end())
+                            continue;
+                        t_counts[c.first]++;
+                        if (collect_vmaps)
+                        {
+                            auto perm = t_canon.get_perm(c.second);
+                            for (size_t j = 0; j < k; ++j)
+                                cvlist[perm[j]] = sub[j];
+                            auto& loc = t_locations[c.first];
+                            loc.insert(loc.end(), cvlist.begin(), cvlist.end());
+                        }
+                    }
+                }
+
+                #pragma omp critical (gather)
+                {
+                    for (auto& c : t_counts)
+                        counts[c.first] += c.second;
+                    for (auto& l : t_locations)
+                    {
+                        auto& loc = locations[l.first];
+                        loc.insert(loc.end(), l.second.begin(), l.second.end());
+                    }
+                }
+            }
+        }
+
+        if (fill_list)
         {
-            for (auto v : vertices_range(g))
-                V.push_back(v);
+            // new classes are appended in the order of their canonical codes
+            std::vector<uint64_t> new_codes;
+            for (auto& c : counts)
+            {
+                if (class_pos.find(c.first) == class_pos.end())
+                    new_codes.push_back(c.first);
+            }
+            std::sort(new_codes.begin(), new_codes.end());
+            for (auto c : new_codes)
+            {
+                subgraph_list.emplace_back();
+                typename wrap_directed::apply<Graph,d_graph_t>::type
+                    usub(subgraph_list.back());
+                canon.make_graph(c, usub);
+                class_pos[c] = subgraph_list.size() - 1;
+                motif_perm.push_back(canon.get_perm(0));
+                hist.push_back(0);
+            }
+        }
+
+        for (auto& c : counts)
+            hist[class_pos[c.first]] += c.second;
 
-            size_t n;
-            if (random() < p)
-                n = size_t(ceil(V.size()*p));
-            else
-                n = size_t(floor(V.size()*p));
+        if (!collect_vmaps)
+            return;
 
-            typedef std::uniform_int_distribution<size_t> idist_t;
-            for (size_t i = 0; i < n; ++i)
+        vmaps.resize(subgraph_list.size());
+        for (auto& l : locations)
+        {
+            size_t pos = class_pos[l.first];
+            auto& sub = subgraph_list[pos];
+            auto perm = motif_perm[pos];
+            for (size_t i = 0; i < l.second.size(); i += k)
             {
-                auto random_v = std::bind(idist_t(0, V.size()-i-1),
-                                          std::ref(rng));
-                size_t j = i + random_v();
-                swap(V[i], V[j]);
+                vmaps[pos].push_back(VMap(get(boost::vertex_index, sub)));
+                auto& vmap = vmaps[pos].back();
+                for (size_t vi = 0; vi < k; ++vi)
+                    vmap[vertex(vi, sub)] = l.second[i + perm[vi]];
             }
-            V.resize(n);
+        }
+    }
+
+    // Larger subgraphs are hashed according to their signature, and compared
+    // with all the motifs with the same signature.
+    template <class Graph, class Sampler, class VMap>
+    void count_isomorphic(Graph& g, size_t k,
+                          std::vector<d_graph_t>& subgraph_list,
+                          std::vector<size_t>& hist,
+                          std::vector<std::vector<VMap> >& vmaps,
+                          Sampler sampler, std::vector<size_t>& V) const
+    {
+        // this hashes subgraphs according to their signature
+        gt_hash_map<std::vector<size_t>,
+                    std::vector<pair<size_t, d_graph_t> >,
+                    std::hash<std::vector<size_t>>> sub_list;
+        std::vector<size_t> sig; // current signature
+
+        for (size_t i = 0; i < subgraph_list.size(); ++i)
+        {
+            auto& sub = subgraph_list[i];
+            typename wrap_directed::apply<Graph,d_graph_t>::type
+                usub(sub);
+            get_sig(usub, sig);
+            sub_list[sig].push_back(make_pair(i, sub));
         }
 
         size_t N = (p < 1) ? V.size() : num_vertices(g);
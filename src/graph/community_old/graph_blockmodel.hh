@@ -28,6 +28,7 @@
 #include <tuple>
 
 #include "hash_map_wrap.hh"
+#include "../inference/cache.hh"
 
 #include "../generation/sampler.hh"
 #include "../generation/dynamic_sampler.hh"
@@ -62,51 +63,7 @@ public:
 // ====================
 
 // Repeated computation of x*log(x) and log(x) actually adds up to a lot of
-// time. A significant speedup can be made by caching pre-computed values. This
-// is doable since the values of mrse are bounded in [0, 2E], where E is the
-// total number of edges in the network. Here we simply grow the cache as
-// needed.
-
-extern vector<double> __safelog_cache;
-extern vector<double> __xlogx_cache;
-extern vector<double> __lgamma_cache;
-
-void init_safelog(size_t x);
-
-template <class Type>
-inline double safelog(Type x)
-{
-    if (x == 0)
-        return 0;
-    return log(x);
-}
-
-inline double safelog(size_t x)
-{
-    if (x >= __safelog_cache.size())
-        init_safelog(x);
-    return __safelog_cache[x];
-}
-
-void init_xlogx(size_t x);
-
-inline double xlogx(size_t x)
-{
-    //return x * safelog(x);
-    if (x >= __xlogx_cache.size())
-        init_xlogx(x);
-    return __xlogx_cache[x];
-}
-
-void init_lgamma(size_t x);
-
-inline double lgamma_fast(size_t x)
-{
-    //return lgamma(x);
-    if (x >= __lgamma_cache.size())
-        init_lgamma(x);
-    return __lgamma_cache[x];
-}
+// time, so the values are cached, as defined in inference/cache.hh.
 
 // polylogarithm and degree-distribution description length (xi)
 
@@ -2664,23 +2621,6 @@ void move_sweep(vector<BlockState>& states, vector<MEntries>& m_entries_r,
             std::seed_seq seq(std::begin(seed_data), std::end(seed_data));
             rngs.push_back(new rng_t(seq));
         }
-
-        // pre-init function cache to prevent race condition
-        size_t E = 0;
-        int i = 0, N = num_vertices(g);
-        #pragma omp parallel for default(shared) private(i) \
-            reduction(+:E) schedule(runtime)
-        for (i = 0; i < N; ++i)
-        {
-            auto v = vertex(i, g);
-            if (!is_valid_vertex(v, g))
-                continue;
-            for (auto e : out_edges_range(v, g))
-                E += eweight[e];
-        }
-        init_lgamma(2 * E);
-        init_xlogx(2 * E);
-        init_safelog(2 * E);
     }
     else
     {
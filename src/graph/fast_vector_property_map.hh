@@ -43,6 +43,120 @@
 
 namespace boost {
 
+// Allocator of the storage of the vector property maps, which behaves like
+// std::allocator, except that the storage can also be an array owned by
+// something else, such as a column of a memory-mapped file (see
+// adopt_storage() below). Such an array is never freed, but its owner is kept
+// alive for as long as the allocator, or any copy of it, exists. If the
+// storage needs to grow, the values are moved to memory obtained in the usual
+// way. Copies of the storage always use the usual memory.
+template <class T>
+class property_allocator
+{
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    struct external
+    {
+        void* data;
+        size_t size;
+        std::shared_ptr<const void> owner;
+        bool pending;
+        bool adopting;
+    };
+
+    property_allocator() {}
+    explicit property_allocator(const std::shared_ptr<external>& ext)
+        : _ext(ext) {}
+    template <class U>
+    property_allocator(const property_allocator<U>& a) : _ext(a._ext) {}
+
+    property_allocator select_on_container_copy_construction() const
+    {
+        return property_allocator();
+    }
+
+    T* allocate(size_t n)
+    {
+        if (_ext != nullptr && _ext->pending && n * sizeof(T) == _ext->size)
+        {
+            _ext->pending = false;
+            return static_cast<T*>(_ext->data);
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        if (_ext != nullptr && static_cast<void*>(p) == _ext->data)
+            return;
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    // default-inserted values are left as they are while an external array
+    // is being adopted, so that its contents are kept
+    template <class U>
+    void construct(U* p)
+    {
+        if (_ext != nullptr && _ext->adopting)
+            ::new (static_cast<void*>(p)) U;
+        else
+            ::new (static_cast<void*>(p)) U();
+    }
+
+    template <class U, class... Args>
+    void construct(U* p, Args&&... args)
+    {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template <class U>
+    bool operator==(const property_allocator<U>& a) const
+    {
+        return _ext == a._ext;
+    }
+
+    template <class U>
+    bool operator!=(const property_allocator<U>& a) const
+    {
+        return _ext != a._ext;
+    }
+
+private:
+    template <class U>
+    friend class property_allocator;
+
+    std::shared_ptr<external> _ext;
+};
+
+// Replaces the contents of "vec" by the n values stored at "data", without
+// copying them, if possible; "owner" is kept alive for as long as they are in
+// use.
+template <class T>
+void adopt_storage(std::vector<T, property_allocator<T>>& vec, T* data,
+                   size_t n, std::shared_ptr<const void> owner)
+{
+    typedef typename property_allocator<T>::external external_t;
+    auto ext = std::make_shared<external_t>
+        (external_t{data, n * sizeof(T), owner, true, false});
+    std::vector<T, property_allocator<T>> v((property_allocator<T>(ext)));
+    v.reserve(n);
+    if (v.data() == data)
+    {
+        ext->adopting = true;
+        v.resize(n);
+        ext->adopting = false;
+    }
+    else
+    {
+        ext->pending = false;
+        v.assign(data, data + n);
+    }
+    vec = std::move(v);
+}
+
 template<typename T, typename IndexMap>
 class unchecked_vector_property_map;
 
@@ -50,14 +164,15 @@ template<typename T, typename IndexMap = identity_property_map>
 class checked_vector_property_map
     : public boost::put_get_helper<
               typename std::iterator_traits<
-                  typename std::vector<T>::iterator >::reference,
+                  typename std::vector<T, property_allocator<T>>::iterator >::reference,
               checked_vector_property_map<T, IndexMap> >
 {
 public:
+    typedef std::vector<T, property_allocator<T>> storage_t;
     typedef typename property_traits<IndexMap>::key_type  key_type;
     typedef T value_type;
     typedef typename std::iterator_traits<
-        typename std::vector<T>::iterator >::reference reference;
+        typename storage_t::iterator >::reference reference;
     typedef boost::lvalue_property_map_tag category;
 
     template<typename Type, typename Index>
@@ -68,28 +183,28 @@ public:
     typedef checked_vector_property_map<T,IndexMap> self_t;
 
     checked_vector_property_map(const IndexMap& idx = IndexMap())
-        : store(std::make_shared<std::vector<T>>()), index(idx) {}
+        : store(std::make_shared<storage_t>()), index(idx) {}
 
     checked_vector_property_map(unsigned initial_size,
                                 const IndexMap& idx = IndexMap())
-        : store(std::make_shared<std::vector<T>>(initial_size)), index(idx) {}
+        : store(std::make_shared<storage_t>(initial_size)), index(idx) {}
 
-    typename std::vector<T>::iterator storage_begin()
+    typename storage_t::iterator storage_begin()
     {
         return store->begin();
     }
 
-    typename std::vector<T>::iterator storage_end()
+    typename storage_t::iterator storage_end()
     {
         return store->end();
     }
 
-    typename std::vector<T>::const_iterator storage_begin() const
+    typename storage_t::const_iterator storage_begin() const
     {
         return store->begin();
     }
 
-    typename std::vector<T>::const_iterator storage_end() const
+    typename storage_t::const_iterator storage_end() const
     {
         return store->end();
     }
@@ -110,7 +225,7 @@ public:
         store->shrink_to_fit();
     }
 
-    std::vector<T>& get_storage() const { return (*store); }
+    storage_t& get_storage() const { return (*store); }
 
     unchecked_t get_unchecked(size_t size = 0) const
     {
@@ -145,7 +260,7 @@ protected:
     // store pointer to data, because if copy of property map resizes
     // the vector, the pointer to data will be invalidated.
     // I wonder if class 'pmap_ref' is simply needed.
-    std::shared_ptr< std::vector<T> > store;
+    std::shared_ptr<storage_t> store;
     IndexMap index;
 };
 
@@ -153,14 +268,15 @@ template<typename T, typename IndexMap = identity_property_map>
 class unchecked_vector_property_map
     : public boost::put_get_helper<
                 typename std::iterator_traits<
-                    typename std::vector<T>::iterator >::reference,
+                    typename std::vector<T, property_allocator<T>>::iterator >::reference,
                 unchecked_vector_property_map<T, IndexMap> >
 {
 public:
+    typedef std::vector<T, property_allocator<T>> storage_t;
     typedef typename property_traits<IndexMap>::key_type  key_type;
     typedef T value_type;
     typedef typename std::iterator_traits<
-        typename std::vector<T>::iterator >::reference reference;
+        typename storage_t::iterator >::reference reference;
     typedef boost::lvalue_property_map_tag category;
 
     typedef checked_vector_property_map<T, IndexMap> checked_t;
@@ -189,7 +305,7 @@ public:
         return (*_checked.store)[i];
     }
 
-    std::vector<T>& get_storage() const { return _checked.get_storage(); }
+    storage_t& get_storage() const { return _checked.get_storage(); }
 
     checked_t get_checked() {return _checked;}
 
@@ -33,6 +33,7 @@ GraphInterface::GraphInterface()
     :_mg(std::make_shared<multigraph_t>()),
      _vertex_index(get(vertex_index, *_mg)),
      _edge_index(get(edge_index_t(), *_mg)),
+     _csr_mod_count(0),
      _reversed(false),
      _directed(true),
      _graph_index(0),
@@ -58,8 +59,10 @@ size_t GraphInterface::get_num_vertices(bool filtered)
     if (filtered && is_vertex_filter_active())
         run_action<>()(*this, lambda::var(n) =
                        lambda::bind<size_t>(HardNumVertices(),lambda::_1))();
+    else if (is_frozen())
+        n = num_vertices(*_csr);
     else
-        n = num_vertices(*_mg);
+        n = num_vertices(get_graph());
     return n;
 }
 
@@ -113,3 +116,46 @@ void GraphInterface::clear_edges()
 {
     run_action<>()(*this, std::bind(do_clear_edges(), std::placeholders::_1))();
 }
+
+size_t GraphInterface::get_comp(size_t v)
+{
+    return get_graph().get_comp(v);
+}
+
+bool GraphInterface::get_connected(size_t u, size_t v)
+{
+    return get_graph().get_connected(u, v);
+}
+
+size_t GraphInterface::get_comp_size(size_t v)
+{
+    return get_graph().get_comp_size(v);
+}
+
+size_t GraphInterface::get_num_comps()
+{
+    return get_graph().get_num_comps();
+}
+
+// this will create an immutable CSR snapshot of the graph, which will be used
+// by read-only algorithms instead of the adjacency list, for as long as the
+// graph is not modified. O(V + E)
+void GraphInterface::freeze()
+{
+    if (is_frozen())
+        return;
+    _csr = std::make_shared<csr_graph_t>(get_graph());
+    _csr_mod_count = _mg->get_mod_count();
+    _frozen_views.clear();
+}
+
+void GraphInterface::unfreeze()
+{
+    _csr.reset();
+    _frozen_views.clear();
+}
+
+bool GraphInterface::is_frozen() const
+{
+    return _csr != nullptr && _csr_mod_count == _mg->get_mod_count();
+}
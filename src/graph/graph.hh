@@ -26,6 +26,7 @@
 #include <deque>
 
 #include "graph_adjacency.hh"
+#include "graph_csr.hh"
 
 #include <boost/graph/graph_traits.hpp>
 
@@ -84,8 +85,20 @@ public:
     bool get_directed() {return _directed;}
     void set_reversed(bool reversed) {_reversed = reversed;}
     bool get_reversed() {return _reversed;}
-    void set_keep_epos(bool keep) {_mg->set_keep_epos(keep);}
+    void set_keep_epos(bool keep) {get_graph().set_keep_epos(keep);}
     bool get_keep_epos() {return _mg->get_keep_epos();}
+    void set_keep_ehash(bool keep) {get_graph().set_keep_ehash(keep);}
+    bool get_keep_ehash() {return _mg->get_keep_ehash();}
+    void set_keep_comps(bool keep) {get_graph().set_keep_comps(keep);}
+    bool get_keep_comps() {return _mg->get_keep_comps();}
+
+    // weakly connected components of the unfiltered graph, which are kept
+    // incrementally if get_keep_comps() == true, or otherwise computed from
+    // scratch at the first query after each modification, in O(V + E) time
+    size_t get_comp(size_t v);
+    bool get_connected(size_t u, size_t v);
+    size_t get_comp_size(size_t v);
+    size_t get_num_comps();
 
 
     // graph filtering
@@ -107,7 +120,12 @@ public:
                               boost::any prop_tgt);
     void copy_edge_property(const GraphInterface& src, boost::any prop_src,
                             boost::any prop_tgt);
-    void shrink_to_fit() { _mg->shrink_to_fit(); }
+    void shrink_to_fit() { get_graph().shrink_to_fit(); }
+
+    // immutable CSR snapshot, used by read-only algorithms while valid
+    void freeze();
+    void unfreeze();
+    bool is_frozen() const;
 
     //
     // python interface
@@ -120,18 +138,24 @@ public:
 
     // I/O
     void write_to_file(string s, boost::python::object pf, string format,
-                       boost::python::list properties);
+                       boost::python::list properties, bool mappable);
     boost::python::tuple read_from_file(string s, boost::python::object pf,
                                         string format,
                                         boost::python::list ignore_vp,
                                         boost::python::list ignore_ep,
                                         boost::python::list ignore_gp);
+    void read_from_csv(string s, boost::python::object pf, string delimiter,
+                       string quotechar, bool skip_first, int64_t c_s,
+                       int64_t c_t, bool string_vals, bool hashed,
+                       boost::python::object get_eprops,
+                       boost::python::object vname);
 
     //
     // Internal types
     //
 
     typedef boost::adj_list<size_t> multigraph_t;
+    typedef boost::csr_adj_list<size_t> csr_graph_t;
     typedef boost::graph_traits<multigraph_t>::vertex_descriptor vertex_t;
     typedef boost::graph_traits<multigraph_t>::edge_descriptor edge_t;
 
@@ -139,10 +163,12 @@ public:
     typedef boost::property_map<multigraph_t, boost::edge_index_t>::type edge_index_map_t;
     typedef ConstantPropertyMap<size_t,boost::graph_property_tag> graph_index_map_t;
 
-    // internal access
+    // internal access; the adjacency list of a graph loaded from a
+    // memory-mapped file is only built here, when first needed (see
+    // graph_io_binary.hh)
 
-    multigraph_t&      get_graph() {return *_mg;}
-    std::shared_ptr<multigraph_t> get_graph_ptr() {return _mg;}
+    multigraph_t&      get_graph() {_mg->materialize(); return *_mg;}
+    std::shared_ptr<multigraph_t> get_graph_ptr() {_mg->materialize(); return _mg;}
     vertex_index_map_t get_vertex_index()   {return _vertex_index;}
     edge_index_map_t   get_edge_index()     {return _edge_index;}
     size_t             get_edge_index_range() {return _mg->get_edge_index_range();}
@@ -153,6 +179,11 @@ public:
     boost::any get_graph_view() const;
     vector<boost::any>& get_graph_views() {return _graph_views;}
 
+    // Gets the encapsulated view of the CSR snapshot, or an empty object if
+    // it is not available (see graph_filtering.cc for details)
+    boost::any get_frozen_view() const;
+    vector<boost::any>& get_frozen_views() {return _frozen_views;}
+
 private:
 
     // Generic graph_action functor. See graph_filtering.hh for details.
@@ -171,6 +202,12 @@ private:
     // this will hold an instance of the graph views at run time
     vector<boost::any> _graph_views;
 
+    // CSR snapshot of the main graph, and the modification count of the
+    // latter when the snapshot was taken
+    shared_ptr<csr_graph_t> _csr;
+    size_t _csr_mod_count;
+    vector<boost::any> _frozen_views;
+
     // reverse and directed states
     bool _reversed;
     bool _directed;
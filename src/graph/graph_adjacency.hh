@@ -25,6 +25,11 @@
 #include <iostream>
 #include <tuple>
 #include <functional>
+#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <exception>
 #include <boost/iterator.hpp>
 #include <boost/graph/graph_traits.hpp>
 #include <boost/range/irange.hpp>
@@ -35,6 +40,10 @@
 
 #include "transform_iterator.hh"
 
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
 namespace boost
 {
 
@@ -139,6 +148,36 @@ void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
 // boost::adjacency_list with vector storage selectors for both vertex and edge
 // lists.
 
+// Optionally, two auxiliary data structures can be kept: the positions of each
+// edge in the in and out-edge lists (set_keep_epos()), which makes the removal
+// of edges O(1), and a hash table indexed by the (source, target) pairs
+// (set_keep_ehash()), which makes edge(s, t) lookups O(1) on average, instead
+// of O(k_s). Both require O(E) additional memory, and are maintained
+// incrementally by all manipulation functions. Since removing an edge found via
+// the hash table is only O(1) if its positions are known, keeping the hash
+// table implies keeping the edge positions as well, and dropping the positions
+// drops the hash table.
+
+// If there are parallel edges, edge(s, t) and remove_edge(s, t) refer to the
+// one with the smallest index when the hash table is kept, and otherwise to the
+// first one in the out-edge list of s.
+
+// The weakly connected components (i.e. disregarding the edge directions) can
+// also be kept (set_keep_comps()), with O(V) additional memory, so that the
+// component of a vertex can be queried in O(1) time (get_comp(),
+// get_comp_size() and get_num_comps()). Every vertex stores the label of its
+// component, and every component the list of its vertices. When an edge joins
+// two components, the smaller one is relabeled, so that the total cost of
+// insertions is O(V log V). When an edge is removed, a breadth-first search is
+// started from both endpoints, always expanding the side which has visited
+// fewer vertices, until they meet or one of them is exhausted, in which case
+// its vertices are split off into a new component. Since the smaller side is
+// exhausted first, this is usually much faster than recomputing the
+// components. The clearing of a vertex is handled in the same way, by
+// searching between its former neighbours, and its removal by dropping its
+// (then isolated) entry. If the components are not kept, they are computed at
+// the first query, in O(V + E) time, and reused until the graph is modified.
+
 namespace detail
 {
 template <class Vertex>
@@ -182,7 +221,9 @@ public:
     typedef std::vector<edge_list_t> vertex_list_t;
     typedef typename integer_range<Vertex>::iterator vertex_iterator;
 
-    adj_list(): _n_edges(0), _edge_index_range(0), _keep_epos(false) {}
+    adj_list(): _n_edges(0), _edge_index_range(0), _keep_epos(false),
+                _keep_ehash(false), _mod_count(0), _keep_comps(false),
+                _comps_stale(true), _n_comps(0) {}
 
     struct get_vertex
     {
@@ -312,6 +353,7 @@ public:
 
     void reindex_edges()
     {
+        _mod_count++;
         _free_indexes.clear();
         _edge_index_range = 0;
         _in_edges.clear();
@@ -331,6 +373,275 @@ public:
 
         if (_keep_epos)
             rebuild_epos();
+        if (_keep_ehash)
+            rebuild_ehash();
+    }
+
+    // Replaces the whole graph by the one given in compressed sparse row
+    // form: the out-edges (in-edges) of vertex v are the (neighbour, edge
+    // index) pairs in the range [out_pos[v], out_pos[v + 1]) of out_edges
+    // (resp. in_edges), and all edge indexes must lie in the range [0,
+    // E). This is O(V + E) and runs in parallel, since the edge lists of each
+    // vertex are copied as a whole.
+    void assign_csr(size_t N, size_t E,
+                    const size_t* out_pos,
+                    const std::pair<vertex_t, vertex_t>* out_edges,
+                    const size_t* in_pos,
+                    const std::pair<vertex_t, vertex_t>* in_edges)
+    {
+        _mod_count++;
+        _deferred.reset();
+        copy_csr(N, E, out_pos, out_edges, in_pos, in_edges);
+    }
+
+    // Same as assign_csr(), except that the arrays are only copied into the
+    // edge lists when materialize() is called, which is O(1) until then. The
+    // arrays must remain valid in the meantime, which is ensured by keeping a
+    // reference to "storage", their owner. Other than num_edges(),
+    // get_edge_index_range() and get_mod_count(), nothing may be used before
+    // the graph is materialized. Copies of the graph share the arrays.
+    void defer_csr(size_t N, size_t E,
+                   const size_t* out_pos,
+                   const std::pair<vertex_t, vertex_t>* out_edges,
+                   const size_t* in_pos,
+                   const std::pair<vertex_t, vertex_t>* in_edges,
+                   std::shared_ptr<const void> storage)
+    {
+        _mod_count++;
+        _free_indexes.clear();
+        _out_edges.clear();
+        _in_edges.clear();
+        _n_edges = E;
+        _edge_index_range = E;
+        _epos.clear();
+        _ehash.clear();
+        _comps_stale = true;
+        _deferred = std::make_shared<deferred_csr>
+            (deferred_csr{N, E, out_pos, out_edges, in_pos, in_edges,
+                          storage});
+    }
+
+    bool is_deferred() const { return _deferred != nullptr; }
+
+    // Builds the edge lists from the arrays given to defer_csr(), if this has
+    // not been done yet. This is not counted as a modification, since the
+    // graph remains the same.
+    void materialize()
+    {
+        if (_deferred == nullptr)
+            return;
+        auto d = std::move(_deferred);
+        copy_csr(d->N, d->E, d->out_pos, d->out_edges, d->in_pos,
+                 d->in_edges);
+    }
+
+    // Adds the edges (source(i), target(i)), for i in [0, E), creating
+    // vertices as needed. The result is identical to calling add_edge() for
+    // each pair in sequence, including the edge indexes and the ordering of
+    // the edge lists, but most of the work is done in parallel: the edges are
+    // first distributed into buckets of consecutive vertices with a stable
+    // parallel counting sort, and then each bucket is appended to the lists of
+    // its vertices by a single thread, so that each edge list grows only once.
+    // The total work is O(E + N), with O(E) temporary memory, and no atomic
+    // operations or locks are needed.
+    //
+    // Afterwards, f(i, e) is called for every new edge e (e.g. to set
+    // property values), in parallel if "parallel_f == true". It is called
+    // first for the edge with the largest index, alone, so that vector-based
+    // property maps can grow their storage beforehand.
+    template <class Source, class Target, class F>
+    void add_edges(size_t E, Source&& source, Target&& target, F&& f,
+                   bool parallel_f = true)
+    {
+        if (E == 0)
+            return;
+        _mod_count++;
+
+        size_t N = _out_edges.size();
+        #pragma omp parallel for schedule(static) if (E > 10000) \
+            reduction(max:N)
+        for (size_t i = 0; i < E; ++i)
+            N = std::max({N, size_t(source(i)) + 1, size_t(target(i)) + 1});
+        _out_edges.resize(N);
+        _in_edges.resize(N);
+
+        // the same indexes add_edge() would have chosen
+        size_t n_free = std::min(E, _free_indexes.size());
+        std::vector<Vertex> free_idx(_free_indexes.begin(),
+                                     _free_indexes.begin() + n_free);
+        _free_indexes.erase(_free_indexes.begin(),
+                            _free_indexes.begin() + n_free);
+        size_t idx_base = _edge_index_range;
+        _edge_index_range += E - n_free;
+        auto get_idx = [&](size_t i) -> Vertex
+            {
+                return (i < n_free) ? free_idx[i] : idx_base + (i - n_free);
+            };
+
+        size_t n_parts = 1;
+        #ifdef USING_OPENMP
+        if (E > 10000)
+            n_parts = omp_get_max_threads();
+        #endif
+
+        // the vertices are divided into buckets of consecutive indexes, more
+        // numerous than the threads, for load balancing
+        size_t bsize = (N + 8 * n_parts - 1) / (8 * n_parts);
+        size_t n_buckets = (N + bsize - 1) / bsize;
+        auto chunk_begin = [&](size_t c) { return (c * E) / n_parts; };
+
+        // the inputs are split into n_parts contiguous chunks, and the number
+        // of edges of each chunk that fall into each bucket (by source for the
+        // out-edges, and by target for the in-edges) is counted
+        std::vector<size_t> out_pos(n_parts * n_buckets),
+            in_pos(n_parts * n_buckets);
+        #pragma omp parallel for schedule(static, 1) if (n_parts > 1)
+        for (size_t c = 0; c < n_parts; ++c)
+        {
+            for (size_t i = chunk_begin(c); i < chunk_begin(c + 1); ++i)
+            {
+                out_pos[c * n_buckets + size_t(source(i)) / bsize]++;
+                in_pos[c * n_buckets + size_t(target(i)) / bsize]++;
+            }
+        }
+
+        // the prefix sums over the buckets, and then the chunks, give the
+        // offsets where each chunk writes its part of each bucket, so that
+        // every bucket is a contiguous range which keeps the input order
+        auto prefix_sum = [&](auto& pos)
+            {
+                std::vector<size_t> begin(n_buckets + 1);
+                size_t m = 0;
+                for (size_t b = 0; b < n_buckets; ++b)
+                {
+                    begin[b] = m;
+                    for (size_t c = 0; c < n_parts; ++c)
+                    {
+                        size_t k = pos[c * n_buckets + b];
+                        pos[c * n_buckets + b] = m;
+                        m += k;
+                    }
+                }
+                begin[n_buckets] = m;
+                return begin;
+            };
+        auto out_begin = prefix_sum(out_pos);
+        auto in_begin = prefix_sum(in_pos);
+
+        std::vector<size_t> out_order(E), in_order(E);
+        #pragma omp parallel for schedule(static, 1) if (n_parts > 1)
+        for (size_t c = 0; c < n_parts; ++c)
+        {
+            for (size_t i = chunk_begin(c); i < chunk_begin(c + 1); ++i)
+            {
+                out_order[out_pos[c * n_buckets + size_t(source(i)) / bsize]++] = i;
+                in_order[in_pos[c * n_buckets + size_t(target(i)) / bsize]++] = i;
+            }
+        }
+
+        if (_keep_epos)
+            _epos.resize(_edge_index_range);
+
+        // each bucket is appended to the edge lists of its vertices by a single
+        // thread, in the input order; the capacity grows at least
+        // geometrically, so that the cost remains linear if edges are added in
+        // several batches
+        auto fill = [&](size_t b, auto& order, auto& begin, auto& es_list,
+                        auto&& get_v, auto&& get_u, auto&& set_pos)
+            {
+                size_t v_begin = b * bsize;
+                size_t v_end = std::min(N, v_begin + bsize);
+                std::vector<size_t> k(v_end - v_begin);
+                for (size_t j = begin[b]; j < begin[b + 1]; ++j)
+                    k[get_v(order[j]) - v_begin]++;
+                for (size_t v = v_begin; v < v_end; ++v)
+                {
+                    auto& es = es_list[v];
+                    size_t n = es.size() + k[v - v_begin];
+                    if (n > es.capacity())
+                        es.reserve(std::max(n, 2 * es.capacity()));
+                }
+                for (size_t j = begin[b]; j < begin[b + 1]; ++j)
+                {
+                    size_t i = order[j];
+                    Vertex idx = get_idx(i);
+                    auto& es = es_list[get_v(i)];
+                    es.emplace_back(get_u(i), idx);
+                    set_pos(idx, es.size() - 1);
+                }
+            };
+        auto get_s = [&](size_t i) { return Vertex(source(i)); };
+        auto get_t = [&](size_t i) { return Vertex(target(i)); };
+        #pragma omp parallel for schedule(dynamic, 1) if (n_parts > 1)
+        for (size_t b = 0; b < n_buckets; ++b)
+        {
+            fill(b, out_order, out_begin, _out_edges, get_s, get_t,
+                 [&](Vertex idx, size_t j)
+                 {
+                     if (_keep_epos)
+                         _epos[idx].first = j;
+                 });
+            fill(b, in_order, in_begin, _in_edges, get_t, get_s,
+                 [&](Vertex idx, size_t j)
+                 {
+                     if (_keep_epos)
+                         _epos[idx].second = j;
+                 });
+        }
+
+        _n_edges += E;
+
+        // neither the hash table nor the components support concurrent
+        // updates, so these are done serially, in O(E) time (amortized, for
+        // the components)
+        if (_keep_ehash)
+        {
+            _ehash.reserve(_n_edges);
+            for (size_t i = 0; i < E; ++i)
+                _ehash.emplace(std::make_pair(Vertex(source(i)),
+                                              Vertex(target(i))),
+                               get_idx(i));
+        }
+
+        if (_keep_comps && !_comps_stale)
+        {
+            while (_comp.size() < N)
+                comps_add_vertex();
+            for (size_t i = 0; i < E; ++i)
+                comps_add_edge(source(i), target(i));
+        }
+
+        size_t i_max = E - 1;
+        if (n_free == E)
+            i_max = std::max_element(free_idx.begin(), free_idx.end())
+                - free_idx.begin();
+        auto get_edge = [&](size_t i)
+            {
+                return edge_descriptor(source(i), target(i), get_idx(i),
+                                       false);
+            };
+        f(i_max, get_edge(i_max));
+
+        std::exception_ptr exc;
+        #pragma omp parallel for schedule(static) \
+            if (parallel_f && E > 10000)
+        for (size_t i = 0; i < E; ++i)
+        {
+            if (i == i_max)
+                continue;
+            try
+            {
+                f(i, get_edge(i));
+            }
+            catch (...)
+            {
+                #pragma omp critical (add_edges_exception)
+                if (!exc)
+                    exc = std::current_exception();
+            }
+        }
+        if (exc)
+            std::rethrow_exception(exc);
     }
 
     void set_keep_epos(bool keep)
@@ -342,6 +653,7 @@ public:
         }
         else
         {
+            set_keep_ehash(false);
             _epos.clear();
         }
         _keep_epos = keep;
@@ -352,8 +664,91 @@ public:
         return _keep_epos;
     }
 
+    void set_keep_ehash(bool keep)
+    {
+        if (keep)
+        {
+            set_keep_epos(true);
+            if (!_keep_ehash)
+                rebuild_ehash();
+        }
+        else
+        {
+            ehash_t().swap(_ehash);
+        }
+        _keep_ehash = keep;
+    }
+
+    bool get_keep_ehash()
+    {
+        return _keep_ehash;
+    }
+
+    void set_keep_comps(bool keep)
+    {
+        if (keep)
+        {
+            // a structure computed by a previous query is adopted if the
+            // graph has not been modified since
+            if (!_keep_comps && _comps_mod_count != _mod_count)
+                _comps_stale = true;
+        }
+        else
+        {
+            std::vector<Vertex>().swap(_comp);
+            std::vector<Vertex>().swap(_comp_pos);
+            std::vector<std::vector<Vertex>>().swap(_comp_members);
+            std::vector<Vertex>().swap(_comp_free);
+            std::vector<size_t>().swap(_comp_mark);
+            _comps_stale = true;
+        }
+        _keep_comps = keep;
+    }
+
+    bool get_keep_comps()
+    {
+        return _keep_comps;
+    }
+
+    // The following take O(1) time if get_keep_comps() == true, and
+    // otherwise O(V + E) at the first query after each modification.
+
+    // label of the component of v; the labels are only meant to be compared
+    // with each other, since they are not renumbered when vertices are
+    // removed: they are smaller than the largest number of vertices the graph
+    // had since the components were last computed, which may be larger than V
+    Vertex get_comp(Vertex v)
+    {
+        refresh_comps();
+        return _comp[v];
+    }
+
+    bool get_connected(Vertex u, Vertex v)
+    {
+        refresh_comps();
+        return _comp[u] == _comp[v];
+    }
+
+    // number of vertices in the component of v
+    size_t get_comp_size(Vertex v)
+    {
+        refresh_comps();
+        return _comp_members[_comp[v]].size();
+    }
+
+    size_t get_num_comps()
+    {
+        refresh_comps();
+        return _n_comps;
+    }
+
     size_t get_edge_index_range() const { return _edge_index_range; }
 
+    // number of structural modifications performed so far; this can be used
+    // to detect whether data derived from the graph (e.g. a csr_adj_list
+    // snapshot) is still up to date
+    size_t get_mod_count() const { return _mod_count; }
+
     static Vertex null_vertex() { return std::numeric_limits<Vertex>::max(); }
 
     void shrink_to_fit()
@@ -395,6 +790,79 @@ private:
     bool _keep_epos;
     std::vector<std::pair<int32_t, int32_t>> _epos;
 
+    struct ehash_hash
+    {
+        size_t operator()(const std::pair<Vertex, Vertex>& k) const
+        {
+            std::hash<Vertex> h;
+            size_t seed = h(k.first);
+            seed ^= h(k.second) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+    };
+
+    typedef std::unordered_multimap<std::pair<Vertex, Vertex>, Vertex,
+                                    ehash_hash> ehash_t;
+    bool _keep_ehash;
+    ehash_t _ehash; // (source, target) -> edge index
+
+    size_t _mod_count;
+
+    // arrays given to defer_csr(), which are yet to be copied
+    struct deferred_csr
+    {
+        size_t N;
+        size_t E;
+        const size_t* out_pos;
+        const std::pair<vertex_t, vertex_t>* out_edges;
+        const size_t* in_pos;
+        const std::pair<vertex_t, vertex_t>* in_edges;
+        std::shared_ptr<const void> storage;
+    };
+    std::shared_ptr<deferred_csr> _deferred;
+
+    bool _keep_comps;
+    bool _comps_stale;
+    size_t _n_comps;
+    std::vector<Vertex> _comp;      // component label of each vertex
+    std::vector<Vertex> _comp_pos;  // position of each vertex in its list
+    std::vector<std::vector<Vertex>> _comp_members; // vertices of each label
+    std::vector<Vertex> _comp_free; // unused labels
+    std::vector<size_t> _comp_mark; // visited marks of the searches
+    size_t _comp_stamp = 0;
+    size_t _comps_mod_count = 0;    // _mod_count of the last rebuild
+
+    void copy_csr(size_t N, size_t E,
+                  const size_t* out_pos,
+                  const std::pair<vertex_t, vertex_t>* out_edges,
+                  const size_t* in_pos,
+                  const std::pair<vertex_t, vertex_t>* in_edges)
+    {
+        _free_indexes.clear();
+        _out_edges.clear();
+        _in_edges.clear();
+        _out_edges.resize(N);
+        _in_edges.resize(N);
+
+        #pragma omp parallel for schedule(runtime) if (N > 100)
+        for (size_t v = 0; v < N; ++v)
+        {
+            _out_edges[v].assign(out_edges + out_pos[v],
+                                 out_edges + out_pos[v + 1]);
+            _in_edges[v].assign(in_edges + in_pos[v],
+                                in_edges + in_pos[v + 1]);
+        }
+
+        _n_edges = E;
+        _edge_index_range = E;
+
+        if (_keep_epos)
+            rebuild_epos();
+        if (_keep_ehash)
+            rebuild_ehash();
+        _comps_stale = true;
+    }
+
     void rebuild_epos()
     {
         _epos.resize(_edge_index_range);
@@ -416,6 +884,246 @@ private:
         }
     }
 
+    void rebuild_ehash()
+    {
+        _ehash.clear();
+        _ehash.reserve(_n_edges);
+        for (size_t i = 0; i < _out_edges.size(); ++i)
+        {
+            for (auto& oe : _out_edges[i])
+                _ehash.emplace(std::make_pair(Vertex(i), oe.first), oe.second);
+        }
+    }
+
+    void refresh_comps()
+    {
+        // if the components are not kept, they are not updated by the
+        // modifications, and are only valid for the graph they were computed
+        // for
+        if (!_keep_comps && _comps_mod_count != _mod_count)
+            _comps_stale = true;
+        if (!_comps_stale)
+            return;
+        size_t N = _out_edges.size();
+        _comp.clear();
+        _comp_pos.clear();
+        _comp_members.clear();
+        _comp_free.clear();
+        _comp_mark.clear();
+        _n_comps = 0;
+        _comps_stale = false;
+        _comps_mod_count = _mod_count;
+        for (size_t v = 0; v < N; ++v)
+            comps_push_vertex();
+        for (size_t v = 0; v < N; ++v)
+        {
+            for (auto& oe : _out_edges[v])
+                comps_join(v, oe.first);
+        }
+    }
+
+    Vertex comps_new_label()
+    {
+        Vertex c;
+        if (_comp_free.empty())
+        {
+            c = _comp_members.size();
+            _comp_members.emplace_back();
+        }
+        else
+        {
+            c = _comp_free.back();
+            _comp_free.pop_back();
+        }
+        _n_comps++;
+        return c;
+    }
+
+    void comps_move(Vertex v, Vertex c)
+    {
+        auto& members = _comp_members[_comp[v]];
+        Vertex back = members.back();
+        members[_comp_pos[v]] = back;
+        _comp_pos[back] = _comp_pos[v];
+        members.pop_back();
+
+        _comp[v] = c;
+        _comp_pos[v] = _comp_members[c].size();
+        _comp_members[c].push_back(v);
+    }
+
+    void comps_push_vertex()
+    {
+        Vertex c = comps_new_label();
+        _comp.push_back(c);
+        _comp_pos.push_back(0);
+        _comp_members[c].push_back(_comp.size() - 1);
+    }
+
+    void comps_join(Vertex s, Vertex t)
+    {
+        Vertex a = _comp[s];
+        Vertex b = _comp[t];
+        if (a == b)
+            return;
+        if (_comp_members[a].size() < _comp_members[b].size())
+            std::swap(a, b);
+        auto& members = _comp_members[b];
+        while (!members.empty())
+            comps_move(members.back(), a);
+        std::vector<Vertex>().swap(members);
+        _comp_free.push_back(b);
+        _n_comps--;
+    }
+
+    // Splits off the component of s or t, if they are no longer connected,
+    // which is returned.
+    bool comps_split(Vertex s, Vertex t)
+    {
+        // The visited vertices of side i are marked with _comp_stamp + i.
+        _comp_mark.resize(_comp.size(), 0);
+        if (_comp_stamp > std::numeric_limits<size_t>::max() - 4)
+        {
+            std::fill(_comp_mark.begin(), _comp_mark.end(), 0);
+            _comp_stamp = 0;
+        }
+        _comp_stamp += 2;
+
+        std::vector<Vertex> queue[2] = {{s}, {t}};
+        size_t head[2] = {0, 0};
+        _comp_mark[s] = _comp_stamp;
+        _comp_mark[t] = _comp_stamp + 1;
+        while (true)
+        {
+            size_t i = (queue[0].size() <= queue[1].size()) ? 0 : 1;
+            if (head[i] == queue[i].size())
+                break;
+            Vertex w = queue[i][head[i]++];
+            for (auto* es : {&_out_edges[w], &_in_edges[w]})
+            {
+                for (auto& e : *es)
+                {
+                    Vertex u = e.first;
+                    if (_comp_mark[u] == _comp_stamp + 1 - i)
+                        return false;   // still connected
+                    if (_comp_mark[u] == _comp_stamp + i)
+                        continue;
+                    _comp_mark[u] = _comp_stamp + i;
+                    queue[i].push_back(u);
+                }
+            }
+        }
+
+        // the exhausted side is split off
+        size_t i = (queue[0].size() <= queue[1].size()) ? 0 : 1;
+        Vertex c = comps_new_label();
+        for (auto v : queue[i])
+            comps_move(v, c);
+        return true;
+    }
+
+    // The functions below are called by the graph modifications, and do
+    // nothing if the components are not kept up to date.
+
+    void comps_add_vertex()
+    {
+        if (!_keep_comps || _comps_stale)
+            return;
+        comps_push_vertex();
+    }
+
+    void comps_add_edge(Vertex s, Vertex t)
+    {
+        if (!_keep_comps || _comps_stale)
+            return;
+        comps_join(s, t);
+    }
+
+    void comps_remove_edge(Vertex s, Vertex t)
+    {
+        if (!_keep_comps || _comps_stale || s == t)
+            return;
+        comps_split(s, t);
+    }
+
+    // Called after all the edges of v are removed, with its former distinct
+    // neighbours ns. What remains of its component is split in pieces which
+    // contain at least one neighbour each. Every neighbour is either found
+    // connected to the previous one with the same label, or split off from
+    // it, so that at the end every label corresponds to a single piece.
+    void comps_clear_vertex(Vertex v, const std::vector<Vertex>& ns)
+    {
+        if (!_keep_comps || _comps_stale)
+            return;
+        if (_comp_members[_comp[v]].size() > 1)
+            comps_move(v, comps_new_label());
+        std::unordered_map<Vertex, Vertex> rep; // label -> neighbour
+        for (auto u : ns)
+        {
+            auto iter = rep.find(_comp[u]);
+            if (iter == rep.end())
+            {
+                rep[_comp[u]] = u;
+                continue;
+            }
+            if (comps_split(iter->second, u))
+                rep[_comp[u]] = u;
+        }
+    }
+
+    // Called when the isolated vertex v is removed, and the vertex with index
+    // w takes its place (w == v if it is the last one); larger indexes are
+    // shifted down by one if shift == true.
+    void comps_remove_vertex(Vertex v, Vertex w, bool shift)
+    {
+        if (!_keep_comps || _comps_stale)
+            return;
+        Vertex c = _comp[v];
+        std::vector<Vertex>().swap(_comp_members[c]);
+        _comp_free.push_back(c);
+        _n_comps--;
+
+        if (shift)
+        {
+            _comp.erase(_comp.begin() + v);
+            _comp_pos.erase(_comp_pos.begin() + v);
+            for (auto& members : _comp_members)
+            {
+                for (auto& u : members)
+                {
+                    if (u > v)
+                        u--;
+                }
+            }
+        }
+        else
+        {
+            if (w != v)
+            {
+                _comp[v] = _comp[w];
+                _comp_pos[v] = _comp_pos[w];
+                _comp_members[_comp[v]][_comp_pos[v]] = v;
+            }
+            _comp.pop_back();
+            _comp_pos.pop_back();
+        }
+        if (_comp_mark.size() > _comp.size())
+            _comp_mark.resize(_comp.size());
+    }
+
+    void ehash_erase(Vertex s, Vertex t, Vertex idx)
+    {
+        auto range = _ehash.equal_range(std::make_pair(s, t));
+        for (auto iter = range.first; iter != range.second; ++iter)
+        {
+            if (iter->second == idx)
+            {
+                _ehash.erase(iter);
+                break;
+            }
+        }
+    }
+
     // manipulation functions
     friend std::pair<vertex_iterator, vertex_iterator>
     vertices<>(const adj_list<Vertex>& g);
@@ -592,12 +1300,28 @@ std::pair<typename adj_list<Vertex>::edge_descriptor, bool>
 edge(Vertex s, Vertex t, const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::edge_descriptor edge_descriptor;
-    const auto& oes = g._out_edges[s];
-    auto iter = std::find_if(oes.begin(), oes.end(),
-                             [&](const auto& e) -> bool {return e.first == t;});
-    if (iter != oes.end())
-        return std::make_pair(edge_descriptor(s, t, iter->second, false),
-                              true);
+    if (g._keep_ehash) // O(1), or O(m) for m parallel edges
+    {
+        auto range = g._ehash.equal_range(std::make_pair(s, t));
+        if (range.first != range.second)
+        {
+            // the hash table order depends on its history, so we return the
+            // smallest index for a deterministic result
+            Vertex idx = range.first->second;
+            for (auto iter = range.first; iter != range.second; ++iter)
+                idx = std::min(idx, iter->second);
+            return std::make_pair(edge_descriptor(s, t, idx, false), true);
+        }
+    }
+    else // O(k_s)
+    {
+        const auto& oes = g._out_edges[s];
+        auto iter = std::find_if(oes.begin(), oes.end(),
+                                 [&](const auto& e) -> bool {return e.first == t;});
+        if (iter != oes.end())
+            return std::make_pair(edge_descriptor(s, t, iter->second, false),
+                                  true);
+    }
     Vertex v = graph_traits<adj_list<Vertex> >::null_vertex();
     return std::make_pair(edge_descriptor(v, v, v, false), false);
 }
@@ -699,14 +1423,40 @@ template <class Vertex>
 inline __attribute__((always_inline))
 Vertex add_vertex(adj_list<Vertex>& g)
 {
+    g._mod_count++;
     g._out_edges.emplace_back();
     g._in_edges.emplace_back();
+    g.comps_add_vertex();
     return g._out_edges.size() - 1;
 }
 
 template <class Vertex>
 inline void clear_vertex(Vertex v, adj_list<Vertex>& g)
 {
+    g._mod_count++;
+    std::vector<Vertex> ns;
+    if (g._keep_comps && !g._comps_stale)
+    {
+        for (auto* es : {&g._out_edges[v], &g._in_edges[v]})
+        {
+            for (const auto& e : *es)
+            {
+                if (e.first != v)
+                    ns.push_back(e.first);
+            }
+        }
+        std::sort(ns.begin(), ns.end());
+        ns.erase(std::unique(ns.begin(), ns.end()), ns.end());
+    }
+
+    if (g._keep_ehash)
+    {
+        for (const auto& oe : g._out_edges[v])
+            g.ehash_erase(v, oe.first, oe.second);
+        for (const auto& ie : g._in_edges[v])
+            g.ehash_erase(ie.first, v, ie.second);
+    }
+
     if (!g._keep_epos)
     {
         auto remove_es = [&] (auto& out_edges, auto& in_edges)
@@ -762,6 +1512,7 @@ inline void clear_vertex(Vertex v, adj_list<Vertex>& g)
         remove_es(g._in_edges, g._out_edges,
                   [&](size_t idx) -> auto& {return g._epos[idx].first;});
     }
+    g.comps_clear_vertex(v, ns);
 }
 
 // O(V + E)
@@ -769,6 +1520,8 @@ template <class Vertex>
 inline void remove_vertex(Vertex v, adj_list<Vertex>& g)
 {
     clear_vertex(v, g);
+    g._mod_count++;
+    g.comps_remove_vertex(v, v, true);
     g._out_edges.erase(g._out_edges.begin() + v);
     g._in_edges.erase(g._in_edges.begin() + v);
 
@@ -788,6 +1541,9 @@ inline void remove_vertex(Vertex v, adj_list<Vertex>& g)
         shift_es(g._out_edges, i);
         shift_es(g._in_edges, i);
     }
+
+    if (g._keep_ehash)
+        g.rebuild_ehash();
 }
 
 // O(k + k_last)
@@ -795,15 +1551,34 @@ template <class Vertex>
 inline void remove_vertex_fast(Vertex v, adj_list<Vertex>& g)
 {
     Vertex back = g._out_edges.size() - 1;
+    g._mod_count++;
 
     if (v < back)
     {
         clear_vertex(v, g);
+        g.comps_remove_vertex(v, back, false);
         g._out_edges[v].swap(g._out_edges[back]);
         g._in_edges[v].swap(g._in_edges[back]);
         g._out_edges.pop_back();
         g._in_edges.pop_back();
 
+        if (g._keep_ehash)
+        {
+            for (const auto& oe : g._out_edges[v])
+            {
+                g.ehash_erase(back, oe.first, oe.second);
+                Vertex t = (oe.first == back) ? v : oe.first;
+                g._ehash.emplace(std::make_pair(v, t), oe.second);
+            }
+            for (const auto& ie : g._in_edges[v])
+            {
+                if (ie.first == back) // self-loops were handled above
+                    continue;
+                g.ehash_erase(ie.first, back, ie.second);
+                g._ehash.emplace(std::make_pair(ie.first, v), ie.second);
+            }
+        }
+
         auto rename_v = [&] (auto& out_edges, auto& in_edges,
                              const auto& get_pos)
             {
@@ -842,6 +1617,7 @@ inline void remove_vertex_fast(Vertex v, adj_list<Vertex>& g)
     else
     {
         clear_vertex(v, g);
+        g.comps_remove_vertex(v, v, false);
         g._out_edges.pop_back();
         g._in_edges.pop_back();
     }
@@ -866,6 +1642,7 @@ add_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
     auto& oes = g._out_edges[s];
     auto& ies = g._in_edges[t];
     oes.emplace_back(t, idx);
+    g._mod_count++;
     ies.emplace_back(s, idx);
     g._n_edges++;
 
@@ -878,6 +1655,11 @@ add_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
         ei.second = ies.size() - 1;
     }
 
+    if (g._keep_ehash)
+        g._ehash.emplace(std::make_pair(s, t), idx);
+
+    g.comps_add_edge(s, t);
+
     typedef typename adj_list<Vertex>::edge_descriptor edge_descriptor;
     return std::make_pair(edge_descriptor(s, t, idx, false), true);
 }
@@ -886,13 +1668,15 @@ template <class Vertex>
 inline void remove_edge(Vertex s, Vertex t,
                         adj_list<Vertex>& g)
 {
-    if (!g._keep_epos)
+    g._mod_count++;
+    if (!g._keep_epos && !g._keep_ehash)
     {
         auto& oes = g._out_edges[s];
         auto iter_o = std::find_if(oes.begin(), oes.end(),
                                    [&] (const auto& ei) -> bool
                                    {return t == ei.first;});
-        if (iter_o != oes.end())
+        bool found = (iter_o != oes.end());
+        if (found)
         {
             g._free_indexes.push_back(iter_o->second);
             oes.erase(iter_o);
@@ -907,10 +1691,15 @@ inline void remove_edge(Vertex s, Vertex t,
         {
             ies.erase(iter_i);
         }
+
+        if (found)
+            g.comps_remove_edge(s, t);
     }
     else
     {
-        remove_edge(edge(s, t, g).first, g);
+        auto e = edge(s, t, g);
+        if (e.second)
+            remove_edge(e.first, g);
     }
 }
 
@@ -923,6 +1712,7 @@ inline void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
     auto& idx = e.idx;
     auto& oes = g._out_edges[s];
     auto& ies = g._in_edges[t];
+    g._mod_count++;
 
     bool found = false;
     if (!g._keep_epos) // O(k_s + k_t)
@@ -966,6 +1756,9 @@ inline void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
     {
         g._free_indexes.push_back(idx);
         g._n_edges--;
+        if (g._keep_ehash)
+            g.ehash_erase(s, t, idx);
+        g.comps_remove_edge(s, t);
     }
 }
 
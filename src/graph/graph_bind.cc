@@ -487,6 +487,14 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
         .def("get_reversed", &GraphInterface::get_reversed)
         .def("set_keep_epos", &GraphInterface::set_keep_epos)
         .def("get_keep_epos", &GraphInterface::get_keep_epos)
+        .def("set_keep_ehash", &GraphInterface::set_keep_ehash)
+        .def("get_keep_ehash", &GraphInterface::get_keep_ehash)
+        .def("set_keep_comps", &GraphInterface::set_keep_comps)
+        .def("get_keep_comps", &GraphInterface::get_keep_comps)
+        .def("get_comp", &GraphInterface::get_comp)
+        .def("get_connected", &GraphInterface::get_connected)
+        .def("get_comp_size", &GraphInterface::get_comp_size)
+        .def("get_num_comps", &GraphInterface::get_num_comps)
         .def("set_vertex_filter_property",
              &GraphInterface::set_vertex_filter_property)
         .def("is_vertex_filter_active", &GraphInterface::is_vertex_filter_active)
@@ -500,6 +508,7 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
         .def("re_index_vertex_property",  &GraphInterface::re_index_vertex_property)
         .def("write_to_file", &GraphInterface::write_to_file)
         .def("read_from_file",&GraphInterface::read_from_file)
+        .def("read_from_csv", &GraphInterface::read_from_csv)
         .def("degree_map", &GraphInterface::degree_map)
         .def("clear", &GraphInterface::clear)
         .def("clear_edges", &GraphInterface::clear_edges)
@@ -508,6 +517,9 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
         .def("get_edge_index_range", &GraphInterface::get_edge_index_range)
         .def("re_index_edges", &GraphInterface::re_index_edges)
         .def("shrink_to_fit", &GraphInterface::shrink_to_fit)
+        .def("freeze", &GraphInterface::freeze)
+        .def("unfreeze", &GraphInterface::unfreeze)
+        .def("is_frozen", &GraphInterface::is_frozen)
         .def("get_graph_index", &GraphInterface::get_graph_index)
         .def("copy_vertex_property", &GraphInterface::copy_vertex_property)
         .def("copy_edge_property", &GraphInterface::copy_edge_property)
@@ -236,6 +236,8 @@ GraphInterface::GraphInterface(const GraphInterface& gi, bool keep_ref,
     :_mg(keep_ref ? gi._mg : std::make_shared<multigraph_t>()),
      _vertex_index(get(vertex_index, *_mg)),
      _edge_index(get(edge_index_t(), *_mg)),
+     _csr(gi._csr),
+     _csr_mod_count(gi._csr_mod_count),
      _reversed(gi._reversed),
      _directed(gi._directed),
      _vertex_filter_map(_vertex_index),
@@ -250,11 +252,14 @@ GraphInterface::GraphInterface(const GraphInterface& gi, bool keep_ref,
 
     if (vorder == python::object())
     {
-        // simple copying
+        // simple copying; the CSR snapshot remains valid, and the adjacency
+        // list is not built if it has not been yet
         *_mg = *gi._mg;
         return;
     }
 
+    unfreeze();
+
     vector<pair<std::reference_wrapper<boost::any>,std::reference_wrapper<boost::any>>> vprops;
     for (int i = 0; i < python::len(ovprops); ++i)
     {
@@ -0,0 +1,582 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2016 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_CSR_HH
+#define GRAPH_CSR_HH
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <memory>
+
+#include "graph_adjacency.hh"
+
+namespace boost
+{
+
+// ========================================================================
+// csr_adj_list<Vertex>
+// ========================================================================
+//
+// csr_adj_list is an immutable "snapshot" of an adj_list<Vertex>, stored in
+// compressed sparse row (CSR) format: the out- and in-edge lists of all
+// vertices are kept contiguously in a single array each, delimited by an
+// offset array of size N + 1. Traversals therefore touch only contiguous
+// memory, instead of one heap block per vertex.
+//
+// The edge descriptors, and hence the edge indexes, are exactly the same as in
+// the originating adj_list, so that all existing vertex and edge property maps
+// can be used unmodified with the snapshot. The relative ordering of the out-
+// and in-edges of each vertex is also preserved.
+//
+// The snapshot can be constructed in O(V + E) time, and it cannot be modified
+// afterwards; none of the manipulation functions (add_edge(), etc.) are
+// defined for it.
+//
+// The graph only holds pointers to the offset and edge arrays, together with a
+// shared reference to whatever owns them. This is either a private copy made
+// from an adj_list, or an external memory region, such as a memory-mapped
+// file (see graph_io_binary.hh). Copies of the graph share the same storage.
+
+template <class Vertex>
+class csr_adj_list;
+
+template <class Vertex>
+std::pair<typename csr_adj_list<Vertex>::vertex_iterator,
+          typename csr_adj_list<Vertex>::vertex_iterator>
+vertices(const csr_adj_list<Vertex>& g);
+
+template <class Vertex>
+std::pair<typename csr_adj_list<Vertex>::edge_iterator,
+          typename csr_adj_list<Vertex>::edge_iterator>
+edges(const csr_adj_list<Vertex>& g);
+
+template <class Vertex>
+std::pair<typename csr_adj_list<Vertex>::edge_descriptor, bool>
+edge(Vertex s, Vertex t, const csr_adj_list<Vertex>& g);
+
+template <class Vertex>
+size_t out_degree(Vertex v, const csr_adj_list<Vertex>& g);
+
+template <class Vertex>
+size_t in_degree(Vertex v, const csr_adj_list<Vertex>& g);
+
+template <class Vertex>
+std::pair<typename csr_adj_list<Vertex>::out_edge_iterator,
+          typename csr_adj_list<Vertex>::out_edge_iterator>
+out_edges(Vertex v, const csr_adj_list<Vertex>& g);
+
+template <class Vertex>
+std::pair<typename csr_adj_list<Vertex>::in_edge_iterator,
+          typename csr_adj_list<Vertex>::in_edge_iterator>
+in_edges(Vertex v, const csr_adj_list<Vertex>& g);
+
+template <class Vertex>
+std::pair<typename csr_adj_list<Vertex>::adjacency_iterator,
+          typename csr_adj_list<Vertex>::adjacency_iterator>
+out_neighbours(Vertex v, const csr_adj_list<Vertex>& g);
+
+template <class Vertex>
+std::pair<typename csr_adj_list<Vertex>::adjacency_iterator,
+          typename csr_adj_list<Vertex>::adjacency_iterator>
+in_neighbours(Vertex v, const csr_adj_list<Vertex>& g);
+
+template <class Vertex>
+size_t num_vertices(const csr_adj_list<Vertex>& g);
+
+template <class Vertex>
+size_t num_edges(const csr_adj_list<Vertex>& g);
+
+template <class Vertex = size_t>
+class csr_adj_list
+{
+public:
+    struct graph_tag {};
+    typedef Vertex vertex_t;
+
+    typedef detail::adj_edge_descriptor<Vertex> edge_descriptor;
+
+    // the edge entries have the same layout as in adj_list, i.e. (neighbour,
+    // edge index) pairs
+    typedef std::pair<Vertex, Vertex> edge_entry_t;
+    typedef const edge_entry_t* entry_iterator;
+
+    typedef typename adj_list<Vertex>::vertex_iterator vertex_iterator;
+    typedef transform_random_access_iterator<typename adj_list<Vertex>::get_vertex,
+                                             entry_iterator>
+        adjacency_iterator;
+    typedef adjacency_iterator in_adjacency_iterator;
+
+    template <class Deference>
+    struct base_edge_iterator:
+        public boost::iterator_facade<base_edge_iterator<Deference>,
+                                      edge_descriptor,
+                                      std::random_access_iterator_tag,
+                                      edge_descriptor>
+    {
+        base_edge_iterator() {}
+        base_edge_iterator(vertex_t v, entry_iterator iter)
+            : _v(v), _iter(iter)
+        {}
+
+    private:
+        friend class boost::iterator_core_access;
+        void increment() { ++_iter; }
+        void decrement() { --_iter; }
+        template <class Distance>
+        void advance(Distance n) { _iter += n; }
+        auto distance_to(base_edge_iterator const& other) const
+        {
+            return other._iter - _iter;
+        }
+
+        bool equal(base_edge_iterator const& other) const
+        {
+            return _iter == other._iter;
+        }
+
+        edge_descriptor dereference() const
+        {
+            return Deference::def(_v, *_iter);
+        }
+
+        vertex_t _v;
+        entry_iterator _iter;
+    };
+
+    typedef base_edge_iterator<typename adj_list<Vertex>::make_out_edge>
+        out_edge_iterator;
+    typedef base_edge_iterator<typename adj_list<Vertex>::make_in_edge>
+        in_edge_iterator;
+
+    class edge_iterator:
+        public boost::iterator_facade<edge_iterator,
+                                      edge_descriptor,
+                                      boost::forward_traversal_tag,
+                                      edge_descriptor>
+    {
+    public:
+        edge_iterator() {}
+        explicit edge_iterator(const csr_adj_list* g, size_t v, size_t pos)
+            : _g(g), _v(v), _pos(pos)
+        {
+            skip();
+        }
+
+    private:
+        friend class boost::iterator_core_access;
+
+        void skip()
+        {
+            // move to the vertex which owns the current position, skipping
+            // vertices without out-edges
+            size_t N = _g->_N;
+            while (_v < N && _pos >= _g->_out_pos[_v + 1])
+                ++_v;
+        }
+
+        void increment()
+        {
+            ++_pos;
+            skip();
+        }
+
+        bool equal(edge_iterator const& other) const
+        {
+            return _pos == other._pos;
+        }
+
+        edge_descriptor dereference() const
+        {
+            const auto& e = _g->_out_edges[_pos];
+            return edge_descriptor(_v, e.first, e.second, false);
+        }
+
+        const csr_adj_list* _g;
+        size_t _v;
+        size_t _pos;
+    };
+
+    csr_adj_list()
+        : csr_adj_list(adj_list<Vertex>()) {}
+
+    // O(V + E)
+    explicit csr_adj_list(const adj_list<Vertex>& g)
+        : _N(num_vertices(g)), _n_edges(num_edges(g)),
+          _edge_index_range(g.get_edge_index_range())
+    {
+        auto storage = std::make_shared<csr_storage>();
+        auto& out_pos = storage->out_pos;
+        auto& in_pos = storage->in_pos;
+        auto& oes = storage->out_edges;
+        auto& ies = storage->in_edges;
+
+        size_t N = _N;
+        out_pos.resize(N + 1);
+        in_pos.resize(N + 1);
+        out_pos[0] = in_pos[0] = 0;
+        for (size_t v = 0; v < N; ++v)
+        {
+            out_pos[v + 1] = out_pos[v] + out_degree(Vertex(v), g);
+            in_pos[v + 1] = in_pos[v] + in_degree(Vertex(v), g);
+        }
+
+        oes.resize(out_pos[N]);
+        ies.resize(in_pos[N]);
+
+        #pragma omp parallel for schedule(runtime) if (N > 100)
+        for (size_t v = 0; v < N; ++v)
+        {
+            auto opos = oes.begin() + out_pos[v];
+            typename adj_list<Vertex>::out_edge_iterator e, e_end;
+            for (tie(e, e_end) = out_edges(Vertex(v), g); e != e_end; ++e)
+                *(opos++) = std::make_pair((*e).t, (*e).idx);
+
+            auto ipos = ies.begin() + in_pos[v];
+            typename adj_list<Vertex>::in_edge_iterator ie, ie_end;
+            for (tie(ie, ie_end) = in_edges(Vertex(v), g); ie != ie_end; ++ie)
+                *(ipos++) = std::make_pair((*ie).s, (*ie).idx);
+        }
+
+        _out_pos = out_pos.data();
+        _in_pos = in_pos.data();
+        _out_edges = oes.data();
+        _in_edges = ies.data();
+        _storage = storage;
+    }
+
+    // Wraps existing arrays without copying them; "storage" is kept alive
+    // for as long as the graph (or any of its copies) exists. The offset
+    // arrays must have size N + 1, and the edge arrays size E.
+    csr_adj_list(size_t N, size_t E, size_t edge_index_range,
+                 const size_t* out_pos, const edge_entry_t* out_edges,
+                 const size_t* in_pos, const edge_entry_t* in_edges,
+                 std::shared_ptr<const void> storage)
+        : _N(N), _out_pos(out_pos), _in_pos(in_pos), _out_edges(out_edges),
+          _in_edges(in_edges), _n_edges(E),
+          _edge_index_range(edge_index_range), _storage(storage) {}
+
+    size_t get_edge_index_range() const { return _edge_index_range; }
+
+    static Vertex null_vertex() { return std::numeric_limits<Vertex>::max(); }
+
+private:
+    struct csr_storage
+    {
+        std::vector<size_t> out_pos;
+        std::vector<size_t> in_pos;
+        std::vector<edge_entry_t> out_edges;
+        std::vector<edge_entry_t> in_edges;
+    };
+
+    size_t _N;
+    const size_t* _out_pos;
+    const size_t* _in_pos;
+    const edge_entry_t* _out_edges;
+    const edge_entry_t* _in_edges;
+    size_t _n_edges;
+    size_t _edge_index_range;
+    std::shared_ptr<const void> _storage;
+
+    // access functions
+    friend std::pair<vertex_iterator, vertex_iterator>
+    vertices<>(const csr_adj_list<Vertex>& g);
+
+    friend std::pair<edge_iterator, edge_iterator>
+    edges<>(const csr_adj_list<Vertex>& g);
+
+    friend std::pair<edge_descriptor, bool>
+    edge<>(Vertex s, Vertex t, const csr_adj_list<Vertex>& g);
+
+    friend size_t out_degree<>(Vertex v, const csr_adj_list<Vertex>& g);
+
+    friend size_t in_degree<>(Vertex v, const csr_adj_list<Vertex>& g);
+
+    friend std::pair<out_edge_iterator, out_edge_iterator>
+    out_edges<>(Vertex v, const csr_adj_list<Vertex>& g);
+
+    friend std::pair<in_edge_iterator, in_edge_iterator>
+    in_edges<>(Vertex v, const csr_adj_list<Vertex>& g);
+
+    friend std::pair<adjacency_iterator, adjacency_iterator>
+    out_neighbours<>(Vertex v, const csr_adj_list<Vertex>& g);
+
+    friend std::pair<adjacency_iterator, adjacency_iterator>
+    in_neighbours<>(Vertex v, const csr_adj_list<Vertex>& g);
+
+    friend size_t num_vertices<>(const csr_adj_list<Vertex>& g);
+
+    friend size_t num_edges<>(const csr_adj_list<Vertex>& g);
+};
+
+//========================================================================
+// Graph traits and BGL scaffolding
+//========================================================================
+
+template <class Vertex>
+struct graph_traits<csr_adj_list<Vertex> >
+{
+    typedef Vertex vertex_descriptor;
+    typedef typename csr_adj_list<Vertex>::edge_descriptor edge_descriptor;
+    typedef typename csr_adj_list<Vertex>::edge_iterator edge_iterator;
+    typedef typename csr_adj_list<Vertex>::adjacency_iterator adjacency_iterator;
+
+    typedef typename csr_adj_list<Vertex>::out_edge_iterator out_edge_iterator;
+    typedef typename csr_adj_list<Vertex>::in_edge_iterator in_edge_iterator;
+
+    typedef typename csr_adj_list<Vertex>::vertex_iterator vertex_iterator;
+
+    typedef bidirectional_tag directed_category;
+    typedef allow_parallel_edge_tag edge_parallel_category;
+    typedef adj_list_traversal_tag traversal_category;
+
+    typedef Vertex vertices_size_type;
+    typedef Vertex edges_size_type;
+    typedef size_t degree_size_type;
+
+    static Vertex null_vertex() { return csr_adj_list<Vertex>::null_vertex(); }
+};
+
+template <class Vertex>
+struct graph_traits<const csr_adj_list<Vertex> >
+    : public graph_traits<csr_adj_list<Vertex> >
+{
+};
+
+template <class Vertex>
+struct edge_property_type<csr_adj_list<Vertex> >
+{
+    typedef void type;
+};
+
+template <class Vertex>
+struct vertex_property_type<csr_adj_list<Vertex> >
+{
+    typedef void type;
+};
+
+template <class Vertex>
+struct graph_property_type<csr_adj_list<Vertex> >
+{
+    typedef void type;
+};
+
+//========================================================================
+// Graph access functions
+//========================================================================
+
+template <class Vertex>
+inline __attribute__((always_inline))
+std::pair<typename csr_adj_list<Vertex>::vertex_iterator,
+          typename csr_adj_list<Vertex>::vertex_iterator>
+vertices(const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::vertex_iterator vi_t;
+    return std::make_pair(vi_t(0), vi_t(g._N));
+}
+
+template <class Vertex>
+inline
+std::pair<typename csr_adj_list<Vertex>::edge_iterator,
+          typename csr_adj_list<Vertex>::edge_iterator>
+edges(const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::edge_iterator ei_t;
+    return std::make_pair(ei_t(&g, 0, 0), ei_t(&g, g._N, g._out_pos[g._N]));
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+Vertex vertex(size_t i, const csr_adj_list<Vertex>&)
+{
+    return i;
+}
+
+template <class Vertex>
+inline
+std::pair<typename csr_adj_list<Vertex>::edge_descriptor, bool>
+edge(Vertex s, Vertex t, const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::edge_descriptor edge_descriptor;
+    auto begin = g._out_edges + g._out_pos[s];
+    auto end = g._out_edges + g._out_pos[s + 1];
+    auto iter = std::find_if(begin, end,
+                             [&](const auto& e) -> bool {return e.first == t;});
+    if (iter != end)
+        return std::make_pair(edge_descriptor(s, t, iter->second, false),
+                              true);
+    Vertex v = graph_traits<csr_adj_list<Vertex> >::null_vertex();
+    return std::make_pair(edge_descriptor(v, v, v, false), false);
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t out_degree(Vertex v, const csr_adj_list<Vertex>& g)
+{
+    return g._out_pos[v + 1] - g._out_pos[v];
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t in_degree(Vertex v, const csr_adj_list<Vertex>& g)
+{
+    return g._in_pos[v + 1] - g._in_pos[v];
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t degree(Vertex v, const csr_adj_list<Vertex>& g)
+{
+    return in_degree(v, g) + out_degree(v, g);
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+std::pair<typename csr_adj_list<Vertex>::out_edge_iterator,
+          typename csr_adj_list<Vertex>::out_edge_iterator>
+out_edges(Vertex v, const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::out_edge_iterator ei_t;
+    auto begin = g._out_edges;
+    return std::make_pair(ei_t(v, begin + g._out_pos[v]),
+                          ei_t(v, begin + g._out_pos[v + 1]));
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+std::pair<typename csr_adj_list<Vertex>::in_edge_iterator,
+          typename csr_adj_list<Vertex>::in_edge_iterator>
+in_edges(Vertex v, const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::in_edge_iterator ei_t;
+    auto begin = g._in_edges;
+    return std::make_pair(ei_t(v, begin + g._in_pos[v]),
+                          ei_t(v, begin + g._in_pos[v + 1]));
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+std::pair<typename csr_adj_list<Vertex>::adjacency_iterator,
+          typename csr_adj_list<Vertex>::adjacency_iterator>
+out_neighbours(Vertex v, const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::adjacency_iterator ai_t;
+    auto begin = g._out_edges;
+    return std::make_pair(ai_t(begin + g._out_pos[v]),
+                          ai_t(begin + g._out_pos[v + 1]));
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+std::pair<typename csr_adj_list<Vertex>::adjacency_iterator,
+          typename csr_adj_list<Vertex>::adjacency_iterator>
+in_neighbours(Vertex v, const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::adjacency_iterator ai_t;
+    auto begin = g._in_edges;
+    return std::make_pair(ai_t(begin + g._in_pos[v]),
+                          ai_t(begin + g._in_pos[v + 1]));
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+std::pair<typename csr_adj_list<Vertex>::adjacency_iterator,
+          typename csr_adj_list<Vertex>::adjacency_iterator>
+adjacent_vertices(Vertex v, const csr_adj_list<Vertex>& g)
+{
+    return out_neighbours(v, g);
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t num_vertices(const csr_adj_list<Vertex>& g)
+{
+    return g._N;
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t num_edges(const csr_adj_list<Vertex>& g)
+{
+    return g._n_edges;
+}
+
+template <class Vertex>
+inline
+Vertex source(const typename csr_adj_list<Vertex>::edge_descriptor& e,
+              const csr_adj_list<Vertex>&)
+{
+    return e.s;
+}
+
+template <class Vertex>
+inline
+Vertex target(const typename csr_adj_list<Vertex>::edge_descriptor& e,
+              const csr_adj_list<Vertex>&)
+{
+    return e.t;
+}
+
+//========================================================================
+// Vertex and edge index property maps
+//========================================================================
+
+template <class Vertex>
+struct property_map<csr_adj_list<Vertex>, vertex_index_t>
+{
+    typedef identity_property_map type;
+    typedef type const_type;
+};
+
+template <class Vertex>
+struct property_map<const csr_adj_list<Vertex>, vertex_index_t>
+{
+    typedef identity_property_map type;
+    typedef type const_type;
+};
+
+template <class Vertex>
+inline identity_property_map
+get(vertex_index_t, csr_adj_list<Vertex>&)
+{
+    return identity_property_map();
+}
+
+template <class Vertex>
+inline identity_property_map
+get(vertex_index_t, const csr_adj_list<Vertex>&)
+{
+    return identity_property_map();
+}
+
+template <class Vertex>
+struct property_map<csr_adj_list<Vertex>, edge_index_t>
+{
+    typedef adj_edge_index_property_map<Vertex> type;
+    typedef type const_type;
+};
+
+template <class Vertex>
+inline adj_edge_index_property_map<Vertex>
+get(edge_index_t, const csr_adj_list<Vertex>&)
+{
+    return adj_edge_index_property_map<Vertex>();
+}
+
+} // namespace boost
+
+#endif //GRAPH_CSR_HH
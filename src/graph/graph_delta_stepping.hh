@@ -0,0 +1,323 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2016 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_DELTA_STEPPING_HH
+#define GRAPH_DELTA_STEPPING_HH
+
+#include <vector>
+#include <atomic>
+#include <limits>
+#include <cmath>
+
+#include "graph_selectors.hh"
+#include "graph_util.hh"
+#include "graph_exceptions.hh"
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
+namespace graph_tool
+{
+
+// Single-source shortest paths with non-negative weights, using the
+// delta-stepping algorithm of U. Meyer, P. Sanders, "Delta-stepping: a
+// parallelizable shortest path algorithm", J. Algorithms 49, 114 (2003).
+//
+// Tentative distances are kept in buckets of width delta, and the vertices in
+// the lowest non-empty bucket are processed in parallel phases, until it
+// empties. As in the original algorithm, only the "light" edges (with weight
+// not larger than delta), which may insert vertices back into the same bucket,
+// are relaxed in these phases; the "heavy" edges of all the vertices removed
+// from the bucket are relaxed once, after it empties. Since tentative
+// distances never exceed the current bucket by more than the largest weight,
+// only ceil(w_max / delta) + 2 buckets are needed at any time, and they are
+// kept in a circular array, regardless of the range of the distances. Buckets
+// are kept per thread, and merged only when they are about to be processed.
+// Distances are updated with a compare-and-swap, and each vertex keeps a small
+// lock so that its predecessor always corresponds to its final distance.
+//
+// Only the vertices with a distance not larger than max_dist are labelled.
+// Every time a bucket is finished, stop(settled) is called, where settled(v)
+// returns true if the distance of v is already final, and the search ends if
+// it returns true.
+//
+// If delta is zero, the value w_max / <k> is used, where w_max is the largest
+// edge weight, and <k> is the average out-degree, as suggested by Meyer and
+// Sanders. Negative values of delta are invalid. When called inside a
+// parallel region, the search runs serially.
+
+template <class Dist>
+struct delta_stepping_supported
+{
+    // distances are kept in lock-free atomics
+    static constexpr bool value = std::is_arithmetic<Dist>::value &&
+        sizeof(Dist) <= sizeof(uint64_t);
+};
+
+template <class Graph, class DistMap, class PredMap, class WeightMap,
+          class Stop>
+void delta_stepping(const Graph& g,
+                    typename boost::graph_traits<Graph>::vertex_descriptor s,
+                    DistMap dist_map, PredMap pred_map, WeightMap weight,
+                    double delta,
+                    typename boost::property_traits<DistMap>::value_type max_dist,
+                    Stop&& stop)
+{
+    typedef typename boost::graph_traits<Graph>::vertex_descriptor vertex_t;
+    typedef typename boost::property_traits<DistMap>::value_type dist_t;
+    static_assert(delta_stepping_supported<dist_t>::value,
+                  "unsupported distance type");
+
+    if (!(delta >= 0) || std::isinf(delta))
+        throw ValueException("The bucket width of the delta-stepping search "
+                             "must be positive and finite.");
+
+    dist_t inf = std::is_floating_point<dist_t>::value ?
+        std::numeric_limits<dist_t>::infinity() :
+        std::numeric_limits<dist_t>::max();
+    const size_t null_bin = std::numeric_limits<size_t>::max();
+
+    size_t N = num_vertices(g);
+
+    bool parallel = N > OPENMP_MIN_THRESH;
+#ifdef USING_OPENMP
+    if (omp_in_parallel())
+        parallel = false;
+#endif
+
+    std::vector<std::atomic<dist_t>> dist(N);
+    std::vector<std::atomic_flag> lock(N);
+    std::vector<std::atomic<size_t>> removed(N); // last bucket of removal
+    #pragma omp parallel for schedule(static) if (parallel)
+    for (size_t i = 0; i < N; ++i)
+    {
+        dist[i].store(inf, std::memory_order_relaxed);
+        lock[i].clear();
+        removed[i].store(null_bin, std::memory_order_relaxed);
+    }
+
+    double w_max = 0;
+    size_t E = 0, V = 0;
+    bool negative = false;
+    #pragma omp parallel for schedule(runtime) if (parallel) \
+        reduction(max:w_max) reduction(+:E, V) reduction(||:negative)
+    for (size_t i = 0; i < N; ++i)
+    {
+        auto v = vertex(i, g);
+        if (!is_valid_vertex(v, g))
+            continue;
+        for (const auto& e : out_edges_range(v, g))
+        {
+            double w = get(weight, e);
+            w_max = std::max(w_max, w);
+            negative = negative || w < 0;
+            ++E;
+        }
+        ++V;
+    }
+    if (negative)
+        throw ValueException("Negative edge weights are not supported "
+                             "by the delta-stepping search.");
+
+    if (delta == 0)
+        delta = (E > 0 && w_max > 0) ? w_max / (double(E) / V) : 1.;
+    if (std::is_integral<dist_t>::value)
+        delta = std::max(std::ceil(delta), 1.);
+
+    auto get_bin = [&](dist_t d) { return size_t(d / delta); };
+
+    // circular array of buckets: the tentative distances lie in the buckets
+    // [curr, curr + n_bins - 1], where curr is the bucket being processed
+    size_t n_bins = size_t(std::ceil(w_max / delta)) + 2;
+
+#ifdef USING_OPENMP
+    size_t n_threads = parallel ? omp_get_max_threads() : 1;
+#else
+    size_t n_threads = 1;
+#endif
+    std::vector<std::vector<std::vector<vertex_t>>>
+        bins(n_threads, std::vector<std::vector<vertex_t>>(n_bins));
+
+    auto get_lbins = [&]() -> auto&
+        {
+#ifdef USING_OPENMP
+            return bins[parallel ? omp_get_thread_num() : 0];
+#else
+            return bins[0];
+#endif
+        };
+
+    auto relax = [&](auto u, dist_t d_u, const auto& e, auto& lbins)
+        {
+            dist_t nd = d_u + get(weight, e);
+            if (nd > max_dist)
+                return;
+
+            auto v = target(e, g);
+            dist_t d_v = dist[v].load(std::memory_order_relaxed);
+            bool relaxed = false;
+            while (nd < d_v)
+            {
+                if (dist[v].compare_exchange_weak
+                    (d_v, nd, std::memory_order_relaxed))
+                {
+                    relaxed = true;
+                    break;
+                }
+            }
+            if (!relaxed)
+                return;
+
+            // distances decrease strictly, hence only the last successful
+            // update will find its own value here
+            while (lock[v].test_and_set(std::memory_order_acquire));
+            if (dist[v].load(std::memory_order_relaxed) == nd)
+                pred_map[v] = u;
+            lock[v].clear(std::memory_order_release);
+
+            lbins[get_bin(nd) % n_bins].push_back(v);
+        };
+
+    // vertices in the current bucket, and those removed from it
+    std::vector<vertex_t> frontier = {s}, removed_list;
+    dist[s] = 0;
+    size_t curr = 0;
+
+    while (true)
+    {
+        removed_list.clear();
+
+        // light edges, until the bucket is empty
+        while (!frontier.empty())
+        {
+            #pragma omp parallel if (parallel)
+            {
+                auto& lbins = get_lbins();
+                std::vector<vertex_t> lremoved;
+
+                #pragma omp for schedule(runtime)
+                for (size_t i = 0; i < frontier.size(); ++i)
+                {
+                    auto u = frontier[i];
+                    dist_t d_u = dist[u].load(std::memory_order_relaxed);
+
+                    // u was settled in a previous bucket
+                    if (get_bin(d_u) < curr)
+                        continue;
+
+                    if (removed[u].exchange(curr, std::memory_order_relaxed)
+                        != curr)
+                        lremoved.push_back(u);
+
+                    for (const auto& e : out_edges_range(u, g))
+                    {
+                        if (get(weight, e) <= delta)
+                            relax(u, d_u, e, lbins);
+                    }
+                }
+
+                #pragma omp critical (delta_stepping_removed)
+                removed_list.insert(removed_list.end(), lremoved.begin(),
+                                    lremoved.end());
+            }
+
+            frontier.clear();
+            for (auto& lbins : bins)
+            {
+                auto& b = lbins[curr % n_bins];
+                frontier.insert(frontier.end(), b.begin(), b.end());
+                b.clear();
+            }
+        }
+
+        // heavy edges, once for each removed vertex, at its final distance
+        #pragma omp parallel if (parallel)
+        {
+            auto& lbins = get_lbins();
+
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < removed_list.size(); ++i)
+            {
+                auto u = removed_list[i];
+                dist_t d_u = dist[u].load(std::memory_order_relaxed);
+                for (const auto& e : out_edges_range(u, g))
+                {
+                    if (get(weight, e) > delta)
+                        relax(u, d_u, e, lbins);
+                }
+            }
+        }
+
+        size_t next = null_bin;
+        for (size_t k = 1; k < n_bins && next == null_bin; ++k)
+        {
+            for (auto& lbins : bins)
+            {
+                if (!lbins[(curr + k) % n_bins].empty())
+                {
+                    next = curr + k;
+                    break;
+                }
+            }
+        }
+
+        if (next == null_bin)
+            break;
+
+        auto settled = [&](auto v)
+            {
+                dist_t d = dist[v].load(std::memory_order_relaxed);
+                return d != inf && get_bin(d) < next;
+            };
+        if (stop(settled))
+            break;
+
+        frontier.clear();
+        for (auto& lbins : bins)
+        {
+            auto& b = lbins[next % n_bins];
+            frontier.insert(frontier.end(), b.begin(), b.end());
+            b.clear();
+        }
+        curr = next;
+    }
+
+    #pragma omp parallel for schedule(static) if (parallel)
+    for (size_t i = 0; i < N; ++i)
+    {
+        auto v = vertex(i, g);
+        if (!is_valid_vertex(v, g))
+            continue;
+        dist_map[v] = dist[i].load(std::memory_order_relaxed);
+    }
+}
+
+template <class Graph, class DistMap, class PredMap, class WeightMap>
+void delta_stepping(const Graph& g,
+                    typename boost::graph_traits<Graph>::vertex_descriptor s,
+                    DistMap dist_map, PredMap pred_map, WeightMap weight,
+                    double delta,
+                    typename boost::property_traits<DistMap>::value_type max_dist)
+{
+    delta_stepping(g, s, dist_map, pred_map, weight, delta, max_dist,
+                   [](auto&&) { return false; });
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_DELTA_STEPPING_HH
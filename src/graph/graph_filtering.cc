@@ -129,6 +129,7 @@ check_filtered(const Graph& g, const EdgeFilter& edge_filter,
 // gets the correct graph view at run time
 boost::any GraphInterface::get_graph_view() const
 {
+    _mg->materialize();
     boost::any graph =
         check_filtered(*_mg, _edge_filter_map, _edge_filter_invert,
                        _edge_filter_active, _mg->get_edge_index_range(),
@@ -139,6 +140,49 @@ boost::any GraphInterface::get_graph_view() const
     return graph;
 }
 
+// this will retrieve a view of the CSR snapshot stored in frozen_views, or
+// store one if non-existent
+template <class Graph>
+std::shared_ptr<Graph> retrieve_frozen_view(GraphInterface& gi, Graph& init)
+{
+    size_t index = boost::mpl::find<frozen_graph_views, Graph>::type::pos::value;
+    auto& frozen_views = gi.get_frozen_views();
+    if (index >= frozen_views.size())
+        frozen_views.resize(index + 1);
+    boost::any& gview = frozen_views[index];
+    std::shared_ptr<Graph>* gptr = boost::any_cast<std::shared_ptr<Graph>>(&gview);
+    if (gptr == 0)
+    {
+        std::shared_ptr<Graph> new_g = std::make_shared<Graph>(init);
+        gview = new_g;
+        return new_g;
+    }
+    return *gptr;
+}
+
+// gets the view of the CSR snapshot at run time, if it exists and is still
+// valid, and the graph is not filtered; otherwise an empty object is returned
+boost::any GraphInterface::get_frozen_view() const
+{
+    if (!is_frozen() || _vertex_filter_active || _edge_filter_active)
+        return boost::any();
+
+    auto& gi = const_cast<GraphInterface&>(*this);
+    if (!_directed)
+    {
+        UndirectedAdaptor<csr_graph_t> ug(*_csr);
+        return std::ref(*retrieve_frozen_view(gi, ug));
+    }
+
+    if (_reversed)
+    {
+        reverse_graph<csr_graph_t> rg(*_csr);
+        return std::ref(*retrieve_frozen_view(gi, rg));
+    }
+
+    return std::ref(*_csr);
+}
+
 // these test whether or not the vertex and edge filters are active
 bool GraphInterface::is_vertex_filter_active() const
 { return _vertex_filter_active; }
@@ -151,7 +195,7 @@ bool GraphInterface::is_edge_filter_active() const
 // found
 void GraphInterface::re_index_edges()
 {
-    _mg->reindex_edges();
+    get_graph().reindex_edges();
 }
 
 // this will definitively remove all the edges from the graph, which are being
@@ -161,6 +205,7 @@ void GraphInterface::purge_edges()
     if (!is_edge_filter_active())
         return;
 
+    _mg->materialize();
     MaskFilter<edge_filter_t> filter(_edge_filter_map, _edge_filter_invert);
     vector<graph_traits<multigraph_t>::edge_descriptor> deleted_edges;
     for (auto v : vertices_range(*_mg))
@@ -182,6 +227,7 @@ void GraphInterface::purge_vertices(boost::any aold_index)
     if (!is_vertex_filter_active())
         return;
 
+    _mg->materialize();
     typedef vprop_map_t<int32_t>::type index_prop_t;
     index_prop_t old_index = any_cast<index_prop_t>(aold_index);
 
@@ -44,6 +44,9 @@
 #include <boost/mpl/quote.hpp>
 #include <boost/mpl/range_c.hpp>
 #include <boost/mpl/print.hpp>
+#include <boost/mpl/contains.hpp>
+#include <boost/mpl/remove_if.hpp>
+#include <boost/mpl/copy.hpp>
 
 #include "graph_adaptor.hh"
 #include "graph_selectors.hh"
@@ -72,6 +75,14 @@ namespace graph_tool
 //
 // The total number of graph views is then: 1 + 1 + 2 + 2 = 6
 //
+// Additionally, if an immutable CSR snapshot of the graph was created with
+// GraphInterface::freeze(), the unfiltered views above (original, reversed and
+// undirected) can be replaced by equivalent views of the snapshot. Since this
+// increases the number of instantiations, it is only done for algorithms which
+// explicitly request it, by using a view sequence extended with
+// with_frozen_views<> (e.g. all_graph_views_frozen below). The snapshot is
+// used only if it is still valid, and no filtering is active.
+//
 // The specific specialization can be called at run time (and generated at
 // compile time) with the run_action() function, which takes as arguments the
 // GraphInterface worked on, and the template functor to be specialized, which
@@ -356,6 +367,74 @@ struct never_filtered_never_reversed:
                                boost::mpl::bool_<false>,boost::mpl::bool_<false>,
                                boost::mpl::bool_<true>,boost::mpl::bool_<true> >::type {};
 
+// metafunction to get the view of the CSR snapshot which corresponds to a given
+// graph view, or void if there is none (i.e. filtered graphs)
+template <class Graph>
+struct graph_freeze
+{
+    typedef void type;
+};
+
+template <>
+struct graph_freeze<GraphInterface::multigraph_t>
+{
+    typedef GraphInterface::csr_graph_t type;
+};
+
+template <>
+struct graph_freeze<boost::reverse_graph<GraphInterface::multigraph_t>>
+{
+    typedef boost::reverse_graph<GraphInterface::csr_graph_t> type;
+};
+
+template <>
+struct graph_freeze<boost::UndirectedAdaptor<GraphInterface::multigraph_t>>
+{
+    typedef boost::UndirectedAdaptor<GraphInterface::csr_graph_t> type;
+};
+
+// this metafunction extends a sequence of graph views with the corresponding
+// views of the CSR snapshot
+template <class GraphViews>
+struct with_frozen_views
+{
+    typedef typename boost::mpl::transform<GraphViews,
+                                           graph_freeze<boost::mpl::_1>>::type
+        frozen_t;
+    typedef typename boost::mpl::remove_if<frozen_t,
+                                           std::is_void<boost::mpl::_1>>::type
+        frozen_views_t;
+    typedef typename boost::mpl::copy<frozen_views_t,
+                                      boost::mpl::back_inserter<GraphViews>>::type
+        type;
+};
+
+// returns true if the sequence contains any view of the CSR snapshot
+template <class GraphViews>
+struct has_frozen_views
+{
+    typedef typename boost::mpl::or_<
+        typename boost::mpl::contains<GraphViews,
+                                      GraphInterface::csr_graph_t>::type,
+        typename boost::mpl::contains<GraphViews,
+                                      boost::reverse_graph<GraphInterface::csr_graph_t>>::type,
+        typename boost::mpl::contains<GraphViews,
+                                      boost::UndirectedAdaptor<GraphInterface::csr_graph_t>>::type>::type
+        type;
+};
+
+// all the possible views of the CSR snapshot
+struct frozen_graph_views:
+    boost::mpl::vector<GraphInterface::csr_graph_t,
+                       boost::reverse_graph<GraphInterface::csr_graph_t>,
+                       boost::UndirectedAdaptor<GraphInterface::csr_graph_t>> {};
+
+struct all_graph_views_frozen:
+    with_frozen_views<all_graph_views>::type {};
+
+struct never_directed_frozen:
+    with_frozen_views<never_directed>::type {};
+
 // sanity check
 typedef boost::mpl::size<all_graph_views>::type n_views;
 #ifndef NO_GRAPH_FILTERING
@@ -435,6 +514,21 @@ struct action_wrap
     Action _a;
 };
 
+// gets the view which will be used for dispatching; if the sequence supports
+// it, this will be the view of the CSR snapshot, if it is available
+inline boost::any get_dispatch_view(GraphInterface& gi, std::true_type)
+{
+    boost::any gview = gi.get_frozen_view();
+    if (gview.empty())
+        gview = gi.get_graph_view();
+    return gview;
+}
+
+inline boost::any get_dispatch_view(GraphInterface& gi, std::false_type)
+{
+    return gi.get_graph_view();
+}
+
 // this takes a functor and type ranges and iterates through the type
 // combinations when called with boost::any parameters, and calls the correct
 // function
@@ -468,7 +562,13 @@ struct run_action
     auto operator()(GraphInterface& gi, Action a, TRS...)
     {
         auto dispatch = detail::action_dispatch<Action,Wrap,GraphViews,TRS...>(a);
-        auto wrap = [dispatch, &gi](auto&&... args) { dispatch(gi.get_graph_view(), args...); };
+        typedef std::integral_constant
+            <bool, detail::has_frozen_views<GraphViews>::type::value> frozen_t;
+        auto wrap = [dispatch, &gi](auto&&... args)
+            {
+                dispatch(detail::get_dispatch_view(gi, frozen_t()),
+                         args...);
+            };
         return wrap;
     }
 };
@@ -491,6 +591,8 @@ typedef detail::never_reversed never_reversed;
 typedef detail::always_directed_never_reversed always_directed_never_reversed;
 typedef detail::never_filtered never_filtered;
 typedef detail::never_filtered_never_reversed never_filtered_never_reversed;
+typedef detail::all_graph_views_frozen all_graph_views_frozen;
+typedef detail::never_directed_frozen never_directed_frozen;
 
 // returns true if graph filtering was enabled at compile time
 bool graph_filtering_enabled();
@@ -92,6 +92,7 @@ std::ostringstream& operator<<(std::ostringstream& stream, const boost::python::
 #include <boost/graph/graphviz.hpp>
 
 #include "graph_io_binary.hh"
+#include "graph_io_edges.hh"
 
 // the following source & sink provide iostream access to python file-like
 // objects
@@ -390,6 +391,7 @@ boost::python::tuple GraphInterface::read_from_file(string file,
             map_creator(_vertex_index, _edge_index);
         dynamic_properties dp(map_creator);
         *_mg = multigraph_t();
+        unfreeze();
 
         if (format == "dot")
             _directed = read_graphviz(stream, *_mg, dp, "vertex_name", true,
@@ -405,9 +407,37 @@ boost::python::tuple GraphInterface::read_from_file(string file,
         if (format == "gt")
         {
             vector<pair<string, boost::any>> agprops, avprops, aeprops;
-            stream.exceptions(ios_base::badbit | ios_base::failbit | ios_base::eofbit);
-            _directed = read_graph(stream, *_mg, agprops, avprops, aeprops, igp,
-                                   ivp, iep);
+            std::shared_ptr<csr_graph_t> csr;
+
+            // files in the version 2 layout are memory-mapped, instead of
+            // being read through the stream
+            std::shared_ptr<char> data;
+            size_t size = 0;
+            if (file != "-" && pfile == boost::python::object())
+                data = map_graph_file(file, size);
+
+            if (data != nullptr)
+            {
+                _directed = read_graph_mapped(data, size, *_mg, csr, agprops,
+                                              avprops, aeprops, igp, ivp, iep);
+            }
+            else
+            {
+                stream.exceptions(ios_base::badbit | ios_base::failbit |
+                                  ios_base::eofbit);
+                _directed = read_graph(stream, *_mg, agprops, avprops, aeprops,
+                                       igp, ivp, iep, &csr);
+            }
+
+            // the graph is left frozen, with a snapshot which refers directly
+            // to the file contents; the adjacency list is only built when
+            // first needed
+            if (csr != nullptr)
+            {
+                _csr = csr;
+                _csr_mod_count = _mg->get_mod_count();
+            }
+
             for (auto& p : agprops)
                 gprops[p.first] = find_property_map(p.second, _graph_index);
             for (auto& p : avprops)
@@ -446,6 +476,809 @@ boost::python::tuple GraphInterface::read_from_file(string file,
     }
 };
 
+//==============================================================================
+// read_graph_edges(stream, f)
+//==============================================================================
+
+// The sizes stored in the stream are not trusted: the arrays are read in
+// blocks, so that the memory allocated grows only with the data actually
+// present, and the stream is checked after every read.
+
+namespace graph_tool
+{
+
+template <bool BE, class T>
+void read_edges_block(std::istream& s, std::vector<T>& v, uint64_t n)
+{
+    const uint64_t block = uint64_t(1) << 16;
+    v.clear();
+    while (n > 0)
+    {
+        size_t m = std::min(n, block);
+        size_t pos = v.size();
+        v.resize(pos + m);
+        s.read(reinterpret_cast<char*>(v.data() + pos), m * sizeof(T));
+        if (!s)
+            throw IOException("error reading graph: unexpected end of file");
+        for (size_t i = pos; i < v.size(); ++i)
+            byte_swap<BE>(v[i]);
+        n -= m;
+    }
+}
+
+template <bool BE, class Vint>
+void read_edges_dispatch(std::istream& s, size_t N,
+                         const std::function<void(size_t, size_t)>& f)
+{
+    std::vector<Vint> us;
+    for (size_t v = 0; v < N; ++v)
+    {
+        uint64_t k = 0;
+        read<BE>(s, k);
+        if (!s)
+            throw IOException("error reading graph: unexpected end of file");
+        read_edges_block<BE>(s, us, k);
+        for (Vint u : us)
+        {
+            if (u >= N)
+                throw IOException("error reading graph: vertex index not in range");
+            f(v, size_t(u));
+        }
+    }
+}
+
+template <bool BE>
+bool read_edges_mapped_dispatch(std::istream& s, size_t offset, uint64_t& N,
+                                const std::function<void(size_t, size_t)>& f)
+{
+    // the version 2 layout is read sequentially, keeping track of the
+    // 8-byte alignment relative to the beginning of the file
+    auto align = [&]()
+        {
+            size_t r = offset % 8;
+            if (r > 0)
+            {
+                s.ignore(8 - r);
+                offset += 8 - r;
+            }
+        };
+
+    align();
+    uint8_t directed = false;
+    read<BE>(s, directed);
+    offset += sizeof(directed);
+    align();
+
+    uint64_t E = 0;
+    read<BE>(s, N);
+    read<BE>(s, E);
+    if (!s)
+        throw IOException("error reading graph: unexpected end of file");
+
+    // every edge takes 16 bytes, so that no valid stream has more edges, nor
+    // vertices, than can be addressed
+    if (N >= numeric_limits<uint64_t>::max() / sizeof(uint64_t) ||
+        E >= numeric_limits<uint64_t>::max() / (2 * sizeof(uint64_t)))
+        throw IOException("error reading graph: invalid adjacency");
+
+    std::vector<uint64_t> pos;
+    read_edges_block<BE>(s, pos, N + 1);
+    if (pos[0] != 0 || pos[N] != E)
+        throw IOException("error reading graph: invalid adjacency");
+
+    std::vector<uint64_t> es;
+    size_t v = 0;
+    for (size_t i = 0; i < E;)
+    {
+        size_t n = std::min(E - i, uint64_t(1) << 16);
+        read_edges_block<BE>(s, es, 2 * n);
+        for (size_t j = 0; j < n; ++j, ++i)
+        {
+            while (v < N && pos[v + 1] <= i)
+            {
+                if (pos[v + 1] < pos[v])
+                    throw IOException("error reading graph: invalid adjacency");
+                ++v;
+            }
+            uint64_t u = es[2 * j];
+            if (u >= N || v >= N)
+                throw IOException("error reading graph: vertex index not in range");
+            f(v, size_t(u));
+        }
+    }
+    return directed;
+}
+
+std::pair<size_t, bool>
+read_graph_edges(std::istream& s, const std::function<void(size_t, size_t)>& f)
+{
+    char magic[_magic_length];
+    s.read(magic, _magic_length);
+    if (!s || strncmp(magic, _magic, _magic_length) != 0)
+        throw IOException("Error reading graph: Invalid magic number");
+    uint8_t version = 0;
+    read<false>(s, version);
+    if (version != _version && version != _version_csr)
+        throw IOException("Error reading graph: Invalid format version " +
+                          boost::lexical_cast<std::string>(version));
+    uint8_t big_end = 0;
+    read<false>(s, big_end);
+
+    // the comment is not needed, only its length
+    uint64_t comment_size = 0;
+    read<false>(s, comment_size);
+    s.ignore(comment_size);
+    if (!s)
+        throw IOException("error reading graph: unexpected end of file");
+
+    uint64_t N = 0;
+    bool directed;
+    if (version == _version_csr)
+    {
+        size_t offset = _magic_length + 2 + sizeof(uint64_t) + comment_size;
+        if (big_end)
+            directed = read_edges_mapped_dispatch<true>(s, offset, N, f);
+        else
+            directed = read_edges_mapped_dispatch<false>(s, offset, N, f);
+        return std::make_pair(size_t(N), directed);
+    }
+
+    uint8_t udirected = false;
+    if (big_end)
+    {
+        read<true>(s, udirected);
+        read<true>(s, N);
+    }
+    else
+    {
+        read<false>(s, udirected);
+        read<false>(s, N);
+    }
+    if (!s)
+        throw IOException("error reading graph: unexpected end of file");
+
+    auto dispatch = [&](auto vint)
+        {
+            typedef decltype(vint) vint_t;
+            if (big_end)
+                read_edges_dispatch<true, vint_t>(s, N, f);
+            else
+                read_edges_dispatch<false, vint_t>(s, N, f);
+        };
+
+    if (N <= numeric_limits<uint8_t>::max())
+        dispatch(uint8_t());
+    else if (N <= numeric_limits<uint16_t>::max())
+        dispatch(uint16_t());
+    else if (N <= numeric_limits<uint32_t>::max())
+        dispatch(uint32_t());
+    else
+        dispatch(uint64_t());
+
+    return std::make_pair(size_t(N), bool(udirected));
+}
+
+} // namespace graph_tool
+
+//==============================================================================
+// read_from_csv(file, pfile, ...)
+//==============================================================================
+
+// The edge list is read in large blocks, which are cut at record boundaries
+// and split further into one chunk per thread. The chunks are parsed in
+// parallel, and the edges of each block are then inserted at once with
+// adj_list::add_edges().
+
+// Scans one record (i.e. a line, unless a line break appears inside a quoted
+// field) starting at "pos", and calls field(j) at the start of the j-th field
+// and push(c) for each of its characters, following the conventions of
+// Python's csv module: fields may be enclosed in quotes, in which case they
+// can contain delimiters and line breaks, and a doubled quote character
+// stands for a literal one. Returns the position just after the record, or
+// nullptr if it is not complete before "end".
+template <class Field, class Push>
+const char* scan_csv_record(const char* pos, const char* end, char delim,
+                            char quote, bool at_eof, Field&& field, Push&& push)
+{
+    size_t j = 0;
+    bool in_quote = false;
+    bool field_start = true;
+    field(j);
+    while (pos < end)
+    {
+        char c = *pos++;
+        if (in_quote)
+        {
+            if (c == quote)
+            {
+                if (pos == end && !at_eof)
+                    return nullptr;
+                if (pos < end && *pos == quote)
+                {
+                    push(quote);
+                    ++pos;
+                }
+                else
+                {
+                    in_quote = false;
+                }
+            }
+            else
+            {
+                push(c);
+            }
+            continue;
+        }
+
+        if (c == '\n')
+            return pos;
+        if (c == '\r')
+        {
+            if (pos == end && !at_eof)
+                return nullptr;
+            if (pos == end || *pos == '\n')
+                continue;
+        }
+
+        if (c == delim)
+        {
+            field(++j);
+            field_start = true;
+            continue;
+        }
+        if (c == quote && field_start)
+            in_quote = true;
+        else
+            push(c);
+        field_start = false;
+    }
+    return at_eof ? pos : nullptr;
+}
+
+// The record boundaries of a block with quotes depend on whether each position
+// lies inside a quoted field, which is only known after scanning everything
+// before it. The scanner of scan_csv_record() has only four states as far as
+// the boundaries are concerned, so a chunk of the block can be scanned
+// independently from each of them; the actual initial state of each chunk is
+// then found by chaining the final states of the previous ones.
+enum class csv_state : uint8_t
+{
+    field_start = 0, // at the start of a field
+    field = 1,       // inside an unquoted field
+    quoted = 2,      // inside a quoted field
+    quoted_end = 3   // after a quote inside a quoted field
+};
+
+inline csv_state csv_next_state(csv_state s, char c, char delim, char quote,
+                                bool& eol)
+{
+    eol = false;
+    switch (s)
+    {
+    case csv_state::quoted:
+        return (c == quote) ? csv_state::quoted_end : csv_state::quoted;
+    case csv_state::quoted_end:
+        if (c == quote)
+            return csv_state::quoted;  // doubled quote
+        s = csv_state::field;
+        break;
+    default:
+        break;
+    }
+    if (c == '\n')
+    {
+        eol = true;
+        return csv_state::field_start;
+    }
+    if (c == delim)
+        return csv_state::field_start;
+    if (c == quote && s == csv_state::field_start)
+        return csv_state::quoted;
+    return csv_state::field;
+}
+
+// result of scanning a chunk from each initial state
+struct csv_chunk_scan
+{
+    csv_state state[4];        // final states
+    size_t first[4], last[4];  // first and last record boundaries, if any
+};
+
+inline void scan_csv_chunk(const char* buf, size_t begin, size_t end,
+                           char delim, char quote, csv_chunk_scan& r)
+{
+    const size_t none = std::numeric_limits<size_t>::max();
+    csv_state* s = r.state;
+    for (size_t k = 0; k < 4; ++k)
+    {
+        s[k] = csv_state(k);
+        r.first[k] = r.last[k] = none;
+    }
+
+    // the four trajectories usually merge after a few fields, after which
+    // a single one is followed
+    bool eol;
+    size_t i = begin;
+    bool merged = false;
+    for (; i < end && !merged; ++i)
+    {
+        merged = true;
+        for (size_t k = 0; k < 4; ++k)
+        {
+            s[k] = csv_next_state(s[k], buf[i], delim, quote, eol);
+            if (eol)
+            {
+                if (r.first[k] == none)
+                    r.first[k] = i + 1;
+                r.last[k] = i + 1;
+            }
+            merged = merged && s[k] == s[0];
+        }
+    }
+    if (!merged)
+        return;
+
+    csv_state t = s[0];
+    size_t first = none, last = none;
+    for (; i < end; ++i)
+    {
+        t = csv_next_state(t, buf[i], delim, quote, eol);
+        if (eol)
+        {
+            if (first == none)
+                first = i + 1;
+            last = i + 1;
+        }
+    }
+    for (size_t k = 0; k < 4; ++k)
+    {
+        s[k] = t;
+        if (r.first[k] == none)
+            r.first[k] = first;
+        if (last != none)
+            r.last[k] = last;
+    }
+}
+
+// Returns the end of the last complete record in [0, len), and stores in
+// "split" the record boundaries closest to n_parts evenly spaced positions.
+size_t split_csv_block(const char* buf, size_t begin, size_t len, char delim,
+                       char quote, bool at_eof, size_t n_parts,
+                       vector<size_t>& split)
+{
+    split.assign(n_parts + 1, begin);
+    size_t end = begin;
+
+    if (memchr(buf + begin, quote, len - begin) == nullptr)
+    {
+        // without quotes, every line break is a record boundary
+        if (at_eof)
+        {
+            end = len;
+        }
+        else
+        {
+            const char* pos = static_cast<const char*>
+                (memrchr(buf + begin, '\n', len - begin));
+            if (pos != nullptr)
+                end = pos - buf + 1;
+        }
+        for (size_t p = 1; p < n_parts; ++p)
+        {
+            size_t x = std::max(begin + (p * (end - begin)) / n_parts,
+                                split[p - 1]);
+            const char* pos = static_cast<const char*>
+                (memchr(buf + x, '\n', end - x));
+            split[p] = (pos == nullptr) ? end : pos - buf + 1;
+        }
+    }
+    else if (n_parts > 1)
+    {
+        const size_t none = std::numeric_limits<size_t>::max();
+        vector<csv_chunk_scan> scans(n_parts);
+        auto chunk_begin = [&](size_t p)
+            {
+                return begin + (p * (len - begin)) / n_parts;
+            };
+        #pragma omp parallel for schedule(static, 1)
+        for (size_t p = 0; p < n_parts; ++p)
+            scan_csv_chunk(buf, chunk_begin(p), chunk_begin(p + 1), delim,
+                           quote, scans[p]);
+
+        // every record starts at a field, and the first chunk at a record
+        vector<size_t> first(n_parts);
+        csv_state s = csv_state::field_start;
+        for (size_t p = 0; p < n_parts; ++p)
+        {
+            size_t k = size_t(s);
+            first[p] = scans[p].first[k];
+            if (scans[p].last[k] != none)
+                end = scans[p].last[k];
+            s = scans[p].state[k];
+        }
+        if (at_eof)
+            end = len;
+
+        // each split point is the first record boundary after the beginning
+        // of its chunk
+        size_t next = end;
+        for (size_t p = n_parts - 1; p > 0; --p)
+        {
+            if (first[p] != none)
+                next = std::min(first[p], end);
+            split[p] = next;
+        }
+        for (size_t p = 1; p < n_parts; ++p)
+            split[p] = std::max(split[p], split[p - 1]);
+    }
+    else
+    {
+        auto nop = [](auto) {};
+        size_t p = 1;
+        const char* pos = buf + begin;
+        while (pos < buf + len)
+        {
+            pos = scan_csv_record(pos, buf + len, delim, quote, at_eof, nop,
+                                  nop);
+            if (pos == nullptr)
+                break;
+            end = pos - buf;
+            while (p < n_parts && end >= begin + (p * (len - begin)) / n_parts)
+                split[p++] = end;
+        }
+        for (; p < n_parts; ++p)
+            split[p] = end;
+    }
+    split[n_parts] = end;
+    return end;
+}
+
+// Vertex values are either used directly as indexes, or hashed (as integers
+// or strings) and replaced by ids in the order in which they are encountered.
+template <class Key, bool Hashed>
+struct csv_vertex_id
+{
+    static size_t get(const string& val, std::unordered_map<Key, size_t>& ids,
+                      vector<Key>& names)
+    {
+        Key key = lexical_cast<Key>(val);
+        auto iter = ids.find(key);
+        if (iter != ids.end())
+            return iter->second;
+        size_t i = names.size();
+        ids[key] = i;
+        names.push_back(key);
+        return i;
+    }
+};
+
+template <>
+struct csv_vertex_id<size_t, false>
+{
+    static size_t get(const string& val, std::unordered_map<size_t, size_t>&,
+                      vector<size_t>&)
+    {
+        // not lexical_cast<size_t>(), which would accept negative values
+        int64_t v = lexical_cast<int64_t>(val);
+        if (v < 0)
+            throw bad_lexical_cast();
+        return v;
+    }
+};
+
+// parsed contents of a chunk
+template <class Key>
+struct csv_chunk
+{
+    vector<size_t> source, target;  // vertex indexes, or local ids if hashed
+    vector<Key> names;              // values of the local ids
+    vector<string> props;           // n_props values per edge
+    string error;
+};
+
+template <class Key, bool Hashed>
+void read_csv_edge_list(std::istream& stream, GraphInterface::multigraph_t& g,
+                        char delim, char quote, bool skip_first,
+                        int64_t c_s, int64_t c_t,
+                        boost::python::object& get_eprops,
+                        boost::python::object& ovname)
+{
+    typedef GraphInterface::edge_t edge_t;
+    typedef GraphInterface::vertex_t vertex_t;
+
+    size_t n_parts = 1;
+#ifdef USING_OPENMP
+    n_parts = omp_get_max_threads();
+#endif
+    const size_t block_size = n_parts * (size_t(1) << 24);
+
+    vector<DynamicPropertyMapWrap<string, edge_t>> eprops;
+    bool parallel = true;
+    size_t n_props = 0;
+
+    DynamicPropertyMapWrap<Key, vertex_t> vname;
+    if (Hashed)
+        vname = DynamicPropertyMapWrap<Key, vertex_t>
+            (boost::python::extract<boost::any>(ovname)(),
+             writable_vertex_properties());
+    std::unordered_map<Key, size_t> vertices;
+
+    vector<csv_chunk<Key>> chunks(n_parts);
+    vector<size_t> split, offset(n_parts + 1);
+    vector<size_t> source, target;
+    vector<string> props;
+
+    string buf;
+    size_t len = 0;
+    bool at_eof = false;
+    bool first = true;
+    while (!at_eof)
+    {
+        if (buf.size() < len + block_size)
+            buf.resize(len + block_size);
+        stream.read(&buf[len], block_size);
+        size_t n = stream.gcount();
+        len += n;
+        at_eof = n < block_size;
+
+        const char* data = buf.data();
+        size_t begin = 0;
+
+        if (first)
+        {
+            // the number of property columns is given by the first line
+            vector<string> fields;
+            auto field = [&](size_t) { fields.emplace_back(); };
+            auto push = [&](char c) { fields.back().push_back(c); };
+            const char* pos = data;
+            const char* next = pos;
+            while (pos < data + len)
+            {
+                fields.clear();
+                next = scan_csv_record(pos, data + len, delim, quote, at_eof,
+                                       field, push);
+                if (next == nullptr)
+                    break;
+                if (skip_first)
+                {
+                    skip_first = false;
+                    pos = next;
+                    continue;
+                }
+                if (fields.size() > 1 || !fields[0].empty())
+                    break;
+                pos = next;
+            }
+
+            begin = pos - data;
+            if (next == nullptr)
+            {
+                // incomplete line; read more
+                buf.erase(0, begin);
+                len -= begin;
+                continue;
+            }
+
+            if (pos < data + len)
+            {
+                size_t n_cols = fields.size() - std::min(fields.size(),
+                                                         size_t(2));
+                boost::python::object aeprops = get_eprops(n_cols);
+                boost::python::stl_input_iterator<boost::any>
+                    piter(aeprops), pend;
+                for (; piter != pend; ++piter)
+                {
+                    boost::any aprop = *piter;
+                    // python objects cannot be created without the GIL
+                    if (aprop.type() ==
+                        typeid(eprop_map_t<boost::python::object>::type))
+                        parallel = false;
+                    eprops.emplace_back(aprop, writable_edge_properties());
+                }
+                n_props = eprops.size();
+                first = false;
+            }
+        }
+
+        size_t end = split_csv_block(data, begin, len, delim, quote, at_eof,
+                                     n_parts, split);
+
+        #pragma omp parallel for schedule(static, 1) if (n_parts > 1)
+        for (size_t p = 0; p < n_parts; ++p)
+        {
+            auto& chunk = chunks[p];
+            chunk.source.clear();
+            chunk.target.clear();
+            chunk.names.clear();
+            chunk.props.clear();
+            chunk.error.clear();
+
+            std::unordered_map<Key, size_t> local;
+            auto get_vertex = [&](const string& val) -> size_t
+                {
+                    return csv_vertex_id<Key, Hashed>::get(val, local,
+                                                           chunk.names);
+                };
+
+            vector<string> fields;
+            size_t n_fields = 0;
+            auto field = [&](size_t j)
+                {
+                    if (j >= fields.size())
+                        fields.emplace_back();
+                    fields[j].clear();
+                    n_fields = j + 1;
+                };
+            auto push = [&](char c) { fields[n_fields - 1].push_back(c); };
+
+            const char* pos = data + split[p];
+            const char* pend = data + split[p + 1];
+            while (pos < pend)
+            {
+                pos = scan_csv_record(pos, pend, delim, quote, true, field,
+                                      push);
+                if (n_fields == 1 && fields[0].empty())
+                    continue;  // empty line
+                // negative columns count from the end of the line, as with
+                // Python's indexing
+                int64_t j_s = (c_s < 0) ? c_s + int64_t(n_fields) : c_s;
+                int64_t j_t = (c_t < 0) ? c_t + int64_t(n_fields) : c_t;
+                if (j_s < 0 || j_t < 0 ||
+                    size_t(std::max(j_s, j_t)) >= n_fields)
+                {
+                    chunk.error = "line with only " +
+                        lexical_cast<string>(n_fields) + " column(s)";
+                    break;
+                }
+                try
+                {
+                    size_t s = get_vertex(fields[j_s]);
+                    size_t t = get_vertex(fields[j_t]);
+                    chunk.source.push_back(s);
+                    chunk.target.push_back(t);
+                }
+                catch (bad_lexical_cast&)
+                {
+                    chunk.error = "invalid vertex value: '" + fields[j_s] +
+                        "' -> '" + fields[j_t] + "'";
+                    break;
+                }
+                size_t j = 0;
+                for (size_t k = 0; k < n_fields && j < n_props; ++k)
+                {
+                    if (int64_t(k) == j_s || int64_t(k) == j_t)
+                        continue;
+                    chunk.props.push_back(std::move(fields[k]));
+                    ++j;
+                }
+                for (; j < n_props; ++j)
+                    chunk.props.emplace_back();
+            }
+        }
+
+        for (auto& chunk : chunks)
+            if (!chunk.error.empty())
+                throw IOException(chunk.error);
+
+        // The local ids of each chunk are mapped to vertices in chunk order,
+        // so that the result does not depend on the number of threads.
+        for (size_t p = 0; p < n_parts; ++p)
+        {
+            auto& chunk = chunks[p];
+            offset[p + 1] = offset[p] + chunk.source.size();
+            if (!Hashed)
+                continue;
+            vector<size_t> ids(chunk.names.size());
+            for (size_t i = 0; i < chunk.names.size(); ++i)
+            {
+                auto& key = chunk.names[i];
+                auto iter = vertices.find(key);
+                if (iter == vertices.end())
+                {
+                    auto v = add_vertex(g);
+                    vertices[key] = v;
+                    put(vname, v, key);
+                    ids[i] = v;
+                }
+                else
+                {
+                    ids[i] = iter->second;
+                }
+            }
+            for (auto& v : chunk.source)
+                v = ids[v];
+            for (auto& v : chunk.target)
+                v = ids[v];
+        }
+
+        size_t E = offset[n_parts];
+        source.resize(E);
+        target.resize(E);
+        props.resize(E * n_props);
+        #pragma omp parallel for schedule(static, 1) if (n_parts > 1)
+        for (size_t p = 0; p < n_parts; ++p)
+        {
+            auto& chunk = chunks[p];
+            std::copy(chunk.source.begin(), chunk.source.end(),
+                      source.begin() + offset[p]);
+            std::copy(chunk.target.begin(), chunk.target.end(),
+                      target.begin() + offset[p]);
+            std::move(chunk.props.begin(), chunk.props.end(),
+                      props.begin() + offset[p] * n_props);
+        }
+
+        g.add_edges(E,
+                    [&](size_t i) { return source[i]; },
+                    [&](size_t i) { return target[i]; },
+                    [&](size_t i, const edge_t& e)
+                    {
+                        for (size_t j = 0; j < n_props; ++j)
+                        {
+                            auto& val = props[i * n_props + j];
+                            if (val.empty())
+                                continue;
+                            try
+                            {
+                                put(eprops[j], e, val);
+                            }
+                            catch (bad_lexical_cast&)
+                            {
+                                throw ValueException("Invalid edge property value: " + val);
+                            }
+                        }
+                    }, parallel);
+
+        buf.erase(0, end);
+        len -= end;
+    }
+}
+
+void GraphInterface::read_from_csv(string file, boost::python::object pfile,
+                                   string delimiter, string quotechar,
+                                   bool skip_first, int64_t c_s, int64_t c_t,
+                                   bool string_vals, bool hashed,
+                                   boost::python::object get_eprops,
+                                   boost::python::object vname)
+{
+    if (delimiter.size() != 1 || quotechar.size() != 1)
+        throw ValueException("the delimiter and quote character must be "
+                             "single characters");
+    if (c_s == c_t)
+        throw ValueException("the source and target columns must be "
+                             "different");
+    try
+    {
+        boost::iostreams::filtering_stream<boost::iostreams::input>
+            stream;
+        std::ifstream file_stream;
+        build_stream(stream, file, pfile, file_stream);
+
+        char delim = delimiter[0];
+        char quote = quotechar[0];
+        _mg->materialize();
+        if (string_vals)
+            read_csv_edge_list<string, true>(stream, *_mg, delim, quote,
+                                             skip_first, c_s, c_t,
+                                             get_eprops, vname);
+        else if (hashed)
+            read_csv_edge_list<int64_t, true>(stream, *_mg, delim, quote,
+                                              skip_first, c_s, c_t,
+                                              get_eprops, vname);
+        else
+            read_csv_edge_list<size_t, false>(stream, *_mg, delim, quote,
+                                              skip_first, c_s, c_t,
+                                              get_eprops, vname);
+    }
+    catch (ios_base::failure &e)
+    {
+        throw IOException("error reading from file '" + file + "':" + e.what());
+    }
+    catch (IOException &e)
+    {
+        throw IOException("error reading from file '" + file + "': " + e.what());
+    }
+}
+
 template <class IndexMap>
 string graphviz_insert_index(dynamic_properties& dp, IndexMap index_map,
                              bool insert = true)
@@ -506,9 +1339,11 @@ struct do_write_to_binary_file
     void operator()(ostream& stream, Graph& g, IndexMap index_map, size_t N,
                     bool directed, vector<pair<string, boost::any >> & gprops,
                     vector<pair<string, boost::any >> & vprops,
-                    vector<pair<string, boost::any >> & eprops) const
+                    vector<pair<string, boost::any >> & eprops,
+                    bool mappable) const
     {
-        write_graph(g, index_map, N, directed, gprops, vprops, eprops, stream);
+        write_graph(g, index_map, N, directed, gprops, vprops, eprops, stream,
+                    mappable);
     }
 };
 
@@ -525,7 +1360,8 @@ struct generate_index
 };
 
 void GraphInterface::write_to_file(string file, boost::python::object pfile,
-                                   string format, boost::python::list props)
+                                   string format, boost::python::list props,
+                                   bool mappable)
 {
     if (format != "gt" && format != "xml" && format != "dot" && format != "gml")
         throw ValueException("error writing to file '" + file +
@@ -534,6 +1370,7 @@ void GraphInterface::write_to_file(string file, boost::python::object pfile,
     {
         boost::iostreams::filtering_stream<boost::iostreams::output> stream;
         std::ofstream file_stream;
+        bool gzip_blocks = false;
         if (file == "-")
             stream.push(std::cout);
         else
@@ -543,8 +1380,15 @@ void GraphInterface::write_to_file(string file, boost::python::object pfile,
                 file_stream.open(file.c_str(), std::ios_base::out |
                                  std::ios_base::binary);
                 file_stream.exceptions(ios_base::badbit | ios_base::failbit);
+                // the binary format is compressed in independent blocks, in
+                // parallel (see block_streambuf)
                 if (boost::ends_with(file,".gz"))
-                    stream.push(boost::iostreams::gzip_compressor());
+                {
+                    if (format == "gt")
+                        gzip_blocks = true;
+                    else
+                        stream.push(boost::iostreams::gzip_compressor());
+                }
                 if (boost::ends_with(file,".bz2"))
                     stream.push(boost::iostreams::bzip2_compressor());
                 stream.push(file_stream);
@@ -579,6 +1423,11 @@ void GraphInterface::write_to_file(string file, boost::python::object pfile,
             bool directed = _directed;
             _directed = true;
 
+            // the output is passed on in large blocks
+            block_streambuf buf(stream.rdbuf(), gzip_blocks);
+            std::ostream bstream(&buf);
+            bstream.exceptions(ios_base::badbit | ios_base::failbit);
+
             if (is_vertex_filter_active())
             {
                 // vertex indexes must be between the [0, HardNumVertices(g)] range
@@ -587,27 +1436,30 @@ void GraphInterface::write_to_file(string file, boost::python::object pfile,
                                                 std::placeholders::_1,
                                                 index_map))();
                 run_action<>()(*this, std::bind(do_write_to_binary_file(),
-                                                std::ref(stream),
+                                                std::ref(bstream),
                                                 std::placeholders::_1,
                                                 index_map,
                                                 get_num_vertices(),
                                                 directed,
                                                 std::ref(agprops),
                                                 std::ref(avprops),
-                                                std::ref(aeprops)))();
+                                                std::ref(aeprops),
+                                                mappable))();
             }
             else
             {
                 run_action<>()(*this, std::bind(do_write_to_binary_file(),
-                                                std::ref(stream),
+                                                std::ref(bstream),
                                                 std::placeholders::_1,
                                                 _vertex_index,
                                                 get_num_vertices(),
                                                 directed,
                                                 std::ref(agprops),
                                                 std::ref(avprops),
-                                                std::ref(aeprops)))();
+                                                std::ref(aeprops),
+                                                mappable))();
             }
+            bstream.flush();
 
             _directed = directed;
         }
@@ -19,11 +19,22 @@
 #define GRAPH_IO_BINARY_HH
 
 #include <iostream>
+#include <streambuf>
+#include <memory>
 #include "graph.hh"
 #include "graph_properties.hh"
 #include "graph_selectors.hh"
 #include <unordered_set>
 
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 namespace graph_tool
 {
 
@@ -31,6 +42,15 @@ const char* _magic = u8"⛾ gt";
 size_t _magic_length = 6;
 const uint8_t _version = 1;
 
+// Version 2 of the format stores the adjacency in compressed sparse row (CSR)
+// form, and the values of scalar property maps as contiguous columns, all
+// aligned to 8-byte boundaries relative to the beginning of the file. This
+// allows the file to be memory-mapped and read without parsing or copying: the
+// frozen CSR snapshot and the scalar property maps use the mapped arrays
+// directly, and the adjacency list is only built from them when it is first
+// needed (see adj_list::defer_csr()).
+const uint8_t _version_csr = 2;
+
 // deal with endianness
 
 inline bool is_bigendian()
@@ -165,14 +185,182 @@ void skip(std::istream& s, const boost::python::object&)
     skip<BE>(s, std::string());
 };
 
+// Output stream buffer which forwards the data to another one in large
+// blocks. If "gzip == true", each block is compressed as a separate gzip
+// member (a concatenation of members is itself a valid gzip stream), and
+// consecutive blocks are compressed in parallel. Any pending data is only
+// written when the buffer is synchronized, e.g. by flushing the stream.
+class block_streambuf: public std::streambuf
+{
+public:
+    block_streambuf(std::streambuf* sb, bool gzip = false,
+                    size_t block_size = 1 << 22)
+        : _sb(sb), _gzip(gzip), _block_size(block_size), _current(0)
+    {
+        size_t n_blocks = 1;
+#ifdef USING_OPENMP
+        if (gzip)
+            n_blocks = omp_get_max_threads();
+#endif
+        _blocks.resize(n_blocks);
+        _out.resize(n_blocks);
+        set_block(0);
+    }
+
+protected:
+    virtual int_type overflow(int_type c)
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+            return traits_type::not_eof(c);
+        if (!next_block())
+            return traits_type::eof();
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+        return c;
+    }
+
+    virtual std::streamsize xsputn(const char* s, std::streamsize n)
+    {
+        std::streamsize r = 0;
+        while (r < n)
+        {
+            if (pptr() == epptr() && !next_block())
+                break;
+            std::streamsize k = std::min(n - r,
+                                         std::streamsize(epptr() - pptr()));
+            memcpy(pptr(), s + r, k);
+            pbump(k);
+            r += k;
+        }
+        return r;
+    }
+
+    virtual int sync()
+    {
+        if (!write_blocks(_current, pptr() - pbase()))
+            return -1;
+        set_block(0);
+        return _sb->pubsync();
+    }
+
+private:
+    void set_block(size_t i)
+    {
+        _current = i;
+        auto& b = _blocks[i];
+        b.resize(_block_size);
+        setp(&b[0], &b[0] + b.size());
+    }
+
+    bool next_block()
+    {
+        if (_current + 1 < _blocks.size())
+        {
+            set_block(_current + 1);
+            return true;
+        }
+        if (!write_blocks(_current + 1, 0))
+            return false;
+        set_block(0);
+        return true;
+    }
+
+    // writes out the first n_full blocks, followed by the first "last" bytes
+    // of the next one
+    bool write_blocks(size_t n_full, size_t last)
+    {
+        size_t n = n_full + ((last > 0) ? 1 : 0);
+        auto size = [&](size_t i) { return (i < n_full) ? _block_size : last; };
+
+        if (!_gzip)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (_sb->sputn(&_blocks[i][0], size(i)) !=
+                    std::streamsize(size(i)))
+                    return false;
+            }
+            return true;
+        }
+
+        size_t nerr = 0;
+        #pragma omp parallel for schedule(dynamic, 1) if (n > 1) \
+            reduction(+:nerr)
+        for (size_t i = 0; i < n; ++i)
+        {
+            try
+            {
+                _out[i].clear();
+                boost::iostreams::filtering_ostream z;
+                z.push(boost::iostreams::gzip_compressor());
+                z.push(boost::iostreams::back_inserter(_out[i]));
+                z.write(&_blocks[i][0], size(i));
+                z.reset();
+            }
+            catch (std::exception&)
+            {
+                nerr++;
+            }
+        }
+        if (nerr > 0)
+            return false;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (_sb->sputn(_out[i].data(), _out[i].size()) !=
+                std::streamsize(_out[i].size()))
+                return false;
+        }
+        return true;
+    }
+
+    std::streambuf* _sb;
+    bool _gzip;
+    size_t _block_size;
+    std::vector<std::string> _blocks;
+    std::vector<std::string> _out;
+    size_t _current;
+};
+
+// Scalar values are gathered in chunks, so that they can be written with a few
+// large writes, instead of one for each value.
+template <class Value, class Range, class Get>
+typename std::enable_if<std::is_scalar<Value>::value>::type
+write_column(std::ostream& s, Range&& range, Get&& get)
+{
+    const size_t chunk_size = 1 << 16;
+    std::vector<Value> chunk;
+    chunk.reserve(chunk_size);
+    for (auto x : range)
+    {
+        chunk.push_back(get(x));
+        if (chunk.size() == chunk_size)
+        {
+            s.write(reinterpret_cast<const char*>(chunk.data()),
+                    chunk.size() * sizeof(Value));
+            chunk.clear();
+        }
+    }
+    s.write(reinterpret_cast<const char*>(chunk.data()),
+            chunk.size() * sizeof(Value));
+}
+
+template <class Value, class Range, class Get>
+typename std::enable_if<!std::is_scalar<Value>::value>::type
+write_column(std::ostream& s, Range&& range, Get&& get)
+{
+    for (auto x : range)
+        write(s, get(x));
+}
+
 template <class Vint, class Graph, class VProp>
 void write_adjacency_dispatch(Graph& g, const VProp& vindex, std::ostream& s)
 {
+    // the same buffer is reused for every vertex
+    std::vector<Vint> us;
     for (auto v : vertices_range(g))
     {
-        size_t k = out_degree(v, g);
-        std::vector<Vint> us;
-        us.reserve(k);
+        us.clear();
         for (auto e : out_edges_range(v, g))
             us.push_back(vindex[target(e, g)]);
         write(s, us);
@@ -201,19 +389,25 @@ void write_adjacency(Graph& g, const VProp& vindex, uint64_t N,
 template <bool BE, class Vint, class Graph>
 void read_adjacency_dispatch(Graph& g, size_t N, std::istream& s)
 {
-    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-
-    for (vertex_t v = 0; v < N; ++v)
+    // the edges are collected first, and then inserted all at once
+    std::vector<Vint> sources, targets;
+    std::vector<Vint> us;
+    for (size_t v = 0; v < N; ++v)
     {
-        std::vector<Vint> us;
         read<BE>(s, us);
-        for (vertex_t u : us)
+        for (Vint u : us)
         {
             if (u >= N)
                 throw IOException("error reading graph: vertex index not in range");
-            add_edge(v, u, g);
+            sources.push_back(v);
+            targets.push_back(u);
         }
     }
+
+    g.add_edges(sources.size(),
+                [&](size_t i) { return size_t(sources[i]); },
+                [&](size_t i) { return size_t(targets[i]); },
+                [](size_t, const auto&) {});
 }
 
 
@@ -303,12 +497,19 @@ struct edge_range_traits
 };
 
 
+// the alignment functor is called between the value type index and the
+// property values; it does nothing in version 1 of the format
+struct no_align
+{
+    void operator()(std::ostream&) const {}
+};
+
 template <class RangeTraits>
 struct write_property_dispatch
 {
-    template <class T, class Graph>
+    template <class T, class Graph, class Align>
     void operator()(T, Graph& g, boost::any& aprop, bool& found,
-                    std::ostream& s) const
+                    Align& align, std::ostream& s) const
     {
         try
         {
@@ -317,17 +518,18 @@ struct write_property_dispatch
             typedef typename mpl::find<val_types, T>::type pos;
             uint8_t val = mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value;
             write(s, val);
-            for (auto x : RangeTraits::get_range(g))
-                write(s, prop[x]);
+            align(s);
+            write_column<T>(s, RangeTraits::get_range(g),
+                            [&](const auto& x) -> auto& { return prop[x]; });
             found = true;
         }
         catch (const boost::bad_any_cast&) {}
     }
 
 
-    template <class Graph>
+    template <class Graph, class Align>
     void operator()(size_t, Graph& g, boost::any& aprop, bool& found,
-                    std::ostream& s) const
+                    Align& align, std::ostream& s) const
     {
         try
         {
@@ -336,12 +538,9 @@ struct write_property_dispatch
             typedef typename mpl::find<val_types, int64_t>::type pos;
             uint8_t val = mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value;
             write(s, val);
-            int64_t y;
-            for (auto x : vertices_range(g))
-            {
-                y = prop[x];
-                write(s, y);
-            }
+            align(s);
+            write_column<int64_t>(s, vertices_range(g),
+                                  [&](auto v) { return int64_t(prop[v]); });
             found = true;
         }
         catch (const boost::bad_any_cast&) {}
@@ -353,12 +552,9 @@ struct write_property_dispatch
             typedef typename mpl::find<val_types, int64_t>::type pos;
             uint8_t val = mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value;
             write(s, val);
-            int64_t y;
-            for (auto x : edges_range(g))
-            {
-                y = prop[x];
-                write(s, y);
-            }
+            align(s);
+            write_column<int64_t>(s, edges_range(g),
+                                  [&](const auto& e) { return int64_t(prop[e]); });
             found = true;
         }
         catch (const boost::bad_any_cast&) {}
@@ -367,8 +563,9 @@ struct write_property_dispatch
 };
 
 
-template <class RangeTraits, class Graph>
-void write_property(Graph& g, std::string& name, boost::any& prop, std::ostream& s)
+template <class RangeTraits, class Graph, class Align = no_align>
+void write_property(Graph& g, std::string& name, boost::any& prop,
+                    std::ostream& s, Align align = Align())
 {
     property_type pt = RangeTraits::get_property_id();
     write(s, pt);
@@ -377,7 +574,7 @@ void write_property(Graph& g, std::string& name, boost::any& prop, std::ostream&
     mpl::for_each<val_types>(std::bind(write_property_dispatch<RangeTraits>(),
                                        std::placeholders::_1, std::ref(g),
                                        std::ref(prop), std::ref(found),
-                                       std::ref(s)));
+                                       std::ref(align), std::ref(s)));
     if (!found)
         throw GraphException("Error writing graph: unknown property map type (this is a bug)");
 }
@@ -438,16 +635,545 @@ read_property(Graph& g, const std::unordered_set<std::string>& ignore,
 }
 
 
+//
+// Version 2 (CSR) layout
+//
+
+// output stream buffer which keeps track of the number of bytes written, so
+// that the data can be aligned
+class counting_streambuf: public std::streambuf
+{
+public:
+    counting_streambuf(std::streambuf* sb): _sb(sb), _count(0) {}
+    size_t count() const { return _count; }
+
+protected:
+    virtual int_type overflow(int_type c)
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+            return traits_type::not_eof(c);
+        if (traits_type::eq_int_type(_sb->sputc(traits_type::to_char_type(c)),
+                                     traits_type::eof()))
+            return traits_type::eof();
+        ++_count;
+        return c;
+    }
+
+    virtual std::streamsize xsputn(const char* s, std::streamsize n)
+    {
+        std::streamsize r = _sb->sputn(s, n);
+        _count += r;
+        return r;
+    }
+
+    virtual int sync() { return _sb->pubsync(); }
+
+private:
+    std::streambuf* _sb;
+    size_t _count;
+};
+
+// pads the output with zeros up to the next multiple of 8 bytes
+struct write_align
+{
+    write_align(counting_streambuf& buf): _buf(buf) {}
+    void operator()(std::ostream& s) const
+    {
+        const char zeros[8] = {};
+        size_t r = _buf.count() % 8;
+        if (r > 0)
+            s.write(zeros, 8 - r);
+    }
+    counting_streambuf& _buf;
+};
+
+// input stream buffer over a contiguous region of memory, which allows direct
+// access to the data at the current position
+class mem_streambuf: public std::streambuf
+{
+public:
+    mem_streambuf(std::shared_ptr<char> data, size_t size)
+        : _data(data)
+    {
+        setg(data.get(), data.get(), data.get() + size);
+    }
+
+    // the owner of the whole memory region
+    const std::shared_ptr<char>& get_data() const { return _data; }
+
+    size_t tell() const { return gptr() - eback(); }
+    size_t avail() const { return egptr() - gptr(); }
+    char* get_ptr() const { return gptr(); }
+
+    void advance(size_t n)
+    {
+        if (n > avail())
+            throw IOException("Error reading graph: unexpected end of file");
+        setg(eback(), gptr() + n, egptr());
+    }
+
+    void align()
+    {
+        size_t r = tell() % 8;
+        if (r > 0)
+            advance(8 - r);
+    }
+
+private:
+    std::shared_ptr<char> _data;
+};
+
+// returns a pointer to an array of n values at the current position, which
+// are byte-swapped in place if necessary
+template <bool BE, class T>
+T* get_array(mem_streambuf& buf, size_t n)
+{
+    if (n > buf.avail() / sizeof(T))
+        throw IOException("Error reading graph: unexpected end of file");
+    T* a = reinterpret_cast<T*>(buf.get_ptr());
+    buf.advance(n * sizeof(T));
+    if (BE != is_bigendian())
+    {
+        for (size_t i = 0; i < n; ++i)
+            byte_swap<BE>(a[i]);
+    }
+    buf.align();
+    return a;
+}
+
+// Memory-maps the given file, if it is stored in the version 2 layout;
+// otherwise a null pointer is returned. The mapping is private and
+// copy-on-write, so that the pages which are never modified are shared via
+// the page cache with every other process which maps the same file.
+inline std::shared_ptr<char> map_graph_file(const std::string& file,
+                                            size_t& size)
+{
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd == -1)
+        return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < _magic_length + 2)
+    {
+        close(fd);
+        return nullptr;
+    }
+    size_t len = st.st_size;
+    void* addr = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        return nullptr;
+    std::shared_ptr<char> data(static_cast<char*>(addr),
+                               [len](char* p) { munmap(p, len); });
+    if (strncmp(data.get(), _magic, _magic_length) != 0 ||
+        uint8_t(data.get()[_magic_length]) != _version_csr)
+        return nullptr;
+    size = len;
+    return data;
+}
+
+// Reads the remainder of the stream into an 8-byte aligned buffer, preceded by
+// the header bytes already consumed.
+inline std::shared_ptr<char> read_graph_buffer(std::istream& s,
+                                               const char* head, size_t nhead,
+                                               size_t& size)
+{
+    auto buf = std::make_shared<std::vector<uint64_t>>(1 << 16);
+    memcpy(buf->data(), head, nhead);
+    size = nhead;
+    auto exceptions = s.exceptions();
+    s.exceptions(std::ios_base::badbit);
+    while (s)
+    {
+        size_t cap = buf->size() * sizeof(uint64_t);
+        if (size == cap)
+        {
+            buf->resize(buf->size() * 2);
+            cap *= 2;
+        }
+        s.read(reinterpret_cast<char*>(buf->data()) + size, cap - size);
+        size += s.gcount();
+    }
+    s.clear();
+    s.exceptions(exceptions);
+    return std::shared_ptr<char>(buf, reinterpret_cast<char*>(buf->data()));
+}
+
+template <class Vertex>
+bool check_csr(size_t N, size_t E, const uint64_t* pos, const Vertex* es)
+{
+    if (pos[0] != 0 || pos[N] != E)
+        return false;
+    size_t nerr = 0;
+    #pragma omp parallel for schedule(runtime) if (N > 100) reduction(+:nerr)
+    for (size_t v = 0; v < N; ++v)
+    {
+        if (pos[v] > pos[v + 1] || pos[v + 1] > E)
+        {
+            nerr++;
+            continue;
+        }
+        for (size_t i = pos[v]; i < pos[v + 1]; ++i)
+        {
+            if (es[2 * i] >= N || es[2 * i + 1] >= E)
+                nerr++;
+        }
+    }
+    return nerr == 0;
+}
+
+// Checks that the index of each out-edge is its position in the out-edge
+// array, and that the in-edge list of each vertex is sorted by edge index and
+// agrees with the out-edge lists on the endpoints of its edges, as written by
+// write_graph_mapped(). Together, this means that every edge index in [0, E)
+// appears exactly once on each side. Every test involves only a single entry
+// and the one before it, so that no memory is needed beyond the arrays
+// themselves. The CSR arrays must have been validated with check_csr() first.
+template <class Vertex>
+bool check_csr_edges(size_t N, const uint64_t* out_pos, const Vertex* out_es,
+                     const uint64_t* in_pos, const Vertex* in_es)
+{
+    size_t nerr = 0;
+    #pragma omp parallel for schedule(runtime) if (N > 100) reduction(+:nerr)
+    for (size_t v = 0; v < N; ++v)
+    {
+        for (size_t i = out_pos[v]; i < out_pos[v + 1]; ++i)
+        {
+            if (out_es[2 * i + 1] != i)
+                nerr++;
+        }
+        for (size_t i = in_pos[v]; i < in_pos[v + 1]; ++i)
+        {
+            size_t u = in_es[2 * i];
+            size_t idx = in_es[2 * i + 1];
+            if (out_es[2 * idx] != v || idx < out_pos[u] ||
+                idx >= out_pos[u + 1] ||
+                (i > in_pos[v] && idx <= in_es[2 * (i - 1) + 1]))
+                nerr++;
+        }
+    }
+    return nerr == 0;
+}
+
+// the values of scalar columns are used in place, if they are suitably
+// aligned, and the memory region is kept alive by the property map
+template <bool BE, class T>
+typename std::enable_if<std::is_scalar<T>::value>::type
+read_column(std::vector<T, property_allocator<T>>& vec, size_t n, bool ignore,
+            mem_streambuf& buf, std::istream&)
+{
+    T* a = get_array<BE, T>(buf, n);
+    if (ignore)
+        return;
+    if (reinterpret_cast<uintptr_t>(a) % alignof(T) == 0)
+        adopt_storage(vec, a, n, buf.get_data());
+    else
+        vec.assign(a, a + n);
+}
+
+template <bool BE, class T>
+typename std::enable_if<!std::is_scalar<T>::value>::type
+read_column(std::vector<T, property_allocator<T>>& vec, size_t n, bool ignore,
+            mem_streambuf&, std::istream& s)
+{
+    if (!ignore)
+    {
+        vec.resize(n);
+        for (auto& x : vec)
+            read<BE>(s, x);
+    }
+    else
+    {
+        T y;
+        for (size_t i = 0; i < n; ++i)
+            skip<BE>(s, y);
+    }
+}
+
+template <bool BE, class RangeTraits>
+struct read_property_column_dispatch
+{
+    template <class T, class Graph>
+    void operator()(T, Graph& g, size_t n, boost::any& aprop, uint8_t val,
+                    bool ignore, bool& found, mem_streambuf& buf,
+                    std::istream& s) const
+    {
+        typedef typename mpl::find<val_types, T>::type pos;
+        if (mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value == val)
+        {
+            typedef typename property_map_type::apply<T, typename RangeTraits::index_map_t>::type pmap_t;
+            pmap_t prop(RangeTraits::get_index_map(g));
+            read_column<BE>(prop.get_storage(), n, ignore, buf, s);
+            if (!ignore)
+                aprop = prop;
+            found = true;
+        }
+    }
+};
+
+template <bool BE, class RangeTraits, class Graph>
+std::pair<std::string, boost::any>
+read_property_column(Graph& g, size_t n,
+                     const std::unordered_set<std::string>& ignore,
+                     mem_streambuf& buf, std::istream& s)
+{
+    boost::any prop;
+    bool found = false;
+    std::string name;
+    read<BE>(s, name);
+    bool skip = ignore.find(name) != ignore.end();
+    uint8_t val = 0;
+    read<BE>(s, val);
+    buf.align();
+    mpl::for_each<val_types>(std::bind(read_property_column_dispatch<BE, RangeTraits>(),
+                                       std::placeholders::_1, std::ref(g), n,
+                                       std::ref(prop), val, skip, std::ref(found),
+                                       std::ref(buf), std::ref(s)));
+    if (!found)
+        throw IOException("Error reading graph: invalid property value type index "
+                          + boost::lexical_cast<std::string>(val));
+    return make_pair(name, prop);
+}
+
 template <class Graph, class VProp>
-void write_graph(Graph& g, const VProp& vindex, size_t N, bool directed,
-                 std::vector<std::pair<std::string, boost::any>>& gprops,
-                 std::vector<std::pair<std::string, boost::any>>& vprops,
-                 std::vector<std::pair<std::string, boost::any>>& eprops, std::ostream& s)
+void write_graph_mapped(Graph& g, const VProp& vindex, size_t N, bool directed,
+                        const std::string& comment,
+                        std::vector<std::pair<std::string, boost::any>>& gprops,
+                        std::vector<std::pair<std::string, boost::any>>& vprops,
+                        std::vector<std::pair<std::string, boost::any>>& eprops,
+                        std::ostream& os)
 {
+    counting_streambuf buf(os.rdbuf());
+    std::ostream s(&buf);
+    s.exceptions(os.exceptions());
+    write_align align(buf);
+
     s.write(_magic, _magic_length);
-    write(s, _version);
+    write(s, _version_csr);
     uint8_t big_end = is_bigendian();
     write(s, big_end);
+    write(s, comment);
+    align(s);
+
+    uint8_t udirected = directed;
+    write(s, udirected);
+    align(s);
+
+    // edges are indexed in the order in which they appear in the out-edge
+    // lists, as in version 1, and the in-edge list of each vertex is sorted by
+    // edge index, which is the order in which version 1 files are loaded, and
+    // which allows the reader to validate the adjacency in place (see
+    // check_csr_edges())
+    std::vector<uint64_t> out_pos(1, 0), in_pos(1, 0);
+    out_pos.reserve(N + 1);
+    in_pos.reserve(N + 1);
+    auto eindex = get(edge_index, g);
+    checked_vector_property_map<uint64_t, decltype(eindex)> eidx(eindex);
+    uint64_t E = 0;
+    for (auto v : vertices_range(g))
+    {
+        for (auto e : out_edges_range(v, g))
+            eidx[e] = E++;
+        out_pos.push_back(E);
+        in_pos.push_back(in_pos.back() + in_degreeS()(v, g));
+    }
+
+    uint64_t N64 = N;
+    write(s, N64);
+    write(s, E);
+
+    std::vector<uint64_t> es;
+    s.write(reinterpret_cast<const char*>(out_pos.data()),
+            out_pos.size() * sizeof(uint64_t));
+    for (auto v : vertices_range(g))
+    {
+        es.clear();
+        for (auto e : out_edges_range(v, g))
+        {
+            es.push_back(vindex[target(e, g)]);
+            es.push_back(eidx[e]);
+        }
+        s.write(reinterpret_cast<const char*>(es.data()),
+                es.size() * sizeof(uint64_t));
+    }
+
+    s.write(reinterpret_cast<const char*>(in_pos.data()),
+            in_pos.size() * sizeof(uint64_t));
+    std::vector<std::pair<uint64_t, uint64_t>> ies;
+    for (auto v : vertices_range(g))
+    {
+        ies.clear();
+        for (auto e : in_edges_range(v, g))
+            ies.emplace_back(vindex[source(e, g)], eidx[e]);
+        std::sort(ies.begin(), ies.end(),
+                  [](auto& a, auto& b) { return a.second < b.second; });
+        es.clear();
+        for (auto& ie : ies)
+        {
+            es.push_back(ie.first);
+            es.push_back(ie.second);
+        }
+        s.write(reinterpret_cast<const char*>(es.data()),
+                es.size() * sizeof(uint64_t));
+    }
+
+    uint64_t nprops = gprops.size() + vprops.size() + eprops.size();
+    write(s, nprops);
+    for (auto& p : gprops)
+    {
+        write_property<graph_range_traits>(g, p.first, p.second, s, align);
+        align(s);
+    }
+    for (auto& p : vprops)
+    {
+        write_property<vertex_range_traits>(g, p.first, p.second, s, align);
+        align(s);
+    }
+    for (auto& p : eprops)
+    {
+        write_property<edge_range_traits>(g, p.first, p.second, s, align);
+        align(s);
+    }
+    s.flush();
+}
+
+template <bool BE, class Graph>
+bool read_graph_mapped_dispatch(std::shared_ptr<char> data, mem_streambuf& buf,
+                                std::istream& s, Graph& g,
+                                std::shared_ptr<boost::csr_adj_list<size_t>>& csr,
+                                std::vector<std::pair<std::string, boost::any>>& gprops,
+                                std::vector<std::pair<std::string, boost::any>>& vprops,
+                                std::vector<std::pair<std::string, boost::any>>& eprops,
+                                const std::unordered_set<std::string>& ignore_gp,
+                                const std::unordered_set<std::string>& ignore_vp,
+                                const std::unordered_set<std::string>& ignore_ep)
+{
+    static_assert(sizeof(size_t) == sizeof(uint64_t),
+                  "version 2 files require 64-bit indexes");
+
+    uint8_t directed = false;
+    read<BE>(s, directed);
+    buf.align();
+
+    uint64_t N = 0, E = 0;
+    read<BE>(s, N);
+    read<BE>(s, E);
+    if (N >= buf.avail() || E >= buf.avail())
+        throw IOException("Error reading graph: unexpected end of file");
+
+    auto out_pos = get_array<BE, uint64_t>(buf, N + 1);
+    auto out_es = get_array<BE, uint64_t>(buf, 2 * E);
+    auto in_pos = get_array<BE, uint64_t>(buf, N + 1);
+    auto in_es = get_array<BE, uint64_t>(buf, 2 * E);
+
+    if (!check_csr(N, E, out_pos, out_es) || !check_csr(N, E, in_pos, in_es) ||
+        !check_csr_edges(N, out_pos, out_es, in_pos, in_es))
+        throw IOException("error reading graph: invalid adjacency");
+
+    typedef typename boost::csr_adj_list<size_t>::edge_entry_t entry_t;
+    csr = std::make_shared<boost::csr_adj_list<size_t>>
+        (N, E, E,
+         reinterpret_cast<const size_t*>(out_pos),
+         reinterpret_cast<const entry_t*>(out_es),
+         reinterpret_cast<const size_t*>(in_pos),
+         reinterpret_cast<const entry_t*>(in_es),
+         data);
+    g.defer_csr(N, E,
+                reinterpret_cast<const size_t*>(out_pos),
+                reinterpret_cast<const entry_t*>(out_es),
+                reinterpret_cast<const size_t*>(in_pos),
+                reinterpret_cast<const entry_t*>(in_es),
+                data);
+
+    uint64_t nprops;
+    read<BE>(s, nprops);
+    for (size_t i = 0; i < nprops; ++i)
+    {
+        property_type pt;
+        read<BE>(s, pt);
+        std::pair<std::string, boost::any> p;
+        switch (pt)
+        {
+        case property_type::Graph:
+            p = read_property_column<BE, graph_range_traits>(g, 1, ignore_gp,
+                                                             buf, s);
+            if (!p.second.empty())
+                gprops.push_back(p);
+            break;
+        case property_type::Vertex:
+            p = read_property_column<BE, vertex_range_traits>(g, N, ignore_vp,
+                                                              buf, s);
+            if (!p.second.empty())
+                vprops.push_back(p);
+            break;
+        case property_type::Edge:
+            p = read_property_column<BE, edge_range_traits>(g, E, ignore_ep,
+                                                            buf, s);
+            if (!p.second.empty())
+                eprops.push_back(p);
+            break;
+        default:
+            throw IOException("Error reading graph: invalid property type " +
+                              boost::lexical_cast<std::string>(uint8_t(pt)));
+        }
+        buf.align();
+    }
+    return directed;
+}
+
+// Reads a graph stored in the version 2 layout from the given memory region
+// (e.g. obtained with map_graph_file()), without copying it. A csr_adj_list
+// snapshot which refers directly to the memory region is returned in "csr",
+// the adjacency list of the graph is deferred until it is first needed (see
+// adj_list::defer_csr()), and the scalar property maps use the mapped
+// columns as their storage. All of these keep the memory region alive. Apart
+// from the bounds checks, validation takes O(V + E) time and no additional
+// memory.
+template <class Graph>
+bool read_graph_mapped(std::shared_ptr<char> data, size_t size, Graph& g,
+                       std::shared_ptr<boost::csr_adj_list<size_t>>& csr,
+                       std::vector<std::pair<std::string, boost::any>>& gprops,
+                       std::vector<std::pair<std::string, boost::any>>& vprops,
+                       std::vector<std::pair<std::string, boost::any>>& eprops,
+                       const std::unordered_set<std::string>& ignore_gp = std::unordered_set<std::string>(),
+                       const std::unordered_set<std::string>& ignore_vp = std::unordered_set<std::string>(),
+                       const std::unordered_set<std::string>& ignore_ep = std::unordered_set<std::string>())
+{
+    mem_streambuf buf(data, size);
+    std::istream s(&buf);
+    s.exceptions(ios_base::badbit | ios_base::failbit | ios_base::eofbit);
+
+    char magic[_magic_length];
+    s.read(magic, _magic_length);
+    if (strncmp(magic, _magic, _magic_length) != 0)
+        throw IOException("Error reading graph: Invalid magic number");
+    uint8_t version = 0;
+    read<false>(s, version);
+    if (version != _version_csr)
+        throw IOException("Error reading graph: Invalid format version " +
+                          boost::lexical_cast<std::string>(version));
+    uint8_t big_end = 0;
+    read<false>(s, big_end);
+    string comment;
+    read<false>(s, comment);
+    buf.align();
+
+    if (big_end)
+        return read_graph_mapped_dispatch<true>(data, buf, s, g, csr, gprops,
+                                                vprops, eprops, ignore_gp,
+                                                ignore_vp, ignore_ep);
+    else
+        return read_graph_mapped_dispatch<false>(data, buf, s, g, csr, gprops,
+                                                 vprops, eprops, ignore_gp,
+                                                 ignore_vp, ignore_ep);
+}
+
+template <class Graph, class VProp>
+void write_graph(Graph& g, const VProp& vindex, size_t N, bool directed,
+                 std::vector<std::pair<std::string, boost::any>>& gprops,
+                 std::vector<std::pair<std::string, boost::any>>& vprops,
+                 std::vector<std::pair<std::string, boost::any>>& eprops, std::ostream& s,
+                 bool mappable = false)
+{
     string comment = "graph-tool binary file (http:://graph-tool.skewed.de)"
         " generated by version " VERSION " (commit " GIT_COMMIT ", " GIT_COMMIT_DATE ")";
     comment += " stats: " + lexical_cast<std::string>(N) + " vertices, " +
@@ -456,6 +1182,18 @@ void write_graph(Graph& g, const VProp& vindex, size_t N, bool directed,
         lexical_cast<std::string>(gprops.size()) + " graph props, " +
         lexical_cast<std::string>(vprops.size()) + " vertex props, " +
         lexical_cast<std::string>(eprops.size()) + " edge props";
+
+    if (mappable)
+    {
+        write_graph_mapped(g, vindex, N, directed, comment, gprops, vprops,
+                           eprops, s);
+        return;
+    }
+
+    s.write(_magic, _magic_length);
+    write(s, _version);
+    uint8_t big_end = is_bigendian();
+    write(s, big_end);
     write(s, comment);
 
     write_adjacency(g, vindex, N, directed, s);
@@ -520,7 +1258,8 @@ bool read_graph(std::istream& s, Graph& g,
                 std::vector<std::pair<std::string, boost::any>>& eprops,
                 const std::unordered_set<std::string>& ignore_gp = std::unordered_set<std::string>(),
                 const std::unordered_set<std::string>& ignore_vp = std::unordered_set<std::string>(),
-                const std::unordered_set<std::string>& ignore_ep = std::unordered_set<std::string>())
+                const std::unordered_set<std::string>& ignore_ep = std::unordered_set<std::string>(),
+                std::shared_ptr<boost::csr_adj_list<size_t>>* csr = nullptr)
 {
     char magic[_magic_length];
     s.read(magic, _magic_length);
@@ -528,6 +1267,25 @@ bool read_graph(std::istream& s, Graph& g,
         throw IOException("Error reading graph: Invalid magic number");
     uint8_t version = 0;
     read<false>(s, version);
+    if (version == _version_csr)
+    {
+        // the stream cannot be mapped, so it is read into memory as a whole
+        char head[_magic_length + 1];
+        memcpy(head, magic, _magic_length);
+        head[_magic_length] = version;
+        size_t size = 0;
+        auto data = read_graph_buffer(s, head, _magic_length + 1, size);
+        std::shared_ptr<boost::csr_adj_list<size_t>> mcsr;
+        bool directed = read_graph_mapped(data, size, g, mcsr, gprops, vprops,
+                                          eprops, ignore_gp, ignore_vp,
+                                          ignore_ep);
+        // without the snapshot, the adjacency list is needed right away
+        if (csr != nullptr)
+            *csr = mcsr;
+        else
+            g.materialize();
+        return directed;
+    }
     if (version != _version)
         throw IOException("Error reading graph: Invalid format version " +
                           boost::lexical_cast<std::string>(version));
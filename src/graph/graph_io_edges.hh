@@ -0,0 +1,42 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2016 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_IO_EDGES_HH
+#define GRAPH_IO_EDGES_HH
+
+#include <istream>
+#include <functional>
+#include <utility>
+
+namespace graph_tool
+{
+
+// Calls f(u, v) for every edge of the graph stored in the stream, in the
+// binary "gt" format, in the order of the out-edge lists, without building the
+// graph. Only the adjacency is read, and the memory used is proportional to
+// the largest out-degree for version 1 of the format, and O(V) for version
+// 2. The number of vertices and the directedness of the graph are returned. An
+// IOException is thrown if the stream is invalid or ends prematurely.
+//
+// This is defined in graph_io.cc, so that the modules which only stream the
+// edges do not need the rest of the binary format.
+std::pair<size_t, bool>
+read_graph_edges(std::istream& s, const std::function<void(size_t, size_t)>& f);
+
+} // namespace graph_tool
+
+#endif // GRAPH_IO_EDGES_HH
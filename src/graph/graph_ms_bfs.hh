@@ -0,0 +1,180 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2016 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_MS_BFS_HH
+#define GRAPH_MS_BFS_HH
+
+#include <vector>
+#include <cstdint>
+
+#include "graph_selectors.hh"
+#include "graph_util.hh"
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
+namespace graph_tool
+{
+
+// Multi-source breadth-first search, which traverses the graph from up to 64
+// sources at once, as described in M. Then et al., "The more the merrier:
+// efficient multi-source graph traversal", Proc. VLDB Endow. 8, 449 (2014).
+//
+// Each vertex keeps a bit mask with the sources which have already reached it,
+// and another with the sources for which it is in the current frontier, so
+// that the edges of a vertex are scanned only once per level, for all the
+// sources which reach it simultaneously. An instance is meant to be used by a
+// single thread, and reused for many batches of sources, since it only resets
+// the vertices reached by the previous one.
+
+template <class Graph>
+class ms_bfs
+{
+public:
+    typedef uint64_t mask_t;
+    typedef typename boost::graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    static constexpr size_t width = 64;
+
+    ms_bfs(const Graph& g)
+        : _seen(num_vertices(g)), _visit(num_vertices(g)),
+          _next(num_vertices(g)) {}
+
+    // Searches from sources[0], ..., sources[n-1], with n <= width, which
+    // must be distinct. The function visit(v, mask, d) is called once for
+    // every distance d > 0 at which v is reached, where the set bits of mask
+    // are the indexes of the sources at distance d from v.
+    template <class Visit>
+    void search(const Graph& g, const vertex_t* sources, size_t n,
+                Visit&& visit)
+    {
+        for (auto v : _reached)
+            _seen[v] = _visit[v] = 0;
+        _reached.clear();
+        _frontier.clear();
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            auto s = sources[i];
+            _seen[s] = _visit[s] = mask_t(1) << i;
+            _frontier.push_back(s);
+            _reached.push_back(s);
+        }
+
+        for (size_t d = 1; !_frontier.empty(); ++d)
+        {
+            _new.clear();
+            for (auto u : _frontier)
+            {
+                mask_t m_u = _visit[u];
+                for (auto v : out_neighbours_range(u, g))
+                {
+                    mask_t m = m_u & ~_seen[v];
+                    if (m == 0)
+                        continue;
+                    if (_next[v] == 0)
+                        _new.push_back(v);
+                    _next[v] |= m;
+                }
+            }
+
+            for (auto u : _frontier)
+                _visit[u] = 0;
+
+            for (auto v : _new)
+            {
+                mask_t m = _next[v];
+                _next[v] = 0;
+                if (_seen[v] == 0)
+                    _reached.push_back(v);
+                _seen[v] |= m;
+                _visit[v] = m;
+                visit(v, m, d);
+            }
+
+            _frontier.swap(_new);
+        }
+    }
+
+private:
+    std::vector<mask_t> _seen;
+    std::vector<mask_t> _visit;
+    std::vector<mask_t> _next;
+    std::vector<vertex_t> _frontier;
+    std::vector<vertex_t> _new;
+    std::vector<vertex_t> _reached;
+};
+
+// Calls f(i) for every set bit i of the mask.
+template <class F>
+inline __attribute__((always_inline))
+void for_each_bit(uint64_t mask, F&& f)
+{
+    while (mask != 0)
+    {
+        f(size_t(__builtin_ctzll(mask)));
+        mask &= mask - 1;
+    }
+}
+
+// Runs a BFS from every vertex in "sources", which must be distinct, in
+// batches of ms_bfs::width, which are distributed among the threads of the
+// current parallel region. For every batch, f(bfs, batch, n) is called, where
+// bfs is the thread's ms_bfs instance, and batch points to the n sources of
+// the batch, which should be passed to bfs.search().
+
+template <class Graph, class F>
+void parallel_ms_bfs_no_spawn(const Graph& g,
+                              const std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& sources,
+                              F&& f)
+{
+    constexpr size_t width = ms_bfs<Graph>::width;
+    size_t n_batches = (sources.size() + width - 1) / width;
+
+    ms_bfs<Graph> bfs(g);
+
+    #pragma omp for schedule(runtime)
+    for (size_t i = 0; i < n_batches; ++i)
+    {
+        size_t pos = i * width;
+        size_t n = std::min(width, sources.size() - pos);
+        f(bfs, &sources[pos], n);
+    }
+}
+
+// Same as above, with every vertex of the graph as a source.
+template <class Graph, class F>
+void parallel_ms_bfs_no_spawn(const Graph& g, F&& f)
+{
+    typedef typename boost::graph_traits<Graph>::vertex_descriptor vertex_t;
+    std::vector<vertex_t> vs;
+    for (auto v : vertices_range(g))
+        vs.push_back(v);
+    parallel_ms_bfs_no_spawn(g, vs, std::forward<F>(f));
+}
+
+template <class Graph, class F>
+void parallel_ms_bfs(const Graph& g, F&& f)
+{
+    #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
+    parallel_ms_bfs_no_spawn(g, std::forward<F>(f));
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_MS_BFS_HH
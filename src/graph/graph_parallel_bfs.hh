@@ -0,0 +1,263 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2016 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_PARALLEL_BFS_HH
+#define GRAPH_PARALLEL_BFS_HH
+
+#include <vector>
+#include <atomic>
+#include <limits>
+
+#include "graph_selectors.hh"
+#include "graph_util.hh"
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
+namespace graph_tool
+{
+
+// Level-synchronous breadth-first search, in which every level is expanded in
+// parallel. Each level is expanded either "top-down", i.e. by scanning the
+// out-edges of the vertices in the current frontier, or "bottom-up", i.e. by
+// scanning the in-edges (or all edges, if the graph is undirected) of every
+// unvisited vertex, until a parent in the frontier is found. The latter is
+// much cheaper when the frontier contains a large fraction of the edges, which
+// happens for the middle levels of searches in small-world graphs. The
+// direction is chosen for each level according to the heuristic of
+// S. Beamer, K. Asanović, D. Patterson, "Direction-optimizing breadth-first
+// search", SC '12.
+//
+// The function visit(v, u, d) is called once for every vertex v reached from
+// the source, where u is a parent of v in the search tree and d is the distance
+// of v from the source. It is called concurrently for the vertices of the same
+// level, after the level is complete. If more than one parent is available,
+// the one chosen is the first in the in-edge list of v if the level was
+// expanded bottom-up, or the one with the smallest index if it was expanded
+// top-down. Since the direction of each level depends only on the graph and
+// the source, the search tree does not depend on the number of threads or on
+// their scheduling. The search stops after the level max_dist, or before if
+// stop() returns true after the completion of a level.
+//
+// The O(N) buffers are allocated when the object is constructed, and reset
+// after each search only at the vertices that were reached, so that a single
+// object should be reused for searches from many sources. When run inside a
+// parallel region (e.g. by a loop over many sources, with one object per
+// thread), the search runs serially, but still switches directions.
+
+template <class Graph>
+class parallel_bfs_search
+{
+public:
+    typedef typename boost::graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    parallel_bfs_search(const Graph& g)
+        : _g(g), _N(num_vertices(g)), _level(_N), _parent(_N), _m(0)
+    {
+        bool parallel = is_parallel();
+        #pragma omp parallel for schedule(static) if (parallel)
+        for (size_t i = 0; i < _N; ++i)
+        {
+            _level[i].store(_inf, std::memory_order_relaxed);
+            _parent[i].store(_inf, std::memory_order_relaxed);
+        }
+
+        size_t m = 0;
+        #pragma omp parallel for schedule(static) if (parallel) \
+            reduction(+:m)
+        for (size_t i = 0; i < _N; ++i)
+        {
+            auto v = vertex(i, g);
+            if (is_valid_vertex(v, g))
+                m += out_degreeS()(v, g);
+        }
+        _m = m;
+    }
+
+    template <class Visit, class Stop>
+    void run(vertex_t s, size_t max_dist, Visit&& visit, Stop&& stop)
+    {
+        const Graph& g = _g;
+        size_t N = _N;
+        bool parallel = is_parallel();
+
+        // parameters used by Beamer et al.
+        const size_t alpha = 15;
+        const size_t beta = 18;
+
+        _frontier.assign(1, s);
+        _next.clear();
+        _reached.assign(1, s);
+        _level[s] = 0;
+
+        // number of edges which remain to be scanned by a top-down search
+        size_t m_f = out_degreeS()(s, g);
+        size_t m_u = _m - m_f;
+        bool bottom_up = false;
+
+        for (size_t d = 0; d < max_dist && !_frontier.empty(); ++d)
+        {
+            if (!bottom_up)
+                bottom_up = m_f > m_u / alpha;
+            else
+                bottom_up = !(_frontier.size() < _next.size() &&
+                              _frontier.size() < N / beta);
+
+            size_t m = 0;
+            _next.clear();
+            #pragma omp parallel if (parallel) reduction(+:m)
+            {
+                std::vector<vertex_t> local;
+
+                if (bottom_up)
+                {
+                    #pragma omp for schedule(runtime)
+                    for (size_t i = 0; i < N; ++i)
+                    {
+                        auto v = vertex(i, g);
+                        if (!is_valid_vertex(v, g) ||
+                            _level[v].load(std::memory_order_relaxed) != _inf)
+                            continue;
+                        for (const auto& e : in_or_out_edges_range(v, g))
+                        {
+                            auto u = source(e, g);
+                            if (u == v)
+                                u = target(e, g);
+                            if (_level[u].load(std::memory_order_relaxed) != d)
+                                continue;
+                            _level[v].store(d + 1, std::memory_order_relaxed);
+                            _parent[v].store(u, std::memory_order_relaxed);
+                            local.push_back(v);
+                            m += out_degreeS()(v, g);
+                            break;
+                        }
+                    }
+                }
+                else
+                {
+                    #pragma omp for schedule(runtime)
+                    for (size_t i = 0; i < _frontier.size(); ++i)
+                    {
+                        auto u = _frontier[i];
+                        for (auto v : out_neighbours_range(u, g))
+                        {
+                            size_t l = _level[v].load(std::memory_order_relaxed);
+                            if (l == _inf &&
+                                _level[v].compare_exchange_strong
+                                    (l, d + 1, std::memory_order_relaxed))
+                            {
+                                local.push_back(v);
+                                m += out_degreeS()(v, g);
+                                l = d + 1;
+                            }
+                            if (l != d + 1)
+                                continue;
+
+                            // smallest parent
+                            size_t p = _parent[v].load(std::memory_order_relaxed);
+                            while (size_t(u) < p &&
+                                   !_parent[v].compare_exchange_weak
+                                       (p, u, std::memory_order_relaxed));
+                        }
+                    }
+                }
+
+                #pragma omp critical (parallel_bfs_frontier)
+                _next.insert(_next.end(), local.begin(), local.end());
+            }
+
+            #pragma omp parallel for schedule(runtime) if (parallel)
+            for (size_t i = 0; i < _next.size(); ++i)
+            {
+                auto v = _next[i];
+                visit(v, vertex_t(_parent[v].load(std::memory_order_relaxed)),
+                      d + 1);
+            }
+            _reached.insert(_reached.end(), _next.begin(), _next.end());
+
+            // "_next" keeps the size of the previous frontier, to detect when
+            // it starts to shrink
+            _frontier.swap(_next);
+            m_f = m;
+            m_u -= std::min(m_u, m_f);
+
+            if (stop())
+                break;
+        }
+
+        #pragma omp parallel for schedule(static) \
+            if (parallel && _reached.size() > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < _reached.size(); ++i)
+        {
+            auto v = _reached[i];
+            _level[v].store(_inf, std::memory_order_relaxed);
+            _parent[v].store(_inf, std::memory_order_relaxed);
+        }
+    }
+
+    template <class Visit>
+    void run(vertex_t s, size_t max_dist, Visit&& visit)
+    {
+        run(s, max_dist, std::forward<Visit>(visit), []() { return false; });
+    }
+
+private:
+    bool is_parallel() const
+    {
+        bool parallel = _N > OPENMP_MIN_THRESH;
+#ifdef USING_OPENMP
+        if (omp_in_parallel())
+            parallel = false;
+#endif
+        return parallel;
+    }
+
+    static constexpr size_t _inf = std::numeric_limits<size_t>::max();
+
+    const Graph& _g;
+    size_t _N;
+    std::vector<std::atomic<size_t>> _level, _parent;
+    std::vector<vertex_t> _frontier, _next, _reached;
+    size_t _m; // total number of out-edges
+};
+
+template <class Graph>
+constexpr size_t parallel_bfs_search<Graph>::_inf;
+
+// Single search, which allocates its own buffers.
+template <class Graph, class Visit, class Stop>
+void parallel_bfs(const Graph& g,
+                  typename boost::graph_traits<Graph>::vertex_descriptor s,
+                  size_t max_dist, Visit&& visit, Stop&& stop)
+{
+    parallel_bfs_search<Graph> bfs(g);
+    bfs.run(s, max_dist, std::forward<Visit>(visit), std::forward<Stop>(stop));
+}
+
+template <class Graph, class Visit>
+void parallel_bfs(const Graph& g,
+                  typename boost::graph_traits<Graph>::vertex_descriptor s,
+                  size_t max_dist, Visit&& visit)
+{
+    parallel_bfs(g, s, max_dist, std::forward<Visit>(visit),
+                 []() { return false; });
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_PARALLEL_BFS_HH
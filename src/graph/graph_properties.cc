@@ -68,6 +68,7 @@ struct do_shift_vertex_property
 void GraphInterface::shift_vertex_property(boost::any prop, python::object oindex) const
 {
     boost::multi_array_ref<int64_t,1> index = get_array<int64_t,1>(oindex);
+    _mg->materialize();
     bool found = false;
     mpl::for_each<writable_vertex_properties>
         (std::bind(do_shift_vertex_property(), std::placeholders::_1,
@@ -101,6 +102,7 @@ struct do_move_vertex_property
 void GraphInterface::move_vertex_property(boost::any prop, python::object oindex) const
 {
     boost::multi_array_ref<int64_t,1> index = get_array<int64_t,1>(oindex);
+    _mg->materialize();
     size_t back = num_vertices(*_mg) - 1;
     bool found = false;
     mpl::for_each<writable_vertex_properties>
@@ -139,6 +141,7 @@ void GraphInterface::re_index_vertex_property(boost::any map,
     typedef vprop_map_t<int64_t>::type index_prop_t;
     index_prop_t old_index = any_cast<index_prop_t>(aold_index);
 
+    _mg->materialize();
     bool found = false;
     mpl::for_each<writable_vertex_properties>
         (std::bind(reindex_vertex_property(), std::placeholders::_1, std::ref(*_mg),
@@ -250,6 +250,17 @@ struct get_edge_dispatch
                     bool all_edges, boost::python::list& es) const
     {
         auto gp = retrieve_graph_view<Graph>(gi, g);
+
+        // use the edge hash, if available; this will only find a single
+        // edge, which may be masked if edge filtering is active
+        if (!all_edges && gi.get_keep_ehash() && !gi.is_edge_filter_active())
+        {
+            auto e = edge(vertex(s, g), vertex(t, g), g);
+            if (e.second)
+                es.append(PythonEdge<Graph>(gp, e.first));
+            return;
+        }
+
         size_t k_t = is_directed::apply<Graph>::type::value ?
             in_degreeS()(t, g) : out_degree(t, g);
         if (out_degree(s, g) <= k_t)
@@ -96,6 +96,66 @@ struct add_edge_list
     };
 };
 
+// Inserts the edges directly in the underlying adjacency list, in parallel;
+// this is only possible if there are no active filters.
+struct add_edge_list_bulk
+{
+    template <class Value>
+    void operator()(Value, GraphInterface::multigraph_t& g, bool reversed,
+                    python::object& aedge_list, python::object& oeprops,
+                    bool& found) const
+    {
+        if (found)
+            return;
+        try
+        {
+            boost::multi_array_ref<Value, 2> edge_list = get_array<Value, 2>(aedge_list);
+
+            if (edge_list.shape()[1] < 2)
+                throw GraphException("Second dimension in edge list must be of size (at least) two");
+
+            typedef GraphInterface::edge_t edge_t;
+            vector<DynamicPropertyMapWrap<Value, edge_t>> eprops;
+
+            // python objects cannot be created without the GIL
+            bool parallel = true;
+            python::stl_input_iterator<boost::any> iter(oeprops), end;
+            for (; iter != end; ++iter)
+            {
+                boost::any aprop = *iter;
+                if (aprop.type() == typeid(eprop_map_t<python::object>::type))
+                    parallel = false;
+                eprops.emplace_back(aprop, writable_edge_properties());
+            }
+
+            size_t n_props = std::min(eprops.size(), edge_list.shape()[1] - 2);
+
+            size_t c_s = reversed ? 1 : 0;
+            size_t c_t = reversed ? 0 : 1;
+            g.add_edges(edge_list.shape()[0],
+                        [&](size_t i) { return size_t(edge_list[i][c_s]); },
+                        [&](size_t i) { return size_t(edge_list[i][c_t]); },
+                        [&](size_t i, const edge_t& e)
+                        {
+                            for (size_t j = 0; j < n_props; ++j)
+                            {
+                                try
+                                {
+                                    put(eprops[j], e, edge_list[i][j + 2]);
+                                }
+                                catch(bad_lexical_cast&)
+                                {
+                                    throw ValueException("Invalid edge property value: " +
+                                                         lexical_cast<string>(edge_list[i][j + 2]));
+                                }
+                            }
+                        }, parallel);
+            found = true;
+        }
+        catch (InvalidNumpyConversion& e) {}
+    }
+};
+
 void do_add_edge_list(GraphInterface& gi, python::object aedge_list,
                       python::object eprops)
 {
@@ -103,9 +163,21 @@ void do_add_edge_list(GraphInterface& gi, python::object aedge_list,
                         int8_t, int16_t, int32_t, int64_t, uint64_t, double,
                         long double> vals_t;
     bool found = false;
-    run_action<>()(gi, std::bind(add_edge_list<vals_t>(), std::placeholders::_1,
-                                 aedge_list, std::ref(eprops),
-                                 std::ref(found)))();
+    if (!gi.is_vertex_filter_active() && !gi.is_edge_filter_active())
+    {
+        bool reversed = gi.get_directed() && gi.get_reversed();
+        mpl::for_each<vals_t>(std::bind(add_edge_list_bulk(),
+                                        std::placeholders::_1,
+                                        std::ref(gi.get_graph()), reversed,
+                                        std::ref(aedge_list), std::ref(eprops),
+                                        std::ref(found)));
+    }
+    else
+    {
+        run_action<>()(gi, std::bind(add_edge_list<vals_t>(),
+                                     std::placeholders::_1, aedge_list,
+                                     std::ref(eprops), std::ref(found)))();
+    }
     if (!found)
         throw GraphException("Invalid type for edge list; must be two-dimensional with a scalar type");
 }
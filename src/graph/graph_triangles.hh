@@ -0,0 +1,255 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2016 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_TRIANGLES_HH
+#define GRAPH_TRIANGLES_HH
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "graph_selectors.hh"
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+
+// Calls f(i, j) for every pair of positions with a[i] == b[j], where a and b
+// are sorted ranges, and a has no repeated elements (b may have them, in which
+// case f is called once for each repetition). If one of the ranges is much
+// shorter than the other, its elements are looked up in the longer one by
+// binary search ("galloping"), otherwise both are merged linearly.
+
+template <class IterA, class IterB, class F>
+void sorted_intersection(IterA a, IterA a_end, IterB b, IterB b_end, F&& f)
+{
+    size_t na = a_end - a;
+    size_t nb = b_end - b;
+
+    if (na * 32 < nb)
+    {
+        auto pos = b;
+        for (size_t i = 0; i < na && pos != b_end; ++i)
+        {
+            pos = std::lower_bound(pos, b_end, a[i]);
+            for (; pos != b_end && *pos == a[i]; ++pos)
+                f(i, size_t(pos - b));
+        }
+        return;
+    }
+
+    if (nb * 32 < na)
+    {
+        auto pos = a;
+        for (size_t j = 0; j < nb && pos != a_end; ++j)
+        {
+            pos = std::lower_bound(pos, a_end, b[j]);
+            if (pos != a_end && *pos == b[j])
+                f(size_t(pos - a), j);
+        }
+        return;
+    }
+
+    size_t i = 0, j = 0;
+    while (i < na && j < nb)
+    {
+        auto x = a[i];
+        auto y = b[j];
+        if (x == y)
+            f(i, j);
+        i += (x < y);
+        j += (y <= x);
+    }
+}
+
+// Triangle counts of a graph, obtained in a single parallel pass, as in
+// T. Schank, D. Wagner, "Finding, counting and listing all triangles in large
+// graphs, an experimental study", WEA '05.
+//
+// Parallel edges, self-loops and edge directions are ignored, i.e. the counts
+// refer to the simple undirected graph with the same connected vertex pairs.
+// Each edge is oriented from the endpoint with the smaller degree to the one
+// with the larger degree (with ties broken by the vertex index), and the
+// out-neighbours of every vertex are kept sorted, in a contiguous array. Every
+// triangle is then found exactly once, by intersecting the out-neighbours of
+// its two lowest-ranked vertices. Since every vertex has at most O(sqrt(E))
+// out-neighbours, the total work is O(E^{3/2}), instead of O(sum_v k_v^2)
+// when the full neighbourhoods are scanned.
+//
+// If edge_counts == true, the number of triangles to which each (oriented)
+// edge belongs is also accumulated in the same pass, and can be retrieved with
+// edge_triangles().
+
+template <class Graph>
+class triangle_counts
+{
+public:
+    typedef typename boost::graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    triangle_counts(const Graph& g, bool edge_counts = false)
+        : _deg(num_vertices(g), 0), _tri(num_vertices(g), 0)
+    {
+        size_t N = num_vertices(g);
+
+        // sorted, distinct neighbours of every vertex, in slots with the
+        // size of its full adjacency list
+        std::vector<size_t> slot(N + 1, 0);
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto v = vertex(i, g);
+            slot[i + 1] = slot[i];
+            if (is_valid_vertex(v, g))
+                slot[i + 1] += total_degreeS()(v, g);
+        }
+        std::vector<size_t> ns(slot.back());
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 auto begin = ns.begin() + slot[v];
+                 auto end = begin;
+                 for (const auto& e : all_edges_range(v, g))
+                 {
+                     vertex_t u = source(e, g);
+                     if (u == v)
+                         u = target(e, g);
+                     if (u == v)
+                         continue;
+                     *(end++) = u;
+                 }
+                 std::sort(begin, end);
+                 _deg[v] = std::unique(begin, end) - begin;
+             });
+
+        // keep only the out-neighbours of the degree orientation
+        _pos.resize(N + 1, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 auto begin = ns.begin() + slot[v];
+                 auto end = std::remove_if(begin, begin + _deg[v],
+                                           [&](auto u)
+                                           { return !is_forward(v, u); });
+                 _pos[v + 1] = end - begin;
+             });
+        for (size_t i = 0; i < N; ++i)
+            _pos[i + 1] += _pos[i];
+
+        _out.resize(_pos.back());
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 auto begin = ns.begin() + slot[v];
+                 std::copy(begin, begin + (_pos[v + 1] - _pos[v]),
+                           _out.begin() + _pos[v]);
+             });
+        std::vector<size_t>().swap(ns);
+
+        if (edge_counts)
+            _etri.resize(_out.size(), 0);
+
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t v = 0; v < N; ++v)
+        {
+            auto vb = _out.begin() + _pos[v];
+            auto ve = _out.begin() + _pos[v + 1];
+            size_t t_v = 0;
+            for (size_t i = _pos[v]; i < _pos[v + 1]; ++i)
+            {
+                size_t u = _out[i];
+                size_t t_u = 0;
+                sorted_intersection
+                    (vb, ve, _out.begin() + _pos[u], _out.begin() + _pos[u + 1],
+                     [&](size_t j, size_t k)
+                     {
+                         size_t w = vb[j];
+                         ++t_u;
+                         #pragma omp atomic
+                         _tri[w]++;
+                         if (edge_counts)
+                         {
+                             #pragma omp atomic
+                             _etri[_pos[v] + j]++;
+                             #pragma omp atomic
+                             _etri[_pos[u] + k]++;
+                         }
+                     });
+                if (t_u == 0)
+                    continue;
+                t_v += t_u;
+                #pragma omp atomic
+                _tri[u] += t_u;
+                if (edge_counts)
+                {
+                    #pragma omp atomic
+                    _etri[i] += t_u;
+                }
+            }
+            if (t_v > 0)
+            {
+                #pragma omp atomic
+                _tri[v] += t_v;
+            }
+        }
+    }
+
+    // number of triangles to which v belongs
+    size_t triangles(vertex_t v) const { return _tri[v]; }
+
+    // number of distinct neighbours of v, other than itself
+    size_t degree(vertex_t v) const { return _deg[v]; }
+
+    // number of pairs of distinct neighbours of v
+    size_t wedges(vertex_t v) const
+    {
+        size_t k = _deg[v];
+        return (k * (k - 1)) / 2;
+    }
+
+    // number of triangles to which the edge (u, v) belongs, or zero if u and v
+    // are not adjacent; requires edge_counts == true
+    size_t edge_triangles(vertex_t u, vertex_t v) const
+    {
+        if (!is_forward(u, v))
+            std::swap(u, v);
+        auto begin = _out.begin() + _pos[u];
+        auto end = _out.begin() + _pos[u + 1];
+        auto iter = std::lower_bound(begin, end, size_t(v));
+        if (iter == end || *iter != v)
+            return 0;
+        return _etri[iter - _out.begin()];
+    }
+
+private:
+    bool is_forward(size_t v, size_t u) const
+    {
+        return (_deg[v] < _deg[u]) || (_deg[v] == _deg[u] && v < u);
+    }
+
+    std::vector<size_t> _deg;
+    std::vector<size_t> _tri;
+    std::vector<size_t> _pos;
+    std::vector<size_t> _out;
+    std::vector<size_t> _etri;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_TRIANGLES_HH
@@ -167,6 +167,19 @@ protected:
     std::array<bool,Dim> _const_width;
 };
 
+// Converts the bin edges of a one-dimensional histogram, as given from python,
+// to its value type
+template <class ValueType>
+std::array<std::vector<ValueType>, 1>
+get_hist_bins(const std::vector<long double>& obins)
+{
+    std::array<std::vector<ValueType>, 1> bins;
+    bins[0].resize(obins.size());
+    for (size_t i = 0; i < obins.size(); ++i)
+        bins[0][i] = obins[i];
+    return bins;
+}
+
 
 // This class will encapsulate a histogram, and atomically sum it to a given
 // resulting histogram (which is shared among all copies) after it is
@@ -22,77 +22,99 @@ namespace graph_tool
 
 using namespace std;
 
-vector<double> __safelog_cache;
-vector<double> __xlogx_cache;
-vector<double> __lgamma_cache;
+constexpr size_t lazy_cache::base_bits;
+constexpr size_t lazy_cache::n_chunks;
+constexpr size_t lazy_cache::max_size;
 
-void init_safelog(size_t x)
+const double* lazy_cache::fill(size_t c)
 {
-    #pragma omp critical (_safelog_)
+    size_t begin = ((size_t(1) << c) - 1) << base_bits;
+    size_t n = size_t(1) << (c + base_bits);
+    double* chunk = new double[n];
+    for (size_t i = 0; i < n; ++i)
+        chunk[i] = _f(begin + i);
+
+    // if another thread has published the same chunk in the meantime, ours is
+    // discarded
+    double* expected = nullptr;
+    if (!_chunks[c].compare_exchange_strong(expected, chunk,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_acquire))
     {
-        size_t old_size = __safelog_cache.size();
-        if (x >= old_size)
-        {
-            __safelog_cache.resize(x + 1);
-            for (size_t i = old_size; i < __safelog_cache.size(); ++i)
-                __safelog_cache[i] = safelog(double(i));
-        }
+        delete[] chunk;
+        return expected;
     }
+    return chunk;
 }
 
-void clear_safelog()
+void lazy_cache::init(size_t x)
 {
-    vector<double>().swap(__safelog_cache);
+    double val;
+    x = std::min(x, max_size - 1);
+    for (size_t c = 0; c < n_chunks; ++c)
+    {
+        size_t begin = ((size_t(1) << c) - 1) << base_bits;
+        if (begin > x)
+            break;
+        get(begin, val);
+    }
 }
 
+void lazy_cache::clear()
+{
+    for (auto& chunk : _chunks)
+        delete[] chunk.exchange(nullptr);
+}
 
-void init_xlogx(size_t x)
+static double compute_safelog(size_t x)
 {
-    #pragma omp critical (_xlogx_)
-    {
-        size_t old_size = __xlogx_cache.size();
-        if (x >= old_size)
-        {
-            __xlogx_cache.resize(x + 1);
-            for (size_t i = old_size; i < __xlogx_cache.size(); ++i)
-                __xlogx_cache[i] = i * safelog(i);
-        }
-    }
+    return safelog(double(x));
 }
 
-void clear_xlogx()
+static double compute_xlogx(size_t x)
 {
-    vector<double>().swap(__xlogx_cache);
+    return x * safelog(double(x));
 }
 
-void init_lgamma(size_t x)
+static double compute_lgamma(size_t x)
 {
-    using namespace boost::math::policies;
-    #pragma omp critical (_lgamma_)
-    {
+    if (x == 0)
+        return numeric_limits<double>::infinity();
+    return boost::math::lgamma(double(x));
+}
 
-        size_t old_size = __lgamma_cache.size();
-        if (x >= old_size)
-        {
-            __lgamma_cache.resize(x + 1);
-            if (old_size == 0)
-                __lgamma_cache[0] = numeric_limits<double>::infinity();
-            for (size_t i = std::max(old_size, size_t(1)); i < __lgamma_cache.size(); ++i)
-                __lgamma_cache[i] = boost::math::lgamma(i);
-        }
-    }
+lazy_cache __safelog_cache(compute_safelog);
+lazy_cache __xlogx_cache(compute_xlogx);
+lazy_cache __lgamma_cache(compute_lgamma);
+
+void init_safelog(size_t x)
+{
+    __safelog_cache.init(x);
 }
 
-void clear_lgamma()
+void clear_safelog()
+{
+    __safelog_cache.clear();
+}
+
+void init_xlogx(size_t x)
+{
+    __xlogx_cache.init(x);
+}
+
+void clear_xlogx()
+{
+    __xlogx_cache.clear();
+}
+
+void init_lgamma(size_t x)
 {
-    vector<double>().swap(__lgamma_cache);
+    __lgamma_cache.init(x);
 }
 
-void init_cache(size_t E)
+void clear_lgamma()
 {
-    init_lgamma(2 * E);
-    init_xlogx(2 * E);
-    init_safelog(2 * E);
+    __lgamma_cache.clear();
 }
 
 
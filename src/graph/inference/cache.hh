@@ -22,6 +22,7 @@
 
 #include <vector>
 #include <cmath>
+#include <atomic>
 
 #include <boost/math/special_functions/gamma.hpp>
 
@@ -31,12 +32,58 @@ using namespace std;
 
 // Repeated computation of x*log(x) and log(x) actually adds up to a lot of
 // time. A significant speedup can be made by caching pre-computed values.
-
-extern vector<double> __safelog_cache;
-extern vector<double> __xlogx_cache;
-extern vector<double> __lgamma_cache;
-
-void init_safelog(size_t x);
+//
+// The values are stored in a sequence of chunks, where chunk c contains the
+// values for the arguments in [(2^c - 1) B, (2^(c+1) - 1) B), with B =
+// 2^base_bits. A chunk is computed the first time one of its values is
+// requested, and is published with an atomic compare-and-swap, after which it
+// is never modified, so that the cache can be read and grown concurrently
+// without locks. Arguments beyond the last chunk are not cached, and the value
+// is computed directly.
+
+class lazy_cache
+{
+public:
+    typedef double (*func_t)(size_t);
+
+    static constexpr size_t base_bits = 10;
+    static constexpr size_t n_chunks = 12;
+    static constexpr size_t max_size =
+        ((size_t(1) << n_chunks) - 1) << base_bits;
+
+    constexpr lazy_cache(func_t f) : _f(f), _chunks{} {}
+    ~lazy_cache() { clear(); }
+
+    // returns false if x is not cached, in which case val is left untouched
+    bool get(size_t x, double& val)
+    {
+        if (x >= max_size)
+            return false;
+        size_t i = (x >> base_bits) + 1;
+        size_t c = 63 - __builtin_clzll(i);
+        const double* chunk = _chunks[c].load(std::memory_order_acquire);
+        if (chunk == nullptr)
+            chunk = fill(c);
+        val = chunk[x - (((size_t(1) << c) - 1) << base_bits)];
+        return true;
+    }
+
+    // computes all the chunks which contain arguments up to x
+    void init(size_t x);
+
+    // frees the memory, which must not happen concurrently with get()
+    void clear();
+
+private:
+    const double* fill(size_t c);
+
+    func_t _f;
+    std::atomic<double*> _chunks[n_chunks];
+};
+
+extern lazy_cache __safelog_cache;
+extern lazy_cache __xlogx_cache;
+extern lazy_cache __lgamma_cache;
 
 template <class Type>
 inline double safelog(Type x)
@@ -48,32 +95,47 @@ inline double safelog(Type x)
 
 inline double safelog(size_t x)
 {
-    if (x >= __safelog_cache.size())
-        init_safelog(x);
-    return __safelog_cache[x];
+    double val;
+    if (__safelog_cache.get(x, val))
+        return val;
+    return log(x);
 }
 
-void init_xlogx(size_t x);
-
 inline double xlogx(size_t x)
 {
     //return x * safelog(x);
-    if (x >= __xlogx_cache.size())
-        init_xlogx(x);
-    return __xlogx_cache[x];
+    double val;
+    if (__xlogx_cache.get(x, val))
+        return val;
+    return x * log(x);
 }
 
-void init_lgamma(size_t x);
+// Stirling's series for log(Gamma(x)), which is accurate to machine precision
+// for the uncached arguments of lgamma_fast()
+inline double lgamma_stirling(double x)
+{
+    double ix = 1. / x;
+    double ix2 = ix * ix;
+    return (x - 0.5) * log(x) - x + 0.91893853320467274178 +
+        ix * (1. / 12 - ix2 * (1. / 360 - ix2 * (1. / 1260)));
+}
 
 inline double lgamma_fast(size_t x)
 {
     //return lgamma(x);
-    if (x >= __lgamma_cache.size())
-        init_lgamma(x);
-    return __lgamma_cache[x];
+    double val;
+    if (__lgamma_cache.get(x, val))
+        return val;
+    return lgamma_stirling(x);
 }
 
-void init_cache(size_t E);
+void init_safelog(size_t x);
+void init_xlogx(size_t x);
+void init_lgamma(size_t x);
+
+void clear_safelog();
+void clear_xlogx();
+void clear_lgamma();
 
 } // graph_tool namespace
 
@@ -45,7 +45,6 @@ auto gibbs_sweep(GibbsState state, RNG& rng_)
     if (state._parallel)
     {
         init_rngs(rngs, rng_);
-        init_cache(state._E);
         best_move.resize(num_vertices(g));
     }
 
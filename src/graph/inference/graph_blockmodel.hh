@@ -185,25 +185,32 @@ public:
     }
 
 
-    template <bool Add, class EFilt, class GetB>
-    void modify_vertex(size_t v, size_t r, EFilt&& efilt, GetB&& get_b)
+    template <bool Add, class EFilt, class GetB, class MEntries>
+    void modify_vertex(size_t v, size_t r, EFilt&& efilt, GetB&& get_b,
+                       MEntries& m_entries)
     {
-        _m_entries.clear();
+        m_entries.clear();
         if (Add)
-            get_move_entries(v, null_group, r, _m_entries, efilt, get_b);
+            get_move_entries(v, null_group, r, m_entries, efilt, get_b);
         else
-            get_move_entries(v, r, null_group, _m_entries, efilt, get_b);
+            get_move_entries(v, r, null_group, m_entries, efilt, get_b);
 
-        entries_op(_m_entries, _emat,
+        entries_op(m_entries, _emat,
                    [&](auto r, auto s, auto& me, auto& delta)
                    {
                        if (Add && me == this->_emat.get_null_edge())
                        {
-                           me = add_edge(r, s, this->_bg).first;
+                           // the block graph and the size of its edge
+                           // properties are shared by concurrent moves (see
+                           // reserve_moves())
+                           #pragma omp critical (block_graph_add_edge)
+                           {
+                               me = add_edge(r, s, this->_bg).first;
+                               this->_c_mrs[me] = 0;
+                               this->_c_brec[me] = 0;
+                               this->_c_bdrec[me] = 0;
+                           }
                            _emat.put_me(r, s, me);
-                           this->_c_mrs[me] = 0;
-                           this->_c_brec[me] = 0;
-                           this->_c_bdrec[me] = 0;
                        }
 
                        this->_mrs[me] += get<0>(delta);
@@ -244,6 +251,12 @@ public:
         }
     }
 
+    template <bool Add, class EFilt, class GetB>
+    void modify_vertex(size_t v, size_t r, EFilt&& efilt, GetB&& get_b)
+    {
+        modify_vertex<Add>(v, r, efilt, get_b, _m_entries);
+    }
+
     void remove_partition_node(size_t v, size_t r)
     {
         auto& gs = *_gstate;
@@ -467,9 +480,10 @@ public:
             return ((_bclabel[r] == _bclabel[nr]));
     }
 
-    // move a vertex from its current block to block nr
-    template <class GetB>
-    void move_vertex(size_t v, size_t nr, GetB&& get_b)
+    // move a vertex from its current block to block nr, using the given
+    // buffer for the edge count entries
+    template <class GetB, class MEntries>
+    void move_vertex(size_t v, size_t nr, GetB&& get_b, MEntries& m_entries)
     {
         size_t r = get_b(v);
 
@@ -479,8 +493,9 @@ public:
         if (!allow_move(r, nr))
             throw ValueException("cannot move vertex across clabel barriers");
 
-        remove_vertex(v, r, [](auto&) {return false;}, get_b);
-        add_vertex(v, nr, [](auto&) {return false;}, get_b);
+        auto efilt = [](auto&) {return false;};
+        modify_vertex<false>(v, r, efilt, get_b, m_entries);
+        modify_vertex<true>(v, nr, efilt, get_b, m_entries);
 
         if (_coupled_state != nullptr && _vweight[v] > 0)
         {
@@ -499,6 +514,12 @@ public:
         }
     }
 
+    template <class GetB>
+    void move_vertex(size_t v, size_t nr, GetB&& get_b)
+    {
+        move_vertex(v, nr, get_b, _m_entries);
+    }
+
     void move_vertex(size_t v, size_t nr)
     {
         move_vertex(v, nr, [&](auto u) -> auto& { return this->_b[u]; });
@@ -1280,6 +1301,58 @@ public:
         return _vweight[v];
     }
 
+    // Calls f(t) for the current block of v and the blocks of its neighbours.
+    // These, together with the target block, are the only blocks which are
+    // read by the proposal of v, or modified when v is moved, unless the move
+    // changes the set of occupied blocks (see is_occupation_move()). The same
+    // holds for the virtual move, except for the dense entropy, which depends
+    // on the sizes of all blocks. This is used to find conflicts between moves
+    // in parallel sweeps.
+    template <class F>
+    void visit_move_blocks(size_t v, F&& f)
+    {
+        f(_b[v]);
+        for (auto e : out_edges_range(v, _g))
+            f(_b[target(e, _g)]);
+        if (is_directed::apply<g_t>::type::value)
+        {
+            for (auto e : in_edges_range(v, _g))
+                f(_b[source(e, _g)]);
+        }
+    }
+
+    // Returns true if moving v to block nr vacates its current block, or
+    // occupies an empty one.
+    bool is_occupation_move(size_t v, size_t nr)
+    {
+        return _wr[_b[v]] == _vweight[v] || _wr[nr] == 0;
+    }
+
+    // Moves which involve disjoint sets of blocks, and which do not change
+    // the set of occupied blocks, can be performed concurrently, each with its
+    // own entry buffer (see move_vertex()), if there is a single partition
+    // (otherwise the partition statistics may be resized), and after the
+    // storage of the edge properties of the block graph is given enough
+    // capacity for the edges which may be created by the moves, so that it is
+    // not reallocated. The edges themselves are added to the block graph in a
+    // critical section.
+    bool allow_concurrent_moves()
+    {
+        return _partition_stats.size() <= 1;
+    }
+
+    template <class Moves>
+    void reserve_moves(const Moves& moves)
+    {
+        size_t n = 0;
+        for (auto& m : moves)
+            n += total_degreeS()(get<0>(m), _g) + 1;
+        auto reserve = [n](auto& store) { store.reserve(store.size() + n); };
+        reserve(_c_mrs.get_storage());
+        reserve(_c_brec.get_storage());
+        reserve(_c_bdrec.get_storage());
+    }
+
     // =========================================================================
     // Entropy computation
     // =========================================================================
@@ -168,6 +168,11 @@ struct Layers
         size_t _actual_B;
         bool _is_partition_stats_enabled;
 
+        // the moves also change the layer states, so that the blocks they
+        // involve are not only those reported by the base state
+        template <class F>
+        void visit_move_blocks(size_t v, F&& f) = delete;
+
         void move_vertex(size_t v, size_t s)
         {
             if (BaseState::_vweight[v] == 0)
@@ -265,7 +265,8 @@ void collect_partitions(boost::any ob, PartitionHist& h, size_t update)
 {
     typedef vprop_map_t<int32_t>::type vmap_t;
     auto b = any_cast<vmap_t>(ob);
-    auto& v = b.get_storage();
+    auto& vb = b.get_storage();
+    vector<int32_t> v(vb.begin(), vb.end());
     h[v] += update;
 }
 
@@ -125,6 +125,45 @@ struct MCMC
         {
             _state.move_vertex(v, nr);
         }
+
+        // only available if the underlying state supports it
+        template <class F, class S = state_t>
+        auto visit_move_blocks(size_t v, F&& f)
+            -> decltype(std::declval<S&>().visit_move_blocks(v, f))
+        {
+            return _state.visit_move_blocks(v, f);
+        }
+
+        bool is_occupation_move(size_t v, size_t nr)
+        {
+            return _state.is_occupation_move(v, nr);
+        }
+
+        // the dense entropy depends on the sizes of all blocks
+        bool is_local_move_dS()
+        {
+            return !_entropy_args.dense;
+        }
+
+        bool allow_concurrent_moves()
+        {
+            return _state.allow_concurrent_moves();
+        }
+
+        template <class Moves>
+        void reserve_moves(const Moves& moves)
+        {
+            _state.reserve_moves(moves);
+        }
+
+        // performs the move with this copy's own entry buffer, so that it can
+        // run concurrently with other moves (see reserve_moves())
+        void perform_concurrent_move(size_t v, size_t nr)
+        {
+            _state.move_vertex(v, nr,
+                               [&](auto u) -> auto& { return _state._b[u]; },
+                               _m_entries);
+        }
     };
 };
 
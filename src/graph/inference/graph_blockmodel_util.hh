@@ -731,6 +731,10 @@ public:
             _actual_B--;
 
         _total[r] += diff * vweight;
+
+        // moves of vertices between different blocks may be performed
+        // concurrently
+        #pragma omp atomic
         _N += diff * vweight;
 
         assert(_total[r] >= 0);
@@ -24,6 +24,7 @@
 #include <queue>
 
 #include <tuple>
+#include <type_traits>
 
 #include "hash_map_wrap.hh"
 #include "parallel_rng.hh"
@@ -34,8 +35,50 @@
 namespace graph_tool
 {
 
+// Whether the state reports the blocks involved in a vertex move, via
+// visit_move_blocks() and is_occupation_move(), which enables the
+// conflict-free parallel sweep below. Such a state must also provide
+// is_local_move_dS(), allow_concurrent_moves(), reserve_moves() and
+// perform_concurrent_move().
+
+struct block_visitor_t
+{
+    void operator()(size_t) {}
+};
+
+template <class State, class = void>
+struct has_move_blocks : std::false_type {};
+
+template <class State>
+struct has_move_blocks
+    <State, decltype(std::declval<State&>()
+                     .visit_move_blocks(size_t(),
+                                        std::declval<block_visitor_t&>()),
+                     void())>
+    : std::true_type {};
+
+template <class RNG>
+bool metropolis_accept(const std::pair<double, double>& dS, double beta,
+                       RNG& rng)
+{
+    if (std::isinf(beta))
+        return dS.first < 0;
+    double a = -dS.first * beta + dS.second;
+    if (a > 0)
+        return true;
+    typedef std::uniform_real_distribution<> rdist_t;
+    double sample = rdist_t()(rng);
+    return sample < exp(a);
+}
+
+
+// Generic sweep. If state._parallel == true, the move proposals are evaluated
+// in parallel, and the accepted moves are then performed sequentially, after
+// their entropy difference is recomputed, so that the sweep is not guaranteed
+// to sample from the correct distribution.
+
 template <class MCMCState, class RNG>
-auto mcmc_sweep(MCMCState state, RNG& rng_)
+auto mcmc_sweep(MCMCState state, RNG& rng_, std::false_type)
 {
     auto& g = state._g;
 
@@ -45,7 +88,6 @@ auto mcmc_sweep(MCMCState state, RNG& rng_)
     if (state._parallel)
     {
         init_rngs(rngs, rng_);
-        init_cache(state._E);
         best_move.resize(num_vertices(g));
     }
 
@@ -94,25 +136,7 @@ auto mcmc_sweep(MCMCState state, RNG& rng_)
 
                  std::pair<double, double> dS = state.virtual_move_dS(v, s);
 
-                 bool accept = false;
-                 if (std::isinf(beta))
-                 {
-                     accept = dS.first < 0;
-                 }
-                 else
-                 {
-                     double a = -dS.first * beta + dS.second;
-                     if (a > 0)
-                     {
-                         accept = true;
-                     }
-                     else
-                     {
-                         typedef std::uniform_real_distribution<> rdist_t;
-                         double sample = rdist_t()(rng);
-                         accept = sample < exp(a);
-                     }
-                 }
+                 bool accept = metropolis_accept(dS, beta, rng);
 
                  if (accept)
                  {
@@ -155,6 +179,236 @@ auto mcmc_sweep(MCMCState state, RNG& rng_)
     return make_pair(S, nmoves);
 }
 
+// Conflict-free parallel sweep. The vertices are visited in the same order as
+// in a sequential sweep, in windows of consecutive vertices. The moves of all
+// vertices in a window are first proposed and evaluated in parallel, against
+// the state at the beginning of the window. Afterwards, the window is
+// traversed in order, and a precomputed move is only used if none of the
+// blocks it depends on (the block of the vertex, those of its neighbours, and
+// the target block) was modified by a move accepted earlier in the window;
+// otherwise it is reevaluated. If the entropy difference depends on all blocks
+// (is_local_move_dS() == false, e.g. for the dense entropy), it is always
+// reevaluated after the first accepted move of the window, and only the
+// proposal is reused.
+//
+// The sweep is then equivalent to a sequential one, and hence preserves
+// detailed balance, provided that the proposal and the entropy difference of
+// a move only depend on the blocks reported by visit_move_blocks() and on the
+// target block, and that the moves which do not vacate or occupy a block
+// modify only these. A move which vacates or occupies a block therefore ends
+// the window. The window size is adapted to the fraction of moves which need
+// to be reevaluated.
+//
+// The accepted moves are collected in batches, which involve disjoint sets of
+// blocks, since a move which depends on a block modified by a pending move is
+// reevaluated, after the batch is performed. If allow_concurrent_moves() ==
+// true, the moves in a batch are performed concurrently.
+
+template <class MCMCState, class RNG>
+auto mcmc_sweep(MCMCState state, RNG& rng_, std::true_type)
+{
+    if (!state._parallel)
+        return mcmc_sweep(state, rng_, std::false_type());
+
+    auto& vlist = state._vlist;
+    auto& beta = state._beta;
+
+    vector<std::shared_ptr<RNG>> rngs;
+    init_rngs(rngs, rng_);
+
+    // each thread needs its own copy of the state, which holds the buffers
+    // used in the evaluation and the concurrent execution of the moves
+    vector<MCMCState> tstates(rngs.size(), state);
+
+    auto get_tstate = [&]() -> MCMCState&
+        {
+            size_t tid = 0;
+#ifdef USING_OPENMP
+            tid = omp_get_thread_num();
+#endif
+            return tstates[tid];
+        };
+
+    struct attempt_t
+    {
+        size_t s;
+        std::pair<double, double> dS;
+        bool accept;
+    };
+
+    auto attempt = [&](MCMCState& st, size_t v, auto& rng)
+        {
+            attempt_t a;
+            a.s = st.node_state(v);
+            a.accept = false;
+            if (st.node_weight(v) == 0)
+                return a;
+            auto r = a.s;
+            a.s = st.move_proposal(v, rng);
+            if (a.s == r)
+                return a;
+            a.dS = st.virtual_move_dS(v, a.s);
+            a.accept = metropolis_accept(a.dS, beta, rng);
+            return a;
+        };
+
+    // round in which each block was last modified
+    vector<size_t> dirty;
+    size_t round = 0;
+    auto mark = [&](size_t t)
+        {
+            if (t >= dirty.size())
+                dirty.resize(t + 1, 0);
+            dirty[t] = round;
+        };
+    auto is_dirty = [&](size_t t)
+        {
+            return t < dirty.size() && dirty[t] == round;
+        };
+
+    bool local_dS = state.is_local_move_dS();
+    bool concurrent = state.allow_concurrent_moves();
+
+    // accepted moves which are not yet performed
+    vector<std::pair<size_t, size_t>> batch;
+    auto perform_batch = [&]()
+        {
+            if (concurrent && batch.size() > rngs.size())
+            {
+                state.reserve_moves(batch);
+                #pragma omp parallel for schedule(runtime)
+                for (size_t i = 0; i < batch.size(); ++i)
+                    get_tstate().perform_concurrent_move(batch[i].first,
+                                                         batch[i].second);
+            }
+            else
+            {
+                for (auto& m : batch)
+                    state.perform_move(m.first, m.second);
+            }
+            batch.clear();
+        };
+
+    const size_t min_window = 16 * rngs.size();
+    size_t window = min_window;
+
+    vector<size_t> vs(vlist.size());
+    vector<attempt_t> attempts;
+
+    double S = 0;
+    size_t nmoves = 0;
+
+    for (size_t iter = 0; iter < state._niter; ++iter)
+    {
+        if (state._sequential)
+        {
+            vs = vlist;
+            std::shuffle(vs.begin(), vs.end(), rng_);
+        }
+        else
+        {
+            for (auto& v : vs)
+                v = uniform_sample(vlist, rng_);
+        }
+
+        size_t pos = 0;
+        while (pos < vs.size())
+        {
+            size_t end = std::min(pos + window, vs.size());
+            attempts.resize(end - pos);
+
+            #pragma omp parallel if (end - pos > OPENMP_MIN_THRESH)
+            {
+                auto& rng = get_rng(rngs, rng_);
+                auto& tstate = get_tstate();
+                #pragma omp for schedule(runtime)
+                for (size_t i = pos; i < end; ++i)
+                    attempts[i - pos] = attempt(tstate, vs[i], rng);
+            }
+
+            ++round;
+            size_t naccept = 0;
+            size_t nredo = 0;
+            size_t i = pos;
+            while (i < end)
+            {
+                auto v = vs[i];
+                auto& a = attempts[i - pos];
+                ++i;
+
+                bool clean = true;
+                state.visit_move_blocks(v,
+                                        [&](size_t t)
+                                        {
+                                            if (is_dirty(t))
+                                                clean = false;
+                                        });
+                if (!clean)
+                {
+                    // the proposal itself may have changed
+                    perform_batch();
+                    a = attempt(state, v, rng_);
+                    nredo++;
+                }
+                else if (a.s != state.node_state(v) &&
+                         (is_dirty(a.s) || (!local_dS && naccept > 0)))
+                {
+                    // only the target block (or, if the entropy difference is
+                    // not local, any other block) has changed, which does not
+                    // affect the proposal probability
+                    perform_batch();
+                    a.dS = state.virtual_move_dS(v, a.s);
+                    a.accept = metropolis_accept(a.dS, beta, rng_);
+                    nredo++;
+                }
+
+                if (!a.accept)
+                    continue;
+
+                bool occupation = state.is_occupation_move(v, a.s);
+
+                state.visit_move_blocks(v, mark);
+                mark(a.s);
+
+                if (state._verbose)
+                    cout << v << ": " << state.node_state(v) << " -> " << a.s
+                         << " " << S << endl;
+
+                naccept++;
+                nmoves += state.node_weight(v);
+                S += a.dS.first;
+
+                // the remaining moves were evaluated with a different set of
+                // occupied blocks
+                if (occupation)
+                {
+                    perform_batch();
+                    state.perform_move(v, a.s);
+                    break;
+                }
+
+                batch.emplace_back(v, a.s);
+            }
+            perform_batch();
+
+            if ((nredo + end - i) * 4 > end - pos)
+                window = std::max(window / 2, min_window);
+            else if (i == end && end - pos == window)
+                window = std::min(2 * window, std::max(vs.size(), min_window));
+
+            pos = i;
+        }
+    }
+    return make_pair(S, nmoves);
+}
+
+template <class MCMCState, class RNG>
+auto mcmc_sweep(MCMCState state, RNG& rng_)
+{
+    return mcmc_sweep(state, rng_,
+                      typename has_move_blocks<MCMCState>::type());
+}
+
 } // graph_tool namespace
 
 #endif //MCMC_LOOP_HH
@@ -41,7 +41,6 @@ auto merge_sweep(MergeState state, RNG& rng_)
     if (state._parallel)
     {
         init_rngs(rngs, rng_);
-        init_cache(state._E);
     }
 
     typedef std::tuple<size_t, size_t, double> merge_t;
@@ -20,6 +20,8 @@
 
 #include <limits>
 #include <iostream>
+#include <array>
+#include <algorithm>
 
 namespace graph_tool
 {
@@ -42,6 +44,18 @@ struct get_arf_layout
                  pos[v].resize(dim);
              });
 
+        switch (dim)
+        {
+        case 2:
+            layout<2>(g, pos, weight, a, d, dt, epsilon, max_iter);
+            return;
+        case 3:
+            layout<3>(g, pos, weight, a, d, dt, epsilon, max_iter);
+            return;
+        default:
+            break;
+        }
+
         pos_t delta = epsilon + 1;
         size_t n_iter = 0;
         pos_t r = d*sqrt(pos_t(HardNumVertices()(g)));
@@ -102,6 +116,96 @@ struct get_arf_layout
             n_iter++;
         }
     }
+
+    // Same as above, for a fixed number of dimensions D. The positions of the
+    // valid vertices are kept in contiguous arrays, one per dimension, so that
+    // the all-pairs repulsive loop is vectorized.
+    template <size_t D, class Graph, class PosMap, class WeightMap>
+    void layout(Graph& g, PosMap pos, WeightMap weight, double a, double d,
+                double dt, double epsilon, size_t max_iter) const
+    {
+        typedef typename property_traits<PosMap>::value_type::value_type pos_t;
+
+        vector<size_t> vs, idx(num_vertices(g));
+        for (auto v : vertices_range(g))
+        {
+            idx[v] = vs.size();
+            vs.push_back(v);
+        }
+        size_t N = vs.size();
+
+        std::array<vector<pos_t>, D> x;
+        for (size_t j = 0; j < D; ++j)
+        {
+            x[j].resize(N);
+            for (size_t i = 0; i < N; ++i)
+                x[j][i] = pos[vs[i]][j];
+        }
+
+        pos_t delta = epsilon + 1;
+        size_t n_iter = 0;
+        pos_t r = d*sqrt(pos_t(N));
+        while (delta > epsilon && (max_iter == 0 || n_iter < max_iter))
+        {
+            delta = 0;
+            #pragma omp parallel for schedule(runtime) reduction(+:delta) \
+                if (N > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < N; ++i)
+            {
+                const pos_t* xs[D];
+                pos_t xv[D];
+                for (size_t j = 0; j < D; ++j)
+                {
+                    xs[j] = x[j].data();
+                    xv[j] = x[j][i];
+                }
+
+                // the term w == v vanishes, since dx == 0
+                pos_t delta_pos[D] = {};
+                #pragma omp simd reduction(+:delta_pos[:D])
+                for (size_t k = 0; k < N; ++k)
+                {
+                    pos_t dx[D];
+                    pos_t diff = 0;
+                    for (size_t j = 0; j < D; ++j)
+                    {
+                        dx[j] = xs[j][k] - xv[j];
+                        diff += dx[j] * dx[j];
+                    }
+                    diff = sqrt(diff);
+                    pos_t m = 1 - r / std::max(diff, pos_t(1e-6));
+                    for (size_t j = 0; j < D; ++j)
+                        delta_pos[j] += m * dx[j];
+                }
+
+                auto v = vs[i];
+                for (auto e : out_edges_range(v, g))
+                {
+                    auto u = target(e, g);
+                    if (u == v)
+                        continue;
+                    pos_t m = a * get(weight, e) - 1;
+                    for (size_t j = 0; j < D; ++j)
+                        delta_pos[j] += m * (x[j][idx[u]] - xv[j]);
+                }
+
+                for (size_t j = 0; j < D; ++j)
+                {
+                    #pragma omp atomic
+                    x[j][i] += dt * delta_pos[j];
+                    delta += abs(delta_pos[j]);
+                }
+            }
+            n_iter++;
+        }
+
+        parallel_loop(vs,
+                      [&](size_t i, auto v)
+                      {
+                          for (size_t j = 0; j < D; ++j)
+                              pos[v][j] = x[j][i];
+                      });
+    }
 };
 
 } // namespace graph_tool
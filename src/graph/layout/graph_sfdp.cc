@@ -23,6 +23,7 @@
 #include <boost/lambda/bind.hpp>
 
 #include "graph_sfdp.hh"
+#include "graph_sfdp_multilevel.hh"
 #include "random.hh"
 #include "hash_map_wrap.hh"
 
@@ -76,6 +77,88 @@ void sfdp_layout(GraphInterface& g, boost::any pos, boost::any vweight,
         (pos, vweight, eweight);
 }
 
+python::object sfdp_layout_multilevel(GraphInterface& g, boost::any pos,
+                                      boost::any vweight, boost::any eweight,
+                                      boost::any groups,
+                                      python::object spring_parms,
+                                      python::object coarse_parms, double theta,
+                                      double step_schedule, size_t max_level,
+                                      double epsilon, size_t max_iter,
+                                      size_t dim, rng_t& rng)
+{
+    typedef UnityPropertyMap<int,GraphInterface::vertex_t> vweight_map_t;
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> eweight_map_t;
+    typedef mpl::push_back<vertex_scalar_properties, vweight_map_t>::type
+        vertex_props_t;
+    typedef mpl::push_back<edge_scalar_properties, eweight_map_t>::type
+        edge_props_t;
+
+    typedef vprop_map_t<int32_t>::type group_map_t;
+
+    double C = python::extract<double>(spring_parms[0]);
+    double p = python::extract<double>(spring_parms[1]);
+    double gamma = python::extract<double>(spring_parms[2]);
+    double mu = python::extract<double>(spring_parms[3]);
+    double mu_p = python::extract<double>(spring_parms[4]);
+
+    string method = python::extract<string>(coarse_parms[0]);
+    double mivs_thres = python::extract<double>(coarse_parms[1]);
+    double ec_thres = python::extract<double>(coarse_parms[2]);
+    bool weighted = python::extract<bool>(coarse_parms[3]);
+
+    coarse_method_t cmethod;
+    if (method == "hybrid")
+        cmethod = coarse_method_t::hybrid;
+    else if (method == "ec")
+        cmethod = coarse_method_t::ec;
+    else if (method == "mivs")
+        cmethod = coarse_method_t::mivs;
+    else
+        throw ValueException("invalid coarsening method: " + method);
+
+    bool has_groups = !groups.empty();
+    group_map_t group_map;
+    if (has_groups)
+        group_map = any_cast<group_map_t>(groups);
+
+    if(vweight.empty())
+        vweight = vweight_map_t();
+    if(eweight.empty())
+        eweight = eweight_map_t();
+
+    vector<sfdp_level_stats> stats;
+    run_action<graph_tool::detail::never_directed>()
+        (g,
+         [&](auto& graph, auto pos_map, auto vweight_map, auto eweight_map)
+         {
+             get_sfdp_multilevel_layout(C, p, theta, gamma, mu, mu_p,
+                                        step_schedule, max_level, epsilon,
+                                        max_iter, cmethod, mivs_thres,
+                                        ec_thres, weighted, dim)
+                 (graph, pos_map, vweight_map, eweight_map,
+                  group_map.get_unchecked(num_vertices(g.get_graph())),
+                  has_groups, rng, stats);
+         },
+         vertex_floating_vector_properties(), vertex_props_t(), edge_props_t())
+        (pos, vweight, eweight);
+
+    python::list ret;
+    for (auto& s : stats)
+    {
+        python::dict d;
+        d["vertices"] = s.N;
+        d["edges"] = s.E;
+        d["mivs"] = s.mivs;
+        d["K"] = s.K;
+        d["iterations"] = s.n_iter;
+        d["coarse_time"] = s.coarse_time;
+        d["layout_time"] = s.layout_time;
+        d["prolong_time"] = s.prolong_time;
+        ret.append(d);
+    }
+    return ret;
+}
+
 struct do_propagate_pos
 {
     template <class Graph, class CoarseGraph, class VertexMap, class PosMap,
@@ -229,22 +312,23 @@ double avg_dist(GraphInterface& gi, boost::any pos)
 struct do_sanitize_pos
 {
     template <class Graph, class PosMap>
-    void operator()(Graph& g, PosMap pos) const
+    void operator()(Graph& g, PosMap pos, size_t dim) const
     {
         parallel_vertex_loop
                 (g,
                  [&](auto v)
                  {
-                     pos[v].resize(2);
+                     pos[v].resize(dim);
                  });
     }
 };
 
 
-void sanitize_pos(GraphInterface& gi, boost::any pos)
+void sanitize_pos(GraphInterface& gi, boost::any pos, size_t dim)
 {
     run_action<>()
-        (gi, std::bind(do_sanitize_pos(), std::placeholders::_1, std::placeholders::_2),
+        (gi, std::bind(do_sanitize_pos(), std::placeholders::_1, std::placeholders::_2,
+                       dim),
          vertex_scalar_vector_properties()) (pos);
 }
 
@@ -253,6 +337,7 @@ void sanitize_pos(GraphInterface& gi, boost::any pos)
 void export_sfdp()
 {
     python::def("sfdp_layout", &sfdp_layout);
+    python::def("sfdp_layout_multilevel", &sfdp_layout_multilevel);
     python::def("propagate_pos", &propagate_pos);
     python::def("propagate_pos_mivs", &propagate_pos_mivs);
     python::def("avg_dist", &avg_dist);
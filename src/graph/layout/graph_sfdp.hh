@@ -20,6 +20,17 @@
 
 #include <limits>
 #include <iostream>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+#include "graph_util.hh"
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
 
 #ifndef __clang__
 #include <ext/numeric>
@@ -37,129 +48,323 @@ namespace graph_tool
 using namespace std;
 using namespace boost;
 
-template <class Pos, class Weight>
+// Barnes-Hut tree in D dimensions (i.e. a quadtree for D = 2, or an octree
+// for D = 3), stored as a flat array of nodes in a single arena.
+//
+// Every point is assigned the Morton code of the cell at the deepest level
+// which contains it, and the points are kept sorted by this code, so that the
+// points inside any cell of the tree occupy a contiguous range of the sorted
+// arrays, which are stored as a structure of arrays. The tree is built level
+// by level, in parallel: the non-empty children of every node are found by
+// binary search inside the range of their parent, and are placed contiguously
+// in the arena, so that each level of the tree is also a contiguous range of
+// nodes. Cells with at most leaf_size points are not subdivided, so that the
+// interactions with their points can be evaluated in vectorized loops. The
+// centers of mass are then obtained from the deepest level up. All buffers are
+// kept between calls to build(), so that no memory is allocated after the
+// first iteration of the layout.
+
+template <class Val, size_t D>
 class QuadTree
 {
 public:
-    QuadTree(const Pos& ll, const Pos& ur, int max_level)
-        :_ll(ll), _ur(ur), _cm(2, 0), _count(0),
-         _max_level(max_level)
+    // number of children of a node
+    static constexpr size_t n_branch = size_t(1) << D;
+
+    // maximum depth supported by 64-bit Morton codes
+    static constexpr size_t max_depth = 63 / D;
+
+    // upper bound on the size of the stack of a depth-first traversal
+    static constexpr size_t stack_size = n_branch * (max_depth + 1);
+
+    // maximum number of points in a cell which is not subdivided
+    static constexpr size_t leaf_size = 16;
+
+    struct node_t
     {
-        _w = sqrt(power(_ur[0] - _ll[0], 2) +
-                  power(_ur[1] - _ll[1], 2));
+        std::array<Val, D> cm;  // center of mass
+        Val count;              // total weight
+        Val w;                  // diagonal of the cell
+        size_t begin, end;      // range of points in the cell
+        size_t children;        // index of the first child
+        size_t nchildren;       // number of non-empty children
+    };
+
+    template <class Graph>
+    QuadTree(const Graph& g)
+    {
+        for (auto v : vertices_range(g))
+            _vs.push_back(v);
     }
 
-    vector<QuadTree>& get_leafs()
+    template <class VertexWeightMap>
+    void build(const std::array<vector<Val>, D>& x, VertexWeightMap vweight,
+               size_t max_level)
     {
-        if (_max_level > 0 && _leafs.empty())
+        size_t N = _vs.size();
+        size_t depth = std::min(max_level, max_depth);
+
+        Val x_min[D], x_max[D];
+        for (size_t j = 0; j < D; ++j)
+        {
+            x_min[j] = numeric_limits<Val>::max();
+            x_max[j] = -numeric_limits<Val>::max();
+        }
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH) \
+            reduction(min:x_min[:D]) reduction(max:x_max[:D])
+        for (size_t i = 0; i < N; ++i)
         {
-            _leafs.reserve(4);
-            for (size_t i = 0; i < 4; ++i)
+            auto v = _vs[i];
+            for (size_t j = 0; j < D; ++j)
             {
-                Pos lll = _ll, lur = _ur;
-                if (i % 2)
-                    lll[0] += (_ur[0] - _ll[0]) / 2;
-                else
-                    lur[0] -= (_ur[0] - _ll[0]) / 2;
-                if (i / 2)
-                    lll[1] += (_ur[1] - _ll[1]) / 2;
-                else
-                    lur[1] -= (_ur[1] - _ll[1]) / 2;
-                _leafs.emplace_back(lll, lur, _max_level - 1);
+                x_min[j] = std::min(x_min[j], x[j][v]);
+                x_max[j] = std::max(x_max[j], x[j][v]);
             }
         }
 
-        return _leafs;
-    }
+        // Morton codes
+        double L = std::ldexp(1., depth);
+        std::array<double, D> scale;
+        for (size_t j = 0; j < D; ++j)
+            scale[j] = (x_max[j] > x_min[j]) ? L / (x_max[j] - x_min[j]) : 0;
+        uint64_t q_max = (uint64_t(1) << depth) - 1;
+        _keys.resize(N);
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto v = _vs[i];
+            uint64_t code = 0;
+            for (size_t j = 0; j < D; ++j)
+            {
+                uint64_t q = std::min(uint64_t((x[j][v] - x_min[j]) * scale[j]),
+                                      q_max);
+                code |= spread(q) << j;
+            }
+            _keys[i] = {code, v};
+        }
+        parallel_sort(_keys, _tmp);
 
-    vector<std::tuple<Pos,Weight> >& get_dense_leafs()
-    {
-        return _dense_leafs;
-    }
+        for (size_t j = 0; j < D; ++j)
+            _x[j].resize(N);
+        _w.resize(N);
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto v = _keys[i].second;
+            for (size_t j = 0; j < D; ++j)
+                _x[j][i] = x[j][v];
+            _w[i] = get(vweight, v);
+        }
 
-    size_t get_branch(Pos& p)
-    {
-        int i = p[0] > (_ll[0] + (_ur[0] - _ll[0]) / 2);
-        int j = p[1] > (_ll[1] + (_ur[1] - _ll[1]) / 2);
-        return i + 2 * j;
-    }
+        // tree nodes, one level at a time
+        Val w = 0;
+        for (size_t j = 0; j < D; ++j)
+            w += power(x_max[j] - x_min[j], 2);
+        w = sqrt(w);
+        _nodes.clear();
+        _nodes.push_back({{}, 0, w, 0, N, 0, 0});
+        _levels.clear();
+        _levels.push_back(0);
+        _levels.push_back(1);
+        for (size_t l = 0; l < depth; ++l)
+        {
+            size_t lb = _levels[l], le = _levels[l + 1];
+            size_t shift = D * (depth - 1 - l);
 
-    size_t put_pos(Pos& p, Weight w)
-    {
-        _count += w;
-        _cm[0] += p[0] * w;
-        _cm[1] += p[1] * w;
+            #pragma omp parallel for schedule(runtime) \
+                if (le - lb > OPENMP_MIN_THRESH)
+            for (size_t i = lb; i < le; ++i)
+            {
+                auto& n = _nodes[i];
+                n.nchildren = 0;
+                if (n.end - n.begin <= leaf_size)
+                    continue;
+                std::array<size_t, n_branch + 1> split;
+                get_split(n, shift, split);
+                for (size_t k = 0; k < n_branch; ++k)
+                {
+                    if (split[k + 1] > split[k])
+                        n.nchildren++;
+                }
+            }
 
-        if (_max_level == 0 || _count == w)
-        {
-            _dense_leafs.emplace_back(p, w);
-            return 1;
+            size_t pos = le;
+            for (size_t i = lb; i < le; ++i)
+            {
+                auto& n = _nodes[i];
+                n.children = pos;
+                pos += n.nchildren;
+            }
+            if (pos == le)
+                break;
+            _nodes.resize(pos);
+
+            Val cw = std::ldexp(w, -int(l + 1));
+            #pragma omp parallel for schedule(runtime) \
+                if (le - lb > OPENMP_MIN_THRESH)
+            for (size_t i = lb; i < le; ++i)
+            {
+                auto& n = _nodes[i];
+                if (n.nchildren == 0)
+                    continue;
+                std::array<size_t, n_branch + 1> split;
+                get_split(n, shift, split);
+                size_t c = n.children;
+                for (size_t k = 0; k < n_branch; ++k)
+                {
+                    if (split[k + 1] > split[k])
+                        _nodes[c++] = {{}, 0, cw, split[k], split[k + 1], 0, 0};
+                }
+            }
+            _levels.push_back(pos);
         }
-        else
+
+        // centers of mass, from the bottom up
+        for (size_t l = _levels.size() - 1; l > 0; --l)
         {
-            if (!_dense_leafs.empty())
+            size_t lb = _levels[l - 1], le = _levels[l];
+            #pragma omp parallel for schedule(runtime) \
+                if (le - lb > OPENMP_MIN_THRESH)
+            for (size_t i = lb; i < le; ++i)
             {
-                // move dense leafs down
-                auto& leafs = get_leafs();
-                for (auto& leaf : _dense_leafs)
+                auto& n = _nodes[i];
+                std::array<Val, D> cm;
+                cm.fill(0);
+                Val count = 0;
+                if (n.nchildren == 0)
+                {
+                    for (size_t k = n.begin; k < n.end; ++k)
+                    {
+                        for (size_t j = 0; j < D; ++j)
+                            cm[j] += _x[j][k] * _w[k];
+                        count += _w[k];
+                    }
+                }
+                else
                 {
-                    auto& lp = get<0>(leaf);
-                    auto& lw = get<1>(leaf);
-                    leafs[get_branch(lp)].put_pos(lp, lw);
+                    for (size_t k = n.children;
+                         k < n.children + n.nchildren; ++k)
+                    {
+                        auto& c = _nodes[k];
+                        for (size_t j = 0; j < D; ++j)
+                            cm[j] += c.cm[j] * c.count;
+                        count += c.count;
+                    }
                 }
-                _dense_leafs.clear();
+                if (count > 0)
+                {
+                    for (size_t j = 0; j < D; ++j)
+                        cm[j] /= count;
+                }
+                n.cm = cm;
+                n.count = count;
             }
-
-            size_t sc = (_max_level > 0 && _leafs.empty()) ? 4 : 0;
-            return sc + get_leafs()[get_branch(p)].put_pos(p, w);
         }
-        return 0;
     }
 
-    void get_cm(Pos& cm)
+    const node_t& get_node(size_t i) const
     {
-        for (size_t i = 0; i < 2; ++i)
-            cm[i] = _cm[i] / _count;
+        return _nodes[i];
     }
 
-    double get_w() const
+    // positions and weights of the points, in Morton order
+    const std::array<vector<Val>, D>& get_pos() const
+    {
+        return _x;
+    }
+
+    const vector<Val>& get_weight() const
     {
         return _w;
     }
 
-    Weight get_count()
+private:
+    // inserts D - 1 zeros between consecutive bits of x
+    static uint64_t spread(uint64_t x)
+    {
+        uint64_t r = 0;
+        for (size_t i = 0; i < max_depth; ++i)
+            r |= ((x >> i) & 1) << (D * i);
+        return r;
+    }
+
+    // boundaries of the children of node n inside its range of points
+    void get_split(const node_t& n, size_t shift,
+                   std::array<size_t, n_branch + 1>& split)
     {
-        return _count;
+        auto begin = _keys.begin() + n.begin;
+        auto end = _keys.begin() + n.end;
+        split[0] = n.begin;
+        for (size_t k = 1; k < n_branch; ++k)
+            split[k] = std::partition_point
+                (begin, end,
+                 [&](auto& key)
+                 {
+                     return ((key.first >> shift) & (n_branch - 1)) < k;
+                 }) - _keys.begin();
+        split[n_branch] = n.end;
     }
 
-    int max_level()
+    // sorts v by sorting contiguous chunks in parallel, which are then merged
+    // pairwise, also in parallel
+    template <class T>
+    static void parallel_sort(vector<T>& v, vector<T>& tmp)
     {
-        return _max_level;
+        size_t N = v.size();
+        size_t n_chunks = 1;
+        #ifdef USING_OPENMP
+        if (N > OPENMP_MIN_THRESH)
+            n_chunks = omp_get_max_threads();
+        #endif
+        if (n_chunks == 1)
+        {
+            std::sort(v.begin(), v.end());
+            return;
+        }
+
+        vector<size_t> bounds(n_chunks + 1);
+        for (size_t i = 0; i <= n_chunks; ++i)
+            bounds[i] = (i * N) / n_chunks;
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t i = 0; i < n_chunks; ++i)
+            std::sort(v.begin() + bounds[i], v.begin() + bounds[i + 1]);
+
+        tmp.resize(N);
+        for (size_t step = 1; step < n_chunks; step *= 2)
+        {
+            #pragma omp parallel for schedule(dynamic, 1)
+            for (size_t i = 0; i < n_chunks; i += 2 * step)
+            {
+                size_t b = bounds[i];
+                size_t m = bounds[std::min(i + step, n_chunks)];
+                size_t e = bounds[std::min(i + 2 * step, n_chunks)];
+                std::merge(v.begin() + b, v.begin() + m, v.begin() + m,
+                           v.begin() + e, tmp.begin() + b);
+            }
+            v.swap(tmp);
+        }
     }
 
-private:
-    Pos _ll, _ur;
-    vector<QuadTree> _leafs;
-    vector<std::tuple<Pos,Weight> > _dense_leafs;
-    Pos _cm;
-    Weight _count;
-    int _max_level;
-    double _w;
+    vector<size_t> _vs;
+    vector<pair<uint64_t, size_t>> _keys, _tmp;
+    std::array<vector<Val>, D> _x;
+    vector<Val> _w;
+    vector<node_t> _nodes;
+    vector<size_t> _levels;
 };
 
 template <class Pos>
 inline double dist(const Pos& p1, const Pos& p2)
 {
     double r = 0;
-    for (size_t i = 0; i < 2; ++i)
+    for (size_t i = 0; i < p1.size(); ++i)
         r += power(double(p1[i] - p2[i]), 2);
     return sqrt(r);
 }
 
-template <class Pos>
-inline double f_r(double C, double K, double p, const Pos& p1, const Pos& p2)
+inline double f_r(double C, double K, double p, double d)
 {
-    double d = dist(p1, p2);
     if (d == 0)
         return 0;
     if (round(p) == p)
@@ -168,17 +373,28 @@ inline double f_r(double C, double K, double p, const Pos& p1, const Pos& p2)
         return -C * pow(K, 1 + p) / pow(d, p);
 }
 
+template <class Pos>
+inline double f_r(double C, double K, double p, const Pos& p1, const Pos& p2)
+{
+    return f_r(C, K, p, dist(p1, p2));
+}
+
+inline double f_a(double K, double d)
+{
+    return power(d, 2) / K;
+}
+
 template <class Pos>
 inline double f_a(double K, const Pos& p1, const Pos& p2)
 {
-    return power(dist(p1, p2), 2) / K;
+    return f_a(K, dist(p1, p2));
 }
 
 template <class Pos>
 inline double get_diff(const Pos& p1, const Pos& p2, Pos& r)
 {
     double abs = 0;
-    for (size_t i = 0; i < 2; ++i)
+    for (size_t i = 0; i < r.size(); ++i)
     {
         r[i] = p1[i] - p2[i];
         abs += r[i] * r[i];
@@ -186,22 +402,11 @@ inline double get_diff(const Pos& p1, const Pos& p2, Pos& r)
     if (abs == 0)
         abs = 1;
     abs = sqrt(abs);
-    for (size_t i = 0; i < 2; ++i)
+    for (size_t i = 0; i < r.size(); ++i)
         r[i] /= abs;
     return abs;
 }
 
-template <class Pos>
-inline double norm(Pos& x)
-{
-    double abs = 0;
-    for (size_t i = 0; i < 2; ++i)
-        abs += power(x[i], 2);
-    for (size_t i = 0; i < 2; ++i)
-        x[i] /= sqrt(abs);
-    return sqrt(abs);
-}
-
 struct get_sfdp_layout
 {
     get_sfdp_layout(double C, double K, double p, double theta, double gamma,
@@ -223,9 +428,126 @@ struct get_sfdp_layout
                     EdgeWeightMap eweight, PinMap pin, GroupMap group,
                     bool verbose, RNG& rng) const
     {
-        typedef typename property_traits<PosMap>::value_type pos_t;
+        // the number of dimensions is given by the initial positions
+        size_t dim = 2;
+        for (auto v : vertices_range(g))
+        {
+            dim = std::max(pos[v].size(), size_t(2));
+            break;
+        }
+
+        switch (dim)
+        {
+        case 2:
+            run<2>(g, pos, vweight, eweight, pin, group, verbose, rng);
+            break;
+        case 3:
+            run<3>(g, pos, vweight, eweight, pin, group, verbose, rng);
+            break;
+        default:
+            throw ValueException("only two- or three-dimensional layouts "
+                                 "are supported");
+        }
+    }
+
+    template <size_t D, class Graph, class PosMap, class VertexWeightMap,
+              class EdgeWeightMap, class PinMap, class GroupMap, class RNG>
+    void run(Graph& g, PosMap pos, VertexWeightMap vweight,
+             EdgeWeightMap eweight, PinMap pin, GroupMap group, bool verbose,
+             RNG& rng) const
+    {
         typedef typename property_traits<PosMap>::value_type::value_type val_t;
 
+        // the positions are kept as a structure of arrays during the layout
+        std::array<vector<val_t>, D> x;
+        for (size_t j = 0; j < D; ++j)
+            x[j].resize(num_vertices(g));
+
+        for (auto v : vertices_range(g))
+        {
+            pos[v].resize(D, 0);
+            for (size_t j = 0; j < D; ++j)
+                x[j][v] = pos[v][j];
+        }
+
+        layout(g, x, vweight, eweight, pin, group, verbose, rng);
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 for (size_t j = 0; j < D; ++j)
+                     pos[v][j] = x[j][v];
+             });
+    }
+
+    // Adds to ftot the repulsive forces exerted on a vertex at position pos_v
+    // by the points [begin, end) of a tree, with positions x and weights w,
+    // in a vectorized loop. The constant c = -C K^(1+p) is computed by the
+    // caller.
+    template <size_t D, class Val>
+    void repulse(const std::array<vector<Val>, D>& x, const vector<Val>& w,
+                 size_t begin, size_t end, const std::array<Val, D>& pos_v,
+                 Val c, std::array<Val, D>& ftot) const
+    {
+        const Val* xs[D];
+        for (size_t j = 0; j < D; ++j)
+            xs[j] = x[j].data();
+        const Val* ws = w.data();
+
+        // f_r(d) * diff = -C K^(1+p) dx / d^(p+1)
+        Val f[D] = {};
+        if (p == 2)
+        {
+            #pragma omp simd reduction(+:f[:D])
+            for (size_t i = begin; i < end; ++i)
+            {
+                Val dx[D];
+                Val d2 = 0;
+                for (size_t j = 0; j < D; ++j)
+                {
+                    dx[j] = xs[j][i] - pos_v[j];
+                    d2 += dx[j] * dx[j];
+                }
+                Val m = (d2 > 0) ? ws[i] / (d2 * sqrt(d2)) : 0;
+                for (size_t j = 0; j < D; ++j)
+                    f[j] += m * dx[j];
+            }
+        }
+        else
+        {
+            Val e = (p + 1) / 2;
+            #pragma omp simd reduction(+:f[:D])
+            for (size_t i = begin; i < end; ++i)
+            {
+                Val dx[D];
+                Val d2 = 0;
+                for (size_t j = 0; j < D; ++j)
+                {
+                    dx[j] = xs[j][i] - pos_v[j];
+                    d2 += dx[j] * dx[j];
+                }
+                Val m = (d2 > 0) ? ws[i] / pow(d2, e) : 0;
+                for (size_t j = 0; j < D; ++j)
+                    f[j] += m * dx[j];
+            }
+        }
+
+        for (size_t j = 0; j < D; ++j)
+            ftot[j] += c * f[j];
+    }
+
+    // Runs the layout on the positions x[j][v], and returns the number of
+    // iterations performed.
+    template <class Graph, class Val, size_t D, class VertexWeightMap,
+              class EdgeWeightMap, class PinMap, class GroupMap, class RNG>
+    size_t layout(Graph& g, std::array<vector<Val>, D>& x,
+                  VertexWeightMap vweight, EdgeWeightMap eweight, PinMap pin,
+                  GroupMap group, bool verbose, RNG& rng) const
+    {
+        typedef Val val_t;
+        typedef std::array<val_t, D> pos_t;
+
         typedef typename property_traits<VertexWeightMap>::value_type vweight_t;
 
         vector<pos_t> group_cm;
@@ -237,151 +559,137 @@ struct get_sfdp_layout
         {
             if (pin[v] == 0)
                 vertices.push_back(v);
-            pos[v].resize(2, 0);
             if (gamma != 0 || mu != 0)
             {
                 size_t s = group[v];
-
-                if (s >= group_cm.size())
+                if (s >= group_size.size())
                 {
                     group_cm.resize(s + 1);
                     group_size.resize(s + 1, 0);
                 }
-                group_cm[s].resize(2, 0);
                 group_size[s] += get(vweight, v);
-
-                for (size_t j = 0; j < 2; ++j)
-                    group_cm[s][j] += pos[v][j] * get(vweight, v);
             }
             HN++;
         }
 
-        for (size_t s = 0; s < group_size.size(); ++s)
-        {
-            if (group_size[s] == 0)
-                continue;
-            group_cm[s].resize(2, 0);
-            for (size_t j = 0; j < 2; ++j)
-                group_cm[s][j] /= group_size[s];
-        }
-
         val_t delta = epsilon * K + 1, E = 0, E0;
         E0 = numeric_limits<val_t>::max();
         size_t n_iter = 0;
         val_t step = init_step;
         size_t progress = 0;
 
+        QuadTree<val_t, D> qt(g);
+        auto& qx = qt.get_pos();
+        auto& qw = qt.get_weight();
+
+        // repulsive force f_r(d) = c_r / d^p, as in f_r(), with the constant
+        // computed only once
+        bool int_p = (round(p) == p);
+        val_t c_r = -C * (int_p ? power(K, int(1 + p)) : pow(K, 1 + p));
+        auto f_rep = [&](val_t d) -> val_t
+            {
+                return c_r / (int_p ? power(d, int(p)) : pow(d, p));
+            };
+
         while (delta > epsilon * K && (max_iter == 0 || n_iter < max_iter))
         {
             delta = 0;
             E0 = E;
             E = 0;
 
-            pos_t ll(2, numeric_limits<val_t>::max()),
-                ur(2, -numeric_limits<val_t>::max());
-            for (auto v : vertices_range(g))
-            {
-                for (size_t j = 0; j < 2; ++j)
-                {
-                    ll[j] = min(pos[v][j], ll[j]);
-                    ur[j] = max(pos[v][j], ur[j]);
-                }
-            }
-
             if (gamma != 0 || mu != 0)
             {
-                for (size_t s = 0; s < group_size.size(); ++s)
-                {
-                    if (group_size[s] == 0)
-                        continue;
-                    group_cm[s] = {0, 0};
-                }
+                for (auto& cm : group_cm)
+                    cm.fill(0);
 
-                for (auto v : vertices_range(g))
+                #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
                 {
-                    size_t s = group[v];
-                    for (size_t j = 0; j < 2; ++j)
-                        group_cm[s][j] += pos[v][j] * get(vweight, v) /
-                            group_size[s];
+                    vector<pos_t> lcm(group_cm.size(), pos_t());
+                    parallel_vertex_loop_no_spawn
+                        (g,
+                         [&](auto v)
+                         {
+                             size_t s = group[v];
+                             for (size_t j = 0; j < D; ++j)
+                                 lcm[s][j] += x[j][v] * get(vweight, v) /
+                                     group_size[s];
+                         });
+
+                    #pragma omp critical (sfdp_group_cm)
+                    for (size_t s = 0; s < group_cm.size(); ++s)
+                    {
+                        for (size_t j = 0; j < D; ++j)
+                            group_cm[s][j] += lcm[s][j];
+                    }
                 }
             }
 
-            QuadTree<pos_t, vweight_t> qt(ll, ur, max_level);
-            for (auto v : vertices_range(g))
-                qt.put_pos(pos[v], vweight[v]);
+            qt.build(x, vweight, max_level);
 
             std::shuffle(vertices.begin(), vertices.end(), rng);
 
             size_t nmoves = 0;
-            vector<QuadTree<pos_t, vweight_t>*> Q;
 
             #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-                private(Q) reduction(+:E, delta, nmoves)
+                reduction(+:E, delta, nmoves)
             parallel_loop_no_spawn
                 (vertices,
                  [&](size_t, auto v)
                  {
-                     pos_t diff(2, 0), pos_u(2, 0), ftot(2, 0), cm(2, 0);
+                     pos_t pos_v, pos_u, diff, ftot, frep;
+                     for (size_t l = 0; l < D; ++l)
+                         pos_v[l] = x[l][v];
+                     ftot.fill(0);
+                     frep.fill(0);
+                     val_t vw = get(vweight, v);
 
                      // global repulsive forces
-                     Q.push_back(&qt);
-                     while (!Q.empty())
+                     std::array<size_t, QuadTree<val_t, D>::stack_size> Q;
+                     size_t nq = 0;
+                     Q[nq++] = 0;
+                     while (nq > 0)
                      {
-                         auto& q = *Q.back();
-                         Q.pop_back();
-
-                         auto& dleafs = q.get_dense_leafs();
-                         if (!dleafs.empty())
+                         auto& q = qt.get_node(Q[--nq]);
+                         val_t d = get_diff(q.cm, pos_v, diff);
+                         if (q.w > theta * d)
                          {
-                             for (auto& dleaf : dleafs)
+                             if (q.nchildren == 0)
                              {
-                                 val_t d = get_diff(get<0>(dleaf), pos[v], diff);
-                                 if (d == 0)
-                                     continue;
-                                 val_t f = f_r(C, K, p, pos[v], get<0>(dleaf));
-                                 f *= get<1>(dleaf) * get(vweight, v);
-                                 for (size_t l = 0; l < 2; ++l)
-                                     ftot[l] += f * diff[l];
+                                 repulse(qx, qw, q.begin, q.end, pos_v,
+                                         c_r, frep);
+                             }
+                             else
+                             {
+                                 for (size_t i = q.children;
+                                      i < q.children + q.nchildren; ++i)
+                                     Q[nq++] = i;
                              }
                          }
                          else
                          {
-                             double w = q.get_w();
-                             q.get_cm(cm);
-                             double d = get_diff(cm, pos[v], diff);
-                             if (w > theta * d)
+                             if (d > 0)
                              {
-                                 for (auto& leaf : q.get_leafs())
-                                 {
-                                     if (leaf.get_count() > 0)
-                                         Q.push_back(&leaf);
-                                 }
-                             }
-                             else
-                             {
-                                 if (d > 0)
-                                 {
-                                     val_t f = f_r(C, K, p, cm, pos[v]);
-                                     f *= q.get_count() * get(vweight, v);
-                                     for (size_t l = 0; l < 2; ++l)
-                                         ftot[l] += f * diff[l];
-                                 }
+                                 val_t f = f_rep(d) * q.count;
+                                 for (size_t l = 0; l < D; ++l)
+                                     frep[l] += f * diff[l];
                              }
                          }
                      }
+                     for (size_t l = 0; l < D; ++l)
+                         ftot[l] += frep[l] * vw;
 
                      // local attractive forces
-                     auto& pos_v = pos[v];
                      for (auto e : out_edges_range(v, g))
                      {
                          auto u = target(e, g);
                          if (u == v)
                              continue;
-                         pos_u = pos[u];
-                         get_diff(pos_u, pos_v, diff);
-                         val_t f = f_a(K, pos_u, pos_v);
-                         f *= get(eweight, e) * get(vweight, u) * get(vweight, v);
-                         for (size_t l = 0; l < 2; ++l)
+                         for (size_t l = 0; l < D; ++l)
+                             pos_u[l] = x[l][u];
+                         val_t d = get_diff(pos_u, pos_v, diff);
+                         val_t f = f_a(K, d);
+                         f *= get(eweight, e) * get(vweight, u) * vw;
+                         for (size_t l = 0; l < D; ++l)
                              ftot[l] += f * diff[l];
                      }
 
@@ -394,13 +702,12 @@ struct get_sfdp_layout
                                  continue;
                              if (s == size_t(group[v]))
                                  continue;
-                             val_t d = get_diff(group_cm[s], pos[v], diff);
+                             val_t d = get_diff(group_cm[s], pos_v, diff);
                              if (d == 0)
                                  continue;
                              double Kp = K * power(HN, 2);
-                             val_t f = f_a(Kp, group_cm[s], pos[v]) * gamma * \
-                                 group_size[s] * get(vweight, v);
-                             for (size_t l = 0; l < 2; ++l)
+                             val_t f = f_a(Kp, d) * gamma * group_size[s] * vw;
+                             for (size_t l = 0; l < D; ++l)
                                  ftot[l] += f * diff[l];
                          }
                      }
@@ -414,12 +721,12 @@ struct get_sfdp_layout
                                  continue;
                              if (s == size_t(group[v]))
                                  continue;
-                             val_t d = get_diff(group_cm[s], pos[v], diff);
+                             val_t d = get_diff(group_cm[s], pos_v, diff);
                              if (d == 0)
-                            continue;
-                             val_t f = f_r(C, K, p, cm, pos[v]);
-                             f *= group_size[s] * get(vweight, v) * abs(gamma);
-                             for (size_t l = 0; l < 2; ++l)
+                                 continue;
+                             val_t f = f_rep(d);
+                             f *= group_size[s] * vw * abs(gamma);
+                             for (size_t l = 0; l < D; ++l)
                                  ftot[l] += f * diff[l];
                          }
                      }
@@ -427,26 +734,31 @@ struct get_sfdp_layout
                      // intra-group attractive forces
                      if (mu > 0 && group_size[group[v]] > 1)
                      {
-                         val_t d = get_diff(group_cm[group[v]], pos[v], diff);
+                         auto& cm = group_cm[group[v]];
+                         val_t d = get_diff(cm, pos_v, diff);
                          if (d > 0)
                          {
                              double Kp = K * pow(double(group_size[group[v]]), mu_p);
-                             val_t f = f_a(Kp, group_cm[group[v]], pos[v]) * mu * \
-                                 group_size[group[v]] * get(vweight, v);
-                             for (size_t l = 0; l < 2; ++l)
+                             val_t f = f_a(Kp, d) * mu * \
+                                 group_size[group[v]] * vw;
+                             for (size_t l = 0; l < D; ++l)
                                  ftot[l] += f * diff[l];
                          }
                      }
 
-                     E += power(norm(ftot), 2);
-
-                     for (size_t l = 0; l < 2; ++l)
+                     // the vertex is moved by a fixed step in the direction
+                     // of the total force
+                     val_t F = 0;
+                     for (size_t l = 0; l < D; ++l)
+                         F += power(ftot[l], 2);
+                     E += F;
+                     F = sqrt(F);
+                     if (F > 0)
                      {
-                         ftot[l] *= step;
-                         pos[v][l] += ftot[l];
+                         for (size_t l = 0; l < D; ++l)
+                             x[l][v] += step * ftot[l] / F;
+                         delta += step;
                      }
-
-                     delta += norm(ftot);
                      nmoves++;
                  });
 
@@ -479,6 +791,7 @@ struct get_sfdp_layout
                 }
             }
         }
+        return n_iter;
     }
 };
 
@@ -0,0 +1,806 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2016 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_SFDP_MULTILEVEL_HH
+#define GRAPH_SFDP_MULTILEVEL_HH
+
+#include <vector>
+#include <array>
+#include <deque>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <algorithm>
+
+#include "graph_adjacency.hh"
+#include "graph_adaptor.hh"
+#include "graph_properties.hh"
+#include "graph_util.hh"
+#include "graph_sfdp.hh"
+#include "random.hh"
+#include "../inference/parallel_rng.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Multilevel SFDP layout, as described in Y. Hu, "Efficient and high quality
+// force-directed graph drawing", Mathematica Journal 10, 37 (2005).
+//
+// The graph is coarsened repeatedly, either by contracting the edges of a
+// heavy-edge matching ("ec"), or by contracting every vertex of a maximal
+// independent vertex set together with some of its neighbours ("mivs"), or
+// by the former followed by the latter once the matching stops reducing the
+// graph sufficiently ("hybrid"). Every coarse graph is stored as an adj_list
+// with merged parallel edges, and its vertex and edge weights (the summed
+// weights of the contracted vertices and edges) in plain arrays. The coarsest
+// graph is laid out from random positions, which are then interpolated to the
+// next finer level and refined, and so on, until the original graph is
+// reached. The positions of every level are kept as structures of arrays,
+// which are laid out in place by get_sfdp_layout::layout().
+
+enum class coarse_method_t
+{
+    ec,
+    mivs,
+    hybrid
+};
+
+struct sfdp_level_stats
+{
+    size_t N = 0;             // number of vertices
+    size_t E = 0;             // number of edges
+    bool mivs = false;        // obtained by MIVS from the finer level
+    double K = 0;             // natural spring length
+    size_t n_iter = 0;        // number of layout iterations
+    double coarse_time = 0;   // seconds spent building the level
+    double layout_time = 0;   // seconds spent laying it out
+    double prolong_time = 0;  // seconds spent interpolating to the finer level
+};
+
+template <class Val, size_t D>
+struct sfdp_coarse_level
+{
+    typedef UndirectedAdaptor<adj_list<size_t>> graph_t;
+    typedef unchecked_vector_property_map<double,
+                                          typed_identity_property_map<size_t>>
+        vweight_t;
+    typedef unchecked_vector_property_map<double,
+                                          adj_edge_index_property_map<size_t>>
+        eweight_t;
+
+    sfdp_coarse_level() : ug(g) {}
+
+    adj_list<size_t> g;
+    graph_t ug;
+    vweight_t vweight;
+    eweight_t eweight;
+    vector<size_t> cmap;       // vertex of the finer level -> vertex of this one
+    vector<uint8_t> mivs;      // vertices of the finer level in the MIVS
+    std::array<vector<Val>, D> x;
+    sfdp_level_stats stats;
+};
+
+// symmetric hash of a vertex pair, used to break ties
+inline uint64_t sfdp_pair_hash(uint64_t u, uint64_t v)
+{
+    uint64_t x = std::min(u, v) * 0x9e3779b97f4a7c15ULL + std::max(u, v);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Heavy-edge matching, obtained in parallel by repeatedly matching every
+// unmatched vertex with its heaviest unmatched neighbour, if the choice is
+// mutual ("locally dominant" edges). Ties are broken by a hash of the
+// endpoints, so that the heaviest remaining edge is always matched and the
+// result does not depend on the number of threads. If a round matches only a
+// small fraction of the remaining candidates, the matching is completed
+// greedily. The vertices of every matched pair are mapped to the same coarse
+// vertex in cmap, and the number of coarse vertices is returned.
+
+template <class Graph, class EWeight>
+size_t sfdp_heavy_edge_matching(const Graph& g, EWeight eweight,
+                                vector<size_t>& cmap)
+{
+    constexpr size_t null = numeric_limits<size_t>::max();
+    size_t N = num_vertices(g);
+    vector<size_t> match(N, null), cand(N, null), active;
+    for (auto v : vertices_range(g))
+        active.push_back(v);
+
+    auto get_cand = [&](auto v)
+        {
+            size_t best = null;
+            double w_best = 0;
+            uint64_t h_best = 0;
+            for (auto e : out_edges_range(v, g))
+            {
+                auto u = target(e, g);
+                if (u == v || match[u] != null)
+                    continue;
+                double w = get(eweight, e);
+                uint64_t h = sfdp_pair_hash(v, u);
+                if (best == null || w > w_best || (w == w_best && h > h_best))
+                {
+                    best = u;
+                    w_best = w;
+                    h_best = h;
+                }
+            }
+            return best;
+        };
+
+    while (!active.empty())
+    {
+        size_t M = active.size();
+        #pragma omp parallel for schedule(runtime) if (M > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < M; ++i)
+            cand[active[i]] = get_cand(active[i]);
+
+        size_t n_matched = 0;
+        #pragma omp parallel for schedule(runtime) if (M > OPENMP_MIN_THRESH) \
+            reduction(+:n_matched)
+        for (size_t i = 0; i < M; ++i)
+        {
+            auto v = active[i];
+            auto u = cand[v];
+            if (u != null && cand[u] == v)
+            {
+                match[v] = u;
+                n_matched++;
+            }
+        }
+
+        size_t n = 0;
+        for (auto v : active)
+        {
+            if (match[v] == null && cand[v] != null)
+                active[n++] = v;
+        }
+        active.resize(n);
+
+        if (n_matched * 16 < M)
+            break;
+    }
+
+    for (auto v : active)
+    {
+        if (match[v] != null)
+            continue;
+        auto u = get_cand(v);
+        if (u == null)
+            continue;
+        match[v] = u;
+        match[u] = v;
+    }
+
+    cmap.resize(N);
+    size_t Nc = 0;
+    for (auto v : vertices_range(g))
+    {
+        auto u = match[v];
+        if (u == null || v < u)
+            cmap[v] = Nc++;
+        else
+            cmap[v] = cmap[u];
+    }
+    return Nc;
+}
+
+// Maximal independent vertex set, preferring vertices of high degree. It is
+// obtained in parallel by repeatedly including every undecided vertex with
+// a higher priority than all its undecided neighbours, and excluding the
+// neighbours of the included vertices. Every included vertex is mapped to its
+// own coarse vertex in cmap, and every other vertex to the one of the included
+// neighbour with the heaviest edge. The number of coarse vertices is returned.
+
+template <class Graph, class EWeight>
+size_t sfdp_mivs(const Graph& g, EWeight eweight, vector<uint8_t>& mivs,
+                 vector<size_t>& cmap)
+{
+    size_t N = num_vertices(g);
+    vector<uint8_t> state(N, 0), flag(N, 0); // 0: undecided, 1: in, 2: out
+    vector<size_t> active;
+    for (auto v : vertices_range(g))
+        active.push_back(v);
+
+    auto higher = [&](auto u, auto v)
+        {
+            size_t ku = out_degree(u, g);
+            size_t kv = out_degree(v, g);
+            if (ku != kv)
+                return ku > kv;
+            uint64_t hu = sfdp_pair_hash(u, u);
+            uint64_t hv = sfdp_pair_hash(v, v);
+            if (hu != hv)
+                return hu > hv;
+            return u < v;
+        };
+
+    while (!active.empty())
+    {
+        size_t M = active.size();
+        #pragma omp parallel for schedule(runtime) if (M > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < M; ++i)
+        {
+            auto v = active[i];
+            bool include = true;
+            for (auto u : out_neighbours_range(v, g))
+            {
+                if (u != v && state[u] == 0 && higher(u, v))
+                {
+                    include = false;
+                    break;
+                }
+            }
+            flag[v] = include;
+        }
+
+        for (auto v : active)
+        {
+            if (flag[v])
+                state[v] = 1;
+        }
+
+        #pragma omp parallel for schedule(runtime) if (M > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < M; ++i)
+        {
+            auto v = active[i];
+            flag[v] = false;
+            if (state[v] != 0)
+                continue;
+            for (auto u : out_neighbours_range(v, g))
+            {
+                if (state[u] == 1)
+                {
+                    flag[v] = true;
+                    break;
+                }
+            }
+        }
+
+        size_t n = 0;
+        for (auto v : active)
+        {
+            if (flag[v])
+                state[v] = 2;
+            if (state[v] == 0)
+                active[n++] = v;
+        }
+        active.resize(n);
+    }
+
+    mivs.resize(N);
+    cmap.resize(N);
+    size_t Nc = 0;
+    for (auto v : vertices_range(g))
+    {
+        mivs[v] = (state[v] == 1);
+        if (mivs[v])
+            cmap[v] = Nc++;
+    }
+
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             if (mivs[v])
+                 return;
+             size_t best = numeric_limits<size_t>::max();
+             double w_best = 0;
+             for (auto e : out_edges_range(v, g))
+             {
+                 auto u = target(e, g);
+                 if (!mivs[u])
+                     continue;
+                 double w = get(eweight, e);
+                 if (best == numeric_limits<size_t>::max() || w > w_best ||
+                     (w == w_best && u < best))
+                 {
+                     best = u;
+                     w_best = w;
+                 }
+             }
+             cmap[v] = cmap[best];
+         });
+    return Nc;
+}
+
+// Builds the coarse graph c.g with Nc vertices, by contracting the vertices of
+// g according to c.cmap. Self-loops are dropped and parallel edges are merged,
+// and the weights of the contracted vertices and edges are summed. The merged
+// edges of every coarse vertex are collected in parallel, in slots with the
+// size of the summed degrees of its members.
+
+template <class Graph, class VWeight, class EWeight, class Val, size_t D>
+void sfdp_contract(const Graph& g, VWeight vweight, EWeight eweight,
+                   size_t Nc, sfdp_coarse_level<Val, D>& c)
+{
+    auto& cmap = c.cmap;
+
+    vector<size_t> mpos(Nc + 1, 0), members;
+    for (auto v : vertices_range(g))
+        mpos[cmap[v] + 1]++;
+    for (size_t s = 0; s < Nc; ++s)
+        mpos[s + 1] += mpos[s];
+    members.resize(mpos[Nc]);
+    {
+        vector<size_t> mfill(mpos.begin(), mpos.end() - 1);
+        for (auto v : vertices_range(g))
+            members[mfill[cmap[v]]++] = v;
+    }
+
+    c.vweight = typename sfdp_coarse_level<Val, D>::vweight_t
+        (get(vertex_index, c.g), Nc);
+    auto& vw = c.vweight.get_storage();
+
+    vector<size_t> slot(Nc + 1, 0), n_edges(Nc, 0);
+    #pragma omp parallel for schedule(runtime) if (Nc > OPENMP_MIN_THRESH)
+    for (size_t s = 0; s < Nc; ++s)
+    {
+        for (size_t i = mpos[s]; i < mpos[s + 1]; ++i)
+        {
+            vw[s] += get(vweight, members[i]);
+            slot[s + 1] += out_degree(members[i], g);
+        }
+    }
+    for (size_t s = 0; s < Nc; ++s)
+        slot[s + 1] += slot[s];
+
+    vector<pair<size_t, double>> buf(slot[Nc]);
+    #pragma omp parallel for schedule(runtime) if (Nc > OPENMP_MIN_THRESH)
+    for (size_t s = 0; s < Nc; ++s)
+    {
+        auto begin = buf.begin() + slot[s];
+        auto end = begin;
+        for (size_t i = mpos[s]; i < mpos[s + 1]; ++i)
+        {
+            for (auto e : out_edges_range(members[i], g))
+            {
+                size_t t = cmap[target(e, g)];
+                if (t > s)
+                    *(end++) = {t, double(get(eweight, e))};
+            }
+        }
+        std::sort(begin, end,
+                  [](auto& a, auto& b) { return a.first < b.first; });
+        auto last = begin;
+        for (auto iter = begin; iter != end; ++iter)
+        {
+            if (iter != begin && iter->first == (last - 1)->first)
+                (last - 1)->second += iter->second;
+            else
+                *(last++) = *iter;
+        }
+        n_edges[s] = last - begin;
+    }
+
+    vector<size_t> epos(Nc + 1, 0);
+    for (size_t s = 0; s < Nc; ++s)
+        epos[s + 1] = epos[s] + n_edges[s];
+    size_t E = epos[Nc];
+
+    vector<size_t> source(E), target_(E);
+    c.eweight = typename sfdp_coarse_level<Val, D>::eweight_t
+        (get(edge_index, c.g), E);
+    auto& ew = c.eweight.get_storage();
+    #pragma omp parallel for schedule(runtime) if (Nc > OPENMP_MIN_THRESH)
+    for (size_t s = 0; s < Nc; ++s)
+    {
+        for (size_t i = 0; i < n_edges[s]; ++i)
+        {
+            auto& t = buf[slot[s] + i];
+            source[epos[s] + i] = s;
+            target_[epos[s] + i] = t.first;
+            ew[epos[s] + i] = t.second;
+        }
+    }
+    vector<pair<size_t, double>>().swap(buf);
+
+    for (size_t s = 0; s < Nc; ++s)
+        add_vertex(c.g);
+    c.g.add_edges(E,
+                  [&](size_t i) { return source[i]; },
+                  [&](size_t i) { return target_[i]; },
+                  [](size_t, const auto&) {});
+}
+
+// Labels the connected components of g.
+template <class Graph, class CompMap>
+void sfdp_components(const Graph& g, CompMap comp)
+{
+    size_t N = num_vertices(g);
+    vector<uint8_t> visited(N, false);
+    std::deque<size_t> queue;
+    int32_t c = 0;
+    for (auto r : vertices_range(g))
+    {
+        if (visited[r])
+            continue;
+        visited[r] = true;
+        queue.push_back(r);
+        while (!queue.empty())
+        {
+            auto v = queue.front();
+            queue.pop_front();
+            comp[v] = c;
+            for (auto u : out_neighbours_range(v, g))
+            {
+                if (visited[u])
+                    continue;
+                visited[u] = true;
+                queue.push_back(u);
+            }
+        }
+        c++;
+    }
+}
+
+// Average edge length, or one if it is zero or undefined.
+template <class Graph, class Val, size_t D>
+double sfdp_avg_dist(const Graph& g, const std::array<vector<Val>, D>& x)
+{
+    size_t count = 0;
+    double d = 0;
+    #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+        reduction(+: d, count)
+    parallel_vertex_loop_no_spawn
+        (g,
+         [&](auto v)
+         {
+             for (auto u : out_neighbours_range(v, g))
+             {
+                 double r = 0;
+                 for (size_t j = 0; j < D; ++j)
+                     r += power(double(x[j][v] - x[j][u]), 2);
+                 d += sqrt(r);
+                 count++;
+             }
+         });
+    if (count > 0)
+        d /= count;
+    if (std::isnan(d) || d == 0)
+        d = 1;
+    return d;
+}
+
+// Sets the positions of the vertices of the finer graph g from those of the
+// coarse level c. Contracted vertices are placed at the position of their
+// coarse vertex, with a uniform noise of amplitude delta. If c was obtained
+// by MIVS, the vertices in the set are placed exactly at their coarse
+// position, and the others at the average position of their neighbours in
+// the set, or, if there is only one, at its position with added noise.
+
+template <class Graph, class Val, size_t D, class RNG>
+void sfdp_prolong(const Graph& g, const sfdp_coarse_level<Val, D>& c,
+                  std::array<vector<Val>, D>& x, double delta, RNG& rng)
+{
+    vector<std::shared_ptr<RNG>> rngs;
+    init_rngs(rngs, rng);
+
+    auto& cmap = c.cmap;
+    auto& mivs = c.mivs;
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             auto& rng_ = get_rng(rngs, rng);
+             uniform_real_distribution<Val> noise(-delta, delta);
+             size_t count = 0;
+             if (mivs.empty() || mivs[v])
+             {
+                 for (size_t j = 0; j < D; ++j)
+                     x[j][v] = c.x[j][cmap[v]];
+                 count = mivs.empty() ? 1 : 0;
+             }
+             else
+             {
+                 for (size_t j = 0; j < D; ++j)
+                     x[j][v] = 0;
+                 for (auto u : out_neighbours_range(v, g))
+                 {
+                     if (u == v || !mivs[u])
+                         continue;
+                     for (size_t j = 0; j < D; ++j)
+                         x[j][v] += c.x[j][cmap[u]];
+                     count++;
+                 }
+                 if (count > 1)
+                 {
+                     for (size_t j = 0; j < D; ++j)
+                         x[j][v] /= count;
+                 }
+             }
+             if (count == 1 && delta > 0)
+             {
+                 for (size_t j = 0; j < D; ++j)
+                     x[j][v] += noise(rng_);
+             }
+         });
+}
+
+struct get_sfdp_multilevel_layout
+{
+    get_sfdp_multilevel_layout(double C, double p, double theta, double gamma,
+                               double mu, double mu_p, double step_schedule,
+                               size_t max_level, double epsilon,
+                               size_t max_iter, coarse_method_t method,
+                               double mivs_thres, double ec_thres,
+                               bool weighted, size_t dim)
+        : C(C), p(p), theta(theta), gamma(gamma), mu(mu), mu_p(mu_p),
+          step_schedule(step_schedule), epsilon(epsilon),
+          max_level(max_level), max_iter(max_iter), method(method),
+          mivs_thres(mivs_thres), ec_thres(ec_thres), weighted(weighted),
+          dim(dim) {}
+
+    double C, p, theta, gamma, mu, mu_p, step_schedule, epsilon;
+    size_t max_level, max_iter;
+    coarse_method_t method;
+    double mivs_thres, ec_thres;
+    bool weighted;
+    size_t dim;
+
+    typedef std::chrono::steady_clock clock_t;
+
+    static double elapsed(clock_t::time_point start)
+    {
+        return std::chrono::duration<double>(clock_t::now() - start).count();
+    }
+
+    // Lays out the graph g, and returns the statistics of every level,
+    // starting from g itself. If the vertices of g are grouped (has_groups
+    // == true), each group is contracted into a single vertex at the first
+    // coarsening step, and the groups are used in the final layout, otherwise
+    // the connected components are used as groups in every level. The
+    // layout has dim == 2 or 3 dimensions.
+    template <class Graph, class PosMap, class VertexWeightMap,
+              class EdgeWeightMap, class GroupMap, class RNG>
+    void operator()(Graph& g, PosMap pos, VertexWeightMap vweight,
+                    EdgeWeightMap eweight, GroupMap group, bool has_groups,
+                    RNG& rng, vector<sfdp_level_stats>& stats) const
+    {
+        switch (dim)
+        {
+        case 2:
+            run<2>(g, pos, vweight, eweight, group, has_groups, rng, stats);
+            break;
+        case 3:
+            run<3>(g, pos, vweight, eweight, group, has_groups, rng, stats);
+            break;
+        default:
+            throw ValueException("only two- or three-dimensional layouts "
+                                 "are supported");
+        }
+    }
+
+private:
+    template <size_t D, class Graph, class PosMap, class VertexWeightMap,
+              class EdgeWeightMap, class GroupMap, class RNG>
+    void run(Graph& g, PosMap pos, VertexWeightMap vweight,
+             EdgeWeightMap eweight, GroupMap group, bool has_groups,
+             RNG& rng, vector<sfdp_level_stats>& stats) const
+    {
+        typedef typename property_traits<PosMap>::value_type::value_type val_t;
+        typedef sfdp_coarse_level<val_t, D> level_t;
+
+        typedef unchecked_vector_property_map
+            <int32_t, typed_identity_property_map<size_t>> comp_map_t;
+
+        // the finest level may be a filtered graph, in which case N is only
+        // the range of the vertex indexes
+        size_t N = num_vertices(g);
+        vector<std::unique_ptr<level_t>> levels;
+        std::array<vector<val_t>, D> x_fine;
+
+        stats.clear();
+        stats.emplace_back();
+        stats[0].N = HardNumVertices()(g);
+        stats[0].E = HardNumEdges()(g);
+
+        // coarsening
+        bool mivs = (method == coarse_method_t::mivs);
+        bool use_groups = has_groups;
+        while (true)
+        {
+            auto start = clock_t::now();
+            std::unique_ptr<level_t> c(new level_t());
+            auto coarsen = [&](auto& u, auto u_vweight, auto u_eweight)
+                {
+                    size_t Nc;
+                    if (use_groups)
+                    {
+                        gt_hash_map<int32_t, size_t> gmap;
+                        c->cmap.resize(num_vertices(u));
+                        for (auto v : vertices_range(u))
+                        {
+                            auto iter = gmap.find(group[v]);
+                            if (iter == gmap.end())
+                                iter = gmap.insert({group[v],
+                                                    gmap.size()}).first;
+                            c->cmap[v] = iter->second;
+                        }
+                        Nc = gmap.size();
+                    }
+                    else if (mivs)
+                    {
+                        Nc = sfdp_mivs(u, u_eweight, c->mivs, c->cmap);
+                    }
+                    else
+                    {
+                        Nc = sfdp_heavy_edge_matching(u, u_eweight, c->cmap);
+                    }
+                    sfdp_contract(u, u_vweight, u_eweight, Nc, *c);
+                    return HardNumVertices()(u);
+                };
+
+            size_t Nf;
+            if (levels.empty())
+                Nf = coarsen(g, vweight, eweight);
+            else
+                Nf = coarsen(levels.back()->ug, levels.back()->vweight,
+                             levels.back()->eweight);
+            use_groups = false;
+
+            size_t Nc = num_vertices(c->g);
+            c->stats.N = Nc;
+            c->stats.E = num_edges(c->g);
+            c->stats.mivs = !c->mivs.empty();
+            c->stats.coarse_time = elapsed(start);
+
+            double thres = mivs ? mivs_thres : ec_thres;
+            if (Nc >= thres * Nf)
+            {
+                if (method == coarse_method_t::hybrid && !mivs)
+                {
+                    mivs = true;
+                    if (Nc == Nf)
+                        continue;
+                }
+                else
+                {
+                    break;
+                }
+            }
+            if (Nc <= 2)
+                break;
+            levels.push_back(std::move(c));
+        }
+
+        // natural spring lengths, from the coarsest level
+        size_t L = levels.size();
+        vector<double> Ks(L + 1);
+        {
+            auto& x = (L > 0) ? levels.back()->x : x_fine;
+            size_t M = (L > 0) ? num_vertices(levels.back()->g) : N;
+            size_t n = (L > 0) ? M : stats[0].N;
+            uniform_real_distribution<val_t> sample(0, sqrt(double(n)));
+            for (size_t j = 0; j < D; ++j)
+            {
+                x[j].resize(M);
+                for (size_t v = 0; v < M; ++v)
+                    x[j][v] = sample(rng);
+            }
+            if (L > 0)
+                Ks[L] = sfdp_avg_dist(levels.back()->ug, x);
+            else
+                Ks[L] = sfdp_avg_dist(g, x);
+            for (size_t l = L; l > 0; --l)
+                Ks[l - 1] = Ks[l] * (weighted ? 1. : 0.75);
+        }
+
+        // layout, from the coarsest to the finest level
+        for (size_t l = L; l > 0; --l)
+        {
+            auto& c = *levels[l - 1];
+            auto start = clock_t::now();
+            comp_map_t comp(get(vertex_index, c.g), num_vertices(c.g));
+            sfdp_components(c.ug, comp);
+            if (weighted)
+                c.stats.n_iter = run_layout(c.ug, c.x, c.vweight, c.eweight,
+                                            comp, Ks[l], rng);
+            else
+                c.stats.n_iter =
+                    run_layout(c.ug, c.x,
+                               UnityPropertyMap<int, size_t>(),
+                               UnityPropertyMap<int,
+                                                typename graph_traits
+                                                    <typename level_t::graph_t>
+                                                    ::edge_descriptor>(),
+                               comp, Ks[l], rng);
+            c.stats.K = Ks[l];
+            c.stats.layout_time = elapsed(start);
+
+            start = clock_t::now();
+            auto& x = (l > 1) ? levels[l - 2]->x : x_fine;
+            for (size_t j = 0; j < D; ++j)
+                x[j].resize((l > 1) ? num_vertices(levels[l - 2]->g) : N);
+            if (l > 1)
+                sfdp_prolong(levels[l - 2]->ug, c, x, Ks[l] / 1000., rng);
+            else
+                sfdp_prolong(g, c, x, Ks[l] / 1000., rng);
+            c.stats.prolong_time = elapsed(start);
+
+            // the coarse graph is no longer needed
+            stats.push_back(c.stats);
+            levels[l - 1].reset();
+        }
+
+        auto& x = x_fine;
+        auto start = clock_t::now();
+        if (has_groups)
+        {
+            stats[0].n_iter = run_layout(g, x, vweight, eweight, group, Ks[0],
+                                         rng);
+        }
+        else
+        {
+            comp_map_t comp(typed_identity_property_map<size_t>(), N);
+            sfdp_components(g, comp);
+            stats[0].n_iter = run_layout(g, x, vweight, eweight, comp, Ks[0],
+                                         rng);
+        }
+        stats[0].K = Ks[0];
+        stats[0].layout_time = elapsed(start);
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 pos[v].resize(D);
+                 for (size_t j = 0; j < D; ++j)
+                     pos[v][j] = x[j][v];
+             });
+
+        // the coarse levels were appended from the coarsest to the finest
+        std::reverse(stats.begin() + 1, stats.end());
+    }
+
+    // lays out a single level, with the same special cases as sfdp_layout()
+    template <class Graph, class Val, size_t D, class VertexWeightMap,
+              class EdgeWeightMap, class GroupMap, class RNG>
+    size_t run_layout(Graph& g, std::array<vector<Val>, D>& x,
+                      VertexWeightMap vweight, EdgeWeightMap eweight,
+                      GroupMap group, double K, RNG& rng) const
+    {
+        size_t N = HardNumVertices()(g);
+        if (N <= 1)
+            return 0;
+        if (N == 2)
+        {
+            size_t i = 0;
+            for (auto v : vertices_range(g))
+            {
+                for (size_t j = 0; j < D; ++j)
+                    x[j][v] = i;
+                ++i;
+            }
+            return 0;
+        }
+        size_t ml = (N <= 50) ? 0 : max_level;
+        double init_step = 2 * std::max(sfdp_avg_dist(g, x), K);
+        get_sfdp_layout layout(C, K, p, theta, gamma, mu, mu_p, init_step,
+                               step_schedule, ml, epsilon, max_iter, true);
+        ConstantPropertyMap<uint8_t, size_t> pin(0);
+        return layout.layout(g, x, vweight, eweight, pin, group, false, rng);
+    }
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_SFDP_MULTILEVEL_HH
@@ -64,8 +64,8 @@ typedef boost::mpl::map<
     boost::mpl::pair<std::complex<long double>, boost::mpl::int_<NPY_CLONGDOUBLE> > 
     > numpy_types;
 
-template <class ValueType>
-boost::python::object wrap_vector_owned(const vector<ValueType>& vec)
+template <class ValueType, class Alloc>
+boost::python::object wrap_vector_owned(const vector<ValueType, Alloc>& vec)
 {
     int val_type = boost::mpl::at<numpy_types,ValueType>::type::value;
     npy_intp size[1];
@@ -89,8 +89,8 @@ boost::python::object wrap_vector_owned(const vector<ValueType>& vec)
     return o;
 }
 
-template <class ValueType>
-boost::python::object wrap_vector_not_owned(vector<ValueType>& vec)
+template <class ValueType, class Alloc>
+boost::python::object wrap_vector_not_owned(vector<ValueType, Alloc>& vec)
 {
     PyArrayObject* ndarray;
     int val_type = boost::mpl::at<numpy_types,ValueType>::type::value;
@@ -21,6 +21,7 @@
 #include "graph_properties.hh"
 
 #include "graph_distance_sampled.hh"
+#include "graph_hyperanf.hh"
 
 #include "random.hh"
 
@@ -59,7 +60,38 @@ python::object sampled_distance_histogram(GraphInterface& gi, boost::any weight,
     return ret;
 }
 
+python::object hyperanf(GraphInterface& gi, size_t b, size_t max_dist,
+                        boost::any harmonic, rng_t& rng)
+{
+    if (b < 4 || b > 16)
+        throw ValueException("precision must lie in the interval [4, 16]");
+
+    uint64_t seed = (uint64_t(rng()) << 32) | rng();
+    vector<double> nf;
+
+    if (harmonic.empty())
+    {
+        run_action<>()
+            (gi, [&](auto& g)
+             {
+                 get_hyperanf()(g, b, max_dist, seed, nf, false,
+                                dummy_property_map());
+             })();
+    }
+    else
+    {
+        run_action<>()
+            (gi, [&](auto& g, auto hc)
+             {
+                 get_hyperanf()(g, b, max_dist, seed, nf, true, hc);
+             },
+             vertex_floating_properties())(harmonic);
+    }
+    return wrap_vector_owned(nf);
+}
+
 void export_sampled_distance()
 {
     python::def("sampled_distance_histogram", &sampled_distance_histogram);
+    python::def("hyperanf", &hyperanf);
 }
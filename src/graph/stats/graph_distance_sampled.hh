@@ -18,7 +18,6 @@
 #ifndef GRAPH_DISTANCE_SAMPLED_HH
 #define GRAPH_DISTANCE_SAMPLED_HH
 
-#include <boost/graph/breadth_first_search.hpp>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 
 #include <boost/python/object.hpp>
@@ -28,6 +27,7 @@
 #include "histogram.hh"
 #include "numpy_bind.hh"
 #include "hash_map_wrap.hh"
+#include "graph_ms_bfs.hh"
 
 namespace graph_tool
 {
@@ -52,71 +52,88 @@ struct get_val_type<no_weightS>
 
 struct get_sampled_distance_histogram
 {
+    // unweighted version, which uses a multi-source BFS
+    template <class Graph, class VertexIndex, class RNG>
+    void operator()(const Graph& g, VertexIndex, no_weightS, size_t n_samples,
+                    const vector<long double>& obins, python::object& phist,
+                    RNG& rng) const
+    {
+        typedef size_t val_type;
+        typedef Histogram<val_type, size_t, 1> hist_t;
+
+        hist_t hist(get_hist_bins<val_type>(obins));
+        SharedHistogram<hist_t> s_hist(hist);
+
+        auto sources = sample_sources(g, n_samples, rng);
+
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            firstprivate(s_hist)
+        {
+            typename hist_t::point_t point;
+            parallel_ms_bfs_no_spawn
+                (g, sources,
+                 [&](auto& bfs, auto batch, size_t n)
+                 {
+                     bfs.search(g, batch, n,
+                                [&](auto, auto mask, size_t d)
+                                {
+                                    point[0] = d;
+                                    s_hist.put_value(point,
+                                                     __builtin_popcountll(mask));
+                                });
+                 });
+        }
+        s_hist.gather();
 
+        python::list ret;
+        ret.append(wrap_multi_array_owned<size_t,1>(hist.get_array()));
+        ret.append(wrap_vector_owned<val_type>(hist.get_bins()[0]));
+        phist = ret;
+    }
+
+    // weighted version, which uses Dijkstra's algorithm from every source
     template <class Graph, class VertexIndex, class WeightMap, class RNG>
     void operator()(const Graph& g, VertexIndex vertex_index, WeightMap weights,
                     size_t n_samples, const vector<long double>& obins,
                     python::object& phist, RNG& rng) const
     {
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-
-        // select get_vertex_dists based on the existence of weights
-        typedef typename mpl::if_<std::is_same<WeightMap, no_weightS>,
-                                  get_dists_bfs,
-                                  get_dists_djk>::type get_vertex_dists_t;
-
-
         // distance type
         typedef typename get_val_type<WeightMap>::type val_type;
         typedef Histogram<val_type, size_t, 1> hist_t;
 
-        std::array<vector<val_type>,1> bins;
-        bins[0].resize(obins.size());
-        for (size_t i = 0; i < obins.size(); ++i)
-            bins[0][i] = obins[i];
-
-        hist_t hist(bins);
+        hist_t hist(get_hist_bins<val_type>(obins));
         SharedHistogram<hist_t> s_hist(hist);
 
-        vector<vertex_t> sources;
-        sources.reserve(num_vertices(g));
-        for (auto v : vertices_range(g))
-            sources.push_back(v);
-        n_samples = min(n_samples, sources.size());
-
-        typename hist_t::point_t point;
-        get_vertex_dists_t get_vertex_dists;
+        auto sources = sample_sources(g, n_samples, rng);
 
-        #pragma omp parallel for default(shared) private(point) \
-            firstprivate(s_hist) schedule(runtime) \
-            if (num_vertices(g) * n_samples > OPENMP_MIN_THRESH)
-        for (size_t i = 0; i < n_samples; ++i)
+        #pragma omp parallel if (num_vertices(g) * sources.size() > \
+                                 OPENMP_MIN_THRESH) firstprivate(s_hist)
         {
-            vertex_t v;
-            #pragma omp critical
-            {
-                uniform_int_distribution<size_t> randint(0, sources.size()-1);
-                size_t j = randint(rng);
-                v = sources[j];
-                swap(sources[j], sources.back());
-                sources.pop_back();
-            }
-
+            typename hist_t::point_t point;
             unchecked_vector_property_map<val_type,VertexIndex>
                 dist_map(vertex_index, num_vertices(g));
 
-            for (auto u : vertices_range(g))
-                dist_map[u] = numeric_limits<val_type>::max();
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < sources.size(); ++i)
+            {
+                auto v = sources[i];
 
-            dist_map[v] = 0;
-            get_vertex_dists(g, v, vertex_index, dist_map, weights);
+                for (auto u : vertices_range(g))
+                    dist_map[u] = numeric_limits<val_type>::max();
 
-            for (auto v2 : vertices_range(g))
-            {
-                if (v2 != v && dist_map[v2] != numeric_limits<val_type>::max())
+                dist_map[v] = 0;
+                dijkstra_shortest_paths(g, v, vertex_index_map(vertex_index).
+                                        weight_map(weights).
+                                        distance_map(dist_map));
+
+                for (auto v2 : vertices_range(g))
                 {
-                    point[0] = dist_map[v2];
-                    s_hist.put_value(point);
+                    if (v2 != v &&
+                        dist_map[v2] != numeric_limits<val_type>::max())
+                    {
+                        point[0] = dist_map[v2];
+                        s_hist.put_value(point);
+                    }
                 }
             }
         }
@@ -128,43 +145,24 @@ struct get_sampled_distance_histogram
         phist = ret;
     }
 
-    // weighted version. Use dijkstra_shortest_paths()
-    struct get_dists_djk
-    {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap, class WeightMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, WeightMap weights) const
-        {
-            dijkstra_shortest_paths(g, s, vertex_index_map(vertex_index).
-                                    weight_map(weights).distance_map(dist_map));
-        }
-    };
-
-    // unweighted version. Use BFS.
-    struct get_dists_bfs
+    // uniform sample of source vertices, without replacement
+    template <class Graph, class RNG>
+    static vector<typename graph_traits<Graph>::vertex_descriptor>
+    sample_sources(const Graph& g, size_t n_samples, RNG& rng)
     {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, no_weightS) const
+        vector<typename graph_traits<Graph>::vertex_descriptor> sources;
+        sources.reserve(num_vertices(g));
+        for (auto v : vertices_range(g))
+            sources.push_back(v);
+        n_samples = min(n_samples, sources.size());
+        for (size_t i = 0; i < n_samples; ++i)
         {
-            typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-            typedef typename vprop_map_t<default_color_type>::type::unchecked_t vmap_t;
-            vmap_t color_map(vertex_index, num_vertices(g));
-            parallel_vertex_loop
-                (g,
-                 [&](auto v)
-                 {
-                     color_map[v] = color_traits<default_color_type>::white();
-                 });
-            breadth_first_visit(g, s,
-                                visitor(make_bfs_visitor
-                                        (record_distances(dist_map,
-                                                          on_tree_edge()))).
-                                color_map(color_map));
+            uniform_int_distribution<size_t> randint(i, sources.size() - 1);
+            swap(sources[i], sources[randint(rng)]);
         }
-    };
+        sources.resize(n_samples);
+        return sources;
+    }
 };
 
 } // boost namespace
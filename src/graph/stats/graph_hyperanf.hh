@@ -0,0 +1,242 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2016 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_HYPERANF_HH
+#define GRAPH_HYPERANF_HH
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+#include "graph_selectors.hh"
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Approximate neighbourhood function, computed with HyperANF: P. Boldi, M.
+// Rosa, S. Vigna, "HyperANF: approximating the neighbourhood function of very
+// large graphs on a budget", WWW '11.
+//
+// Every vertex v keeps a HyperLogLog counter with 2^b registers, which
+// estimates the size of the ball B(v, t) of vertices reachable from v in at
+// most t steps. Since B(v, t + 1) is the union of B(v, t) and B(u, t) for all
+// out-neighbours u of v, each iteration is a single parallel pass over the
+// edges, where the counters are merged by taking the register-wise maximum. A
+// counter is only recomputed if one of its out-neighbours changed in the
+// previous iteration.
+
+class hyperloglog_array
+{
+public:
+    hyperloglog_array(size_t N, size_t b, uint64_t seed)
+        : _b(b), _m(size_t(1) << b), _seed(seed), _regs(N << b, 0)
+    {
+        switch (_m)
+        {
+        case 16:
+            _alpha = 0.673;
+            break;
+        case 32:
+            _alpha = 0.697;
+            break;
+        case 64:
+            _alpha = 0.709;
+            break;
+        default:
+            _alpha = 0.7213 / (1 + 1.079 / _m);
+        }
+        for (size_t r = 0; r < _pow.size(); ++r)
+            _pow[r] = std::ldexp(1., -int(r));
+    }
+
+    size_t size() const { return _m; }
+
+    uint8_t* operator[](size_t v) { return &_regs[v << _b]; }
+    const uint8_t* operator[](size_t v) const { return &_regs[v << _b]; }
+
+    void insert(size_t v, uint64_t x)
+    {
+        uint64_t h = hash(x);
+        size_t j = h >> (64 - _b);
+        uint64_t w = h << _b;
+        uint8_t rank = (w == 0) ? uint8_t(64 - _b + 1) :
+            uint8_t(__builtin_clzll(w) + 1);
+        auto r = (*this)[v];
+        r[j] = std::max(r[j], rank);
+    }
+
+    double estimate(size_t v) const
+    {
+        auto r = (*this)[v];
+        double S = 0;
+        size_t zeros = 0;
+        for (size_t j = 0; j < _m; ++j)
+        {
+            S += _pow[r[j]];
+            if (r[j] == 0)
+                ++zeros;
+        }
+        double E = _alpha * _m * _m / S;
+        if (E <= 2.5 * _m && zeros > 0)
+            E = _m * std::log(_m / double(zeros));
+        return E;
+    }
+
+    // merges the counter u of "other" into v, and returns true if v changed
+    bool merge(size_t v, const hyperloglog_array& other, size_t u)
+    {
+        auto r = (*this)[v];
+        auto s = other[u];
+        uint8_t changed = 0;
+        for (size_t j = 0; j < _m; ++j)
+        {
+            uint8_t x = std::max(r[j], s[j]);
+            changed |= x ^ r[j];
+            r[j] = x;
+        }
+        return changed != 0;
+    }
+
+    void copy(size_t v, const hyperloglog_array& other, size_t u)
+    {
+        std::memcpy((*this)[v], other[u], _m);
+    }
+
+    void swap(hyperloglog_array& other)
+    {
+        _regs.swap(other._regs);
+    }
+
+private:
+    // splitmix64 finalizer
+    uint64_t hash(uint64_t x) const
+    {
+        x += _seed + 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    size_t _b;
+    size_t _m;
+    uint64_t _seed;
+    double _alpha;
+    std::array<double, 66> _pow;
+    vector<uint8_t> _regs;
+};
+
+struct get_hyperanf
+{
+    // Fills nf[t] with the estimated number of pairs (u, v) with
+    // d(u, v) <= t, for t = 0, ..., until the counters stop changing, or
+    // t == max_dist. If harmonic is true, hc[v] is set to the estimated sum of
+    // 1/d(v, u) over all u != v.
+    template <class Graph, class Harmonic>
+    void operator()(const Graph& g, size_t b, size_t max_dist, uint64_t seed,
+                    vector<double>& nf, bool harmonic, Harmonic hc) const
+    {
+        size_t N = num_vertices(g);
+        hyperloglog_array c(N, b, seed), next(N, b, seed);
+        vector<double> est(N), h(harmonic ? N : 0);
+        vector<uint8_t> changed(N), next_changed(N);
+
+        double total = 0;
+        #pragma omp parallel for schedule(runtime) reduction(+:total) \
+            if (N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto v = vertex(i, g);
+            if (!is_valid_vertex(v, g))
+                continue;
+            c.insert(v, v);
+            est[v] = c.estimate(v);
+            changed[v] = true;
+            total += est[v];
+        }
+        nf.clear();
+        nf.push_back(total);
+
+        for (size_t t = 1; t <= max_dist; ++t)
+        {
+            total = 0;
+            size_t n_changed = 0;
+            #pragma omp parallel for schedule(runtime) \
+                reduction(+:total, n_changed) if (N > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < N; ++i)
+            {
+                auto v = vertex(i, g);
+                if (!is_valid_vertex(v, g))
+                    continue;
+
+                next.copy(v, c, v);
+                bool dirty = false;
+                for (auto u : out_neighbours_range(v, g))
+                {
+                    if (changed[u])
+                        dirty |= next.merge(v, c, u);
+                }
+
+                if (dirty)
+                {
+                    double e = next.estimate(v);
+                    if (harmonic)
+                        h[v] += std::max(e - est[v], 0.) / t;
+                    est[v] = e;
+                    ++n_changed;
+                }
+                next_changed[v] = dirty;
+                total += est[v];
+            }
+
+            if (n_changed == 0)
+                break;
+
+            nf.push_back(total);
+            c.swap(next);
+            changed.swap(next_changed);
+        }
+
+        if (harmonic)
+            put_harmonic(g, h, hc);
+    }
+
+    template <class Graph, class Harmonic>
+    static void put_harmonic(const Graph& g, const vector<double>& h,
+                             Harmonic hc)
+    {
+        typedef typename property_traits<Harmonic>::value_type val_t;
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 hc[v] = val_t(h[v]);
+             });
+    }
+
+    template <class Graph>
+    static void put_harmonic(const Graph&, const vector<double>&,
+                             dummy_property_map) {}
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_HYPERANF_HH
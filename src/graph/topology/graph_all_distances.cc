@@ -19,6 +19,7 @@
 #include "graph_filtering.hh"
 #include "graph_properties.hh"
 #include "graph_selectors.hh"
+#include "graph_ms_bfs.hh"
 
 #include <boost/python.hpp>
 
@@ -65,65 +66,40 @@ struct do_all_pairs_search
 
 struct do_all_pairs_search_unweighted
 {
-    template <class DistMap, class PredMap>
-    class bfs_visitor: public boost::bfs_visitor<null_visitor>
-    {
-    public:
-        bfs_visitor(DistMap& dist_map, PredMap& pred, size_t source)
-        : _dist_map(dist_map), _pred(pred), _source(source) {}
-
-        template <class Graph>
-        void initialize_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                               Graph&)
-        {
-            typedef typename DistMap::value_type dist_t;
-            dist_t inf = std::is_floating_point<dist_t>::value ?
-                numeric_limits<dist_t>::infinity() :
-                numeric_limits<dist_t>::max();
-            _dist_map[v] = (v == _source) ? 0 : inf;
-            _pred[v] = v;
-        }
-
-        template <class Graph>
-        void tree_edge(const typename graph_traits<Graph>::edge_descriptor& e,
-                       Graph& g)
-        {
-            _pred[target(e,g)] = source(e,g);
-        }
-
-        template <class Graph>
-        void discover_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                             Graph&)
-        {
-            if (size_t(_pred[v]) == v)
-                return;
-            _dist_map[v] = _dist_map[_pred[v]] + 1;
-        }
-
-    private:
-        DistMap& _dist_map;
-        PredMap& _pred;
-        size_t _source;
-    };
-
     template <class Graph, class DistMap>
     void operator()(const Graph& g, DistMap dist_map) const
     {
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        typedef typename property_traits<DistMap>::value_type::value_type
+            dist_t;
+        dist_t inf = std::is_floating_point<dist_t>::value ?
+            numeric_limits<dist_t>::infinity() :
+            numeric_limits<dist_t>::max();
 
-        vector<vertex_t> pred_map(num_vertices(g));
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            firstprivate(pred_map)
-        parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
+        size_t N = num_vertices(g);
+        parallel_ms_bfs
+            (g,
+             [&](auto& bfs, auto sources, size_t n)
+             {
+                 for (size_t i = 0; i < n; ++i)
                  {
-                     dist_map[v].resize(num_vertices(g), 0);
-                     bfs_visitor<typename std::remove_reference<decltype(dist_map[v])>::type,
-                                 vector<size_t>>
-                         vis(dist_map[v], pred_map, v);
-                     breadth_first_search(g, v, visitor(vis));
-                 });
+                     auto& dist = dist_map[sources[i]];
+                     dist.clear();
+                     dist.resize(N, 0);
+                     for (auto u : vertices_range(g))
+                         dist[u] = inf;
+                     dist[sources[i]] = 0;
+                 }
+
+                 bfs.search(g, sources, n,
+                            [&](auto v, auto mask, size_t d)
+                            {
+                                for_each_bit(mask,
+                                             [&](size_t i)
+                                             {
+                                                 dist_map[sources[i]][v] = d;
+                                             });
+                            });
+             });
     }
 };
 
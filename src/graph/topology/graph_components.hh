@@ -22,6 +22,19 @@
 #include <boost/graph/strong_components.hpp>
 #include <boost/graph/biconnected_components.hpp>
 
+#include <vector>
+#include <atomic>
+#include <limits>
+#include <random>
+#include <tuple>
+
+#include "graph_parallel_bfs.hh"
+#include "hash_map_wrap.hh"
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
 namespace graph_tool
 {
 template <class PropertyMap>
@@ -96,9 +109,545 @@ void put(HistogramPropertyMap<PropertyMap> pmap,
 }
 
 
+// Weakly connected components of an undirected graph, computed in parallel
+// with the Afforest algorithm: M. Sutton, T. Ben-Nun, A. Barak, "Optimizing
+// parallel graph connectivity computation via subgraph sampling", IPDPS '18.
+//
+// This is a lock-free union-find (as in Shiloach-Vishkin), in which every
+// vertex points to a vertex with a smaller index, and the trees are linked by
+// atomic compare-and-swap operations. First, only the first two edges of each
+// vertex are linked, which is usually enough to form most of the largest
+// component. This component is then identified by sampling, and the remaining
+// edges of its vertices are skipped. On return, root[v] is the smallest vertex
+// index in the component of v.
+template <class Graph>
+void parallel_connected_components(const Graph& g, vector<size_t>& root)
+{
+    size_t N = num_vertices(g);
+    vector<std::atomic<size_t>> comp(N);
+    #pragma omp parallel for schedule(static) if (N > OPENMP_MIN_THRESH)
+    for (size_t i = 0; i < N; ++i)
+        comp[i].store(i, std::memory_order_relaxed);
+
+    auto link = [&](size_t u, size_t v)
+        {
+            size_t p1 = comp[u].load(std::memory_order_relaxed);
+            size_t p2 = comp[v].load(std::memory_order_relaxed);
+            while (p1 != p2)
+            {
+                size_t high = std::max(p1, p2);
+                size_t low = std::min(p1, p2);
+                size_t p_high = comp[high].load(std::memory_order_relaxed);
+                if (p_high == low)
+                    break;
+                if (p_high == high &&
+                    comp[high].compare_exchange_strong(p_high, low))
+                    break;
+                p1 = comp[comp[high].load(std::memory_order_relaxed)]
+                    .load(std::memory_order_relaxed);
+                p2 = comp[low].load(std::memory_order_relaxed);
+            }
+        };
+
+    auto compress = [&]()
+        {
+            #pragma omp parallel for schedule(runtime) \
+                if (N > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < N; ++i)
+            {
+                size_t c = comp[i].load(std::memory_order_relaxed);
+                while (true)
+                {
+                    size_t cc = comp[c].load(std::memory_order_relaxed);
+                    if (cc == c)
+                        break;
+                    c = cc;
+                }
+                comp[i].store(c, std::memory_order_relaxed);
+            }
+        };
+
+    const size_t n_rounds = 2;
+    for (size_t r = 0; r < n_rounds; ++r)
+    {
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t j = 0;
+                 for (auto u : out_neighbours_range(v, g))
+                 {
+                     if (j++ < r)
+                         continue;
+                     link(v, u);
+                     break;
+                 }
+             });
+        compress();
+    }
+
+    // find the largest intermediate component by sampling
+    size_t c_max = 0;
+    if (N > 0)
+    {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<size_t> sample(0, N - 1);
+        gt_hash_map<size_t, size_t> count;
+        size_t n_max = 0;
+        for (size_t i = 0; i < 1024; ++i)
+        {
+            auto v = vertex(sample(rng), g);
+            if (!is_valid_vertex(v, g))
+                continue;
+            size_t c = comp[v].load(std::memory_order_relaxed);
+            size_t n = ++count[c];
+            if (n > n_max)
+            {
+                n_max = n;
+                c_max = c;
+            }
+        }
+    }
+
+    // Every edge between the largest component and another vertex is linked
+    // from the other endpoint, since the graph is undirected.
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             if (comp[v].load(std::memory_order_relaxed) == c_max)
+                 return;
+             size_t j = 0;
+             for (auto u : out_neighbours_range(v, g))
+             {
+                 if (j++ < n_rounds)
+                     continue;
+                 link(v, u);
+             }
+         });
+    compress();
+
+    root.resize(N);
+    #pragma omp parallel for schedule(static) if (N > OPENMP_MIN_THRESH)
+    for (size_t i = 0; i < N; ++i)
+        root[i] = comp[i].load(std::memory_order_relaxed);
+}
+
+// Strongly connected components of a directed graph, computed in parallel with
+// the "Multistep" method of G. M. Slota, S. Rajamanickam, K. Madduri, "BFS and
+// coloring-based parallel algorithms for strongly connected components and
+// related problems", IPDPS '14.
+//
+//  1. Vertices without incoming or outgoing edges to the remaining vertices
+//     are trivial components, and are removed recursively ("trimming").
+//  2. The component of a vertex with large in- and out-degrees, which is
+//     likely to be the largest one, is obtained as the intersection of its
+//     forward and backward reachable sets (FW-BW).
+//  3. The remaining vertices are "colored" by propagating the largest vertex
+//     index forward until convergence. Every vertex whose color is its own
+//     index is then the root of a component, containing the vertices of the
+//     same color from which it is reachable backwards. This is repeated until
+//     few vertices remain, which are processed serially with Tarjan's
+//     algorithm.
+//
+// On return, root[v] is the index of a representative vertex of the component
+// of v.
+template <class Graph>
+class parallel_strong_components
+{
+public:
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    parallel_strong_components(const Graph& g)
+        : _g(g), _N(num_vertices(g)), _root(_N), _color(_N), _k_in(_N),
+          _k_out(_N), _queued(_N, false) {}
+
+    void operator()(vector<size_t>& root)
+    {
+        #pragma omp parallel for schedule(static) if (_N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < _N; ++i)
+            _root[i].store(_null, std::memory_order_relaxed);
+
+        for (auto v : vertices_range(_g))
+            _remaining.push_back(v);
+
+        trim();
+        fw_bw();
+        while (_remaining.size() > OPENMP_MIN_THRESH)
+        {
+            color();
+            trim();
+        }
+        tarjan();
+
+        root.resize(_N);
+        #pragma omp parallel for schedule(static) if (_N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < _N; ++i)
+            root[i] = _root[i].load(std::memory_order_relaxed);
+    }
+
+private:
+    bool is_remaining(vertex_t v)
+    {
+        return _root[v].load(std::memory_order_relaxed) == _null;
+    }
+
+    // sets the root of v to r, if it was not yet assigned
+    bool claim(vertex_t v, size_t r)
+    {
+        size_t x = _null;
+        return (_root[v].load(std::memory_order_relaxed) == _null &&
+                _root[v].compare_exchange_strong(x, r,
+                                                 std::memory_order_relaxed));
+    }
+
+    // keeps only the vertices in _remaining without an assigned root
+    void compact()
+    {
+        _next.clear();
+        #pragma omp parallel if (_remaining.size() > OPENMP_MIN_THRESH)
+        {
+            vector<vertex_t> local;
+            #pragma omp for schedule(runtime) nowait
+            for (size_t i = 0; i < _remaining.size(); ++i)
+            {
+                auto v = _remaining[i];
+                if (is_remaining(v))
+                    local.push_back(v);
+            }
+            #pragma omp critical (scc_gather)
+            _next.insert(_next.end(), local.begin(), local.end());
+        }
+        _remaining.swap(_next);
+    }
+
+    template <class Range>
+    size_t count_remaining(vertex_t v, Range&& us)
+    {
+        size_t k = 0;
+        for (auto u : us)
+        {
+            if (u != v && is_remaining(u))
+                ++k;
+        }
+        return k;
+    }
+
+    // Removes the vertices without in- or out-neighbours among the remaining
+    // vertices, and then their neighbours which are left in the same
+    // situation, and so on, in O(V + E) time.
+    void trim()
+    {
+        // only the entries of the remaining vertices are used, and they are
+        // all set below
+        auto& k_in = _k_in;
+        auto& k_out = _k_out;
+        vector<vertex_t> frontier;
+        #pragma omp parallel if (_remaining.size() > OPENMP_MIN_THRESH)
+        {
+            vector<vertex_t> local;
+            #pragma omp for schedule(runtime) nowait
+            for (size_t i = 0; i < _remaining.size(); ++i)
+            {
+                auto v = _remaining[i];
+                k_out[v] = count_remaining(v, out_neighbours_range(v, _g));
+                k_in[v] = count_remaining(v, in_neighbours_range(v, _g));
+                if (k_out[v] == 0 || k_in[v] == 0)
+                    local.push_back(v);
+            }
+            #pragma omp critical (scc_gather)
+            frontier.insert(frontier.end(), local.begin(), local.end());
+        }
+
+        for (auto v : frontier)
+            claim(v, v);
+
+        // the root of each trimmed vertex is only assigned after its
+        // neighbours were counted
+        auto remove = [&](vector<size_t>& k, vertex_t u, vertex_t w)
+            {
+                if (u == w || !is_remaining(u))
+                    return false;
+                size_t x;
+                #pragma omp atomic capture
+                x = k[u]--;
+                return (x == 1 && claim(u, u));
+            };
+
+        search(frontier, true, true,
+               [&](vertex_t u, vertex_t w) { return remove(k_in, u, w); },
+               [&](vertex_t u, vertex_t w) { return remove(k_out, u, w); });
+        compact();
+    }
+
+    // Level-synchronous search from the vertices in "frontier", following the
+    // out-neighbours if forward == true or the in-neighbours otherwise, and
+    // calling visit(u, w) for every neighbour u of a reached vertex w; the
+    // vertex u is reached if visit() returns true. The function visit() must
+    // return true at most once per vertex.
+    template <class Visit>
+    void search(vector<vertex_t>& frontier, bool forward, Visit&& visit)
+    {
+        search(frontier, forward, !forward, visit, visit);
+    }
+
+    // as above, but following the out-neighbours with visit_out() if out ==
+    // true, and the in-neighbours with visit_in() if in == true
+    template <class VisitOut, class VisitIn>
+    void search(vector<vertex_t>& frontier, bool out, bool in,
+                VisitOut&& visit_out, VisitIn&& visit_in)
+    {
+        while (!frontier.empty())
+        {
+            _next.clear();
+            #pragma omp parallel if (frontier.size() > OPENMP_MIN_THRESH)
+            {
+                vector<vertex_t> local;
+                #pragma omp for schedule(runtime) nowait
+                for (size_t i = 0; i < frontier.size(); ++i)
+                {
+                    auto w = frontier[i];
+                    if (out)
+                    {
+                        for (auto u : out_neighbours_range(w, _g))
+                        {
+                            if (visit_out(u, w))
+                                local.push_back(u);
+                        }
+                    }
+                    if (in)
+                    {
+                        for (auto u : in_neighbours_range(w, _g))
+                        {
+                            if (visit_in(u, w))
+                                local.push_back(u);
+                        }
+                    }
+                }
+                #pragma omp critical (scc_gather)
+                _next.insert(_next.end(), local.begin(), local.end());
+            }
+            frontier.swap(_next);
+        }
+    }
+
+    void fw_bw()
+    {
+        if (_remaining.empty())
+            return;
+
+        vertex_t pivot = _remaining[0];
+        size_t k_max = 0;
+        for (auto v : _remaining)
+        {
+            size_t k = out_degree(v, _g) * in_degree(v, _g);
+            if (k > k_max)
+            {
+                k_max = k;
+                pivot = v;
+            }
+        }
+
+        // the forward reachable set is marked with the pivot as color
+        #pragma omp parallel for schedule(static) \
+            if (_remaining.size() > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < _remaining.size(); ++i)
+            _color[_remaining[i]].store(_null, std::memory_order_relaxed);
+
+        vector<vertex_t> frontier = {pivot};
+        _color[pivot] = pivot;
+        search(frontier, true,
+               [&](vertex_t u, vertex_t)
+               {
+                   size_t x = _null;
+                   return (is_remaining(u) &&
+                           _color[u].load(std::memory_order_relaxed) == _null &&
+                           _color[u].compare_exchange_strong(x, pivot));
+               });
+
+        frontier = {pivot};
+        claim(pivot, pivot);
+        search(frontier, false,
+               [&](vertex_t u, vertex_t)
+               {
+                   return (_color[u].load(std::memory_order_relaxed) == pivot &&
+                           claim(u, pivot));
+               });
+        compact();
+    }
+
+    void color()
+    {
+        #pragma omp parallel for schedule(static) \
+            if (_remaining.size() > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < _remaining.size(); ++i)
+        {
+            auto v = _remaining[i];
+            _color[v].store(v, std::memory_order_relaxed);
+        }
+
+        // Propagate the largest color forward. A vertex is placed only once in
+        // the next frontier, even if its color changes more than once.
+        // all the entries of _queued are false between calls
+        vector<vertex_t> frontier = _remaining;
+        auto& queued = _queued;
+        while (!frontier.empty())
+        {
+            _next.clear();
+            #pragma omp parallel if (frontier.size() > OPENMP_MIN_THRESH)
+            {
+                vector<vertex_t> local;
+                #pragma omp for schedule(runtime) nowait
+                for (size_t i = 0; i < frontier.size(); ++i)
+                {
+                    auto w = frontier[i];
+                    size_t c = _color[w].load(std::memory_order_relaxed);
+                    for (auto u : out_neighbours_range(w, _g))
+                    {
+                        if (!is_remaining(u))
+                            continue;
+                        size_t x = _color[u].load(std::memory_order_relaxed);
+                        bool changed = false;
+                        while (x < c)
+                        {
+                            if (_color[u].compare_exchange_weak
+                                    (x, c, std::memory_order_relaxed))
+                            {
+                                changed = true;
+                                break;
+                            }
+                        }
+                        if (!changed)
+                            continue;
+                        uint8_t was_queued;
+                        #pragma omp atomic capture
+                        {
+                            was_queued = queued[u];
+                            queued[u] = true;
+                        }
+                        if (!was_queued)
+                            local.push_back(u);
+                    }
+                }
+                #pragma omp critical (scc_gather)
+                _next.insert(_next.end(), local.begin(), local.end());
+            }
+            frontier.swap(_next);
+            #pragma omp parallel for schedule(static) \
+                if (frontier.size() > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < frontier.size(); ++i)
+                queued[frontier[i]] = false;
+        }
+
+        // every color root collects its component backwards
+        frontier.clear();
+        for (auto v : _remaining)
+        {
+            if (_color[v].load(std::memory_order_relaxed) == v)
+            {
+                claim(v, v);
+                frontier.push_back(v);
+            }
+        }
+        search(frontier, false,
+               [&](vertex_t u, vertex_t w)
+               {
+                   size_t c = _color[w].load(std::memory_order_relaxed);
+                   return (_color[u].load(std::memory_order_relaxed) == c &&
+                           claim(u, c));
+               });
+        compact();
+    }
+
+    // iterative version of Tarjan's algorithm, restricted to the remaining
+    // vertices
+    void tarjan()
+    {
+        if (_remaining.empty())
+            return;
+
+        typedef typename graph_traits<Graph>::adjacency_iterator iter_t;
+        gt_hash_map<vertex_t, size_t> index, low;
+        vector<vertex_t> stack;
+        gt_hash_set<vertex_t> on_stack;
+        vector<std::tuple<vertex_t, iter_t, iter_t>> call;
+        size_t n = 0;
+
+        auto visit = [&](vertex_t v)
+            {
+                index[v] = low[v] = n++;
+                stack.push_back(v);
+                on_stack.insert(v);
+                auto us = adjacent_vertices(v, _g);
+                call.emplace_back(v, us.first, us.second);
+            };
+
+        for (auto s : _remaining)
+        {
+            if (index.find(s) != index.end())
+                continue;
+            visit(s);
+            while (!call.empty())
+            {
+                auto& top = call.back();
+                vertex_t v = std::get<0>(top);
+                auto& pos = std::get<1>(top);
+                if (pos != std::get<2>(top))
+                {
+                    vertex_t u = *pos;
+                    ++pos;
+                    if (!is_remaining(u))
+                        continue;
+                    auto iter = index.find(u);
+                    if (iter == index.end())
+                        visit(u);
+                    else if (on_stack.find(u) != on_stack.end())
+                        low[v] = std::min(low[v], iter->second);
+                    continue;
+                }
+
+                call.pop_back();
+                if (!call.empty())
+                {
+                    vertex_t w = std::get<0>(call.back());
+                    low[w] = std::min(low[w], low[v]);
+                }
+
+                if (low[v] == index[v])
+                {
+                    vertex_t u;
+                    do
+                    {
+                        u = stack.back();
+                        stack.pop_back();
+                        on_stack.erase(u);
+                        _root[u].store(v, std::memory_order_relaxed);
+                    }
+                    while (u != v);
+                }
+            }
+        }
+        _remaining.clear();
+    }
+
+    const Graph& _g;
+    size_t _N;
+    vector<std::atomic<size_t>> _root;
+    vector<std::atomic<size_t>> _color;
+    vector<size_t> _k_in;
+    vector<size_t> _k_out;
+    vector<uint8_t> _queued;
+    vector<vertex_t> _remaining;
+    vector<vertex_t> _next;
+    static constexpr size_t _null = std::numeric_limits<size_t>::max();
+};
+
 // this will label the components of a graph to a given vertex property, from
 // [0, number of components - 1], and keep an histogram. If the graph is
-// directed the strong components are used.
+// directed the strong components are used. If the graph is large enough, and
+// more than one thread is available, the components are found in parallel.
+// In either case, they are labeled in the order of their smallest vertex
+// index, so that the labels do not depend on the number of threads.
 struct label_components
 {
     template <class Graph, class CompMap>
@@ -107,10 +656,22 @@ struct label_components
     {
         typedef typename graph_traits<Graph>::directed_category
             directed_category;
-        HistogramPropertyMap<CompMap> cm(comp_map, num_vertices(g), hist);
-        get_components(g, cm,
-                       typename std::is_convertible<directed_category,
-                                                    directed_tag>::type());
+        typedef typename std::is_convertible<directed_category,
+                                             directed_tag>::type is_directed;
+        vector<size_t> root;
+#ifdef USING_OPENMP
+        if (num_vertices(g) > OPENMP_MIN_THRESH && omp_get_max_threads() > 1)
+        {
+            get_parallel_components(g, root, is_directed());
+            put_components(g, root, comp_map, hist);
+            return;
+        }
+#endif
+        root.resize(num_vertices(g));
+        get_components(g, make_iterator_property_map(root.begin(),
+                                                     get(vertex_index, g)),
+                       is_directed());
+        put_components(g, root, comp_map, hist);
     }
 
     template <class Graph, class CompMap>
@@ -126,6 +687,55 @@ struct label_components
     {
         boost::connected_components(g, comp_map);
     }
+
+    template <class Graph>
+    void get_parallel_components(Graph& g, vector<size_t>& root,
+                                 std::true_type) const
+    {
+        parallel_strong_components<Graph> scc(g);
+        scc(root);
+    }
+
+    template <class Graph>
+    void get_parallel_components(Graph& g, vector<size_t>& root,
+                                 std::false_type) const
+    {
+        parallel_connected_components(g, root);
+    }
+
+    // relabels the components in the order of their smallest vertex index,
+    // where root[v] is any identifier of the component of v, smaller than
+    // num_vertices(g)
+    template <class Graph, class CompMap>
+    void put_components(Graph& g, vector<size_t>& root, CompMap comp_map,
+                        vector<size_t>& hist) const
+    {
+        typedef typename property_traits<CompMap>::value_type c_type;
+        const size_t null = std::numeric_limits<size_t>::max();
+        size_t N = num_vertices(g);
+        vector<size_t> label(N, null);
+        hist.clear();
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto v = vertex(i, g);
+            if (!is_valid_vertex(v, g))
+                continue;
+            size_t& l = label[root[v]];
+            if (l == null)
+            {
+                l = hist.size();
+                hist.push_back(0);
+            }
+            ++hist[l];
+        }
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 put(comp_map, v, c_type(label[root[v]]));
+             });
+    }
 };
 
 struct label_biconnected_components
@@ -164,27 +774,13 @@ struct label_biconnected_components
 
 struct label_out_component
 {
-    template <class CompMap>
-    class marker_visitor: public bfs_visitor<>
-    {
-    public:
-        marker_visitor() { }
-        marker_visitor(CompMap comp) : _comp(comp) { }
-
-        template <class Vertex, class Graph>
-        void discover_vertex(Vertex u, const Graph&)
-        {
-            _comp[u] = true;
-        }
-    private:
-        CompMap _comp;
-    };
-
     template <class Graph, class CompMap>
     void operator()(Graph& g, CompMap comp_map, size_t root) const
     {
-        marker_visitor<CompMap> marker(comp_map);
-        breadth_first_search(g, vertex(root, g), visitor(marker));
+        auto comp = comp_map.get_unchecked(num_vertices(g));
+        comp[vertex(root, g)] = true;
+        parallel_bfs(g, vertex(root, g), numeric_limits<size_t>::max(),
+                     [&](auto v, auto, size_t) { comp[v] = true; });
     }
 };
 
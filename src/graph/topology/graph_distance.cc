@@ -22,8 +22,9 @@
 #include "graph_python_interface.hh"
 #include "numpy_bind.hh"
 #include "hash_map_wrap.hh"
+#include "graph_parallel_bfs.hh"
+#include "graph_delta_stepping.hh"
 
-#include <boost/graph/breadth_first_search.hpp>
 #include <boost/graph/dijkstra_shortest_paths_no_color_map.hpp>
 #include <boost/graph/bellman_ford_shortest_paths.hpp>
 #include <boost/python/stl_iterator.hpp>
@@ -39,130 +40,6 @@ using namespace graph_tool;
 
 struct stop_search {};
 
-template <class DistMap, class PredMap>
-class bfs_max_visitor:
-    public boost::bfs_visitor<null_visitor>
-{
-public:
-    bfs_max_visitor(DistMap dist_map, PredMap pred, size_t max_dist,
-                    size_t source, size_t target)
-        : _dist_map(dist_map), _pred(pred), _max_dist(max_dist),
-          _source(source), _target(target), _dist(0) {}
-
-    template <class Graph>
-    void initialize_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                           Graph&)
-    {
-        typedef typename property_traits<DistMap>::value_type dist_t;
-        dist_t inf = std::is_floating_point<dist_t>::value ?
-            numeric_limits<dist_t>::infinity() :
-            numeric_limits<dist_t>::max();
-        _dist_map[v] = (v == _source) ? 0 : inf;
-        _pred[v] = v;
-    }
-
-    template <class Graph>
-    void tree_edge(typename graph_traits<Graph>::edge_descriptor e,
-                   Graph& g)
-    {
-        _pred[target(e,g)] = source(e,g);
-    }
-
-    template <class Graph>
-    void examine_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                        Graph&)
-    {
-        typedef typename property_traits<DistMap>::value_type val_t;
-        if ( _dist_map[v] > val_t(_max_dist))
-            throw stop_search();
-    }
-
-    template <class Graph>
-    void discover_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                         Graph&)
-    {
-        if (size_t(_pred[v]) == v)
-            return;
-        _dist_map[v] = _dist_map[_pred[v]] + 1;
-        if (v == _target)
-            throw stop_search();
-    }
-
-private:
-    DistMap _dist_map;
-    PredMap _pred;
-    size_t _max_dist;
-    size_t _source;
-    size_t _target;
-    size_t _dist;
-};
-
-template <class DistMap, class PredMap>
-class bfs_max_multiple_targets_visitor:
-    public boost::bfs_visitor<null_visitor>
-{
-public:
-    bfs_max_multiple_targets_visitor(DistMap dist_map, PredMap pred,
-                                     size_t max_dist, size_t source,
-                                     gt_hash_set<std::size_t> target)
-        : _dist_map(dist_map), _pred(pred), _max_dist(max_dist),
-          _source(source), _target(target), _dist(0) {}
-
-    template <class Graph>
-    void initialize_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                           Graph&)
-    {
-        typedef typename property_traits<DistMap>::value_type dist_t;
-        dist_t inf = std::is_floating_point<dist_t>::value ?
-            numeric_limits<dist_t>::infinity() :
-            numeric_limits<dist_t>::max();
-        _dist_map[v] = (v == _source) ? 0 : inf;
-        _pred[v] = v;
-    }
-
-    template <class Graph>
-    void tree_edge(typename graph_traits<Graph>::edge_descriptor e,
-                   Graph& g)
-    {
-        _pred[target(e,g)] = source(e,g);
-    }
-
-    template <class Graph>
-    void examine_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                        Graph&)
-    {
-        typedef typename property_traits<DistMap>::value_type val_t;
-        if ( _dist_map[v] > val_t(_max_dist))
-            throw stop_search();
-    }
-
-    template <class Graph>
-    void discover_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                         Graph&)
-    {
-        if (size_t(_pred[v]) == v)
-            return;
-        _dist_map[v] = _dist_map[_pred[v]] + 1;
-
-        auto iter = _target.find(v);
-        if (iter != _target.end())
-        {
-            _target.erase(iter);
-            if (_target.empty())
-                throw stop_search();
-        };
-    }
-
-private:
-    DistMap _dist_map;
-    PredMap _pred;
-    size_t _max_dist;
-    size_t _source;
-    gt_hash_set<std::size_t> _target;
-    size_t _dist;
-};
-
-
 template <class DistMap>
 class djk_max_visitor:
     public boost::dijkstra_visitor<null_visitor>
@@ -229,11 +106,11 @@ private:
 
 struct do_bfs_search
 {
-    template <class Graph, class VertexIndexMap, class DistMap, class PredMap>
+    template <class Graph, class DistMap, class PredMap>
     void operator()(const Graph& g, size_t source,
                     boost::python::object otarget_list,
-                    VertexIndexMap vertex_index, DistMap dist_map,
-                    PredMap pred_map, long double max_dist) const
+                    DistMap dist_map, PredMap pred_map,
+                    long double max_dist) const
     {
         typedef typename property_traits<DistMap>::value_type dist_t;
 
@@ -245,36 +122,29 @@ struct do_bfs_search
             numeric_limits<dist_t>::infinity() :
             numeric_limits<dist_t>::max();
 
-        dist_t max_d = (max_dist > 0) ? max_dist : inf;
+        size_t max_d = (max_dist > 0) ?
+            size_t(max_dist) : numeric_limits<size_t>::max();
 
-        unchecked_vector_property_map<boost::default_color_type, VertexIndexMap>
-        color_map(vertex_index, num_vertices(g));
-        try
-        {
-            if (tgt.size() <= 1)
-            {
-                size_t target = tgt.empty() ?
-                    graph_traits<GraphInterface::multigraph_t>::null_vertex() :
-                    *tgt.begin();
-                breadth_first_search(g, vertex(source, g),
-                                     visitor(bfs_max_visitor<DistMap, PredMap>
-                                             (dist_map, pred_map, max_d,
-                                              source, target)).
-                                     vertex_index_map(vertex_index).
-                                     color_map(color_map));
-            }
-            else
-            {
-                breadth_first_search(g, vertex(source, g),
-                                     visitor(bfs_max_multiple_targets_visitor<DistMap, PredMap>
-                                             (dist_map, pred_map, max_d,
-                                              source, tgt)).
-                                     vertex_index_map(vertex_index).
-                                     color_map(color_map));
-            }
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 dist_map[v] = inf;
+                 pred_map[v] = v;
+             });
+        dist_map[source] = 0;
 
-        }
-        catch (stop_search&) {}
+        // the search stops after the level in which the last target is found
+        std::atomic<size_t> n_tgt(tgt.size());
+        parallel_bfs(g, vertex(source, g), max_d,
+                     [&](auto v, auto u, size_t d)
+                     {
+                         dist_map[v] = d;
+                         pred_map[v] = u;
+                         if (!tgt.empty() && tgt.find(v) != tgt.end())
+                             n_tgt--;
+                     },
+                     [&]() { return !tgt.empty() && n_tgt == 0; });
     }
 };
 
@@ -285,7 +155,74 @@ struct do_djk_search
     void operator()(const Graph& g, size_t source,
                     boost::python::object otarget_list,
                     VertexIndexMap vertex_index, DistMap dist_map,
-                    PredMap pred_map, WeightMap weight, long double max_dist) const
+                    PredMap pred_map, WeightMap weight, long double max_dist,
+                    bool delta_stepping, double delta) const
+    {
+        typedef typename property_traits<DistMap>::value_type dist_t;
+        if (delta_stepping)
+            dispatch_delta_stepping(g, source, otarget_list, vertex_index,
+                                    dist_map, pred_map, weight, max_dist,
+                                    delta,
+                                    std::integral_constant
+                                        <bool, delta_stepping_supported<dist_t>::value>());
+        else
+            dijkstra_search(g, source, otarget_list, vertex_index, dist_map,
+                            pred_map, weight, max_dist);
+    }
+
+    template <class Graph, class VertexIndexMap, class DistMap, class PredMap,
+              class WeightMap>
+    void dispatch_delta_stepping(const Graph& g, size_t source,
+                                 boost::python::object otarget_list,
+                                 VertexIndexMap, DistMap dist_map,
+                                 PredMap pred_map, WeightMap weight,
+                                 long double max_dist, double delta,
+                                 std::true_type) const
+    {
+        auto target_list = get_array<int64_t, 1>(otarget_list);
+        typedef typename property_traits<DistMap>::value_type dist_t;
+        dist_t max_d = (max_dist > 0) ?
+            max_dist : (std::is_floating_point<dist_t>::value ?
+                        numeric_limits<dist_t>::infinity() :
+                        numeric_limits<dist_t>::max());
+
+        vector<size_t> tgt(target_list.begin(), target_list.end());
+
+        delta_stepping(g, vertex(source, g), dist_map, pred_map, weight,
+                       delta, max_d,
+                       [&](auto&& settled)
+                       {
+                           if (tgt.empty())
+                               return false;
+                           tgt.erase(std::remove_if(tgt.begin(), tgt.end(),
+                                                    settled),
+                                     tgt.end());
+                           return tgt.empty();
+                       });
+    }
+
+    // distances of type long double cannot be updated atomically, and are
+    // always computed serially
+    template <class Graph, class VertexIndexMap, class DistMap, class PredMap,
+              class WeightMap>
+    void dispatch_delta_stepping(const Graph& g, size_t source,
+                                 boost::python::object otarget_list,
+                                 VertexIndexMap vertex_index, DistMap dist_map,
+                                 PredMap pred_map, WeightMap weight,
+                                 long double max_dist, double,
+                                 std::false_type) const
+    {
+        dijkstra_search(g, source, otarget_list, vertex_index, dist_map,
+                        pred_map, weight, max_dist);
+    }
+
+    template <class Graph, class VertexIndexMap, class DistMap, class PredMap,
+              class WeightMap>
+    void dijkstra_search(const Graph& g, size_t source,
+                         boost::python::object otarget_list,
+                         VertexIndexMap vertex_index, DistMap dist_map,
+                         PredMap pred_map, WeightMap weight,
+                         long double max_dist) const
     {
         auto target_list = get_array<int64_t, 1>(otarget_list);
         typedef typename property_traits<DistMap>::value_type dist_t;
@@ -371,7 +308,8 @@ struct do_bf_search
 
 void get_dists(GraphInterface& gi, size_t source, boost::python::object tgt,
                boost::any dist_map, boost::any weight, boost::any pred_map,
-               long double max_dist, bool bf)
+               long double max_dist, bool bf, bool delta_stepping,
+               double delta)
 {
     typedef property_map_type
         ::apply<int64_t, GraphInterface::vertex_index_map_t>::type pred_map_t;
@@ -380,10 +318,13 @@ void get_dists(GraphInterface& gi, size_t source, boost::python::object tgt,
 
     if (weight.empty())
     {
-        run_action<>()
-            (gi, std::bind(do_bfs_search(), std::placeholders::_1, source, tgt, gi.get_vertex_index(),
-                           std::placeholders::_2, pmap.get_unchecked(num_vertices(gi.get_graph())),
-                           max_dist),
+        run_action<graph_tool::all_graph_views_frozen>()
+            (gi, [&](auto& g, auto dist)
+                 {
+                     do_bfs_search()(g, source, tgt, dist,
+                                     pmap.get_unchecked(num_vertices(gi.get_graph())),
+                                     max_dist);
+                 },
              writable_vertex_scalar_properties())
             (dist_map);
     }
@@ -401,10 +342,11 @@ void get_dists(GraphInterface& gi, size_t source, boost::python::object tgt,
         }
         else
         {
-            run_action<>()
+            run_action<graph_tool::all_graph_views_frozen>()
                 (gi, std::bind(do_djk_search(), std::placeholders::_1, source, tgt, gi.get_vertex_index(),
                                std::placeholders::_2, pmap.get_unchecked(num_vertices(gi.get_graph())),
-                               std::placeholders::_3, max_dist),
+                               std::placeholders::_3, max_dist,
+                               delta_stepping, delta),
                  writable_vertex_scalar_properties(),
                  edge_scalar_properties())
                 (dist_map, weight);
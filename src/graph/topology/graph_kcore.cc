@@ -21,6 +21,7 @@
 #include "graph_selectors.hh"
 
 #include "graph_kcore.hh"
+#include "numpy_bind.hh"
 
 #include <boost/python.hpp>
 
@@ -41,7 +42,27 @@ void do_kcore_decomposition(GraphInterface& gi, boost::any prop,
                              degree_selector(deg));
 }
 
+bool do_kcore_update(GraphInterface& gi, boost::any prop,
+                     python::object oinserted, python::object oremoved)
+{
+    multi_array_ref<int64_t,2> inserted = get_array<int64_t,2>(oinserted);
+    multi_array_ref<int64_t,2> removed = get_array<int64_t,2>(oremoved);
+
+    bool incremental = false;
+    gt_dispatch<>()
+        ([&](auto& g, auto core)
+         {
+             incremental =
+                 kcore_update<std::remove_reference_t<decltype(g)>,
+                              decltype(core)>(g, core)(inserted, removed);
+         },
+         never_directed(), writable_vertex_scalar_properties())
+        (gi.get_graph_view(), prop);
+    return incremental;
+}
+
 void export_kcore()
 {
     python::def("kcore_decomposition", &do_kcore_decomposition);
+    python::def("kcore_update", &do_kcore_update);
 };
@@ -18,13 +18,24 @@
 #ifndef GRAPH_KCORE_HH
 #define GRAPH_KCORE_HH
 
+#include <vector>
+#include <limits>
+
+#include "graph_selectors.hh"
+#include "graph_util.hh"
+#include "hash_map_wrap.hh"
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
 template <class Graph, class CoreMap, class DegSelector>
-void kcore_decomposition(Graph& g, CoreMap core_map, DegSelector degS)
+void serial_kcore_decomposition(Graph& g, CoreMap core_map, DegSelector degS)
 {
     typedef typename property_map<Graph, vertex_index_t>::type
         vertex_index_map_t;
@@ -83,6 +94,466 @@ void kcore_decomposition(Graph& g, CoreMap core_map, DegSelector degS)
     }
 }
 
+// Parallel k-core decomposition by level-synchronous peeling, as in H. Kabir,
+// K. Madduri, "Parallel k-core decomposition on multicore platforms", IPDPSW
+// 2017.
+//
+// At each level k, which is the smallest remaining degree, all vertices with
+// remaining degree k are removed in parallel, and the degrees of their
+// neighbours are decremented atomically. A neighbour whose degree drops to k
+// is removed in the next sub-round of the same level. Since the core numbers
+// do not depend on the order in which the vertices are removed, the result is
+// identical to the serial algorithm. The vertices which have not been removed
+// yet are kept in a list which is compacted after every level, so that the
+// removed vertices are not scanned again.
+template <class Graph, class CoreMap, class DegSelector>
+void parallel_kcore_decomposition(Graph& g, CoreMap core_map, DegSelector degS)
+{
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    size_t N = num_vertices(g);
+    vector<size_t> deg(N);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             deg[v] = degS(v, g);
+         });
+
+    vector<vertex_t> remaining, frontier, next;
+    size_t k = numeric_limits<size_t>::max();
+    for (auto v : vertices_range(g))
+    {
+        remaining.push_back(v);
+        k = std::min(k, deg[v]);
+    }
+
+    while (!remaining.empty())
+    {
+        frontier.clear();
+        #pragma omp parallel if (remaining.size() > OPENMP_MIN_THRESH)
+        {
+            vector<vertex_t> local;
+            #pragma omp for schedule(runtime) nowait
+            for (size_t i = 0; i < remaining.size(); ++i)
+            {
+                auto v = remaining[i];
+                if (deg[v] == k)
+                    local.push_back(v);
+            }
+            #pragma omp critical (kcore_gather)
+            frontier.insert(frontier.end(), local.begin(), local.end());
+        }
+
+        while (!frontier.empty())
+        {
+            next.clear();
+            #pragma omp parallel if (frontier.size() > OPENMP_MIN_THRESH)
+            {
+                vector<vertex_t> local;
+                #pragma omp for schedule(runtime) nowait
+                for (size_t i = 0; i < frontier.size(); ++i)
+                {
+                    auto v = frontier[i];
+                    core_map[v] = k;
+                    for (auto e : out_edges_range(v, g))
+                    {
+                        auto u = target(e, g);
+                        size_t d;
+                        #pragma omp atomic read
+                        d = deg[u];
+                        if (d <= k)
+                            continue;
+                        #pragma omp atomic capture
+                        d = deg[u]--;
+                        if (d == k + 1)
+                        {
+                            local.push_back(u);
+                        }
+                        else if (d <= k)
+                        {
+                            // lost a race with another decrement
+                            #pragma omp atomic
+                            deg[u]++;
+                        }
+                    }
+                }
+                #pragma omp critical (kcore_gather)
+                next.insert(next.end(), local.begin(), local.end());
+            }
+            frontier.swap(next);
+        }
+
+        // drop the removed vertices, and find the next level
+        size_t k_next = numeric_limits<size_t>::max();
+        next.clear();
+        #pragma omp parallel if (remaining.size() > OPENMP_MIN_THRESH)
+        {
+            vector<vertex_t> local;
+            size_t k_local = numeric_limits<size_t>::max();
+            #pragma omp for schedule(runtime) nowait
+            for (size_t i = 0; i < remaining.size(); ++i)
+            {
+                auto v = remaining[i];
+                if (deg[v] > k)
+                {
+                    local.push_back(v);
+                    k_local = std::min(k_local, deg[v]);
+                }
+            }
+            #pragma omp critical (kcore_gather)
+            {
+                next.insert(next.end(), local.begin(), local.end());
+                k_next = std::min(k_next, k_local);
+            }
+        }
+        remaining.swap(next);
+        k = k_next;
+    }
+}
+
+template <class Graph, class CoreMap, class DegSelector>
+void kcore_decomposition(Graph& g, CoreMap core_map, DegSelector degS)
+{
+#ifdef USING_OPENMP
+    if (num_vertices(g) > OPENMP_MIN_THRESH && omp_get_max_threads() > 1)
+    {
+        parallel_kcore_decomposition(g, core_map, degS);
+        return;
+    }
+#endif
+    serial_kcore_decomposition(g, core_map, degS);
+}
+
+// Incremental maintenance of the core numbers of an undirected graph, after
+// the insertion or removal of edges, with the "subcore" algorithm of A. E.
+// Sariyuce, B. Gedik, G. Jacques-Silva, K.-L. Wu, U. V. Catalyurek,
+// "Streaming algorithms for k-core decomposition", Proc. VLDB Endow. 6, 433
+// (2013).
+//
+// When a single edge (u, v) is inserted or removed, with K = min(k_u, k_v),
+// only the vertices with core number K which are reachable from the endpoints
+// with core number K via other such vertices (the "subcore") can change, and
+// only by one. Their number of neighbours with core number at least K is
+// computed, and the vertices which cannot belong to the (K+1)-core (after an
+// insertion) or to the K-core (after a removal) are peeled off. Only the
+// subcore is traversed, which is usually much smaller than the graph. A
+// self-loop contributes twice to the degree, so that it can change the core
+// numbers by two, in which case the procedure is repeated.
+//
+// However, the subcores can be as large as the whole graph, e.g. if most
+// vertices have the same core number. Hence, if the total number of edges
+// scanned exceeds the cost of a full decomposition, the core numbers are
+// recomputed from scratch, and false is returned.
+//
+// The graph g must already contain the inserted edges, given by the vertex
+// pairs in "inserted", and must no longer contain the removed ones, given in
+// "removed". The core_map must hold the core numbers before the changes. The
+// edges are processed one at a time: the removed edges which have not yet
+// been processed are regarded as still present, and the inserted ones as
+// still absent.
+template <class Graph, class CoreMap>
+class kcore_update
+{
+public:
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    kcore_update(Graph& g, CoreMap core_map)
+        : _g(g), _core(core_map), _cd(num_vertices(g)),
+          _visited(num_vertices(g)), _evicted(num_vertices(g)),
+          _budget(num_vertices(g) + 2 * num_edges(g)) {}
+
+    template <class Pairs>
+    bool operator()(Pairs& inserted, Pairs& removed)
+    {
+        for (size_t i = 0; i < inserted.shape()[0]; ++i)
+            put_pair(_pending_ins, inserted[i][0], inserted[i][1]);
+        for (size_t i = 0; i < removed.shape()[0]; ++i)
+            put_pair(_pending_rem, removed[i][0], removed[i][1]);
+
+        for (size_t i = 0; i < removed.shape()[0] && !over_budget(); ++i)
+        {
+            vertex_t u = removed[i][0];
+            vertex_t v = removed[i][1];
+            remove_pair(_pending_rem, u, v);
+            do
+            {
+                size_t K = std::min(get_core(u), get_core(v));
+                if (K == 0 || !remove(u, v, K))
+                    break;
+            }
+            while (u == v);
+        }
+
+        for (size_t i = 0; i < inserted.shape()[0] && !over_budget(); ++i)
+        {
+            vertex_t u = inserted[i][0];
+            vertex_t v = inserted[i][1];
+            remove_pair(_pending_ins, u, v);
+            do
+            {
+                size_t K = std::min(get_core(u), get_core(v));
+                if (!insert(u, v, K))
+                    break;
+            }
+            while (u == v);
+        }
+
+        if (over_budget())
+        {
+            kcore_decomposition(_g, _core, out_degreeS());
+            return false;
+        }
+        return true;
+    }
+
+private:
+    typedef gt_hash_map<vertex_t, gt_hash_map<vertex_t, size_t>> pending_t;
+
+    // a self-loop appears twice in the list of incident edges
+    void put_pair(pending_t& pending, vertex_t u, vertex_t v)
+    {
+        pending[u][v]++;
+        pending[v][u]++;
+    }
+
+    void remove_pair(pending_t& pending, vertex_t u, vertex_t v)
+    {
+        for (auto x : {std::make_pair(u, v), std::make_pair(v, u)})
+        {
+            auto iter = pending.find(x.first);
+            auto& c = iter->second[x.second];
+            if (--c == 0)
+                iter->second.erase(x.second);
+            if (iter->second.empty())
+                pending.erase(iter);
+        }
+    }
+
+    size_t get_core(vertex_t v) { return _core[v]; }
+
+    bool over_budget() { return _work > _budget; }
+
+    // calls f(u) for every edge (v, u) of the graph, regarding the pending
+    // insertions as absent, and the pending removals as present
+    template <class F>
+    void for_each_neighbour(vertex_t v, F&& f_)
+    {
+        auto f = [&](vertex_t u) { ++_work; f_(u); };
+        auto ip = _pending_ins.find(v);
+        if (ip == _pending_ins.end())
+        {
+            for (auto e : out_edges_range(v, _g))
+                f(target(e, _g));
+        }
+        else
+        {
+            _skip = ip->second;
+            for (auto e : out_edges_range(v, _g))
+            {
+                vertex_t u = target(e, _g);
+                auto iter = _skip.find(u);
+                if (iter != _skip.end() && iter->second > 0)
+                {
+                    --iter->second;
+                    continue;
+                }
+                f(u);
+            }
+        }
+
+        auto rp = _pending_rem.find(v);
+        if (rp != _pending_rem.end())
+        {
+            for (auto& uc : rp->second)
+            {
+                for (size_t j = 0; j < uc.second; ++j)
+                    f(uc.first);
+            }
+        }
+    }
+
+    // number of neighbours of w with core number at least K, including the
+    // evicted vertices
+    size_t get_cd(vertex_t w, size_t K)
+    {
+        size_t cd = 0;
+        for_each_neighbour(w,
+                           [&](vertex_t x)
+                           {
+                               if (get_core(x) >= K || _evicted[x])
+                                   ++cd;
+                           });
+        return cd;
+    }
+
+    void visit(vertex_t v)
+    {
+        _visited[v] = true;
+        _touched.push_back(v);
+    }
+
+    void reset()
+    {
+        for (auto v : _touched)
+        {
+            _visited[v] = false;
+            _evicted[v] = false;
+        }
+        _touched.clear();
+    }
+
+    // Updates the core numbers after the insertion of (u, v), with K =
+    // min(k_u, k_v). Returns true if any core number changed.
+    bool insert(vertex_t u, vertex_t v, size_t K)
+    {
+        // Traverse the subcore, but only beyond the vertices with more than K
+        // neighbours with core number at least K, since the others cannot be
+        // promoted, and do not need to be crossed.
+        _stack.clear();
+        for (auto r : {u, v})
+        {
+            if (get_core(r) == K && !_visited[r])
+            {
+                visit(r);
+                _stack.push_back(r);
+            }
+        }
+        _candidates.clear();
+        _peel.clear();
+        while (!_stack.empty() && !over_budget())
+        {
+            vertex_t w = _stack.back();
+            _stack.pop_back();
+            _candidates.push_back(w);
+            _cd[w] = get_cd(w, K);
+            if (_cd[w] <= K)
+            {
+                _evicted[w] = true;
+                _peel.push_back(w);
+                continue;
+            }
+            for_each_neighbour(w,
+                               [&](vertex_t x)
+                               {
+                                   if (get_core(x) == K && !_visited[x])
+                                   {
+                                       visit(x);
+                                       _stack.push_back(x);
+                                   }
+                               });
+        }
+
+        // The vertices with at most K neighbours among the candidates and the
+        // vertices with larger core numbers cannot be in the (K+1)-core.
+        while (!_peel.empty() && !over_budget())
+        {
+            vertex_t w = _peel.back();
+            _peel.pop_back();
+            for_each_neighbour(w,
+                               [&](vertex_t x)
+                               {
+                                   if (x == w || !_visited[x] || _evicted[x])
+                                       return;
+                                   if (--_cd[x] <= K)
+                                   {
+                                       _evicted[x] = true;
+                                       _peel.push_back(x);
+                                   }
+                               });
+        }
+
+        if (over_budget())
+        {
+            reset();
+            return false;
+        }
+
+        bool changed = false;
+        for (auto w : _candidates)
+        {
+            if (!_evicted[w])
+            {
+                _core[w] = K + 1;
+                changed = true;
+            }
+        }
+        reset();
+        return changed && !over_budget();
+    }
+
+    // Updates the core numbers after the removal of (u, v), with K =
+    // min(k_u, k_v) > 0. Returns true if any core number changed.
+    bool remove(vertex_t u, vertex_t v, size_t K)
+    {
+        // Only the vertices which lose a neighbour in the K-core need to be
+        // inspected. The number of neighbours in the K-core is computed for
+        // each vertex when it is first reached, and decremented subsequently,
+        // as its neighbours drop out. A vertex which has dropped out, but
+        // whose neighbours have not yet been decremented, is marked as
+        // "evicted", and is still counted.
+        for (auto r : {u, v})
+        {
+            if (get_core(r) != K || _visited[r])
+                continue;
+            visit(r);
+            _cd[r] = get_cd(r, K);
+        }
+
+        _peel.clear();
+        auto drop = [&](vertex_t x)
+            {
+                _core[x] = K - 1;
+                _evicted[x] = true;
+                _peel.push_back(x);
+            };
+
+        for (auto r : {u, v})
+        {
+            if (get_core(r) == K && _cd[r] < K)
+                drop(r);
+        }
+
+        bool changed = !_peel.empty();
+        while (!_peel.empty() && !over_budget())
+        {
+            vertex_t w = _peel.back();
+            _peel.pop_back();
+            for_each_neighbour(w,
+                               [&](vertex_t x)
+                               {
+                                   if (x == w || get_core(x) != K)
+                                       return;
+                                   if (!_visited[x])
+                                   {
+                                       visit(x);
+                                       _cd[x] = get_cd(x, K);
+                                   }
+                                   if (--_cd[x] < K)
+                                       drop(x);
+                               });
+            _evicted[w] = false;
+        }
+        reset();
+        return changed && !over_budget();
+    }
+
+    Graph& _g;
+    CoreMap _core;
+    pending_t _pending_ins;
+    pending_t _pending_rem;
+    gt_hash_map<vertex_t, size_t> _skip;
+    vector<size_t> _cd;
+    vector<bool> _visited;
+    vector<bool> _evicted;
+    vector<vertex_t> _touched;
+    vector<vertex_t> _candidates;
+    vector<vertex_t> _stack;
+    vector<vertex_t> _peel;
+    size_t _work = 0;
+    size_t _budget;
+};
+
 } // graph_tool namespace
 
 #endif // GRAPH_KCORE_HH
@@ -49,11 +49,12 @@ void get_dice_similarity_pairs(GraphInterface& gi, python::object opairs,
     gt_dispatch<>()
         ([&](auto& g)
          {
-             some_pairs_similarity(g, pairs, sim,
-                                   [&](auto u, auto v, auto& mask)
-                                   {
-                                       return dice(u, v, self_loop, mask, g);
-                                   });
+             pairs_similarity(g, pairs, sim, self_loop,
+                              [&](auto) { return 1.; },
+                              [&](auto u, auto v, double count)
+                              {
+                                  return dice_from_count(u, v, count, g);
+                              });
          },
          all_graph_views())
         (gi.get_graph_view());
@@ -83,11 +84,12 @@ void get_jaccard_similarity_pairs(GraphInterface& gi, python::object opairs,
     gt_dispatch<>()
         ([&](auto& g)
          {
-             some_pairs_similarity(g, pairs, sim,
-                                   [&](auto u, auto v, auto& mask)
-                                   {
-                                       return jaccard(u, v, self_loop, mask, g);
-                                   });
+             pairs_similarity(g, pairs, sim, self_loop,
+                              [&](auto) { return 1.; },
+                              [&](auto u, auto v, double count)
+                              {
+                                  return jaccard_from_count(u, v, count, g);
+                              });
          },
          all_graph_views())
         (gi.get_graph_view());
@@ -118,11 +120,91 @@ void get_inv_log_weight_similarity_pairs(GraphInterface& gi,
     gt_dispatch<>()
         ([&](auto& g)
          {
-             some_pairs_similarity(g, pairs, sim,
-                                   [&](auto u, auto v, auto& mask)
-                                   {
-                                       return inv_log_weighted(u, v,  mask, g);
-                                   });
+             pairs_similarity(g, pairs, sim, false,
+                              [&](auto w) { return inv_log_weight(w, g); },
+                              [&](auto, auto, double count)
+                              {
+                                  return count;
+                              });
+         },
+         all_graph_views())
+        (gi.get_graph_view());
+}
+
+void get_dice_similarity_top_k(GraphInterface& gi, python::object otargets,
+                               python::object osim, bool self_loop)
+{
+    multi_array_ref<int64_t,2> targets = get_array<int64_t,2>(otargets);
+    multi_array_ref<double,2> sim = get_array<double,2>(osim);
+
+    gt_dispatch<>()
+        ([&](auto& g)
+         {
+             top_k_similarity(g, targets, sim, self_loop,
+                              [&](auto) { return 1.; },
+                              [&](auto u, auto v, double count)
+                              {
+                                  return dice_from_count(u, v, count, g);
+                              });
+         },
+         all_graph_views())
+        (gi.get_graph_view());
+}
+
+void get_jaccard_similarity_top_k(GraphInterface& gi, python::object otargets,
+                                  python::object osim, bool self_loop)
+{
+    multi_array_ref<int64_t,2> targets = get_array<int64_t,2>(otargets);
+    multi_array_ref<double,2> sim = get_array<double,2>(osim);
+
+    gt_dispatch<>()
+        ([&](auto& g)
+         {
+             top_k_similarity(g, targets, sim, self_loop,
+                              [&](auto) { return 1.; },
+                              [&](auto u, auto v, double count)
+                              {
+                                  return jaccard_from_count(u, v, count, g);
+                              });
+         },
+         all_graph_views())
+        (gi.get_graph_view());
+}
+
+void get_jaccard_similarity_minhash(GraphInterface& gi,
+                                    python::object otargets,
+                                    python::object osim, bool self_loop,
+                                    size_t m, size_t n_bands, rng_t& rng)
+{
+    multi_array_ref<int64_t,2> targets = get_array<int64_t,2>(otargets);
+    multi_array_ref<double,2> sim = get_array<double,2>(osim);
+
+    gt_dispatch<>()
+        ([&](auto& g)
+         {
+             top_k_jaccard_minhash(g, targets, sim, self_loop, m, n_bands,
+                                   rng);
+         },
+         all_graph_views())
+        (gi.get_graph_view());
+}
+
+void get_inv_log_weight_similarity_top_k(GraphInterface& gi,
+                                         python::object otargets,
+                                         python::object osim)
+{
+    multi_array_ref<int64_t,2> targets = get_array<int64_t,2>(otargets);
+    multi_array_ref<double,2> sim = get_array<double,2>(osim);
+
+    gt_dispatch<>()
+        ([&](auto& g)
+         {
+             top_k_similarity(g, targets, sim, false,
+                              [&](auto w) { return inv_log_weight(w, g); },
+                              [&](auto, auto, double count)
+                              {
+                                  return count;
+                              });
          },
          all_graph_views())
         (gi.get_graph_view());
@@ -138,4 +220,9 @@ void export_vertex_similarity()
     python::def("inv_log_weight_similarity", &get_inv_log_weight_similarity);
     python::def("inv_log_weight_similarity_pairs",
                 &get_inv_log_weight_similarity_pairs);
+    python::def("dice_similarity_top_k", &get_dice_similarity_top_k);
+    python::def("jaccard_similarity_top_k", &get_jaccard_similarity_top_k);
+    python::def("jaccard_similarity_minhash", &get_jaccard_similarity_minhash);
+    python::def("inv_log_weight_similarity_top_k",
+                &get_inv_log_weight_similarity_top_k);
 };
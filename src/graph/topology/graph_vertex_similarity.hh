@@ -18,7 +18,13 @@
 #ifndef GRAPH_VERTEX_SIMILARITY_HH
 #define GRAPH_VERTEX_SIMILARITY_HH
 
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
 #include "graph_util.hh"
+#include "graph_triangles.hh"
+#include "random.hh"
 
 namespace graph_tool
 {
@@ -73,6 +79,15 @@ double jaccard(Vertex u, Vertex v, bool self_loop, Mark& mark, Graph& g)
     return count / double(total);
 }
 
+template <class Graph, class Vertex>
+double inv_log_weight(Vertex w, Graph& g)
+{
+    if (is_directed::apply<Graph>::type::value)
+        return 1. / log(in_degreeS()(w, g));
+    else
+        return 1. / log(out_degree(w, g));
+}
+
 template <class Graph, class Vertex, class Mark>
 double inv_log_weighted(Vertex u, Vertex v, Mark& mark, Graph& g)
 {
@@ -82,12 +97,7 @@ double inv_log_weighted(Vertex u, Vertex v, Mark& mark, Graph& g)
     for (auto w : adjacent_vertices_range(v, g))
     {
         if (mark[w])
-        {
-            if (is_directed::apply<Graph>::type::value)
-                count += 1. / log(in_degreeS()(w, g));
-            else
-                count += 1. / log(out_degree(w, g));
-        }
+            count += inv_log_weight(w, g);
     }
     for (auto w : adjacent_vertices_range(u, g))
         mark[w] = false;
@@ -111,19 +121,428 @@ void all_pairs_similarity(Graph& g, VMap s, Sim&& f)
          });
 }
 
-template <class Graph, class Vlist, class Slist, class Sim>
-void some_pairs_similarity(Graph& g, Vlist& vlist, Slist& slist, Sim&& f)
+// similarities in terms of the (weighted) number of common neighbours
+template <class Graph, class Vertex>
+double dice_from_count(Vertex u, Vertex v, double count, Graph& g)
 {
-    vector<bool> mask(num_vertices(g), false);
-    #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-        firstprivate(mask)
-    parallel_loop_no_spawn
-        (vlist,
-         [&](size_t i, const auto& val)
+    return 2 * count / double(out_degree(u, g) + out_degree(v, g));
+}
+
+template <class Graph, class Vertex>
+double jaccard_from_count(Vertex u, Vertex v, double count, Graph& g)
+{
+    return count / (out_degree(u, g) + out_degree(v, g) - count);
+}
+
+// Computes slist[i] = f(u, v, count) for the vertex pairs (u, v) = vlist[i],
+// where count is the sum of weight(w) over the neighbours w of v (counted with
+// multiplicity) which are also neighbours of u, or u itself if
+// self_loop == true.
+//
+// The pairs are grouped by their first vertex u, so that its neighbourhood is
+// processed only once for all the pairs which share it. If u has a high
+// degree, its neighbours are marked in a per-thread marker, which is then
+// looked up for the neighbours of every v. Otherwise, the sorted, distinct
+// neighbours of u are intersected with the neighbours of every v. If the
+// pairs involve more edges than the whole graph, the sorted neighbour lists
+// of all vertices are first stored in a contiguous array, and merged with the
+// list of u. Otherwise, the neighbours of v are not sorted, but searched in
+// the list of u, which has at most max_merge_degree entries, so that every
+// pair costs O(k_v log k_u).
+template <class Graph, class Vlist, class Slist, class Weight, class Sim>
+void pairs_similarity(Graph& g, Vlist& vlist, Slist& slist, bool self_loop,
+                      Weight&& weight, Sim&& f)
+{
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    constexpr size_t max_merge_degree = 64;
+
+    size_t N = num_vertices(g);
+    size_t M = vlist.shape()[0];
+
+    // pairs sorted by their first vertex
+    vector<size_t> pos(N + 1, 0);
+    for (size_t i = 0; i < M; ++i)
+        pos[vlist[i][0] + 1]++;
+    for (size_t u = 0; u < N; ++u)
+        pos[u + 1] += pos[u];
+    vector<size_t> pairs(M);
+    vector<vertex_t> us;
+    {
+        vector<size_t> next(pos.begin(), pos.end() - 1);
+        for (size_t i = 0; i < M; ++i)
+            pairs[next[vlist[i][0]]++] = i;
+        for (size_t u = 0; u < N; ++u)
+        {
+            if (pos[u + 1] > pos[u])
+                us.push_back(u);
+        }
+    }
+
+    size_t n_query = 0;
+    for (size_t i = 0; i < M; ++i)
+        n_query += out_degree(vertex_t(vlist[i][1]), g);
+    for (auto u : us)
+        n_query += out_degree(u, g);
+
+    vector<size_t> ns_pos;
+    vector<vertex_t> ns;
+    if (n_query > num_edges(g))
+    {
+        ns_pos.resize(N + 1, 0);
+        for (size_t v = 0; v < N; ++v)
+        {
+            ns_pos[v + 1] = ns_pos[v];
+            if (is_valid_vertex(vertex(v, g), g))
+                ns_pos[v + 1] += out_degree(vertex(v, g), g);
+        }
+        ns.resize(ns_pos.back());
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 auto iter = ns.begin() + ns_pos[v];
+                 for (auto w : adjacent_vertices_range(v, g))
+                     *(iter++) = w;
+                 std::sort(ns.begin() + ns_pos[v], iter);
+             });
+    }
+
+    #pragma omp parallel if (M > OPENMP_MIN_THRESH)
+    {
+        vector<bool> mark;
+        vector<vertex_t> ns_u;
+
+        #pragma omp for schedule(runtime)
+        for (size_t j = 0; j < us.size(); ++j)
+        {
+            vertex_t u = us[j];
+
+            if (out_degree(u, g) <= max_merge_degree)
+            {
+                if (!ns.empty())
+                {
+                    ns_u.assign(ns.begin() + ns_pos[u],
+                                ns.begin() + ns_pos[u + 1]);
+                }
+                else
+                {
+                    ns_u.clear();
+                    for (auto w : adjacent_vertices_range(u, g))
+                        ns_u.push_back(w);
+                    std::sort(ns_u.begin(), ns_u.end());
+                }
+                if (self_loop)
+                    ns_u.insert(std::upper_bound(ns_u.begin(), ns_u.end(), u),
+                                u);
+                ns_u.erase(std::unique(ns_u.begin(), ns_u.end()), ns_u.end());
+
+                for (size_t k = pos[u]; k < pos[u + 1]; ++k)
+                {
+                    size_t i = pairs[k];
+                    vertex_t v = vlist[i][1];
+                    double count = 0;
+                    if (!ns.empty())
+                    {
+                        auto vb = ns.begin() + ns_pos[v];
+                        sorted_intersection(ns_u.begin(), ns_u.end(),
+                                            vb, ns.begin() + ns_pos[v + 1],
+                                            [&](size_t, size_t l)
+                                            { count += weight(vb[l]); });
+                    }
+                    else
+                    {
+                        for (auto w : adjacent_vertices_range(v, g))
+                        {
+                            if (std::binary_search(ns_u.begin(), ns_u.end(), w))
+                                count += weight(w);
+                        }
+                    }
+                    slist[i] = f(u, v, count);
+                }
+                continue;
+            }
+
+            if (mark.empty())
+                mark.resize(N, false);
+
+            for (auto w : adjacent_vertices_range(u, g))
+                mark[w] = true;
+            if (self_loop)
+                mark[u] = true;
+
+            for (size_t k = pos[u]; k < pos[u + 1]; ++k)
+            {
+                size_t i = pairs[k];
+                vertex_t v = vlist[i][1];
+                double count = 0;
+                for (auto w : adjacent_vertices_range(v, g))
+                {
+                    if (mark[w])
+                        count += weight(w);
+                }
+                slist[i] = f(u, v, count);
+            }
+
+            for (auto w : adjacent_vertices_range(u, g))
+                mark[w] = false;
+            mark[u] = false;
+        }
+    }
+}
+
+// Calls f(u) for every in-neighbour u of v, i.e. every vertex which has v as
+// an out-neighbour.
+template <class Graph, class Vertex, class F>
+void for_each_in_neighbour(Vertex v, Graph& g, F&& f, std::true_type)
+{
+    for (auto e : in_edges_range(v, g))
+        f(source(e, g));
+}
+
+template <class Graph, class Vertex, class F>
+void for_each_in_neighbour(Vertex v, Graph& g, F&& f, std::false_type)
+{
+    for (auto u : out_neighbours_range(v, g))
+        f(u);
+}
+
+// Inserts (s, v) in the heap [heap, heap + n), which keeps the k pairs with
+// the largest similarities seen so far, with ties broken in favour of smaller
+// vertex indexes. The worst pair is kept at the top.
+struct top_k_cmp
+{
+    template <class Val>
+    bool operator()(const Val& a, const Val& b) const
+    {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    }
+};
+
+template <class Iter>
+void push_top_k(Iter heap, size_t& n, size_t k, double s, size_t v)
+{
+    auto x = std::make_pair(s, v);
+    if (n < k)
+    {
+        heap[n++] = x;
+        std::push_heap(heap, heap + n, top_k_cmp());
+    }
+    else if (k > 0 && top_k_cmp()(x, heap[0]))
+    {
+        std::pop_heap(heap, heap + n, top_k_cmp());
+        heap[n - 1] = x;
+        std::push_heap(heap, heap + n, top_k_cmp());
+    }
+}
+
+// Sorts the heap from the most to the least similar, and writes it in the
+// rows of targets and sims. The remaining entries of the row of targets are
+// set to -1.
+template <class Iter, class Targets, class Sims>
+void put_top_k(Iter heap, size_t n, size_t u, Targets& targets, Sims& sims)
+{
+    std::sort(heap, heap + n, top_k_cmp());
+    size_t k = targets.shape()[1];
+    for (size_t i = 0; i < k; ++i)
+    {
+        if (i < n)
+        {
+            targets[u][i] = heap[i].second;
+            sims[u][i] = heap[i].first;
+        }
+        else
+        {
+            targets[u][i] = -1;
+        }
+    }
+}
+
+// Finds, for every vertex u, the k = targets.shape()[1] other vertices with
+// the largest similarities. Only vertices with at least one common neighbour
+// have a nonzero similarity, and these are found by traversing the
+// in-neighbours of every distinct out-neighbour w of u, which accumulate the
+// weight(w) of their common neighbours. If self_loop == true, u is included
+// in its own set of neighbours. The similarity is then computed with
+// f(u, v, count), and the best ones are kept in a per-thread heap. The time
+// required is proportional to the number of paths of length two in the graph,
+// and the memory to V k, instead of V^2.
+template <class Graph, class Targets, class Sims, class Weight, class Sim>
+void top_k_similarity(Graph& g, Targets& targets, Sims& sims, bool self_loop,
+                      Weight&& weight, Sim&& f)
+{
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    typedef std::integral_constant<bool, is_directed::apply<Graph>::type::value>
+        directed_t;
+
+    size_t N = num_vertices(g);
+    size_t k = targets.shape()[1];
+    vector<double> count(N, 0);
+    vector<bool> mark(N, false);
+    vector<vertex_t> ws, touched;
+    vector<pair<double, size_t>> heap(k);
+
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH) \
+        firstprivate(count, mark, ws, touched, heap)
+    parallel_vertex_loop_no_spawn
+        (g,
+         [&](auto u)
+         {
+             for (auto w : adjacent_vertices_range(u, g))
+             {
+                 if (mark[w])
+                     continue;
+                 mark[w] = true;
+                 ws.push_back(w);
+             }
+             if (self_loop && !mark[u])
+             {
+                 mark[u] = true;
+                 ws.push_back(u);
+             }
+
+             for (auto w : ws)
+             {
+                 double x = weight(w);
+                 for_each_in_neighbour
+                     (w, g,
+                      [&](auto v)
+                      {
+                          if (count[v] == 0)
+                              touched.push_back(v);
+                          count[v] += x;
+                      },
+                      directed_t());
+                 mark[w] = false;
+             }
+             ws.clear();
+
+             size_t n = 0;
+             for (auto v : touched)
+             {
+                 if (v != u)
+                     push_top_k(heap.begin(), n, k, f(u, v, count[v]), v);
+                 count[v] = 0;
+             }
+             touched.clear();
+
+             put_top_k(heap.begin(), n, u, targets, sims);
+         });
+}
+
+// Approximate version of the above for the Jaccard similarity between the
+// sets of out-neighbours (including the vertex itself if self_loop == true),
+// based on MinHash signatures and locality-sensitive hashing, as described in
+// J. Leskovec, A. Rajaraman, J. D. Ullman, "Mining of Massive Datasets",
+// Chap. 3, Cambridge University Press (2014).
+//
+// Every vertex gets a signature with the minimum of m independent hash
+// functions over its neighbours, and the fraction of equal entries of two
+// signatures is an unbiased estimate of their Jaccard similarity. The
+// signatures are split into n_bands bands, and two vertices are compared only
+// if they share all the entries of some band, so that pairs with a similarity
+// s are found with probability 1 - (1 - s^r)^n_bands, with r = m / n_bands.
+// Within a band, the vertices are sorted by the hash of their entries, and
+// every vertex is compared with at most k others in each direction of its
+// bucket, which bounds the work for very large buckets. The time required is
+// O(E m + n_bands (V log V + V k m)), independently of the number of paths of
+// length two, and the memory is O(V (m + k)).
+template <class Graph, class Targets, class Sims, class RNG>
+void top_k_jaccard_minhash(Graph& g, Targets& targets, Sims& sims,
+                           bool self_loop, size_t m, size_t n_bands, RNG& rng)
+{
+    // splitmix64 finalizer
+    auto hash = [](uint64_t x)
+        {
+            x += 0x9e3779b97f4a7c15ULL;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return x ^ (x >> 31);
+        };
+
+    size_t N = num_vertices(g);
+    size_t k = targets.shape()[1];
+    size_t r = m / n_bands;
+
+    vector<uint64_t> seeds(m);
+    std::uniform_int_distribution<uint64_t> random_seed;
+    for (auto& seed : seeds)
+        seed = random_seed(rng);
+
+    vector<uint32_t> sig(N * m, numeric_limits<uint32_t>::max());
+    vector<uint8_t> empty(N, true);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             auto s = &sig[v * m];
+             auto put = [&](size_t w)
+                 {
+                     for (size_t i = 0; i < m; ++i)
+                         s[i] = std::min(s[i], uint32_t(hash(w ^ seeds[i]) >> 32));
+                     empty[v] = false;
+                 };
+             for (auto w : adjacent_vertices_range(v, g))
+                 put(w);
+             if (self_loop)
+                 put(v);
+         });
+
+    vector<pair<double, size_t>> heaps(N * k);
+    vector<size_t> heap_size(N, 0);
+
+    auto compare = [&](size_t u, size_t v)
+        {
+            auto heap = heaps.begin() + u * k;
+            auto& n = heap_size[u];
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (heap[i].second == v)
+                    return;
+            }
+            auto su = &sig[u * m];
+            auto sv = &sig[v * m];
+            size_t c = 0;
+            for (size_t i = 0; i < m; ++i)
+                c += (su[i] == sv[i]);
+            push_top_k(heap, n, k, c / double(m), v);
+        };
+
+    vector<pair<uint64_t, size_t>> keys;
+    for (size_t j = 0; j < n_bands; ++j)
+    {
+        keys.clear();
+        for (auto v : vertices_range(g))
+        {
+            if (empty[v])
+                continue;
+            uint64_t key = j;
+            auto s = &sig[v * m + j * r];
+            for (size_t i = 0; i < r; ++i)
+                key = hash(key ^ s[i]);
+            keys.emplace_back(key, v);
+        }
+        std::sort(keys.begin(), keys.end());
+
+        size_t M = keys.size();
+        #pragma omp parallel for schedule(runtime) if (M > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < M; ++i)
+        {
+            size_t u = keys[i].second;
+            for (size_t l = i + 1;
+                 l < M && l <= i + k && keys[l].first == keys[i].first; ++l)
+                compare(u, keys[l].second);
+            for (size_t l = i; l > 0 && i - l < k &&
+                     keys[l - 1].first == keys[i].first; --l)
+                compare(u, keys[l - 1].second);
+        }
+    }
+
+    parallel_vertex_loop
+        (g,
+         [&](auto u)
          {
-             size_t u = val[0];
-             size_t v = val[1];
-             slist[i] = f(u, v, mask);
+             put_top_k(heaps.begin() + u * k, heap_size[u], u, targets, sims);
          });
 }
 
@@ -1741,7 +1741,15 @@ class Graph(object):
 
         This operation will take :math:`O(min(k(s), k(t)))` time, where
         :math:`k(s)` and :math:`k(t)` are the out-degree and in-degree (or
-        out-degree if undirected) of vertices :math:`s` and :math:`t`.
+        out-degree if undirected) of vertices :math:`s` and :math:`t`. If
+        :meth:`~Graph.set_fast_edge_lookup` is enabled, and ``all_edges ==
+        False``, it will take :math:`O(1)` time on average instead.
+
+        If there are parallel edges and ``all_edges == False``, the edge
+        returned is the one with the smallest index if
+        :meth:`~Graph.set_fast_edge_lookup` is enabled, otherwise it is the
+        first one found in the out-edges of ``s`` (or the in-edges of ``t``,
+        whichever list is shorter).
 
         """
         s = self.vertex(int(s))
@@ -1914,6 +1922,15 @@ class Graph(object):
         If given, ``eprops`` specifies edge property maps that will be filled
         with the remaining values at each row, if there are more than two.
 
+        .. note::
+
+           If ``edge_list`` is a :class:`~numpy.ndarray`, ``hashed == False``
+           and no filters are active, the edges are inserted in bulk, and in
+           parallel: the degrees are counted first, so that the edge lists of
+           each vertex are allocated only once. The resulting graph, including
+           the edge indexes, is the same as if the edges were added one by one
+           with :meth:`~Graph.add_edge`.
+
         """
         if eprops is None:
             eprops = ()
@@ -1947,7 +1964,13 @@ class Graph(object):
         r"""If ``fast == True`` the fast :math:`O(1)` removal of edges will be
         enabled. This requires an additional data structure of size :math:`O(E)`
         to be kept at all times.  If ``fast == False``, this data structure is
-        destroyed."""
+        destroyed.
+
+        .. note::
+
+           Since it depends on this data structure, disabling it will also
+           disable :meth:`~Graph.set_fast_edge_lookup`.
+        """
         self.__graph.set_keep_epos(fast)
 
     def get_fast_edge_removal(self):
@@ -1955,6 +1978,109 @@ class Graph(object):
         enabled."""
         return self.__graph.get_keep_epos()
 
+    def set_fast_edge_lookup(self, fast=True):
+        r"""If ``fast == True`` the fast :math:`O(1)` lookup of edges via
+        :meth:`~Graph.edge` (with ``all_edges == False``) will be enabled,
+        together with the lookup of edges by their endpoints performed
+        internally by the C++ algorithms. This requires an additional hash
+        table of size :math:`O(E)` to be kept at all times.  If ``fast ==
+        False``, this data structure is destroyed.
+
+        .. note::
+
+           This also enables :meth:`~Graph.set_fast_edge_removal`, so that the
+           removal of edges given by their endpoints via
+           :meth:`~Graph.remove_edge` becomes :math:`O(1)` as well. If there are
+           parallel edges, the lookup returns the one with the smallest index.
+
+        Examples
+        --------
+        >>> g = gt.Graph()
+        >>> g.add_vertex(1001)
+        <...>
+        >>> g.add_edge_list([(0, i) for i in range(1, 1001)])
+        >>> g.set_fast_edge_lookup(True)
+        >>> print(g.edge(0, 500))
+        (0, 500)
+        >>> print(g.edge(500, 0))
+        None
+        """
+        self.__graph.set_keep_ehash(fast)
+
+    def get_fast_edge_lookup(self):
+        r"""Return whether the fast :math:`O(1)` lookup of edges is currently
+        enabled."""
+        return self.__graph.get_keep_ehash()
+
+    def set_fast_connectivity(self, fast=True):
+        r"""If ``fast == True``, the weakly connected components of the graph
+        will be kept in a data structure of size :math:`O(V)`, which is updated
+        as vertices and edges are added or removed, so that
+        :meth:`~Graph.connected`, :meth:`~Graph.component_size` and
+        :meth:`~Graph.num_components` take :math:`O(1)` time. When two
+        components are joined by a new edge, the smaller one is relabeled. When
+        an edge is removed, a search is started from both endpoints, always
+        expanding the side with fewer visited vertices, until they meet, or one
+        side is exhausted and split off as a new component. When all the edges
+        of a vertex are cleared, the same search is done between its former
+        neighbours. If ``fast == False``, this data structure is destroyed, and
+        the components are instead computed in :math:`O(V + E)` time at the
+        first query after each modification of the graph.
+
+        .. note::
+
+           The components refer to the whole underlying graph, disregarding
+           edge directions and any vertex or edge filters.
+
+        Examples
+        --------
+        >>> g = gt.Graph(directed=False)
+        >>> g.set_fast_connectivity(True)
+        >>> g.add_vertex(4)
+        <...>
+        >>> g.add_edge_list([(0, 1), (2, 3)])
+        >>> print(g.connected(0, 3), g.num_components())
+        False 2
+        >>> e = g.add_edge(1, 2)
+        >>> print(g.connected(0, 3), g.component_size(0))
+        True 4
+        """
+        self.__graph.set_keep_comps(fast)
+
+    def get_fast_connectivity(self):
+        r"""Return whether the weakly connected components are currently kept
+        up to date (see :meth:`~Graph.set_fast_connectivity`)."""
+        return self.__graph.get_keep_comps()
+
+    def __check_vertex_index(self, v):
+        v = int(v)
+        if v < 0 or v >= self.num_vertices(True):
+            raise ValueError("Invalid vertex index: %d" % v)
+        return v
+
+    def connected(self, u, v):
+        r"""Return ``True`` if the vertices ``u`` and ``v`` belong to the same
+        weakly connected component of the graph, disregarding edge directions
+        and filters. This takes :math:`O(1)` time if
+        :meth:`~Graph.set_fast_connectivity` is enabled. Otherwise, the
+        components are computed in :math:`O(V + E)` time, and reused by the
+        following queries until the graph is modified."""
+        u = self.__check_vertex_index(u)
+        v = self.__check_vertex_index(v)
+        return self.__graph.get_connected(u, v)
+
+    def component_size(self, v):
+        r"""Return the number of vertices in the weakly connected component of
+        ``v``, disregarding edge directions and filters (see
+        :meth:`~Graph.connected`)."""
+        return self.__graph.get_comp_size(self.__check_vertex_index(v))
+
+    def num_components(self):
+        r"""Return the number of weakly connected components of the graph,
+        disregarding edge directions and filters (see
+        :meth:`~Graph.connected`)."""
+        return self.__graph.get_num_comps()
+
     def clear(self):
         """Remove all vertices and edges from the graph."""
         self.__graph.clear()
@@ -2103,6 +2229,47 @@ class Graph(object):
         actual size, potentially freeing memory back to the system."""
         self.__graph.shrink_to_fit()
 
+    def freeze(self):
+        r"""Create an immutable snapshot of the graph in compressed sparse row
+        (CSR) format, where the adjacency of all vertices is stored
+        contiguously in memory. While the snapshot is valid, it will be used
+        instead of the adjacency list by some read-only algorithms (e.g.
+        :func:`~graph_tool.centrality.pagerank`,
+        :func:`~graph_tool.clustering.local_clustering`,
+        :func:`~graph_tool.topology.shortest_distance`), which will then run
+        faster for large graphs. This operation is :math:`O(V + E)`, and
+        requires additional memory of size :math:`O(V + E)`.
+
+        .. note::
+
+           The snapshot is automatically invalidated if the graph is
+           modified, in which case the adjacency list is used again, and
+           :meth:`~Graph.freeze` needs to be called anew. It is also not used
+           while vertex or edge filters are active.
+
+        Examples
+        --------
+        >>> g = gt.collection.data["polblogs"]
+        >>> g.freeze()
+        >>> g.is_frozen()
+        True
+        >>> pr = gt.pagerank(g)
+        >>> v = g.add_vertex()
+        >>> g.is_frozen()
+        False
+        """
+        self.__graph.freeze()
+
+    def unfreeze(self):
+        r"""Remove the immutable snapshot created by :meth:`~Graph.freeze`,
+        freeing its memory."""
+        self.__graph.unfreeze()
+
+    def is_frozen(self):
+        r"""Return whether a valid immutable snapshot created by
+        :meth:`~Graph.freeze` currently exists."""
+        return self.__graph.is_frozen()
+
     # Property map creation
 
     def new_property(self, key_type, value_type, vals=None):
@@ -2289,6 +2456,10 @@ class Graph(object):
         ``ignore_gp``, should contain a list of property names (vertex, edge or
         graph, respectively) which should be ignored when reading the file.
 
+        Uncompressed "gt" files written with ``mmap == True`` (see
+        :meth:`~Graph.save`) are memory-mapped and read without parsing or
+        copying, and the graph is left :meth:`frozen <Graph.freeze>`.
+
         .. warning::
 
            The only file formats which are capable of perfectly preserving the
@@ -2345,12 +2516,26 @@ class Graph(object):
             del self.graph_properties["_Graph__reversed"]
         self.shrink_to_fit()
 
-    def save(self, file_name, fmt="auto"):
+    def save(self, file_name, fmt="auto", mmap=False):
         """Save graph to ``file_name`` (which can be either a string or a file-like
         object). The format is guessed from the ``file_name``, or can be
         specified by ``fmt``, which can be either "gt", "graphml", "xml", "dot"
         or "gml".  (Note that "graphml" and "xml" are synonyms).
 
+        If ``mmap == True`` and the format is "gt", the file is written in the
+        CSR layout (version 2) of the :ref:`gt format <sec_gt_format>`.
+        Uncompressed files in this layout are memory-mapped when loaded, and
+        neither parsed nor copied: the graph is :meth:`frozen <Graph.freeze>`,
+        with a snapshot which refers directly to the mapped file, and the
+        property maps of scalar types use the mapped values as their
+        storage. The usual adjacency list is only built when it is first
+        needed, e.g. when the graph is modified. Note that these files are
+        larger than in the default layout.
+
+        If the format is "gt" and ``file_name`` ends with ".gz", the data is
+        compressed in independent blocks (i.e. as a sequence of gzip members),
+        using several threads if OpenMP is enabled.
+
         .. warning::
 
            The only file formats which are capable of perfectly preserving the
@@ -2397,9 +2582,10 @@ class Graph(object):
             f = open(file_name, "w") # throw the appropriate exception, if
                                      # unable to open
             f.close()
-            u.__graph.write_to_file(_c_str(file_name), None, _c_str(fmt), props)
+            u.__graph.write_to_file(_c_str(file_name), None, _c_str(fmt), props,
+                                    mmap)
         else:
-            u.__graph.write_to_file("", file_name, _c_str(fmt), props)
+            u.__graph.write_to_file("", file_name, _c_str(fmt), props, mmap)
 
 
     # Directedness
@@ -2730,7 +2916,8 @@ def load_graph_from_csv(file_name, directed=True, eprop_types=None,
     skip_first : ``bool`` (optional, default: ``False``)
         If ``True`` the first line of the file will be skipped.
     ecols : pair of ``int`` (optional, default: ``(0,1)``)
-        Line columns used as source and target for the edges.
+        Line columns used as source and target for the edges. Negative values
+        count from the end of each line, as with Python's indexing.
     csv_options : ``dict`` (optional, default: ``{"delimiter": ",", "quotechar": '"'}``)
         Options to be passed to the :func:`csv.reader` parser.
 
@@ -2741,7 +2928,71 @@ def load_graph_from_csv(file_name, directed=True, eprop_types=None,
         internal edge property maps. If ``hashed == True``, it will also contain
         an internal vertex property map with the vertex names.
 
+    Notes
+    -----
+    If ``csv_options`` contains only ``delimiter`` and ``quotechar`` (with
+    single-character values), the file is read by a native parser, which
+    processes large blocks of the file in parallel, and inserts the edges in
+    bulk. In this case, the values of the edge properties are converted from
+    strings directly to the property types, empty fields leave the property
+    values unchanged, and the vertex names are stored in a property map of
+    type ``int64_t`` if ``hashed == True`` and ``string_vals == False``. Other
+    options of :func:`csv.reader` are handled by the slower pure Python
+    reader.
+
     """
+    _csv_options = {"delimiter": ",", "quotechar": '"'}
+    _csv_options.update(csv_options)
+    if (set(_csv_options.keys()) == set(["delimiter", "quotechar"]) and
+        all(isinstance(x, (str, unicode)) and len(x) == 1
+            for x in _csv_options.values())):
+        g = Graph(directed=directed)
+        eprops = []
+        def get_eprops(n):
+            if eprop_types is None:
+                eprops.extend(g.new_ep("string") for i in range(n))
+            else:
+                eprops.extend(g.new_ep(t) for t in eprop_types)
+            return [_prop("e", g, p) for p in eprops]
+
+        name = None
+        if string_vals:
+            name = g.new_vp("string")
+        elif hashed:
+            name = g.new_vp("int64_t")
+
+        pfile = None
+        if isinstance(file_name, (str, unicode)):
+            if file_name.endswith(".xz"):
+                try:
+                    pfile = lzma.open(file_name, mode="rb")
+                except NameError:
+                    raise NotImplementedError("lzma compression is only available in Python >= 3.3")
+                file_name = ""
+        else:
+            pfile = file_name
+            file_name = ""
+
+        g._Graph__graph.read_from_csv(_c_str(file_name), pfile,
+                                      _c_str(_csv_options["delimiter"]),
+                                      _c_str(_csv_options["quotechar"]),
+                                      skip_first, int(ecols[0]),
+                                      int(ecols[1]),
+                                      string_vals, hashed,
+                                      get_eprops,
+                                      _prop("v", g, name) if name is not None else None)
+
+        for i, p in enumerate(eprops):
+            if eprop_names:
+                ename = eprop_names[i]
+            else:
+                ename = "c%d" % i
+            g.ep[ename] = p
+
+        if name is not None:
+            g.vp.name = name
+        return g
+
     if isinstance(file_name, (str, unicode)):
         if file_name.endswith(".xz"):
             try:
@@ -2754,8 +3005,6 @@ def load_graph_from_csv(file_name, directed=True, eprop_types=None,
             file_name = bz2.open(file_name, mode="r")
         else:
             file_name = open(file_name, "r")
-    _csv_options = {"delimiter": ",", "quotechar": '"'}
-    _csv_options.update(csv_options)
     r = csv.reader(file_name, **_csv_options)
     if skip_first:
         next(r)
@@ -2765,8 +3014,9 @@ def load_graph_from_csv(file_name, directed=True, eprop_types=None,
                 row = list(row)
                 s = row[ecols[0]]
                 t = row[ecols[1]]
-                del row[min(ecols)]
-                del row[max(ecols)-1]
+                for i in sorted(set(c % len(row) for c in ecols),
+                                reverse=True):
+                    del row[i]
                 yield [s, t] + row
         r = reorder(r)
     if not string_vals:
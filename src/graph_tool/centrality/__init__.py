@@ -49,7 +49,7 @@ from __future__ import division, absolute_import, print_function
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_centrality")
 
-from .. import _prop, ungroup_vector_property
+from .. import _prop, ungroup_vector_property, _get_rng
 from .. topology import shortest_distance
 import sys
 import numpy
@@ -228,7 +228,8 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
         return prop
 
 
-def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
+def betweenness(g, vprop=None, eprop=None, weight=None, norm=True,
+                pivots=None, epsilon=None, delta=0.1, return_error=False):
     r"""
     Calculate the betweenness centrality for each vertex and edge.
 
@@ -244,11 +245,31 @@ def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
         Edge property map corresponding to the weight value of each edge.
     norm : bool, optional (default: True)
         Whether or not the betweenness values should be normalized.
+    pivots : int, optional (default: None)
+        If given, the betweenness is estimated from the shortest paths starting
+        from only this number of source vertices ("pivots"), sampled uniformly
+        at random. It must be a positive integer.
+    epsilon : float, optional (default: None)
+        If given, the number of pivots is chosen so that the absolute error of
+        every normalized vertex and edge betweenness value is at most
+        ``epsilon``, with probability at least ``1 - delta``. This overrides
+        ``pivots``, and must be positive.
+    delta : float, optional (default: 0.1)
+        Probability that the error bound is violated, used in combination with
+        ``epsilon``, and to compute the error estimate of a sampled computation.
+        It must lie in the open interval :math:`(0, 1)`.
+    return_error : bool, optional (default: False)
+        If ``True``, the upper bound on the error of the normalized values is
+        also returned.
 
     Returns
     -------
     vertex_betweenness : A vertex property map with the vertex betweenness values.
     edge_betweenness : An edge property map with the edge betweenness values.
+    error : float (only if ``return_error == True``)
+        Upper bound on the absolute error of the normalized betweenness values,
+        which holds with probability at least ``1 - delta``. It is zero if the
+        values are exact.
 
     See Also
     --------
@@ -276,9 +297,29 @@ def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
 
     The algorithm used here is defined in [brandes-faster-2001]_, and has a
     complexity of :math:`O(VE)` for unweighted graphs and :math:`O(VE + V(V+E)
-    \log V)` for weighted graphs. The space complexity is :math:`O(VE)`.
+    \log V)` for weighted graphs. The space complexity is :math:`O(V + E)` per
+    thread.
 
-    If enabled during compilation, this algorithm runs in parallel.
+    If ``pivots`` or ``epsilon`` are given, only the dependencies of a uniform
+    sample of :math:`k` source vertices are computed, and multiplied by
+    :math:`N/k`, which yields an unbiased estimate [brandes-centrality-2007]_,
+    in time :math:`O(kE)`. Since the contribution of each source to a
+    normalized value lies in :math:`[0, N/(N-1)]`, Hoeffding's inequality
+    together with the union bound over all vertices and edges guarantees an
+    absolute error of at most
+
+    .. math::
+
+        \epsilon = \frac{N}{N-1}\sqrt{\frac{\ln(2(N+E)/\delta)}{2k}}
+
+    with probability at least :math:`1-\delta`. This is the error value
+    returned if ``return_error == True``, and if ``epsilon`` is given, the
+    smallest :math:`k` which achieves it is used. If :math:`k \geq N`, the
+    exact values are computed.
+
+    If enabled during compilation, this algorithm runs in parallel, with the
+    source vertices distributed among the threads, each of which accumulates
+    the dependencies separately.
 
     Examples
     --------
@@ -319,6 +360,9 @@ def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
     .. [betweenness-wikipedia] http://en.wikipedia.org/wiki/Centrality#Betweenness_centrality
     .. [brandes-faster-2001] U. Brandes, "A faster algorithm for betweenness
        centrality", Journal of Mathematical Sociology, 2001, :doi:`10.1080/0022250X.2001.9990249`
+    .. [brandes-centrality-2007] U. Brandes and C. Pich, "Centrality estimation
+       in large networks", International Journal of Bifurcation and Chaos 17,
+       2303 (2007), :doi:`10.1142/S0218127407018403`
     .. [adamic-polblogs] L. A. Adamic and N. Glance, "The political blogosphere
        and the 2004 US Election", in Proceedings of the WWW-2005 Workshop on the
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
@@ -331,9 +375,38 @@ def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
         nw = g.new_edge_property(eprop.value_type())
         g.copy_property(weight, nw)
         weight = nw
-    libgraph_tool_centrality.\
-            get_betweenness(g._Graph__graph, _prop("e", g, weight),
-                            _prop("e", g, eprop), _prop("v", g, vprop), norm)
+    if epsilon is not None and not epsilon > 0:
+        raise ValueError("epsilon must be positive, not %s" % str(epsilon))
+    if not 0 < delta < 1:
+        raise ValueError("delta must lie in the interval (0, 1), not %s" %
+                         str(delta))
+    if pivots is not None and epsilon is None and int(pivots) < 1:
+        raise ValueError("pivots must be a positive integer, not %s" %
+                         str(pivots))
+
+    N = g.num_vertices()
+    if pivots is not None or epsilon is not None:
+        E = g.num_edges()
+        r = N / (N - 1) if N > 1 else 1
+        log_d = numpy.log(2 * (N + E) / delta) if N + E > 0 else 0
+        if epsilon is not None:
+            pivots = int(numpy.ceil(r ** 2 * log_d / (2 * epsilon ** 2)))
+        pivots = min(int(pivots), N)
+
+    if pivots is None or pivots >= N:
+        libgraph_tool_centrality.\
+                get_betweenness(g._Graph__graph, _prop("e", g, weight),
+                                _prop("e", g, eprop), _prop("v", g, vprop), norm)
+        err = 0.
+    else:
+        libgraph_tool_centrality.\
+                get_sampled_betweenness(g._Graph__graph, _prop("e", g, weight),
+                                        _prop("e", g, eprop),
+                                        _prop("v", g, vprop), norm, pivots,
+                                        _get_rng())
+        err = r * numpy.sqrt(log_d / (2 * pivots))
+    if return_error:
+        return vprop, eprop, err
     return vprop, eprop
 
 def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False):
@@ -399,7 +472,9 @@ def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False
     The algorithm complexity of :math:`O(V(V + E))` for unweighted graphs and
     :math:`O(V(v+E) \log V)` for weighted graphs. If the option ``source`` is
     specified, this drops to :math:`O(V + E)` and :math:`O((V+E)\log V)`
-    respectively.
+    respectively. In the unweighted case, the searches from up to 64 sources
+    are performed simultaneously, with a multi-source BFS [then-ms-bfs-2014]_,
+    so that each edge is scanned only once per level for all of them.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -441,6 +516,10 @@ def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False
     .. [opsahl-node-2010] Opsahl, T., Agneessens, F., Skvoretz, J., "Node
        centrality in weighted networks: Generalizing degree and shortest
        paths". Social Networks 32, 245-251, 2010 :DOI:`10.1016/j.socnet.2010.03.006`
+    .. [then-ms-bfs-2014] M. Then, M. Kaufmann, F. Chirigati, T.-A. Hoang-Vu,
+       K. Pham, A. Kemper, T. Neumann, H. T. Vo, "The more the merrier:
+       efficient multi-source graph traversal", Proceedings of the VLDB
+       Endowment 8, 449 (2014), :doi:`10.14778/2735496.2735507`
     .. [adamic-polblogs] L. A. Adamic and N. Glance, "The political blogosphere
        and the 2004 US Election", in Proceedings of the WWW-2005 Workshop on the
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
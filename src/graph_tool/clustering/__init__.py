@@ -32,7 +32,9 @@ Summary
    :nosignatures:
 
    local_clustering
+   edge_triangles
    global_clustering
+   stream_global_clustering
    extended_clustering
    motifs
    motif_significance
@@ -56,8 +58,9 @@ from numpy import *
 from numpy import random
 import sys
 
-__all__ = ["local_clustering", "global_clustering", "extended_clustering",
-           "motifs", "motif_significance"]
+__all__ = ["local_clustering", "edge_triangles", "global_clustering",
+           "stream_global_clustering", "extended_clustering", "motifs",
+           "motif_significance"]
 
 
 def local_clustering(g, prop=None, undirected=True):
@@ -73,7 +76,9 @@ def local_clustering(g, prop=None, undirected=True):
         parameter will also be the return value.
     undirected : bool (default: True)
         Calculate the *undirected* clustering coefficient, if graph is directed
-        (this option has no effect if the graph is undirected).
+        (this option has no effect if the graph is undirected). Since edge
+        directions are always ignored (see below), this option does not
+        change the result.
 
     Returns
     -------
@@ -105,29 +110,36 @@ def local_clustering(g, prop=None, undirected=True):
     .. math::
        c'_i = 2c_i.
 
-    The implemented algorithm runs in :math:`O(|V|\left< k\right>^2)` time,
-    where :math:`\left< k\right>` is the average out-degree.
+    Parallel edges, self-loops and the directions of the edges are ignored,
+    i.e. the coefficients are those of the simple undirected graph with the
+    same adjacent vertex pairs. In particular, a pair of reciprocal edges in a
+    directed graph counts as a single edge. (Previous versions counted
+    parallel and reciprocal edges as distinct neighbours, and hence returned
+    smaller values for graphs containing them. The values for simple graphs
+    are unchanged.)
+
+    The implemented algorithm runs in :math:`O(|E|^{3/2})` time in the worst
+    case, by counting the triangles over the edges oriented from the lower- to
+    the higher-degree endpoints [schank-finding-2005]_.
 
     If enabled during compilation, this algorithm runs in parallel.
 
     Examples
     --------
-    .. testcode::
-       :hide:
-
-       np.random.seed(42)
-       gt.seed_rng(42)
-
-    >>> g = gt.random_graph(1000, lambda: (5,5))
+    >>> g = gt.collection.data["polblogs"]
     >>> clust = gt.local_clustering(g)
     >>> print(gt.vertex_average(g, clust))
-    (0.006177777777777778, 0.00036966184079941211)
+    (0.2626517751358..., 0.006561070549268...)
 
     References
     ----------
     .. [watts-collective-1998] D. J. Watts and Steven Strogatz, "Collective
        dynamics of 'small-world' networks", Nature, vol. 393, pp 440-442, 1998.
        :doi:`10.1038/30918`
+    .. [schank-finding-2005] T. Schank, D. Wagner, "Finding, counting and
+       listing all triangles in large graphs, an experimental study",
+       Experimental and Efficient Algorithms, WEA 2005, pp. 606-609,
+       :doi:`10.1007/11427186_54`
     """
 
     if prop == None:
@@ -138,7 +150,55 @@ def local_clustering(g, prop=None, undirected=True):
     return prop
 
 
-def global_clustering(g):
+def edge_triangles(g, prop=None):
+    r"""
+    Return the number of triangles to which each edge belongs.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    prop : :class:`~graph_tool.PropertyMap` or string, optional
+        Edge property map where results will be stored. If specified, this
+        parameter will also be the return value.
+
+    Returns
+    -------
+    prop : :class:`~graph_tool.PropertyMap`
+        Edge property containing the number of triangles.
+
+    See Also
+    --------
+    local_clustering: local clustering coefficient
+    global_clustering: global clustering coefficient
+
+    Notes
+    -----
+    The triangles are counted as in :func:`local_clustering`, i.e. parallel
+    edges, self-loops and the directions of the edges are ignored. Hence
+    parallel and reciprocal edges get the same number of triangles, and
+    self-loops get zero.
+
+    The counts are obtained in the same pass as the triangles of the vertices,
+    which runs in :math:`O(|E|^{3/2})` time in the worst case
+    [schank-finding-2005]_.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.complete_graph(4)
+    >>> print(gt.edge_triangles(g).a)
+    [2 2 2 2 2 2]
+    """
+
+    if prop == None:
+        prop = g.new_edge_property("int64_t")
+    _gt.edge_triangles(g._Graph__graph, _prop("e", g, prop))
+    return prop
+
+
+def global_clustering(g, samples=None):
     r"""
     Return the global clustering coefficient.
 
@@ -146,11 +206,16 @@ def global_clustering(g):
     ----------
     g : :class:`~graph_tool.Graph`
         Graph to be used.
+    samples : int (optional, default: None)
+        If supplied, the coefficient is estimated from this number of randomly
+        sampled wedges (i.e. paths of length two), instead of being computed
+        exactly.
 
     Returns
     -------
     c : tuple of floats
-        Global clustering coefficient and standard deviation (jacknife method)
+        Global clustering coefficient and standard deviation (jacknife method),
+        or standard error of the estimate, if ``samples`` is given.
 
     See Also
     --------
@@ -167,34 +232,142 @@ def global_clustering(g):
        c = 3 \times \frac{\text{number of triangles}}
                           {\text{number of connected triples}}
 
-    The implemented algorithm runs in :math:`O(|V|\left< k\right>^2)` time,
-    where :math:`\left< k\right>` is the average (total) degree.
+    Parallel edges, self-loops and the directions of the edges are ignored,
+    as in :func:`local_clustering`. (Previous versions counted parallel and
+    reciprocal edges as distinct connected triples, and used only the
+    out-neighbours of directed graphs. The values for simple undirected graphs
+    are unchanged.)
+
+    The implemented algorithm runs in :math:`O(|E|^{3/2})` time in the worst
+    case [schank-finding-2005]_. The triangles are counted only once, for both
+    the coefficient and its error.
+
+    If ``samples`` is given, the coefficient is estimated by wedge sampling
+    [seshadhri-wedge-2014]_: wedges are sampled uniformly by choosing their
+    centers with probability proportional to :math:`k(k-1)/2`, and the
+    coefficient is the fraction of sampled wedges which are closed. This
+    requires :math:`O(|V| + n\log |V|)` time, where :math:`n` is the number of
+    samples, which does not depend on the number of edges. The standard error
+    is :math:`\sqrt{c(1-c)/n}`, so that an approximate 95% confidence interval
+    is :math:`c\pm 1.96\sqrt{c(1-c)/n}`. Parallel edges and self-loops are
+    ignored here as well: sampled wedges which contain a self-loop or two
+    edges to the same neighbour are rejected, and the others are accepted with
+    probability :math:`1/(m_um_w)`, where :math:`m_u` and :math:`m_w` are the
+    multiplicities of their two edges, so that the accepted wedges are uniform
+    over those of the simple graph.
 
     If enabled during compilation, this algorithm runs in parallel.
 
     Examples
     --------
-    .. testcode::
-       :hide:
-
-       np.random.seed(42)
-       gt.seed_rng(42)
-
-    >>> g = gt.random_graph(1000, lambda: (5,5))
+    >>> g = gt.collection.data["polblogs"]
     >>> print(gt.global_clustering(g))
-    (0.006177777777777778, 0.0003700318726720...)
+    (0.2259585173589..., 0.01317638417454...)
 
     References
     ----------
     .. [newman-structure-2003] M. E. J. Newman, "The structure and function of
        complex networks", SIAM Review, vol. 45, pp. 167-256, 2003,
        :doi:`10.1137/S003614450342480`
+    .. [seshadhri-wedge-2014] C. Seshadhri, A. Pinar, T. G. Kolda, "Wedge
+       sampling for computing clustering coefficients and triangle counts on
+       large graphs", Statistical Analysis and Data Mining 7, 294-307 (2014),
+       :doi:`10.1002/sam.11224`, :arxiv:`1309.3321`
     """
 
-    c = _gt.global_clustering(g._Graph__graph)
+    if samples is not None:
+        c = _gt.sampled_global_clustering(g._Graph__graph, int(samples),
+                                          _get_rng())
+    else:
+        c = _gt.global_clustering(g._Graph__graph)
     return c
 
 
+def stream_global_clustering(file, fmt="auto", reservoir_size=1000000,
+                             n_estimates=8, confidence=0.95):
+    r"""
+    Estimate the global clustering coefficient and the number of triangles of a
+    graph stored in a file, without loading it into memory.
+
+    Parameters
+    ----------
+    file : string
+        Name of the file, which is decompressed on the fly if it ends with
+        ``.gz`` or ``.bz2``.
+    fmt : string (optional, default: ``"auto"``)
+        File format, which can be either ``"gt"`` (see :ref:`sec_gt_format`),
+        or ``"edgelist"``, i.e. a text file with one edge per line, given by
+        the integer indexes of its endpoints, separated by whitespace (lines
+        starting with ``#`` or ``%`` are ignored). If ``"auto"``, the format
+        is ``"gt"`` if the file name contains the ``.gt`` extension, and
+        ``"edgelist"`` otherwise.
+    reservoir_size : int (optional, default: ``1000000``)
+        Number of edges kept in memory by each estimator.
+    n_estimates : int (optional, default: ``8``)
+        Number of independent estimators, which are run in parallel.
+    confidence : float (optional, default: ``0.95``)
+        Confidence level of the returned intervals.
+
+    Returns
+    -------
+    c : tuple
+        Tuple ``(c, c_err, (c_min, c_max))`` with the estimated global
+        clustering coefficient, its standard error, and confidence interval.
+    t : tuple
+        Tuple ``(t, t_err, (t_min, t_max))`` with the estimated number of
+        triangles, its standard error, and confidence interval.
+
+    See Also
+    --------
+    global_clustering: global clustering coefficient
+
+    Notes
+    -----
+    The edges are read only once, in the order in which they are stored, and
+    the graph is considered as undirected. As in :func:`global_clustering`,
+    self-loops are skipped, and so are repeated edges, i.e. parallel edges
+    and, for directed graphs, reciprocal edges, so that the estimate refers to
+    the simple undirected graph with the same adjacent vertex pairs. The number of triangles is estimated
+    with the TRIÈST-IMPR algorithm [destefani-triest-2016]_, which keeps a
+    uniform sample of ``reservoir_size`` edges, by reservoir sampling, and
+    counts the triangles closed by each incoming edge within the sample,
+    weighted by the inverse of their probability of being observed. The number
+    of wedges is computed exactly from the degrees, which are counted along the
+    way. The values returned are the averages over ``n_estimates`` independent
+    estimators, and the confidence intervals are obtained from their spread,
+    using Student's t-distribution.
+
+    The memory required is :math:`O(|V| + |E| + n m)`, where :math:`m` is
+    ``reservoir_size`` and :math:`n` is ``n_estimates``, since the distinct
+    vertex pairs seen so far are kept to detect the repeated edges, and the
+    time is :math:`O(n |E| d)`, where :math:`d` is the typical degree in the
+    sample. If the graph has at most ``reservoir_size`` distinct edges,
+    the result is exact.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    References
+    ----------
+    .. [destefani-triest-2016] L. De Stefani, A. Epasto, M. Riondato, E. Upfal,
+       "TRIÈST: counting local and global triangles in fully dynamic streams
+       with fixed memory size", Proceedings of the 22nd ACM SIGKDD, 825-834
+       (2016), :doi:`10.1145/2939672.2939771`, :arxiv:`1602.07424`
+    """
+
+    if fmt == "auto":
+        if ".gt" in file.split("/")[-1]:
+            fmt = "gt"
+        else:
+            fmt = "edgelist"
+    if n_estimates < 1:
+        raise ValueError("at least one estimator is required")
+    if not (0 < confidence < 1):
+        raise ValueError("confidence must lie in the interval (0, 1)")
+    return _gt.stream_global_clustering(file, fmt, int(reservoir_size),
+                                        int(n_estimates), confidence,
+                                        _get_rng())
+
+
 def extended_clustering(g, props=None, max_depth=3, undirected=False):
     r"""
     Return the extended clustering coefficients for all vertices.
@@ -334,6 +507,15 @@ def motifs(g, k, p=1.0, motif_list=None, return_maps=False):
     This functions implements the ESU and RAND-ESU algorithms described in
     [wernicke-efficient-2006]_.
 
+    For :math:`k \le 5`, each subgraph is assigned to its isomorphism class
+    directly, via a canonical labelling of its adjacency matrix (which also
+    takes into account the multiplicity of parallel edges), instead of being
+    tested for isomorphism against the motifs found so far. The counts are
+    accumulated separately by each thread, and merged at the end. For
+    :math:`k = 3` on undirected graphs without parallel edges, if ``p == 1``
+    and ``return_maps == False``, the counts are obtained directly from the
+    number of triangles and wedges, without enumerating the subgraphs.
+
     If enabled during compilation, this algorithm runs in parallel.
 
     Examples
@@ -351,6 +533,16 @@ def motifs(g, k, p=1.0, motif_list=None, return_maps=False):
     >>> print(counts)
     [115408, 388542, 1031, 1182, 2662, 2138, 833, 28, 16, 5, 5, 3, 4]
 
+    If ``motif_list`` is given, only the motifs in it are counted:
+
+    >>> g = gt.collection.data["karate"]
+    >>> motifs, counts = gt.motifs(g, 3)
+    >>> print(counts)
+    [393, 45]
+    >>> motifs, counts = gt.motifs(g, 3, motif_list=[gt.complete_graph(3)])
+    >>> print(counts)
+    [45]
+
 
     References
     ----------
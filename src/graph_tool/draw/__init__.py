@@ -452,8 +452,8 @@ def _propagate_pos(g, cg, c, cc, cpos, delta, mivs):
     return pos
 
 
-def _avg_edge_distance(g, pos):
-    libgraph_tool_layout.sanitize_pos(g._Graph__graph, _prop("v", g, pos))
+def _avg_edge_distance(g, pos, dim=2):
+    libgraph_tool_layout.sanitize_pos(g._Graph__graph, _prop("v", g, pos), dim)
     ad = libgraph_tool_layout.avg_dist(g._Graph__graph, _prop("v", g, pos))
     if numpy.isnan(ad) or ad == 0:
         ad = 1.
@@ -520,7 +520,7 @@ def coarse_graphs(g, method="hybrid", mivs_thres=0.9, ec_thres=0.75,
                                  Ks[i] / 1000., mivs)
 
 def coarse_graph_stack(g, c, coarse_stack, eweight=None, vweight=None,
-                       weighted_coarse=True, verbose=False):
+                       weighted_coarse=True, verbose=False, dim=2):
     cg = [[g, c, None, None]]
     if weighted_coarse:
         cg[-1][2], cg[-1][3] = vweight, eweight
@@ -535,11 +535,11 @@ def coarse_graph_stack(g, c, coarse_stack, eweight=None, vweight=None,
             print(u.num_vertices())
     cg.reverse()
     Ks = []
-    pos = random_layout(cg[0][0], dim=2)
+    pos = random_layout(cg[0][0], dim=dim)
     for i in range(len(cg)):
         if i == 0:
             u = cg[i][0]
-            K = _avg_edge_distance(u, pos)
+            K = _avg_edge_distance(u, pos, dim)
             if K == 0:
                 K = 1.
             Ks.append(K)
@@ -560,7 +560,7 @@ def coarse_graph_stack(g, c, coarse_stack, eweight=None, vweight=None,
         yield u, pos, Ks[i], vcount, ecount
 
         if verbose:
-            print("avg edge distance:", _avg_edge_distance(u, pos))
+            print("avg edge distance:", _avg_edge_distance(u, pos, dim))
 
         if i < len(cg) - 1:
             if verbose:
@@ -574,7 +574,8 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
                 init_step=None, cooling_step=0.95, adaptive_cooling=True,
                 epsilon=1e-2, max_iter=0, pos=None, multilevel=None,
                 coarse_method="hybrid", mivs_thres=0.9, ec_thres=0.75,
-                coarse_stack=None, weighted_coarse=False, verbose=False):
+                coarse_stack=None, weighted_coarse=False, verbose=False,
+                dim=2):
     r"""Obtain the SFDP spring-block layout of the graph.
 
     Parameters
@@ -601,7 +602,8 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
     theta : float (optional, default: ``0.6``)
         Quadtree opening parameter, a.k.a. Barnes-Hut opening criterion.
     max_level : int (optional, default: ``15``)
-        Maximum quadtree level.
+        Maximum quadtree level. Values larger than ``31`` (or ``21`` if
+        ``dim == 3``) are treated as such.
     gamma : float (optional, default: ``1.0``)
         Strength of the attractive force between connected components, or group
         assignments.
@@ -629,7 +631,11 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
         activated based on the size of the graph.
     coarse_method : str (optional, default: ``"hybrid"``)
         Coarsening method used if ``multilevel == True``. Allowed methods are
-        ``"hybrid"``, ``"mivs"`` and ``"ec"``.
+        ``"hybrid"``, ``"mivs"`` and ``"ec"``. The ``"ec"`` method contracts
+        the edges of a heavy-edge matching, and ``"mivs"`` contracts the
+        neighbourhoods of a maximal independent vertex set. The ``"hybrid"``
+        method uses ``"ec"`` until it becomes ineffective, and then switches to
+        ``"mivs"``.
     mivs_thres : float (optional, default: ``0.9``)
         If the relative size of the MIVS coarse graph is above this value, the
         coarsening stops.
@@ -640,6 +646,10 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
         Use weighted coarse graphs.
     verbose : bool (optional, default: ``False``)
         Provide verbose information.
+    dim : int (optional, default: ``2``)
+        Number of dimensions of the layout, which must be either ``2`` or
+        ``3``. If ``pos`` is given, its values are truncated or padded with
+        zeros to this size.
 
     Returns
     -------
@@ -652,6 +662,11 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
     This algorithm is defined in [hu-multilevel-2005]_, and has
     complexity :math:`O(V\log V)`.
 
+    Unless ``coarse_stack`` is given, the whole multilevel scheme (coarsening,
+    layout of every level, and interpolation of the positions between levels)
+    runs natively and in parallel. If ``verbose == True``, the size of every
+    level, and the time spent on it, are printed.
+
     Examples
     --------
     .. testcode::
@@ -682,8 +697,10 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
        http://www.mathematica-journal.com/issue/v10i1/graph_draw.html
     """
 
+    if dim not in [2, 3]:
+        raise ValueError("'dim' must be either 2 or 3, not " + str(dim))
     if pos is None:
-        pos = random_layout(g, dim=2)
+        pos = random_layout(g, dim=dim)
     _check_prop_vector(pos, name="pos", floating=True)
 
     g_ = g
@@ -696,10 +713,10 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
         pin = g.new_vertex_property("bool")
 
     if K is None:
-        K = _avg_edge_distance(g, pos)
+        K = _avg_edge_distance(g, pos, dim)
 
     if init_step is None:
-        init_step = 2 * max(_avg_edge_distance(g, pos), K)
+        init_step = 2 * max(_avg_edge_distance(g, pos, dim), K)
 
     if multilevel is None:
         multilevel = g.num_vertices() > 1000
@@ -708,18 +725,34 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
         if eweight is not None or vweight is not None:
             weighted_coarse = True
         if coarse_stack is None:
-            cgs = coarse_graphs(g, method=coarse_method,
-                                mivs_thres=mivs_thres,
-                                ec_thres=ec_thres,
-                                weighted_coarse=weighted_coarse,
-                                eweight=eweight,
-                                vweight=vweight,
-                                groups=groups,
-                                verbose=verbose)
-        else:
-            cgs = coarse_graph_stack(g, coarse_stack[0], coarse_stack[1],
-                                     eweight=eweight, vweight=vweight,
-                                     verbose=verbose)
+            if coarse_method not in ["hybrid", "mivs", "ec"]:
+                raise ValueError("invalid coarsening method: " +
+                                 str(coarse_method))
+            if groups is not None and groups.value_type() != "int32_t":
+                raise ValueError("'groups' property must be of type 'int32_t'.")
+            pos = g.new_vertex_property("vector<double>")
+            stats = libgraph_tool_layout.sfdp_layout_multilevel(
+                g._Graph__graph, _prop("v", g, pos), _prop("v", g, vweight),
+                _prop("e", g, eweight), _prop("v", g, groups),
+                (C, p, gamma, mu, mu_p),
+                (coarse_method, mivs_thres, ec_thres, weighted_coarse),
+                theta, cooling_step, max_level, epsilon, max_iter, dim,
+                _get_rng())
+            if verbose:
+                for l, s in enumerate(stats):
+                    print("Level %d%s: %d vertices, %d edges, K = %g, "
+                          "%d iterations; coarsening: %gs, layout: %gs, "
+                          "propagation: %gs" %
+                          (l, " (MIVS)" if s["mivs"] else "", s["vertices"],
+                           s["edges"], s["K"], s["iterations"],
+                           s["coarse_time"], s["layout_time"],
+                           s["prolong_time"]))
+            pos = g_.own_property(pos)
+            return pos
+
+        cgs = coarse_graph_stack(g, coarse_stack[0], coarse_stack[1],
+                                 eweight=eweight, vweight=vweight,
+                                 verbose=verbose, dim=dim)
         for count, (u, pos, K, vcount, ecount) in enumerate(cgs):
             if verbose:
                 print("Positioning level:", count, u.num_vertices(), end=' ')
@@ -738,7 +771,7 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
                               # init_step=max(2 * K,
                               #               _avg_edge_distance(u, pos)),
                               multilevel=False,
-                              verbose=False)
+                              verbose=False, dim=dim)
         pos = g_.own_property(pos)
         return pos
 
@@ -746,8 +779,8 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
         return pos
     if g.num_vertices() == 2:
         vs = [g.vertex(0, False), g.vertex(1, False)]
-        pos[vs[0]] = [0, 0]
-        pos[vs[1]] = [1, 1]
+        pos[vs[0]] = [0] * dim
+        pos[vs[1]] = [1] * dim
         return pos
     if g.num_vertices() <= 50:
         max_level = 0
@@ -755,7 +788,7 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
         groups = label_components(g)[0]
     elif groups.value_type() != "int32_t":
         raise ValueError("'groups' property must be of type 'int32_t'.")
-    libgraph_tool_layout.sanitize_pos(g._Graph__graph, _prop("v", g, pos))
+    libgraph_tool_layout.sanitize_pos(g._Graph__graph, _prop("v", g, pos), dim)
     libgraph_tool_layout.sfdp_layout(g._Graph__graph, _prop("v", g, pos),
                                      _prop("v", g, vweight),
                                      _prop("e", g, eweight),
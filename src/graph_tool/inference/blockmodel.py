@@ -1096,9 +1096,13 @@ class BlockState(object):
         parallel : ``bool`` (optional, default: ``False``)
             If ``parallel == True``, vertex movements are attempted in parallel.
 
+            For :class:`~graph_tool.inference.BlockState`, the result is
+            equivalent to a sequential sweep (see notes below).
+
             .. warning::
 
-               If ``parallel == True``, the asymptotic exactness of the MCMC
+               For the overlapping and layered variants of the model, if
+               ``parallel == True``, the asymptotic exactness of the MCMC
                sampling is not guaranteed.
         vertices : ``list`` of ints (optional, default: ``None``)
             If provided, this should be a list of vertices which will be
@@ -1118,6 +1122,24 @@ class BlockState(object):
         This algorithm has an :math:`O(E)` complexity, where :math:`E` is the
         number of edges (independent of the number of blocks).
 
+        If ``parallel == True``, the moves of consecutive vertices are proposed
+        and evaluated in parallel. They are then accepted in the order the
+        vertices were visited. A precomputed move is reevaluated if a move
+        accepted before it involved any of the same blocks, i.e. the block of
+        the vertex, those of its neighbours, or the target block. With
+        ``entropy_args["dense"] == True``, the entropy difference depends on
+        the sizes of all blocks, and hence it is always reevaluated after the
+        first accepted move (only the proposal is reused). A move which empties
+        a block, or occupies an empty one, is never combined with later
+        precomputed moves. Hence the sweep samples from exactly the same
+        distribution as a sequential one.
+
+        Consecutive accepted moves involving disjoint sets of blocks are
+        performed concurrently, unless ``pclabel`` divides the vertices into
+        more than one partition, in which case they are performed one after
+        the other. The sweep scales with the number of blocks relative to the
+        typical neighbourhood.
+
         References
         ----------
         .. [peixoto-efficient-2014] Tiago P. Peixoto, "Efficient Monte Carlo and
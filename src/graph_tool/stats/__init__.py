@@ -38,6 +38,8 @@ Summary
    remove_self_loops
    remove_labeled_edges
    distance_histogram
+   neighbourhood_function
+   effective_diameter
 
 Contents
 ++++++++
@@ -57,7 +59,8 @@ import sys
 __all__ = ["vertex_hist", "edge_hist", "vertex_average", "edge_average",
            "label_parallel_edges", "remove_parallel_edges",
            "label_self_loops", "remove_self_loops", "remove_labeled_edges",
-           "distance_histogram"]
+           "distance_histogram", "neighbourhood_function",
+           "effective_diameter"]
 
 
 def vertex_hist(g, deg, bins=[0, 1], float_count=True):
@@ -442,3 +445,126 @@ def distance_histogram(g, weight=None, bins=[0, 1], samples=None,
         ret = libgraph_tool_stats.\
               distance_histogram(g._Graph__graph, _prop("e", g, weight), bins)
     return [array(ret[0], dtype="float64") if float_count else ret[0], ret[1]]
+
+
+def neighbourhood_function(g, precision=6, max_dist=None, harmonic=False):
+    r"""Return an approximation of the neighbourhood function of the graph,
+    i.e. the number of vertex pairs within each distance.
+
+    Parameters
+    ----------
+    g : :class:`Graph`
+        Graph to be used.
+    precision : int (optional, default: 6)
+        Base-2 logarithm of the number of registers of each HyperLogLog
+        counter. It must lie in the interval :math:`[4, 16]`.
+    max_dist : int (optional, default: None)
+        If supplied, the neighbourhood function is computed only up to this
+        distance.
+    harmonic : bool (optional, default: False)
+        If True, the approximate harmonic centrality of each vertex is also
+        returned.
+
+    Returns
+    -------
+    nf : :class:`~numpy.ndarray`
+        Array where ``nf[t]`` is the estimated number of ordered pairs
+        :math:`(u, v)` such that :math:`d(u, v) \le t`, including the pairs
+        with :math:`u = v`. The array ends when the estimates stop changing, or
+        at ``t == max_dist``.
+    hc : :class:`~graph_tool.PropertyMap`
+        Vertex property map with the approximate harmonic centrality, i.e.
+        :math:`\frac{1}{V-1}\sum_{u\ne v}1/d(v, u)`. Only returned if
+        ``harmonic == True``.
+
+    See Also
+    --------
+    distance_histogram : Shortest-distance histogram.
+    effective_diameter : Effective diameter from the neighbourhood function.
+
+    Notes
+    -----
+    The neighbourhood function is computed with the HyperANF algorithm
+    [boldi-hyperanf-2011]_, where each vertex keeps a HyperLogLog counter with
+    :math:`m = 2^{\text{precision}}` registers that estimates the number of
+    vertices reachable from it in :math:`t` steps. Each iteration merges the
+    counters of the out-neighbours, so that the algorithm runs in
+    :math:`O(D(V + E)m)` time and :math:`O(Vm)` memory, where :math:`D` is the
+    diameter, instead of the :math:`O(V(V + E))` time required by
+    :func:`distance_histogram`. The relative standard error of each estimate is
+    approximately :math:`1.04/\sqrt{m}`.
+
+    The histogram of distances can be obtained with ``numpy.diff(nf)``.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    .. testsetup::
+
+       gt.seed_rng(42)
+
+    >>> g = gt.collection.data["polblogs"]
+    >>> nf = gt.neighbourhood_function(g, precision=10)
+    >>> hist = numpy.diff(nf)
+    >>> d = gt.effective_diameter(nf)
+
+    References
+    ----------
+    .. [boldi-hyperanf-2011] Paolo Boldi, Marco Rosa, Sebastiano Vigna,
+       "HyperANF: approximating the neighbourhood function of very large graphs
+       on a budget", Proceedings of the 20th International Conference on World
+       Wide Web, 625 (2011), :doi:`10.1145/1963405.1963493`,
+       :arxiv:`1011.5599`
+    """
+
+    if max_dist is None:
+        max_dist = g.num_vertices()
+    hc = None
+    if harmonic:
+        hc = g.new_vertex_property("double")
+    nf = libgraph_tool_stats.hyperanf(g._Graph__graph, precision, max_dist,
+                                      _prop("v", g, hc), _get_rng())
+    if harmonic:
+        if g.num_vertices() > 1:
+            hc.fa /= g.num_vertices() - 1
+        return nf, hc
+    return nf
+
+
+def effective_diameter(nf, q=0.9):
+    r"""Return the effective diameter, i.e. the smallest distance within which a
+    fraction ``q`` of all reachable pairs of vertices lie, given the
+    neighbourhood function ``nf``.
+
+    Parameters
+    ----------
+    nf : :class:`~numpy.ndarray`
+        Cumulative number of pairs within each distance, as returned by
+        :func:`neighbourhood_function`.
+    q : float (optional, default: 0.9)
+        Fraction of reachable pairs.
+
+    Returns
+    -------
+    d : float
+        The effective diameter, linearly interpolated between consecutive
+        distances.
+
+    See Also
+    --------
+    neighbourhood_function : Approximate neighbourhood function.
+    """
+
+    nf = asarray(nf, dtype="float")
+    if len(nf) == 0:
+        raise ValueError("empty neighbourhood function")
+    target = q * nf[-1]
+    t = int(searchsorted(nf, target))
+    if t == 0:
+        return 0.
+    t = min(t, len(nf) - 1)
+    dnf = nf[t] - nf[t - 1]
+    if dnf <= 0:
+        return float(t)
+    return t - 1 + (target - nf[t - 1]) / dnf
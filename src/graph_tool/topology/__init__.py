@@ -82,7 +82,8 @@ __all__ = ["isomorphism", "subgraph_isomorphism", "mark_subgraph",
            "topological_sort", "transitive_closure", "tsp_tour",
            "sequential_vertex_coloring", "label_components",
            "label_largest_component", "label_biconnected_components",
-           "label_out_component", "kcore_decomposition", "shortest_distance",
+           "label_out_component", "kcore_decomposition", "kcore_update",
+           "shortest_distance",
            "shortest_path", "all_shortest_paths", "all_predecessors",
            "all_paths", "all_circuits", "pseudo_diameter", "is_bipartite", "is_DAG",
            "is_planar", "make_maximal_planar", "similarity", "vertex_similarity",
@@ -165,7 +166,7 @@ def similarity(g1, g2, label1=None, label2=None, norm=True):
 
 @_limit_args({"sim_type": ["dice", "jaccard", "inv-log-weight"]})
 def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
-                      sim_map=None):
+                      sim_map=None, top_k=None, minhash=None, lsh_bands=16):
     r"""Return the similarity between pairs of vertices.
 
     Parameters
@@ -185,6 +186,17 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
         If provided, and ``vertex_pairs == None``, the vertex similarities will
         be stored in this vector-valued property. Otherwise, a new one will be
         created.
+    top_k : int (optional, default: ``None``)
+        If provided, only the ``top_k`` most similar vertices to each vertex
+        will be returned, instead of the similarities to all other vertices. It
+        cannot be given together with ``vertex_pairs``.
+    minhash : int (optional, default: ``None``)
+        If provided together with ``top_k``, and ``sim_type == "jaccard"``, the
+        most similar vertices will be found approximately, using this number of
+        MinHash functions (see below).
+    lsh_bands : int (optional, default: ``16``)
+        Number of bands used for locality-sensitive hashing, if ``minhash`` is
+        given. It must divide ``minhash``.
 
     Returns
     -------
@@ -193,6 +205,12 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
         with the corresponding similarities, otherwise it will be a
         vector-valued vertex :class:`~graph_tool.PropertyMap`, with the
         similarities to all other vertices.
+    pairs : :class:`numpy.ndarray`
+        If ``top_k`` was supplied, this will be an array of shape ``(M, 2)``,
+        containing the pairs ``(u, v)``, where ``v`` is among the ``top_k``
+        most similar vertices to ``u``. The pairs are ordered by ``u``, and
+        then by decreasing similarity. This is returned together with the
+        similarities, as a tuple ``(pairs, similarities)``.
 
     Notes
     -----
@@ -227,6 +245,33 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
     The algorithm runs with complexity :math:`O(\left<k\right>N^2)` if
     ``vertex_pairs == None``, otherwise with :math:`O(\left<k\right>P)` where
     :math:`P` is the length of ``vertex_pairs``.
+    The pairs in ``vertex_pairs`` are grouped by their first vertex, so that its
+    neighbourhood is processed only once for all the pairs which share it, and
+    the similarities are obtained by intersecting sorted neighbour lists.
+
+    If ``top_k`` is given, the all-pairs similarity matrix is never
+    materialized. Only vertices which share at least one neighbour have a
+    nonzero similarity, and these are found by traversing the paths of length
+    two from every vertex, while the :math:`K` = ``top_k`` best ones are kept in
+    a heap. The algorithm then runs with complexity :math:`O(\left<k^2\right>N
+    + N \log K)`, and requires :math:`O(NK)` memory.
+    A vertex is never returned as similar to itself, and vertices with no
+    common neighbours are never returned.
+
+    If, in addition, ``minhash`` is given, the Jaccard similarities are
+    estimated from MinHash signatures [leskovec-mining-2014]_, i.e. the
+    minimum values of ``minhash`` independent hash functions over the
+    neighbours of each vertex, which are then split into ``lsh_bands`` bands
+    for locality-sensitive hashing. Only pairs of vertices whose signatures
+    are identical in at least one band are compared, so that pairs with a
+    similarity :math:`s` are found with probability :math:`1 - (1 -
+    s^r)^b`, with :math:`b` = ``lsh_bands`` and :math:`r` = ``minhash /
+    lsh_bands``. This avoids the enumeration of paths of length two, which
+    can be prohibitive for graphs with high-degree vertices, and runs with
+    complexity :math:`O(Em + b N (\log N + K m))`, with :math:`m` =
+    ``minhash``. In this case, the similarity is computed between the
+    sets of neighbours of both vertices (including the vertices themselves, if
+    ``self_loops == True``), ignoring parallel edges.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -271,8 +316,53 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
        "The link-prediction problem for social networks", Journal of the
        American Society for Information Science and Technology, Volume 58, Issue
        7, pages 1019–1031 (2007), :doi:`10.1002/asi.20591`
+    .. [leskovec-mining-2014] Jure Leskovec, Anand Rajaraman, and Jeffrey
+       D. Ullman, "Mining of Massive Datasets", Chapter 3, Cambridge University
+       Press (2014), :doi:`10.1017/CBO9781139924801`
     """
 
+    if top_k is not None and vertex_pairs is not None:
+        raise ValueError("top_k and vertex_pairs cannot be given together")
+
+    if top_k is not None:
+        top_k = int(top_k)
+        if top_k < 1:
+            raise ValueError("top_k must be positive: %d" % top_k)
+        N = g.num_vertices(True)
+        targets = numpy.full((N, top_k), -1, dtype="int64")
+        s = numpy.zeros((N, top_k), dtype="double")
+        if minhash is not None:
+            if sim_type != "jaccard":
+                raise ValueError("MinHash approximation is only available " +
+                                 "for the Jaccard similarity")
+            minhash = int(minhash)
+            lsh_bands = int(lsh_bands)
+            if lsh_bands < 1 or minhash < 1 or minhash % lsh_bands != 0:
+                raise ValueError("the number of LSH bands must divide the " +
+                                 "number of MinHash functions")
+            libgraph_tool_topology.jaccard_similarity_minhash(g._Graph__graph,
+                                                              targets, s,
+                                                              self_loops,
+                                                              minhash,
+                                                              lsh_bands,
+                                                              _get_rng())
+        elif sim_type == "dice":
+            libgraph_tool_topology.dice_similarity_top_k(g._Graph__graph,
+                                                         targets, s,
+                                                         self_loops)
+        elif sim_type == "jaccard":
+            libgraph_tool_topology.jaccard_similarity_top_k(g._Graph__graph,
+                                                            targets, s,
+                                                            self_loops)
+        elif sim_type == "inv-log-weight":
+            libgraph_tool_topology.\
+                inv_log_weight_similarity_top_k(g._Graph__graph, targets, s)
+        idx = targets >= 0
+        pairs = numpy.empty((idx.sum(), 2), dtype="int64")
+        pairs[:, 0] = numpy.nonzero(idx)[0]
+        pairs[:, 1] = targets[idx]
+        return pairs, s[idx]
+
     if vertex_pairs is None:
         if sim_map is None:
             s = g.new_vp("vector<double>")
@@ -291,6 +381,14 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
                                                              _prop("v", g, s))
     else:
         vertex_pairs = numpy.asarray(vertex_pairs, dtype="int64")
+        if vertex_pairs.size == 0:
+            vertex_pairs = vertex_pairs.reshape((0, 2))
+        if (vertex_pairs.ndim != 2 or vertex_pairs.shape[1] != 2 or
+            (vertex_pairs.size > 0 and
+             (vertex_pairs.min() < 0 or
+              vertex_pairs.max() >= g.num_vertices(True)))):
+            raise ValueError("vertex_pairs must be a list of pairs of valid " +
+                             "vertex indexes")
         s = numpy.zeros(vertex_pairs.shape[0], dtype="double")
         if sim_type == "dice":
             libgraph_tool_topology.dice_similarity_pairs(g._Graph__graph,
@@ -934,11 +1032,30 @@ def label_components(g, vprop=None, directed=None, attractors=False):
 
     Notes
     -----
-    The components are arbitrarily labeled from 0 to N-1, where N is the total
-    number of components.
+    The components are labeled from 0 to N-1, where N is the total number of
+    components, in the order of their smallest vertex index. Hence the labels
+    do not depend on the algorithm used, or on the number of threads.
 
     The algorithm runs in :math:`O(V + E)` time.
 
+    If enabled during compilation, and the graph is sufficiently large, the
+    components are found in parallel. For undirected graphs, the union-find
+    algorithm of [sutton-afforest]_ is used, and for directed graphs the
+    trimming, forward-backward search and coloring steps of
+    [slota-multistep]_.
+
+    References
+    ----------
+    .. [sutton-afforest] Michael Sutton, Tal Ben-Nun, Amnon Barak, "Optimizing
+       parallel graph connectivity computation via subgraph sampling", IEEE
+       International Parallel and Distributed Processing Symposium (IPDPS), pp
+       12-21 (2018), :DOI:`10.1109/IPDPS.2018.00012`
+    .. [slota-multistep] George M. Slota, Sivasankaran Rajamanickam, Kamesh
+       Madduri, "BFS and coloring-based parallel algorithms for strongly
+       connected components and related problems", IEEE International Parallel
+       and Distributed Processing Symposium (IPDPS), pp 550-559 (2014),
+       :DOI:`10.1109/IPDPS.2014.64`
+
     Examples
     --------
     .. testcode::
@@ -950,18 +1067,18 @@ def label_components(g, vprop=None, directed=None, attractors=False):
     >>> g = gt.random_graph(100, lambda: (poisson(2), poisson(2)))
     >>> comp, hist, is_attractor = gt.label_components(g, attractors=True)
     >>> print(comp.a)
-    [13 13 13 13 14 12 13 15 16 13 17 19 13 13 13 20 13 13 13 10 13 13 22 13 13
-      4 13 13  2 23 13 13 24 13 13 26 27 13 13 13 13  0 13 13  3 13 13 13 28  1
-      6 13 13 13 13  5 13 13 13 13 13 13 13  9 13 11 13 29 13 13 13 13 18 13 30
-     31 13 13 32 13 33 34 35 13 13 21 13 25  8 36 13 13 13 13 13 37 13 13  7 13]
+    [ 0  0  0  0  1  2  0  3  4  0  5  6  0  0  0  7  0  0  0  8  0  0  9  0  0
+     10  0  0 11 12  0  0 13  0  0 14 15  0  0  0  0 16  0  0 17  0  0  0 18 19
+     20  0  0  0  0 21  0  0  0  0  0  0  0 22  0 23  0 24  0  0  0  0 25  0 26
+     27  0  0 28  0 29 30 31  0  0 32  0 33 34 35  0  0  0  0  0 36  0  0 37  0]
     >>> print(hist)
-    [ 1  1  1  1  1  1  1  1  1  1  1  1  1 63  1  1  1  1  1  1  1  1  1  1  1
+    [63  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1  1
       1  1  1  1  1  1  1  1  1  1  1  1  1]
     >>> print(is_attractor)
-    [ True False  True  True  True False False  True False  True  True  True
-      True False  True False False False False False False False False False
-     False False False False False False False False False  True False  True
-     False False]
+    [False  True  True False False False False False  True False  True  True
+     False False False False  True  True False False False False  True  True
+     False False False False False  True False  True False False False False
+     False  True]
     """
 
     if vprop is None:
@@ -1220,6 +1337,14 @@ def kcore_decomposition(g, deg="out", vprop=None):
     This algorithm is described in [batagelk-algorithm]_ and runs in :math:`O(V + E)`
     time.
 
+    If enabled during compilation, and the graph is sufficiently large, the
+    vertices are removed in parallel instead, one level at a time, with atomic
+    updates of the remaining degrees, as described in [kabir-parallel]_. The
+    result is identical.
+
+    After edges are inserted or removed, the decomposition can be updated with
+    :func:`~graph_tool.topology.kcore_update`.
+
     Examples
     --------
 
@@ -1247,6 +1372,10 @@ def kcore_decomposition(g, deg="out", vprop=None):
        networks", Advances in Data Analysis and Classification
        Volume 5, Issue 2, pp 129-145 (2011), :DOI:`10.1007/s11634-010-0079-y`,
        :arxiv:`cs/0310049`
+    .. [kabir-parallel] Humayun Kabir, Kamesh Madduri, "Parallel k-core
+       decomposition on multicore platforms", IEEE International Parallel and
+       Distributed Processing Symposium Workshops (IPDPSW), pp 1482-1491
+       (2017), :DOI:`10.1109/IPDPSW.2017.151`
 
     """
 
@@ -1269,10 +1398,110 @@ def kcore_decomposition(g, deg="out", vprop=None):
                                    _degree(g, deg))
     return vprop
 
+def kcore_update(g, kval, inserted=None, removed=None):
+    r"""Update the k-core decomposition of the given graph, after the insertion
+    or removal of edges.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used, which must already contain the inserted edges, and
+        no longer contain the removed ones. If the graph is directed, the edge
+        directions are ignored, i.e. the decomposition of
+        ``GraphView(g, directed=False)`` is updated.
+    kval : :class:`~graph_tool.PropertyMap`
+        Vertex property map with the k-core decomposition of the undirected
+        graph before the changes, i.e. as returned by
+        ``kcore_decomposition(GraphView(g, directed=False))``. It is updated in
+        place. Note that the decomposition of a directed graph returned by
+        :func:`~graph_tool.topology.kcore_decomposition` with the default
+        ``deg="out"`` (or with ``deg="in"``) is a different one, and cannot be
+        used here.
+    inserted : iterable of pairs of integers (optional, default: ``None``)
+        Endpoints of the edges which were inserted.
+    removed : iterable of pairs of integers (optional, default: ``None``)
+        Endpoints of the edges which were removed.
+
+    Returns
+    -------
+    incremental : bool
+        ``True`` if the decomposition was updated incrementally, or ``False``
+        if it was recomputed from scratch.
+
+    Notes
+    -----
+
+    The edges are processed one at a time, with the "subcore" algorithm
+    described in [sariyuce-streaming]_: when an edge is inserted or removed,
+    only the core numbers of the vertices with the same core number as its
+    endpoint with the smallest one, which are reachable from it via such
+    vertices, may change, and only by one. The time required is proportional
+    to the number of edges incident on these vertices, which is usually much
+    smaller than the whole graph. However, if most vertices have the same core
+    number, this can include the whole graph, and hence the decomposition is
+    recomputed from scratch if the total work would exceed the
+    :math:`O(V + E)` time of :func:`~graph_tool.topology.kcore_decomposition`.
+
+    Examples
+    --------
+
+    >>> g = gt.collection.data["netscience"]
+    >>> kcore = gt.kcore_decomposition(g)
+    >>> e = g.add_edge(0, 1)
+    >>> inc = gt.kcore_update(g, kcore, inserted=[(0, 1)])
+    >>> (kcore.a == gt.kcore_decomposition(g).a).all()
+    True
+
+    For a directed graph, the decomposition of its undirected version is
+    updated:
+
+    >>> g = gt.collection.data["polblogs"]
+    >>> u = gt.GraphView(g, directed=False)
+    >>> kcore = gt.kcore_decomposition(u)
+    >>> e = g.add_edge(0, 1)
+    >>> inc = gt.kcore_update(g, kcore, inserted=[(0, 1)])
+    >>> (kcore.a == gt.kcore_decomposition(u).a).all()
+    True
+
+    References
+    ----------
+    .. [sariyuce-streaming] Ahmet Erdem Sariyüce, Buğra Gedik, Gabriela
+       Jacques-Silva, Kun-Lung Wu, Ümit V. Çatalyürek, "Streaming algorithms
+       for k-core decomposition", Proceedings of the VLDB Endowment 6, 433
+       (2013), :DOI:`10.14778/2536336.2536344`
+
+    """
+
+    _check_prop_writable(kval, name="kval")
+    _check_prop_scalar(kval, name="kval")
+
+    def get_pairs(pairs, name):
+        if pairs is None:
+            pairs = []
+        pairs = numpy.asarray(pairs, dtype="int64")
+        if pairs.size == 0:
+            pairs = pairs.reshape((0, 2))
+        if (pairs.ndim != 2 or pairs.shape[1] != 2 or
+            (pairs.size > 0 and
+             (pairs.min() < 0 or pairs.max() >= g.num_vertices(True)))):
+            raise ValueError("%s must be a list of pairs of valid " % name +
+                             "vertex indexes")
+        return pairs
+
+    inserted = get_pairs(inserted, "inserted")
+    removed = get_pairs(removed, "removed")
+
+    if g.is_directed():
+        g = GraphView(g, directed=False)
+
+    return libgraph_tool_topology.\
+        kcore_update(g._Graph__graph, _prop("v", g, kval), inserted, removed)
+
 
 def shortest_distance(g, source=None, target=None, weights=None,
                       negative_weights=False, max_dist=None, directed=None,
-                      dense=False, dist_map=None, pred_map=False):
+                      dense=False, dist_map=None, pred_map=False,
+                      delta_stepping=False, delta=None):
     """Calculate the distance from a source to a target vertex, or to of all
     vertices from a given source, or the all pairs shortest paths, if the source
     is not specified.
@@ -1310,6 +1539,14 @@ def shortest_distance(g, source=None, target=None, weights=None,
     pred_map : ``bool`` (optional, default: ``False``)
         If ``True``, a vertex property map with the predecessors is returned.
         Ignored if ``source`` is ``None``.
+    delta_stepping : ``bool`` (optional, default: ``False``)
+        If ``True``, and both ``source`` and ``weights`` are given, the parallel
+        delta-stepping algorithm is used instead of Dijkstra's. This option has
+        no effect if ``negative_weights == True``.
+    delta : ``float`` (optional, default: ``None``)
+        Bucket width used by the delta-stepping algorithm, which must be
+        positive. If not given, the largest weight divided by the average
+        out-degree is used.
 
     Returns
     -------
@@ -1328,7 +1565,20 @@ def shortest_distance(g, source=None, target=None, weights=None,
     [bellman-ford]_, which accepts negative weights, as long as there are no
     negative loops. If source is not given, the distances are calculated with
     Johnson's algorithm [johnson-apsp]_. If dense=True, the Floyd-Warshall
-    algorithm [floyd-warshall-apsp]_ is used instead.
+    algorithm [floyd-warshall-apsp]_ is used instead. If
+    ``delta_stepping == True``, the weighted search uses the delta-stepping
+    algorithm [delta-stepping]_, in which all vertices with tentative distances
+    in the same bucket of width ``delta`` are relaxed in parallel. Only the
+    edges with weights not larger than ``delta`` are relaxed while the bucket
+    is processed; the remaining edges are relaxed once, after it empties. The
+    memory used by the buckets is proportional to the largest weight divided by
+    ``delta``, independently of the range of the distances.
+
+    The unweighted search expands each level of the BFS in parallel. If a
+    vertex has more than one predecessor at the previous level, the one stored
+    in ``pred_map`` does not depend on the number of threads: it is either the
+    first one in its list of in-edges, or the one with the smallest index,
+    depending on which direction was used to expand the level.
 
     If source is specified, the algorithm runs in :math:`O(V + E)` time, or
     :math:`O(V \log V)` if weights are given. If ``negative_weights == True``,
@@ -1403,6 +1653,9 @@ def shortest_distance(g, source=None, target=None, weights=None,
     .. [johnson-apsp] http://www.boost.org/libs/graph/doc/johnson_all_pairs_shortest.html
     .. [floyd-warshall-apsp] http://www.boost.org/libs/graph/doc/floyd_warshall_shortest.html
     .. [bellman-ford] http://www.boost.org/libs/graph/doc/bellman_ford_shortest.html
+    .. [delta-stepping] U. Meyer, P. Sanders, "Delta-stepping: a parallelizable
+       shortest path algorithm", Journal of Algorithms 49, 114 (2003),
+       :doi:`10.1016/S0196-6774(03)00076-2`
     """
 
     if isinstance(target, collections.Iterable):
@@ -1432,6 +1685,9 @@ def shortest_distance(g, source=None, target=None, weights=None,
     if max_dist is None:
         max_dist = 0
 
+    if delta is not None and not delta > 0:
+        raise ValueError("delta must be positive, not %s" % str(delta))
+
     if directed is not None:
         u = GraphView(g, directed=directed)
     else:
@@ -1446,7 +1702,9 @@ def shortest_distance(g, source=None, target=None, weights=None,
                                          _prop("e", u, weights),
                                          _prop("v", u, pmap),
                                          float(max_dist),
-                                         negative_weights)
+                                         negative_weights,
+                                         delta_stepping,
+                                         float(delta if delta is not None else 0))
     else:
         libgraph_tool_topology.get_all_dists(u._Graph__graph,
                                              _prop("v", u, dist_map),